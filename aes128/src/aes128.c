@@ -33,74 +33,50 @@ typedef struct {
 
 
 // default key and iv used, if user didn't passed other one
-#define DEFAULT_KEY \
-    { 0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c }
-#define DEFAULT_IV \
-    { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f }
+static const uint8_t defaultKey[AES128_MAX_KEY_SIZE] = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+static const uint8_t defaultIv[AES128_MAX_KEY_SIZE]  = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
 
 static AES128_Descriptor aes128Desc;
+/// true if aes128Desc.ctx holds the ECB key schedule of aes128Desc.key
+static bool ecbScheduleValid;
 
 static bool AES128_Init(AES128_Mode mode, uint8_t const* key, uint8_t keySize, uint8_t const* iv);
 
 static bool AES128_Init(AES128_Mode mode, uint8_t const* key, uint8_t keySize, uint8_t const* iv) {
-    bool result     = false;
-    aes128Desc.mode = mode;
-    if (keySize <= sizeof(aes128Desc.key)) {
-        aes128Desc.keySize = keySize;
-        switch (mode) {
-            case MODE_CBC: {
-                if (iv == NULL) {
-                    uint8_t ivBuffer[] = DEFAULT_IV;
-                    memcpy(aes128Desc.iv, ivBuffer, keySize);
-                } else {
-                    memcpy(aes128Desc.iv, iv, keySize);
-                }
-
-                if (key == NULL) {
-                    uint8_t keyBuffer[] = DEFAULT_KEY;
-                    memcpy(aes128Desc.key, keyBuffer, keySize);
-                } else {
-                    memcpy(aes128Desc.key, key, keySize);
-                }
-
-                AES_init_ctx_iv(&aes128Desc.ctx, aes128Desc.key, aes128Desc.iv);
-                result = true;
-            } break;
-            case MODE_ECB:
-                (void)iv;
-
-                if (key == NULL) {
-                    uint8_t keyBuffer[] = DEFAULT_KEY;
-                    memcpy(aes128Desc.key, keyBuffer, keySize);
-                } else {
-                    memcpy(aes128Desc.key, key, keySize);
-                }
-
-                AES_init_ctx(&aes128Desc.ctx, aes128Desc.key);
-                result = true;
-                break;
-            case MODE_CTR:
-                if (iv == NULL) {
-                    uint8_t ivBuffer[] = DEFAULT_IV;
-                    memcpy(aes128Desc.iv, ivBuffer, keySize);
-                } else {
-                    memcpy(aes128Desc.iv, iv, keySize);
-                }
-
-                if (key == NULL) {
-                    uint8_t keyBuffer[] = DEFAULT_KEY;
-                    memcpy(aes128Desc.key, keyBuffer, keySize);
-                } else {
-                    memcpy(aes128Desc.key, key, keySize);
-                }
-
-                AES_init_ctx_iv(&aes128Desc.ctx, aes128Desc.key, aes128Desc.iv);
-                result = true;
-                break;
-            default: break;
-        }
+    if (keySize > sizeof(aes128Desc.key)) {
+        return false;
     }
-    return result;
+    if (key == NULL) {
+        key = defaultKey;
+    }
+    if (iv == NULL) {
+        iv = defaultIv;
+    }
+    switch (mode) {
+        case MODE_ECB:
+            // ECB context does not change while in use, the key schedule is kept as long as the key is the same
+            if (ecbScheduleValid && (MODE_ECB == aes128Desc.mode) && (keySize == aes128Desc.keySize) && (0 == memcmp(aes128Desc.key, key, keySize))) {
+                return true;
+            }
+            aes128Desc.mode    = mode;
+            aes128Desc.keySize = keySize;
+            memcpy(aes128Desc.key, key, keySize);
+            AES_init_ctx(&aes128Desc.ctx, aes128Desc.key);
+            ecbScheduleValid = true;
+            return true;
+        case MODE_CBC:
+        case MODE_CTR:
+            // CBC and CTR contexts carry the chaining state, they start over every time
+            aes128Desc.mode    = mode;
+            aes128Desc.keySize = keySize;
+            memcpy(aes128Desc.iv, iv, keySize);
+            memcpy(aes128Desc.key, key, keySize);
+            AES_init_ctx_iv(&aes128Desc.ctx, aes128Desc.key, aes128Desc.iv);
+            ecbScheduleValid = false;
+            return true;
+        default: break;
+    }
+    return false;
 }
 
 bool AES128_Encrypt(AES128_Mode mode, uint8_t const* key, uint8_t keySize, uint8_t const* iv, uint8_t* data, uint16_t length) {
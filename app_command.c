@@ -0,0 +1,141 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Command dispatcher shared by the UDP and MQTT-SN services
+*/
+
+#include "app_command.h"
+#include "app_log.h"
+#include "gpio_config.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "nrf_gpio.h"
+
+/**
+ * @brief Command handler.
+ * @param[in] parameter parameter given in the table
+ * @param[in] args arguments of a binary command, empty for a text one
+ * @param[in] argsSize size of the arguments [bytes]
+ * @return result of the command
+ */
+typedef app_command_result (*CommandHandler)(uint32_t parameter, uint8_t const* args, size_t argsSize);
+
+/// Row of the command table
+typedef struct {
+    char const*    name;      ///< text encoding
+    uint8_t        opcode;    ///< binary encoding, smaller than APP_COMMAND_MAX_OPCODES
+    CommandHandler handler;   ///< executes the command
+    uint32_t       parameter; ///< passed to the handler
+} Command;
+
+#define LED_PARAMETER(pin, on) (((uint32_t)(pin) << 1) | ((on) ? 1U : 0U))
+
+/// Switches a LED (active low), the parameter is LED_PARAMETER
+static app_command_result setLed(uint32_t parameter, uint8_t const* args, size_t argsSize) {
+    (void)args;
+    if (0 != argsSize) {
+        return APP_COMMAND_RESULT_INVALID_ARGS;
+    }
+    uint32_t pin = parameter >> 1;
+    if (0 != (parameter & 1U)) {
+        nrf_gpio_pin_clear(pin);
+    } else {
+        nrf_gpio_pin_set(pin);
+    }
+    return APP_COMMAND_RESULT_OK;
+}
+
+/// Commands, sorted by name (checked by app_command_init)
+static Command const commands[] = {
+    {"led1off", 0x02, setLed, LED_PARAMETER(LED1, false)},
+    {"led1on", 0x01, setLed, LED_PARAMETER(LED1, true)},
+    {"led2off", 0x04, setLed, LED_PARAMETER(LED2, false)},
+    {"led2on", 0x03, setLed, LED_PARAMETER(LED2, true)},
+    {"led3off", 0x06, setLed, LED_PARAMETER(LED3, false)},
+    {"led3on", 0x05, setLed, LED_PARAMETER(LED3, true)},
+    {"led4off", 0x08, setLed, LED_PARAMETER(LED4, false)},
+    {"led4on", 0x07, setLed, LED_PARAMETER(LED4, true)},
+};
+
+#define COMMAND_COUNT (sizeof(commands) / sizeof(commands[0]))
+_Static_assert(COMMAND_COUNT < UINT8_MAX, "Too many commands");
+
+/// Table row + 1 of every opcode, 0 for the unused ones
+static uint8_t opcodeIndex[APP_COMMAND_MAX_OPCODES];
+
+/// Compares a name that is not NUL-terminated with a command name
+static int compareName(char const* name, size_t nameLength, char const* commandName) {
+    int result = strncmp(name, commandName, nameLength);
+    if (0 == result) {
+        // equal up to nameLength, the shorter one goes first
+        result = (0 == commandName[nameLength]) ? 0 : -1;
+    }
+    return result;
+}
+
+static Command const* findByName(char const* name, size_t nameLength) {
+    size_t low  = 0;
+    size_t high = COMMAND_COUNT;
+    while (low < high) {
+        size_t middle = low + ((high - low) / 2);
+        int    result = compareName(name, nameLength, commands[middle].name);
+        if (0 == result) {
+            return &commands[middle];
+        }
+        if (result < 0) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return NULL;
+}
+
+void app_command_init(void) {
+    memset(opcodeIndex, 0, sizeof(opcodeIndex));
+    for (size_t i = 0; i < COMMAND_COUNT; ++i) {
+        if ((i > 0) && (strcmp(commands[i - 1].name, commands[i].name) >= 0)) {
+            printf("APP_COMMAND: Command table not sorted at '%s'\n", commands[i].name);
+        }
+        uint8_t opcode = commands[i].opcode;
+        if ((opcode >= APP_COMMAND_MAX_OPCODES) || (0 != opcodeIndex[opcode])) {
+            printf("APP_COMMAND: Invalid or repeated opcode of '%s'\n", commands[i].name);
+            continue;
+        }
+        opcodeIndex[opcode] = (uint8_t)(i + 1);
+    }
+}
+
+app_command_result app_command_execute(void const* payload, size_t payloadSize) {
+    uint8_t const* bytes = (uint8_t const*)payload;
+    Command const* command = NULL;
+    uint8_t const* args     = NULL;
+    size_t         argsSize = 0;
+
+    if ((payloadSize >= 2) && (APP_COMMAND_BINARY_MARKER == bytes[0])) {
+        if ((bytes[1] < APP_COMMAND_MAX_OPCODES) && (0 != opcodeIndex[bytes[1]])) {
+            command = &commands[opcodeIndex[bytes[1]] - 1];
+        }
+        args     = &bytes[2];
+        argsSize = payloadSize - 2;
+    } else {
+        // the name ends at the first white space or NUL character, if any
+        size_t nameLength = 0;
+        while ((nameLength < payloadSize) && (bytes[nameLength] > ' ')) {
+            nameLength++;
+        }
+        if (nameLength > 0) {
+            command = findByName((char const*)bytes, nameLength);
+        }
+    }
+    if (NULL == command) {
+        return APP_COMMAND_RESULT_UNKNOWN;
+    }
+    app_command_result result = command->handler(command->parameter, args, argsSize);
+    APP_LOG_INFO("APP_COMMAND: Command 0x%02x, result %u", command->opcode, (unsigned)result);
+    return result;
+}
@@ -0,0 +1,57 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Command dispatcher shared by the UDP and MQTT-SN services
+
+Commands are described by a single table (app_command.c), sorted by name, and are accepted in two encodings on every transport:
+ - text: the name of the command (e.g. "led1on"), optionally followed by white space or a NUL character; it is looked up by binary search,
+   the payload does not need to be NUL-terminated,
+ - binary: APP_COMMAND_BINARY_MARKER, the opcode of the command and its arguments; the opcode indexes the table directly.
+The marker is not a printable character, so the two encodings cannot be confused. Adding a command is adding a row to the table, the
+lookup does not grow into a chain of comparisons.
+
+Opcodes:
+ opcode | command
+ -------|-------------------------------------------------------------
+ 0x01   | led1on
+ 0x02   | led1off
+ 0x03   | led2on
+ 0x04   | led2off
+ 0x05   | led3on
+ 0x06   | led3off
+ 0x07   | led4on
+ 0x08   | led4off
+*/
+
+#ifndef APP_COMMAND_H_
+#define APP_COMMAND_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define APP_COMMAND_BINARY_MARKER 0xC0 ///< first byte of a command in the binary encoding
+#define APP_COMMAND_MAX_OPCODES   32   ///< opcodes are smaller than this
+
+/// Results of a command
+typedef enum {
+    APP_COMMAND_RESULT_OK,          ///< command executed
+    APP_COMMAND_RESULT_UNKNOWN,     ///< no such command
+    APP_COMMAND_RESULT_INVALID_ARGS ///< the command rejected its arguments
+} app_command_result;
+
+/**
+ * @brief Checks the command table and indexes the opcodes. Must be called before any command is executed.
+ */
+void app_command_init(void);
+
+/**
+ * @brief Executes a command received in either encoding.
+ * @param[in] payload command as received
+ * @param[in] payloadSize size of the payload [bytes]
+ * @return result of the command
+ */
+app_command_result app_command_execute(void const* payload, size_t payloadSize);
+
+#endif // APP_COMMAND_H_
@@ -0,0 +1,35 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Deferred binary logging over RTT
+*/
+
+#include "app_log.h"
+#include "embenet_critical_section.h"
+#include "embenet_timer.h"
+
+#include "SEGGER_RTT.h"
+
+/// RTT up-buffer of the binary log
+static uint8_t rttBuffer[APP_LOG_BUFFER_SIZE];
+
+void app_log_init(void) {
+    // records that do not fit are dropped whole, so the host always sees complete records
+    SEGGER_RTT_ConfigUpBuffer(APP_LOG_RTT_BUFFER, "app_log", rttBuffer, sizeof(rttBuffer), SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+}
+
+void app_log_write(int level, char const* format, uint32_t const* args, size_t argCount) {
+    uint32_t record[2 + APP_LOG_MAX_ARGS];
+    // the format section is linked at address 0, so the address of the string is its offset in the section
+    record[0] = ((uint32_t)(uintptr_t)format & 0xFFFFFFU) | ((uint32_t)level << 24) | ((uint32_t)argCount << 28);
+    record[1] = EMBENET_TIMER_ReadCounter();
+    for (size_t i = 0; i < argCount; ++i) {
+        record[2 + i] = args[i];
+    }
+    // the write is short and messages can come from any context of the stack, so it is done in the critical section
+    EMBENET_CRITICAL_SECTION_Enter();
+    SEGGER_RTT_WriteSkipNoLock(APP_LOG_RTT_BUFFER, record, (unsigned)((2 + argCount) * sizeof(uint32_t)));
+    EMBENET_CRITICAL_SECTION_Exit();
+}
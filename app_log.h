@@ -0,0 +1,77 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Deferred binary logging over RTT
+
+Log messages are not formatted on the target. Each message is written to its own RTT up-buffer (APP_LOG_RTT_BUFFER) as a single binary
+record: the identifier of the format string, the time and the raw arguments. The format strings are placed in the .app_log section,
+which is kept in the ELF file but not loaded into the flash, and the identifier is the offset of the string in that section. The host
+decodes the records with the strings taken from the ELF file (see tools/app_log_decode.py). A message costs a record copy into the RTT
+buffer; if the buffer is full the whole record is dropped, the target never waits for the host.
+
+Messages above APP_LOG_LEVEL (levels as in embetech/logger.h) are removed at compile time. The arguments must be integers of at most
+32 bits (%d, %i, %u, %x, %X, %c, with the PRI*32 macros), at most APP_LOG_MAX_ARGS of them; strings cannot be logged, as only their
+address would be sent.
+
+Record (little endian 32-bit words):
+ word   | field
+ -------|-----------------------------------------------------------
+ 0      | bits 0-23: format string offset, bits 24-27: level, bits 28-31: number of arguments
+ 1      | time [us] (port timer)
+ 2...   | arguments
+*/
+
+#ifndef APP_LOG_H_
+#define APP_LOG_H_
+
+#include <embetech/logger.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef APP_LOG_LEVEL
+#    define APP_LOG_LEVEL LOGGER_LEVEL_INFO ///< messages of higher (more verbose) levels are not compiled in
+#endif
+#define APP_LOG_RTT_BUFFER  1    ///< RTT up-buffer the records are written to, buffer 0 is the text terminal
+#define APP_LOG_BUFFER_SIZE 1024 ///< size of the RTT up-buffer [bytes]
+#define APP_LOG_MAX_ARGS    8    ///< maximum number of arguments of a message
+
+#define APP_LOG_ERROR(...)   APP_LOG_AT(LOGGER_LEVEL_ERROR, __VA_ARGS__)   ///< Logs an error message
+#define APP_LOG_WARNING(...) APP_LOG_AT(LOGGER_LEVEL_WARNING, __VA_ARGS__) ///< Logs a warning message
+#define APP_LOG_NOTICE(...)  APP_LOG_AT(LOGGER_LEVEL_NOTICE, __VA_ARGS__)  ///< Logs a notice message
+#define APP_LOG_INFO(...)    APP_LOG_AT(LOGGER_LEVEL_INFO, __VA_ARGS__)    ///< Logs an info message
+#define APP_LOG_DEBUG(...)   APP_LOG_AT(LOGGER_LEVEL_DEBUG, __VA_ARGS__)   ///< Logs a debug message
+#define APP_LOG_TRACE(...)   APP_LOG_AT(LOGGER_LEVEL_TRACE, __VA_ARGS__)   ///< Logs a trace message
+
+/**
+ * @brief Logs a message at the given level.
+ * @param[in] level one of LOGGER_LEVEL_*, known at compile time
+ * @param[in] format printf-like format string literal
+ * @param[in] ... integer arguments
+ */
+#define APP_LOG_AT(level, format, ...)                                                                                 \
+    do {                                                                                                               \
+        if (((level) > LOGGER_LEVEL_DISABLED) && ((level) <= APP_LOG_LEVEL)) {                                        \
+            static char const appLogFormat[] __attribute__((section(".app_log"), used)) = format;                     \
+            uint32_t const    appLogArgs[]                                              = {0, ##__VA_ARGS__};          \
+            _Static_assert(sizeof(appLogArgs) <= (APP_LOG_MAX_ARGS + 1) * sizeof(uint32_t), "Too many log arguments"); \
+            app_log_write((level), appLogFormat, &appLogArgs[1], (sizeof(appLogArgs) / sizeof(uint32_t)) - 1);      \
+        }                                                                                                              \
+    } while (0)
+
+/**
+ * @brief Configures the RTT up-buffer of the binary log. Must be called after SEGGER_RTT_Init.
+ */
+void app_log_init(void);
+
+/**
+ * @brief Writes a log record, use the APP_LOG_* macros instead.
+ * @param[in] level level of the message
+ * @param[in] format format string in the .app_log section
+ * @param[in] args arguments
+ * @param[in] argCount number of arguments
+ */
+void app_log_write(int level, char const* format, uint32_t const* args, size_t argCount);
+
+#endif // APP_LOG_H_
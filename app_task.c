@@ -0,0 +1,203 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Periodic tasks and task runtime statistics
+*/
+
+#include "app_task.h"
+#include "embenet_timer.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+/// Task created with this module
+typedef struct {
+    EMBENET_TaskId            taskId;       ///< id given by the stack
+    EMBENET_NODE_TaskFunction taskFunction; ///< wrapped function
+    void*                     context;      ///< context of the wrapped function
+    uint32_t                  periodMs;     ///< period [ms], 0 for tasks scheduled by the user
+    uint32_t                  phaseMs;      ///< offset of the runs within the period [ms]
+    app_task_stats            stats;        ///< runtime statistics
+} AppTask;
+
+/// Tasks created with this module
+static AppTask tasks[APP_TASK_MAX_TASKS];
+/// Number of created tasks
+static uint32_t taskCount;
+
+/**
+ * @brief Gets the current time of the given clock
+ *
+ * @param[in] timeSource clock
+ * @return current time [ms]
+ */
+static uint64_t getTime(EMBENET_NODE_TimeSource timeSource) {
+    return (EMBENET_NODE_TIME_SOURCE_NETWORK == timeSource) ? EMBENET_NODE_GetNetworkTime() : EMBENET_NODE_GetLocalTime();
+}
+
+/**
+ * @brief Gets the earliest time in the phase of the task, not earlier than the given one
+ *
+ * @param[in] task periodic task
+ * @param[in] notBefore lower bound [ms]
+ * @return time of the run [ms]
+ */
+static uint64_t nextRun(AppTask const* task, uint64_t notBefore) {
+    uint64_t run = notBefore - (notBefore % task->periodMs) + task->phaseMs;
+    return (run < notBefore) ? (run + task->periodMs) : run;
+}
+
+/**
+ * @brief Finds the task with the given id
+ *
+ * @param[in] taskId id given by the stack
+ * @return task or NULL if not created with this module
+ */
+static AppTask* findTask(EMBENET_TaskId taskId) {
+    for (uint32_t i = 0; i < taskCount; ++i) {
+        if (taskId == tasks[i].taskId) {
+            return &tasks[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Runs the wrapped task function and updates the statistics
+ *
+ * @param[in] taskId id of the task
+ * @param[in] timeSource time source used in scheduling
+ * @param[in] t time at which the task was scheduled
+ * @param[in] context task created with this module
+ */
+static void runTask(EMBENET_TaskId taskId, EMBENET_NODE_TimeSource timeSource, uint64_t t, void* context) {
+    AppTask* task = (AppTask*)context;
+    uint64_t now  = getTime(timeSource);
+
+    if (0 != task->periodMs) {
+        // the next run follows from the schedule, not from the moment this one happens to run
+        uint64_t next = t + task->periodMs;
+        EMBENET_NODE_TaskSchedule(taskId, timeSource, (next > now) ? next : nextRun(task, now + 1));
+    }
+
+    uint32_t       lateness = (now > t) ? (uint32_t)(now - t) : 0;
+    EMBENET_TimeUs start    = EMBENET_TIMER_ReadCounter();
+    task->taskFunction(taskId, timeSource, t, task->context);
+    uint32_t duration = (uint32_t)(EMBENET_TIMER_ReadCounter() - start);
+
+    app_task_stats* stats = &task->stats;
+    stats->runCount++;
+    stats->totalTimeUs += duration;
+    stats->totalLatenessMs += lateness;
+    if (duration > stats->maxTimeUs) {
+        stats->maxTimeUs = duration;
+    }
+    if (lateness > stats->maxLatenessMs) {
+        stats->maxLatenessMs = lateness;
+    }
+}
+
+/**
+ * @brief Task printing the statistics report
+ *
+ * @param[in] taskId id of the task
+ * @param[in] timeSource time source used in scheduling
+ * @param[in] t time at which the task was scheduled
+ * @param[in] context unused
+ */
+static void reportTask(EMBENET_TaskId taskId, EMBENET_NODE_TimeSource timeSource, uint64_t t, void* context) {
+    (void)taskId;
+    (void)timeSource;
+    (void)t;
+    (void)context;
+    app_task_print_stats();
+}
+
+/**
+ * @brief Registers a task with the stack
+ *
+ * @param[in] name name for the statistics report
+ * @param[in] taskFunction function run as the task
+ * @param[in] context passed to taskFunction
+ * @param[in] periodMs period [ms], 0 for tasks scheduled by the user
+ * @param[in] phaseMs offset of the runs within the period [ms]
+ * @return task identifier or EMBENET_TASKID_INVALID if the task has not been created
+ */
+static EMBENET_TaskId createTask(char const* name, EMBENET_NODE_TaskFunction taskFunction, void* context, uint32_t periodMs, uint32_t phaseMs) {
+    if ((NULL == taskFunction) || (taskCount >= APP_TASK_MAX_TASKS)) {
+        return EMBENET_TASKID_INVALID;
+    }
+    AppTask* task = &tasks[taskCount];
+    task->taskId  = EMBENET_NODE_TaskCreate(runTask, task);
+    if (EMBENET_TASKID_INVALID == task->taskId) {
+        return EMBENET_TASKID_INVALID;
+    }
+    task->taskFunction = taskFunction;
+    task->context      = context;
+    task->periodMs     = periodMs;
+    task->phaseMs      = phaseMs;
+    memset(&task->stats, 0, sizeof(task->stats));
+    task->stats.name = name;
+    taskCount++;
+    return task->taskId;
+}
+
+void app_task_init(void) {
+    taskCount = 0;
+#if APP_TASK_REPORT_PERIOD_MS > 0
+    EMBENET_TaskId reportTaskId = createTask("app_task", reportTask, NULL, APP_TASK_REPORT_PERIOD_MS, 0);
+    if ((EMBENET_TASKID_INVALID == reportTaskId) || (EMBENET_RESULT_OK != app_task_start(reportTaskId, EMBENET_NODE_TIME_SOURCE_LOCAL, APP_TASK_REPORT_PERIOD_MS))) {
+        printf("APP_TASK: Unable to start the statistics report\n");
+    }
+#endif
+}
+
+EMBENET_TaskId app_task_create(char const* name, EMBENET_NODE_TaskFunction taskFunction, void* context) {
+    return createTask(name, taskFunction, context, 0, 0);
+}
+
+EMBENET_TaskId app_task_create_periodic(char const* name, EMBENET_NODE_TaskFunction taskFunction, void* context, uint32_t periodMs, uint32_t phaseMs) {
+    if ((0 == periodMs) || (phaseMs >= periodMs)) {
+        return EMBENET_TASKID_INVALID;
+    }
+    return createTask(name, taskFunction, context, periodMs, phaseMs);
+}
+
+EMBENET_Result app_task_start(EMBENET_TaskId taskId, EMBENET_NODE_TimeSource timeSource, uint32_t delayMs) {
+    AppTask* task = findTask(taskId);
+    if ((NULL == task) || (0 == task->periodMs)) {
+        return EMBENET_RESULT_INVALID_ARGUMENT;
+    }
+    return EMBENET_NODE_TaskSchedule(taskId, timeSource, nextRun(task, getTime(timeSource) + delayMs));
+}
+
+bool app_task_get_stats(EMBENET_TaskId taskId, app_task_stats* stats) {
+    AppTask const* task = findTask(taskId);
+    if ((NULL == task) || (NULL == stats)) {
+        return false;
+    }
+    *stats = task->stats;
+    return true;
+}
+
+void app_task_reset_stats(void) {
+    for (uint32_t i = 0; i < taskCount; ++i) {
+        char const* name = tasks[i].stats.name;
+        memset(&tasks[i].stats, 0, sizeof(tasks[i].stats));
+        tasks[i].stats.name = name;
+    }
+}
+
+void app_task_print_stats(void) {
+    for (uint32_t i = 0; i < taskCount; ++i) {
+        app_task_stats const* stats = &tasks[i].stats;
+        if (0 == stats->runCount) {
+            continue;
+        }
+        printf("APP_TASK: %-16s runs %" PRIu32 ", time avg %" PRIu32 "us max %" PRIu32 "us, lateness avg %" PRIu32 "ms max %" PRIu32 "ms\n", stats->name,
+               stats->runCount, (uint32_t)(stats->totalTimeUs / stats->runCount), stats->maxTimeUs, (uint32_t)(stats->totalLatenessMs / stats->runCount),
+               stats->maxLatenessMs);
+    }
+}
@@ -0,0 +1,96 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Periodic tasks and task runtime statistics
+
+Tasks created here are regular embeNET Node tasks (the returned id works with all EMBENET_NODE_Task* functions), run through a wrapper that
+keeps statistics: the number of runs, the cumulative and the longest execution time and the lateness of every run against the time it was
+scheduled for. The execution time is measured with the port timer, so it has the resolution of one port timer tick.
+
+Periodic tasks run at the times t for which t modulo the period equals the phase. The next run is scheduled from the scheduled time of
+the current one, before the task function is called, so late runs never make the task drift; runs missed entirely are skipped. With the
+network time source every node runs the task at the same moment. A periodic task function may still reschedule or cancel its task.
+
+*/
+
+#ifndef APP_TASK_H_
+#define APP_TASK_H_
+
+#include "embenet_node.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define APP_TASK_MAX_TASKS        16    ///< maximum number of tasks
+#define APP_TASK_REPORT_PERIOD_MS 60000 ///< period of the statistics report printed by the module, 0 for none [ms]
+
+/// Runtime statistics of a task
+typedef struct {
+    char const* name;            ///< name given at creation
+    uint32_t    runCount;        ///< number of runs
+    uint64_t    totalTimeUs;     ///< cumulative execution time [us]
+    uint32_t    maxTimeUs;       ///< longest execution time [us]
+    uint64_t    totalLatenessMs; ///< cumulative delay of the runs against their scheduled time [ms]
+    uint32_t    maxLatenessMs;   ///< longest delay of a run against its scheduled time [ms]
+} app_task_stats;
+
+/**
+ * @brief Initializes the task statistics and starts the periodic statistics report.
+ *
+ * Must be called after the stack is initialized and before any task is created with this module.
+ */
+void app_task_init(void);
+
+/**
+ * @brief Creates a task with runtime statistics, scheduled with EMBENET_NODE_TaskSchedule like any other task.
+ * @param[in] name name for the statistics report, must stay valid
+ * @param[in] taskFunction function run as the task
+ * @param[in] context passed to taskFunction
+ * @return task identifier or EMBENET_TASKID_INVALID if the task has not been created
+ */
+EMBENET_TaskId app_task_create(char const* name, EMBENET_NODE_TaskFunction taskFunction, void* context);
+
+/**
+ * @brief Creates a periodic task with runtime statistics. The task runs once started with @ref app_task_start.
+ * @param[in] name name for the statistics report, must stay valid
+ * @param[in] taskFunction function run as the task
+ * @param[in] context passed to taskFunction
+ * @param[in] periodMs period [ms], not 0
+ * @param[in] phaseMs offset of the runs within the period [ms], smaller than the period
+ * @return task identifier or EMBENET_TASKID_INVALID if the task has not been created
+ */
+EMBENET_TaskId app_task_create_periodic(char const* name, EMBENET_NODE_TaskFunction taskFunction, void* context, uint32_t periodMs, uint32_t phaseMs);
+
+/**
+ * @brief Starts a periodic task.
+ *
+ * The first run is the earliest one, in the phase of the task, at least delayMs from now. A task running on the network time stops when
+ * the node loses the synchronization (it cannot be scheduled any more) and has to be started again.
+ *
+ * @param[in] taskId task created with @ref app_task_create_periodic
+ * @param[in] timeSource clock the period and the phase refer to
+ * @param[in] delayMs minimum time to the first run [ms]
+ * @return result of EMBENET_NODE_TaskSchedule, EMBENET_RESULT_INVALID_ARGUMENT if the task is not periodic
+ */
+EMBENET_Result app_task_start(EMBENET_TaskId taskId, EMBENET_NODE_TimeSource timeSource, uint32_t delayMs);
+
+/**
+ * @brief Gets the runtime statistics of a task.
+ * @param[in] taskId task created with this module
+ * @param[out] stats statistics
+ * @return true if the statistics were written, false if the task is unknown
+ */
+bool app_task_get_stats(EMBENET_TaskId taskId, app_task_stats* stats);
+
+/**
+ * @brief Restarts the runtime statistics of all tasks.
+ */
+void app_task_reset_stats(void);
+
+/**
+ * @brief Prints the runtime statistics of all tasks.
+ */
+void app_task_print_stats(void);
+
+#endif // APP_TASK_H_
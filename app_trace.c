@@ -0,0 +1,121 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Trace handlers shared by the demo modules
+*/
+
+#include "app_trace.h"
+#include "embenet_node_trace.h"
+#include "embenet_port_channel_quality.h"
+#include "energy_monitor.h"
+#include "free_slot_jobs.h"
+#include "slot_profiler.h"
+#include "trace_recorder.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Called by the stack when a transmitted frame was not acknowledged
+ *
+ * @param[in] linkLocalDestinationEui EUI of the next hop
+ * @param[in] destinationEui EUI of the final destination
+ * @param[in] attempt transmission attempt that failed
+ */
+static void onPacketNoAck(uint64_t linkLocalDestinationEui, uint64_t destinationEui, uint8_t attempt) {
+    trace_recorder_packet_no_ack(linkLocalDestinationEui, destinationEui, attempt);
+    // the missing ACK is accounted to the channel of the transmission that just failed
+    EMBENET_CHANNEL_QUALITY_OnPacketNoAck();
+    energy_monitor_on_packet_no_ack();
+}
+
+/**
+ * @brief Called by the stack when a frame is sent or received
+ *
+ * @param[in] linkLayerTelemetry description of the frame
+ */
+static void onLinkLayerEvent(EMBENET_TRACE_LinkLayerTelemetry const* linkLayerTelemetry) {
+    energy_monitor_on_link_layer_event(linkLayerTelemetry);
+    trace_recorder_link_layer_event(linkLayerTelemetry);
+}
+
+/**
+ * @brief Called by the stack when it has free time ahead
+ *
+ * @param[in] asn ASN of the first free slot
+ * @param[in] startNwkTime network time the free period starts at
+ * @param[in] durationUs length of the free period [us]
+ */
+static void onFreeSlots(uint64_t asn, uint64_t startNwkTime, uint32_t durationUs) {
+    free_slot_jobs_on_free_slots(asn, startNwkTime, durationUs);
+    trace_recorder_free_slots(asn, startNwkTime, durationUs);
+}
+
+/**
+ * @brief Called by the stack when an active slot starts and ends
+ *
+ * @param[in] enters true if the slot starts, false if it ends
+ */
+static void onSlotStartEnd(bool enters) {
+    slot_profiler_mark(SLOT_PROFILER_SECTION_SLOT, enters);
+    energy_monitor_on_slot(enters);
+    trace_recorder_slot(enters);
+}
+
+/**
+ * @brief Called by the stack when the MAC layer enters and leaves its routines
+ *
+ * @param[in] enters true on entry, false on exit
+ */
+static void onMacRoutine(bool enters) {
+    slot_profiler_mark(SLOT_PROFILER_SECTION_MAC, enters);
+    trace_recorder_mac_routine(enters);
+}
+
+/**
+ * @brief Called by the stack when it enters and leaves the radio API
+ *
+ * @param[in] enters true on entry, false on exit
+ */
+static void onRadioApiUsed(bool enters) {
+    slot_profiler_mark(SLOT_PROFILER_SECTION_RADIO_API, enters);
+    trace_recorder_radio_api(enters);
+}
+
+/**
+ * @brief Called when the radio interrupt is entered and left
+ *
+ * @param[in] enters true on entry, false on exit
+ */
+static void onRadioIsr(bool enters) {
+    slot_profiler_mark(SLOT_PROFILER_SECTION_RADIO_ISR, enters);
+    trace_recorder_radio_isr(enters);
+}
+
+void app_trace_init(void) {
+    static const EMBENET_NODE_TraceHandlers traceHandlers = {
+        .onStarted            = trace_recorder_started,
+        .onSynchronized       = trace_recorder_synchronized,
+        .onDesynchronized     = trace_recorder_desynchronized,
+        .onPacketNoAck        = onPacketNoAck,
+        .onManagedPacketNoAck = trace_recorder_managed_packet_no_ack,
+        .onPacketNotDelivered = trace_recorder_packet_not_delivered,
+        .onJoined             = trace_recorder_joined,
+        .onSyncCorrection     = trace_recorder_sync_correction,
+        .onParentSelected     = trace_recorder_parent_selected,
+        .onParentLost         = trace_recorder_parent_lost,
+        .onNeighborAdded      = trace_recorder_neighbor_added,
+        .onNeighborRemoved    = trace_recorder_neighbor_removed,
+        .onRankUpdate         = trace_recorder_rank_update,
+        .onQueueLength        = trace_recorder_queue_length,
+        .onEnmsStatusSent     = trace_recorder_enms_status_sent,
+        .onLinkLayerEvent     = onLinkLayerEvent,
+        .onFreeSlots          = onFreeSlots,
+        .onSlotStartEnd       = onSlotStartEnd,
+        .onMacRoutine         = onMacRoutine,
+        .onRadioApiUsed       = onRadioApiUsed,
+        .onRadioIsr           = onRadioIsr,
+    };
+    EMBENET_NODE_SetTraceHandlers(&traceHandlers);
+}
@@ -0,0 +1,19 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Trace handlers shared by the demo modules
+*/
+
+#ifndef APP_TRACE_H_
+#define APP_TRACE_H_
+
+/**
+ * @brief Installs the trace handlers of the demo application.
+ *
+ * The stack accepts a single set of trace handlers, so every demo module that needs trace events gets them dispatched from here.
+ */
+void app_trace_init(void);
+
+#endif
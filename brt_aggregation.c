@@ -0,0 +1,76 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Negotiation of the aggregated framing on the border router link (root only)
+*/
+
+#include "brt_aggregation.h"
+#include "embenet_node.h"
+#include "embenet_port_brt.h"
+#include "embenet_udp.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/// Socket the negotiation goes through
+static EMBENET_UDP_SocketDescriptor negotiationSocket;
+/// True while the offers are taken
+static bool started;
+
+static void sendStatus(EMBENET_IPV6 const* borderRouterAddress, uint16_t borderRouterPort) {
+    uint8_t status[3] = {BRT_AGGREGATION_MSG_STATUS, BRT_AGGREGATION_VERSION, EMBENET_BRT_IsAggregationEnabled() ? 1 : 0};
+    if (EMBENET_RESULT_OK != EMBENET_UDP_Send(&negotiationSocket, borderRouterAddress, borderRouterPort, status, sizeof(status))) {
+        printf("BRT_AGGREGATION: Failed to send the status\n");
+    }
+}
+
+static void onReceived(EMBENET_UDP_SocketDescriptor const* socket, EMBENET_IPV6 const* sourceAddress, uint16_t sourcePort, void const* data, size_t dataSize) {
+    (void)socket;
+    uint8_t const* message = (uint8_t const*)data;
+    EMBENET_IPV6   borderRouterAddress;
+    if (!started || (0 == dataSize) || (EMBENET_RESULT_OK != EMBENET_NODE_GetBorderRouterAddress(&borderRouterAddress))) {
+        return;
+    }
+    // a framing the border router cannot decode would cut the whole network off, nobody else may switch it
+    if (0 != memcmp(sourceAddress->val, borderRouterAddress.val, sizeof(borderRouterAddress.val))) {
+        return;
+    }
+    switch (message[0]) {
+        case BRT_AGGREGATION_MSG_OFFER:
+            if ((dataSize >= 2) && (message[1] >= BRT_AGGREGATION_VERSION)) {
+                EMBENET_BRT_SetAggregation(true);
+            }
+            break;
+        case BRT_AGGREGATION_MSG_WITHDRAW: EMBENET_BRT_SetAggregation(false); break;
+        default: return;
+    }
+    printf("BRT_AGGREGATION: Aggregated framing %s\n", EMBENET_BRT_IsAggregationEnabled() ? "on" : "off");
+    sendStatus(sourceAddress, sourcePort);
+}
+
+void brt_aggregation_init(void) {
+    negotiationSocket = (EMBENET_UDP_SocketDescriptor){
+        .port           = BRT_AGGREGATION_PORT,
+        .groupId        = 0,
+        .handledTraffic = EMBENET_UDP_TRAFFIC_UNICAST,
+        .rxDataHandler  = onReceived,
+        .userContext    = NULL,
+    };
+    EMBENET_Result status = EMBENET_UDP_RegisterSocket(&negotiationSocket);
+    if (EMBENET_RESULT_OK != status) {
+        printf("BRT_AGGREGATION: Registering socket failed with status %d\n", (int)status);
+    }
+}
+
+void brt_aggregation_start(void) {
+    started = true;
+}
+
+void brt_aggregation_stop(void) {
+    started = false;
+    EMBENET_BRT_SetAggregation(false);
+}
@@ -0,0 +1,48 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Negotiation of the aggregated framing on the border router link (root only)
+
+The border router turns the aggregated framing of the root's frames (embenet_port_brt.h) on and off with UDP messages sent to the root
+on BRT_AGGREGATION_PORT. The root takes them only from the border router address and answers each with its status:
+ message   | direction            | bytes
+ ----------|----------------------|-------------------------------------------------------------------------------
+ offer     | border router > root | BRT_AGGREGATION_MSG_OFFER, highest format version the border router decodes
+ withdraw  | border router > root | BRT_AGGREGATION_MSG_WITHDRAW
+ status    | root > border router | BRT_AGGREGATION_MSG_STATUS, BRT_AGGREGATION_VERSION, 1 if aggregating else 0
+
+The border router decodes aggregated frames from the moment it sends the offer, so it does not matter whether the status goes out in
+an aggregated frame or not. The root stops aggregating on a withdraw, when it leaves the network, and whenever the stack re-establishes
+the link (EMBENET_BRT_Init), after which the border router offers again. A root built without EMBENET_PORT_BRT_AGGREGATION answers
+every offer with aggregation off.
+*/
+
+#ifndef BRT_AGGREGATION_H_
+#define BRT_AGGREGATION_H_
+
+#include <stdint.h>
+
+#define BRT_AGGREGATION_PORT         UINT16_C(0xf0b3) ///< UDP port of the negotiation, next to PERF_REPORT_PORT
+#define BRT_AGGREGATION_VERSION      1                ///< format of the aggregated frames: records of a length byte followed by the packet
+#define BRT_AGGREGATION_MSG_OFFER    0x01             ///< the border router takes aggregated frames
+#define BRT_AGGREGATION_MSG_WITHDRAW 0x02             ///< the border router takes plain frames only
+#define BRT_AGGREGATION_MSG_STATUS   0x03             ///< answer of the root
+
+/**
+ * @brief Initializes the negotiation, registering its socket.
+ */
+void brt_aggregation_init(void);
+
+/**
+ * @brief Starts taking offers from the border router.
+ */
+void brt_aggregation_start(void);
+
+/**
+ * @brief Stops taking offers and turns the aggregation off.
+ */
+void brt_aggregation_stop(void);
+
+#endif
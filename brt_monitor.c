@@ -0,0 +1,83 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Monitoring of the border router link (root only)
+*/
+
+#include "brt_monitor.h"
+#include "app_task.h"
+#include "embenet_node.h"
+#include "embenet_port_brt.h"
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define REPORT_PERIOD_MS 60000 ///< period of the link statistics report [ms]
+
+/// ENMS service instance the link health is reported through
+static EnmsNode* monitorEnmsNode;
+/// Id of the reporting task
+static EMBENET_TaskId reportTaskId = EMBENET_TASKID_INVALID;
+/// Statistics at the previous report
+static EMBENET_BRT_Stats lastStats;
+
+/**
+ * @brief Task reporting the link statistics
+ *
+ * @param[in] taskId id of the task
+ * @param[in] timeSource time source used in scheduling
+ * @param[in] t time at which the task was scheduled
+ * @param[in] context unused
+ */
+static void reportTask(EMBENET_TaskId taskId, EMBENET_NODE_TimeSource timeSource, uint64_t t, void* context) {
+    (void)context;
+    EMBENET_BRT_Stats stats;
+    EMBENET_BRT_GetStats(&stats);
+
+    uint32_t frameErrors = (stats.crcErrors - lastStats.crcErrors) + (stats.framingErrors - lastStats.framingErrors);
+    uint32_t rxOverruns  = stats.rxOverruns - lastStats.rxOverruns;
+    uint32_t txStalls    = stats.txStalls - lastStats.txStalls;
+    uint32_t dropped     = stats.packetsDropped - lastStats.packetsDropped;
+    printf("BRT_MONITOR: in %" PRIu32 "B/%" PRIu32 " frames, out %" PRIu32 "B/%" PRIu32 " frames, CRC errors %" PRIu32 ", framing errors %" PRIu32 "\n",
+           stats.bytesIn - lastStats.bytesIn, stats.framesIn - lastStats.framesIn, stats.bytesOut - lastStats.bytesOut, stats.framesOut - lastStats.framesOut,
+           stats.crcErrors - lastStats.crcErrors, stats.framingErrors - lastStats.framingErrors);
+    printf("BRT_MONITOR: RX overruns %" PRIu32 "B, TX stalls %" PRIu32 "B, dropped packets %" PRIu32 ", output space %uB, high-watermarks: input %" PRIu32 "B, output %" PRIu32 "B, frames %" PRIu32
+           ", longest transmission %" PRIu32 "us\n",
+           rxOverruns, txStalls, dropped, (unsigned)EMBENET_BRT_GetOutputSpace(), stats.inputHighWatermark, stats.outputHighWatermark, stats.pendingFrameHighWatermark, stats.maxTransmissionTimeUs);
+
+    uint8_t state = BRT_MONITOR_STATE_RUNNING;
+    if (0 != frameErrors) {
+        state |= BRT_MONITOR_STATE_FRAME_ERRORS;
+    }
+    if (0 != rxOverruns) {
+        state |= BRT_MONITOR_STATE_RX_OVERRUNS;
+    }
+    if ((0 != txStalls) || (0 != dropped)) {
+        state |= BRT_MONITOR_STATE_TX_STALLS;
+    }
+    (void)ENMS_NODE_SetServiceState(monitorEnmsNode, BRT_MONITOR_SERVICE_NAME, state);
+
+    lastStats = stats;
+}
+
+void brt_monitor_init(EnmsNode* enmsNode) {
+    monitorEnmsNode = enmsNode;
+    reportTaskId    = app_task_create_periodic("brt_monitor", reportTask, NULL, REPORT_PERIOD_MS, 0);
+    if (EMBENET_TASKID_INVALID == reportTaskId) {
+        printf("BRT_MONITOR: Unable to create task\n");
+    }
+    (void)ENMS_NODE_RegisterService(monitorEnmsNode, BRT_MONITOR_SERVICE_NAME, 0);
+}
+
+void brt_monitor_start(void) {
+    EMBENET_BRT_GetStats(&lastStats);
+    (void)ENMS_NODE_SetServiceState(monitorEnmsNode, BRT_MONITOR_SERVICE_NAME, BRT_MONITOR_STATE_RUNNING);
+    app_task_start(reportTaskId, EMBENET_NODE_TIME_SOURCE_LOCAL, REPORT_PERIOD_MS);
+}
+
+void brt_monitor_stop(void) {
+    EMBENET_NODE_TaskCancel(reportTaskId);
+    (void)ENMS_NODE_SetServiceState(monitorEnmsNode, BRT_MONITOR_SERVICE_NAME, 0);
+}
@@ -0,0 +1,48 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Monitoring of the border router link (root only)
+
+Periodically reads the border router link statistics, prints the changes over the period and reports the health of the link as the
+state of the "brt" service in ENMS. ENMS carries a single state byte per service, so the state is a set of flags, each telling that
+something went wrong during the last period:
+ bit    | meaning
+ -------|-----------------------------------------------------------
+ 0      | BRT_MONITOR_STATE_RUNNING, always set while the monitor runs
+ 1      | BRT_MONITOR_STATE_FRAME_ERRORS, frames dropped because of a wrong FCS or framing
+ 2      | BRT_MONITOR_STATE_RX_OVERRUNS, received bytes lost, the input buffer was full
+ 3      | BRT_MONITOR_STATE_TX_STALLS, bytes or packets to send lost, the output buffer was full
+*/
+
+#ifndef BRT_MONITOR_H_
+#define BRT_MONITOR_H_
+
+#include "enms_node.h"
+
+#define BRT_MONITOR_SERVICE_NAME       "brt" ///< name of the service reported in ENMS
+#define BRT_MONITOR_STATE_RUNNING      0x01  ///< state flag, set while the monitor runs
+#define BRT_MONITOR_STATE_FRAME_ERRORS 0x02  ///< state flag, set if frames were dropped during the last period
+#define BRT_MONITOR_STATE_RX_OVERRUNS  0x04  ///< state flag, set if received bytes were lost during the last period
+#define BRT_MONITOR_STATE_TX_STALLS    0x08  ///< state flag, set if bytes or packets to send were lost during the last period
+
+/**
+ * @brief Initializes the border router link monitor.
+ *
+ * Creates the reporting task and registers the service in ENMS.
+ * @param[in] enmsNode ENMS Node service instance the link health is reported through
+ */
+void brt_monitor_init(EnmsNode* enmsNode);
+
+/**
+ * @brief Starts the border router link monitor.
+ */
+void brt_monitor_start(void);
+
+/**
+ * @brief Stops the border router link monitor.
+ */
+void brt_monitor_stop(void);
+
+#endif
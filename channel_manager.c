@@ -0,0 +1,245 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Network-wide management of the channel hopping list
+*/
+
+#include "channel_manager.h"
+#include "app_task.h"
+#include "embenet_node.h"
+#include "embenet_port_channel_quality.h"
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define EVALUATION_PERIOD_MS  60000                                       ///< period of link quality evaluation and reporting [ms]
+#define FIRST_REPORT_DELAY_MS 2000                                        ///< delay of the first report after joining, lets the backend send the current map early [ms]
+#define REPORT_SIZE           (19 + EMBENET_CHANNEL_QUALITY_CHANNEL_COUNT) ///< size of the report message [bytes]
+#define MAP_SIZE              18                                          ///< size of the channel map message [bytes]
+
+/// Socket descriptor of the channel manager
+static EMBENET_UDP_SocketDescriptor channelManagerSocket;
+/// Id of the task evaluating the link quality and sending reports
+static EMBENET_TaskId evaluationTaskId = EMBENET_TASKID_INVALID;
+/// Id of the task applying the pending channel map
+static EMBENET_TaskId applyTaskId = EMBENET_TASKID_INVALID;
+
+/// Channel map state
+static struct {
+    EMBENET_PANID       panId;            ///< network the channel map belongs to
+    bool                mapApplied;       ///< true if a channel map was applied in this network
+    uint8_t             epoch;            ///< epoch of the applied channel map
+    uint64_t            appliedTime;      ///< application time of the applied channel map
+    bool                pending;          ///< true if a channel map waits for its application time
+    uint8_t             pendingEpoch;     ///< epoch of the pending channel map
+    uint64_t            pendingTime;      ///< application time of the pending channel map
+    EMBENET_ChannelMask pendingBlacklist; ///< blacklist of the pending channel map
+} channelMap;
+
+static void putU64(uint8_t* buffer, uint64_t value) {
+    for (unsigned i = 0; i < 8; ++i) {
+        buffer[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint64_t getU64(uint8_t const* buffer) {
+    uint64_t value = 0;
+    for (unsigned i = 0; i < 8; ++i) {
+        value |= ((uint64_t)buffer[i]) << (8 * i);
+    }
+    return value;
+}
+
+/**
+ * @brief Checks if the channel map is later than the applied or pending one
+ *
+ * The application time never wraps, unlike the epoch, so it also orders the maps for a node that has just joined.
+ *
+ * @param[in] applyTime network time at which the received channel map is applied
+ */
+static bool isCurrentMap(uint64_t applyTime) {
+    if (channelMap.pending) {
+        return applyTime > channelMap.pendingTime;
+    }
+    if (channelMap.mapApplied) {
+        return applyTime > channelMap.appliedTime;
+    }
+    return true;
+}
+
+/**
+ * @brief Checks if the channel map comes from the border router or the parent
+ *
+ * @param[in] sourceAddress IPv6 Address of the packet originator
+ */
+static bool isTrustedSender(EMBENET_IPV6 const* sourceAddress) {
+    EMBENET_IPV6 address;
+    if ((EMBENET_RESULT_OK == EMBENET_NODE_GetBorderRouterAddress(&address)) && (0 == memcmp(sourceAddress->val, address.val, sizeof(address.val)))) {
+        return true;
+    }
+    return (EMBENET_RESULT_OK == EMBENET_NODE_GetParentAddress(&address)) && (0 == memcmp(sourceAddress->val, address.val, sizeof(address.val)));
+}
+
+/**
+ * @brief Applies the pending channel map
+ */
+static void applyPendingMap(void) {
+    channelMap.pending = false;
+    if (EMBENET_CHANNEL_QUALITY_SetBlacklist(channelMap.pendingBlacklist)) {
+        channelMap.mapApplied  = true;
+        channelMap.epoch       = channelMap.pendingEpoch;
+        channelMap.appliedTime = channelMap.pendingTime;
+        printf("CHANNEL_MANAGER: Applied channel map epoch %u, blacklist 0x%08" PRIx32 "%08" PRIx32 "\n", (unsigned)channelMap.epoch,
+               (uint32_t)(channelMap.pendingBlacklist >> 32), (uint32_t)channelMap.pendingBlacklist);
+    } else {
+        printf("CHANNEL_MANAGER: Channel map epoch %u rejected, too few channels left\n", (unsigned)channelMap.pendingEpoch);
+    }
+}
+
+/**
+ * @brief Task applying the pending channel map at its network time
+ *
+ * @param[in] taskId id of the task
+ * @param[in] timeSource time source (local time or network time)
+ * @param[in] t time at which the task was scheduled to run
+ * @param[in] context generic, user-defined context
+ */
+static void applyTask(EMBENET_TaskId taskId, EMBENET_NODE_TimeSource timeSource, uint64_t t, void* context) {
+    if (channelMap.pending) {
+        applyPendingMap();
+    }
+}
+
+/**
+ * @brief Sends the report with the link quality of all data channels to the border router
+ *
+ * @param[in] proposal proposed blacklist
+ */
+static void sendReport(EMBENET_ChannelMask proposal) {
+    uint8_t report[REPORT_SIZE];
+    report[0] = CHANNEL_MANAGER_MSG_REPORT;
+    report[1] = channelMap.mapApplied ? CHANNEL_MANAGER_FLAG_MAP_APPLIED : 0;
+    report[2] = channelMap.epoch;
+    putU64(&report[3], EMBENET_CHANNEL_QUALITY_GetBlacklist());
+    putU64(&report[11], proposal);
+    for (uint8_t ch = 0; ch < EMBENET_CHANNEL_QUALITY_CHANNEL_COUNT; ++ch) {
+        EMBENET_ChannelQualityStats stats;
+        report[19 + ch] = EMBENET_CHANNEL_QUALITY_GetStats(ch, &stats) ? stats.score : 0;
+    }
+
+    EMBENET_IPV6 borderRouterAddress;
+    EMBENET_NODE_GetBorderRouterAddress(&borderRouterAddress);
+    if (EMBENET_RESULT_OK != EMBENET_UDP_Send(&channelManagerSocket, &borderRouterAddress, CHANNEL_MANAGER_PORT, report, sizeof(report))) {
+        printf("CHANNEL_MANAGER: Failed to send report\n");
+    }
+}
+
+/**
+ * @brief Task evaluating the link quality of the data channels and reporting it to the border router
+ *
+ * @param[in] taskId id of the task
+ * @param[in] timeSource time source (local time or network time)
+ * @param[in] t time at which the task was scheduled to run
+ * @param[in] context generic, user-defined context
+ */
+static void evaluationTask(EMBENET_TaskId taskId, EMBENET_NODE_TimeSource timeSource, uint64_t t, void* context) {
+    EMBENET_ChannelMask proposal = EMBENET_CHANNEL_QUALITY_Evaluate();
+    if (proposal != EMBENET_CHANNEL_QUALITY_GetBlacklist()) {
+        printf("CHANNEL_MANAGER: Proposed blacklist 0x%08" PRIx32 "%08" PRIx32 "\n", (uint32_t)(proposal >> 32), (uint32_t)proposal);
+    }
+    sendReport(proposal);
+}
+
+/**
+ * @brief Handles the channel map messages
+ *
+ * @param[in] socket pointer to socket descriptor
+ * @param[in] sourceAddress IPv6 Address of the packet originator
+ * @param[in] sourcePort UDP source port
+ * @param[in] data pointer to datagram's payload
+ * @param[in] dataSize size of datagram's payload
+ */
+static void channelManagerReceptionHandler(EMBENET_UDP_SocketDescriptor const* socket, EMBENET_IPV6 const* sourceAddress, uint16_t sourcePort, void const* data,
+                                           size_t dataSize) {
+    uint8_t const* msg = (uint8_t const*)data;
+
+    if ((dataSize < MAP_SIZE) || (CHANNEL_MANAGER_MSG_MAP != msg[0])) {
+        printf("CHANNEL_MANAGER: Unrecognized message with size: %d\n", (int)dataSize);
+        return;
+    }
+    // a map from anyone else would desynchronize the node from the network
+    if (!isTrustedSender(sourceAddress)) {
+        printf("CHANNEL_MANAGER: Channel map from an untrusted sender dropped\n");
+        return;
+    }
+    uint8_t  epoch     = msg[1];
+    uint64_t applyTime = getU64(&msg[2]);
+    if (!isCurrentMap(applyTime)) {
+        // the same map arrives again through other paths of the multicast, or an older one arrives late
+        return;
+    }
+    channelMap.pending          = true;
+    channelMap.pendingEpoch     = epoch;
+    channelMap.pendingTime      = applyTime;
+    channelMap.pendingBlacklist = getU64(&msg[10]);
+
+    if (applyTime <= EMBENET_NODE_GetNetworkTime()) {
+        applyPendingMap();
+    } else {
+        printf("CHANNEL_MANAGER: Channel map epoch %u received, applied at network time %" PRIu32 "ms\n", (unsigned)epoch, (uint32_t)applyTime);
+        EMBENET_NODE_TaskSchedule(applyTaskId, EMBENET_NODE_TIME_SOURCE_NETWORK, applyTime);
+    }
+}
+
+void channel_manager_init(void) {
+    // the remapping of the blacklisted channels depends on the slot
+    EMBENET_CHANNEL_QUALITY_SetAsnSource(EMBENET_NODE_GetNetworkAsn);
+    // Channel maps arrive both unicast and to the multicast group of the channel manager
+    channelManagerSocket = (EMBENET_UDP_SocketDescriptor){
+        .port           = CHANNEL_MANAGER_PORT,
+        .groupId        = CHANNEL_MANAGER_GROUP_ID,
+        .handledTraffic = EMBENET_UDP_TRAFFIC_ALL,
+        .rxDataHandler  = channelManagerReceptionHandler,
+        .userContext    = NULL,
+    };
+
+    EMBENET_Result channelManagerSocketRegistrationStatus = EMBENET_UDP_RegisterSocket(&channelManagerSocket);
+    if (EMBENET_RESULT_OK == channelManagerSocketRegistrationStatus) {
+        evaluationTaskId = app_task_create_periodic("channel_eval", evaluationTask, NULL, EVALUATION_PERIOD_MS, 0);
+        applyTaskId      = app_task_create("channel_apply", applyTask, NULL);
+        if ((EMBENET_TASKID_INVALID == evaluationTaskId) || (EMBENET_TASKID_INVALID == applyTaskId)) {
+            printf("CHANNEL_MANAGER: Unable to create task\n");
+        } else {
+            printf("CHANNEL_MANAGER: Service initialized\n");
+        }
+    } else {
+        printf("CHANNEL_MANAGER: Registering socket failed with status %d\n", (int)channelManagerSocketRegistrationStatus);
+    }
+}
+
+void channel_manager_start(EMBENET_PANID panId) {
+    printf("CHANNEL_MANAGER: Starting service\n");
+    // the blacklist of another network must not be used in this one
+    if (panId != channelMap.panId) {
+        channelMap.panId      = panId;
+        channelMap.mapApplied = false;
+        (void)EMBENET_CHANNEL_QUALITY_SetBlacklist(0);
+    }
+    if (!EMBENET_NODE_JoinGroup(CHANNEL_MANAGER_GROUP_ID)) {
+        printf("CHANNEL_MANAGER: Unable to join group 0x%04x\n", (unsigned)CHANNEL_MANAGER_GROUP_ID);
+    }
+    app_task_start(evaluationTaskId, EMBENET_NODE_TIME_SOURCE_LOCAL, FIRST_REPORT_DELAY_MS);
+}
+
+void channel_manager_stop(void) {
+    printf("CHANNEL_MANAGER: Stopping service\n");
+    EMBENET_NODE_TaskCancel(evaluationTaskId);
+    EMBENET_NODE_TaskCancel(applyTaskId);
+    EMBENET_NODE_LeaveGroup(CHANNEL_MANAGER_GROUP_ID);
+    // the blacklist is kept for rejoining the same network, the joining itself uses the advertising channels, never remapped
+    channelMap.pending = false;
+}
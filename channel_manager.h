@@ -0,0 +1,73 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Network-wide management of the channel hopping list
+
+Every node periodically evaluates the link quality of the data channels and reports its proposed blacklist, along with the
+per-channel scores, to the border router. The backend combines the reports and distributes the decided blacklist to the
+multicast group of the channel manager (or unicast to a single node). The channel map message carries an epoch, reported
+back to identify the applied map, and a network time at which the map is applied, so that all nodes switch their hopping list
+at the same moment. Only maps sent by the border router or the parent are taken, and only if they are applied later than the
+map taken before, so repeated, stale or foreign maps are discarded.
+
+A node that has just joined hops without the map until the backend answers its first report. It only misses the frames sent
+on the blacklisted channels meanwhile, since the good channels are never remapped. The map is kept while the node rejoins the
+same network.
+
+Report message (node -> border router), multi-byte fields are little endian:
+ byte   | field
+ -------|-----------------------------------------------------------
+ 0      | CHANNEL_MANAGER_MSG_REPORT
+ 1      | flags, CHANNEL_MANAGER_FLAG_MAP_APPLIED if a channel map was applied since joining
+ 2      | epoch of the applied channel map
+ 3-10   | applied blacklist
+ 11-18  | proposed blacklist
+ 19-55  | score of each data channel, 0 (worst) - 255 (best)
+
+Channel map message (backend -> nodes):
+ byte   | field
+ -------|-----------------------------------------------------------
+ 0      | CHANNEL_MANAGER_MSG_MAP
+ 1      | epoch, incremented (modulo 256) with every new map
+ 2-9    | network time at which the map is applied [ms]
+ 10-17  | blacklist, bit n corresponds to data channel n
+*/
+
+#ifndef CHANNEL_MANAGER_H_
+#define CHANNEL_MANAGER_H_
+
+#include "embenet_defs.h"
+
+#define CHANNEL_MANAGER_PORT             1236   ///< UDP port used by the channel manager, both on the nodes and the border router
+#define CHANNEL_MANAGER_GROUP_ID         0x0C4A ///< multicast group the channel maps are distributed to
+#define CHANNEL_MANAGER_MSG_REPORT       0x01   ///< message type of the report
+#define CHANNEL_MANAGER_MSG_MAP          0x02   ///< message type of the channel map
+#define CHANNEL_MANAGER_FLAG_MAP_APPLIED 0x01   ///< report flag, set when the node applied a channel map
+
+/**
+ * @brief Initializes the channel manager.
+ *
+ * Opens a UDP socket and creates the evaluation and map application tasks.
+ */
+void channel_manager_init(void);
+
+/**
+ * @brief Starts the channel manager.
+ *
+ * Joins the multicast group of the channel manager and schedules the first report. Removes the blacklist if the node joined
+ * another network than before.
+ *
+ * @param[in] panId PAN ID of the joined network
+ */
+void channel_manager_start(EMBENET_PANID panId);
+
+/**
+ * @brief Stops the channel manager.
+ *
+ * Leaves the multicast group and drops the pending channel map. The applied one is kept for rejoining the same network.
+ */
+void channel_manager_stop(void);
+
+#endif
@@ -7,9 +7,14 @@
 */
 
 #include "custom_service.h"
+#include "app_command.h"
+#include "app_log.h"
+#include "app_task.h"
 #include "embenet_node.h"
+#include "embenet_node_diag.h"
 #include "enms_node.h"
 #include "gpio_config.h"
+#include "telemetry_batch.h"
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
@@ -17,13 +22,23 @@
 #include "nrf_gpio.h"
 
 
+#define CUSTOM_SERVICE_PERIOD_MS      5000  ///< period of the samples [ms]
+#define CUSTOM_SERVICE_MAX_LATENCY_MS 30000 ///< longest time a sample waits to be sent with the next ones [ms]
+
+/// Sample sent to the border router, in batches
+typedef struct __attribute__((packed)) {
+    uint32_t counter;    ///< number of the sample
+    uint16_t dagRank;    ///< rank of the node
+    int8_t   parentRssi; ///< RSSI of the parent [dBm]
+} CustomServiceSample;
+
 /// Socket descriptor for exemplary, user-defined custom service
 static EMBENET_UDP_SocketDescriptor customServiceSocket;
 /// Id of the task running the custom service
 static EMBENET_TaskId customServiceTaskId = EMBENET_TASKID_INVALID;
 
 /**
- * @brief User-defined function that will be invoked as a periodically scheduled task
+ * @brief User-defined function that will be invoked as a periodic task, every 5 seconds
  *
  * @param[in] taskId id of the task
  * @param[in] timeSource time source (local time or network time)
@@ -31,21 +46,15 @@ static EMBENET_TaskId customServiceTaskId = EMBENET_TASKID_INVALID;
  * @param[in] context generic, user-defined context
  */
 static void customServiceTask(EMBENET_TaskId taskId, EMBENET_NODE_TimeSource timeSource, uint64_t t, void *context) {
-    static int counter;
+    static uint32_t counter;
 
-    // make a simple message with counter
-    char message[32];
-    int messageLength = snprintf(message, sizeof(message), "Custom message no %d", counter++);
-    // get border router address
-    EMBENET_IPV6 borderRouterAddress;
-    EMBENET_NODE_GetBorderRouterAddress(&borderRouterAddress);
-    // send UDP packet using port 1234
-    if (EMBENET_RESULT_OK != EMBENET_UDP_Send(&customServiceSocket, &borderRouterAddress, 1234, message, messageLength)) {
-        printf("CUSTOM_SERVICE: Failed to send UDP packet\n");
-    }
-
-    // Schedule next invocation of this task after 5 seconds
-    EMBENET_NODE_TaskSchedule(taskId, timeSource, t + 5000);
+    // a small binary sample, sent to the border router on port 1234 together with the next ones
+    CustomServiceSample sample = {
+        .counter    = counter++,
+        .dagRank    = EMBENET_NODE_DIAG_GetDAGRank(),
+        .parentRssi = EMBENET_NODE_DIAG_GetParentRSSI(),
+    };
+    telemetry_batch_add(&sample);
 }
 
 /**
@@ -58,34 +67,8 @@ static void customServiceTask(EMBENET_TaskId taskId, EMBENET_NODE_TimeSource tim
  * @param[in] dataSize size of datagram's payload
  */
 static void customServiceReceptionHandler(EMBENET_UDP_SocketDescriptor const *socket, EMBENET_IPV6 const *sourceAddress, uint16_t sourcePort, void const *data, size_t dataSize) {
-    // Retrieve command from datagram's payload
-    char const *msg = (char const*) data;
-
-    if (dataSize >= 6) {
-        // Perform action based on received command
-        if (0 == strncmp(msg, "led1on", 6)) {
-            printf("CUSTOM_SERVICE: Led 1 on\n");
-            nrf_gpio_pin_clear(LED1);
-        } else if (0 == strncmp(msg, "led1off", 7)) {
-            printf("CUSTOM_SERVICE: Led 1 off\n");
-            nrf_gpio_pin_set(LED1);
-        } else if (0 == strncmp(msg, "led2on", 6)) {
-            printf("CUSTOM_SERVICE: Led 2 on\n");
-            nrf_gpio_pin_clear(LED2);
-        } else if (0 == strncmp(msg, "led2off", 7)) {
-            printf("CUSTOM_SERVICE: Led 2 off\n");
-            nrf_gpio_pin_set(LED2);
-        } else if (0 == strncmp(msg, "led3on", 6)) {
-            printf("CUSTOM_SERVICE: Led 3 on\n");
-            nrf_gpio_pin_clear(LED3);
-        } else if (0 == strncmp(msg, "led3off", 7)) {
-            printf("CUSTOM_SERVICE: Led 3 off\n");
-            nrf_gpio_pin_set(LED3);
-        } else {
-            printf("CUSTOM_SERVICE: Unrecognized command with size: %d\n", (int)dataSize);
-        }
-    } else {
-        printf("CUSTOM_SERVICE: Unrecognized command with size: %d\n", (int)dataSize);
+    if (APP_COMMAND_RESULT_OK != app_command_execute(data, dataSize)) {
+        APP_LOG_WARNING("CUSTOM_SERVICE: Unrecognized command with size: %u", (unsigned)dataSize);
     }
 }
 
@@ -103,8 +86,10 @@ void custom_service_init(void) {
     EMBENET_Result customServiceSocketRegistrationStatus = EMBENET_UDP_RegisterSocket(&customServiceSocket);
     if (EMBENET_RESULT_OK == customServiceSocketRegistrationStatus) {
         printf("CUSTOM_SERVICE: Socket %d registered successfully\n", (int)customServiceSocket.port);
-        // Create a task using built-in scheduler
-        customServiceTaskId = EMBENET_NODE_TaskCreate(customServiceTask, NULL);
+        // Create a periodic task running every 5 seconds, on top of the built-in scheduler
+        customServiceTaskId = app_task_create_periodic("custom", customServiceTask, NULL, CUSTOM_SERVICE_PERIOD_MS, 0);
+        // Samples are sent in batches, the datagram overhead is paid once for several of them
+        (void)telemetry_batch_init(&customServiceSocket, 1234, sizeof(CustomServiceSample), CUSTOM_SERVICE_MAX_LATENCY_MS, true);
         if (EMBENET_TASKID_INVALID == customServiceTaskId) {
             printf("CUSTOM_SERVICE: Unable to create task\n");
         } else {
@@ -117,14 +102,14 @@ void custom_service_init(void) {
 
 void custom_service_start(void) {
     printf("CUSTOM_SERVICE: Starting service\n");
-    // Get current time
-    uint64_t current_time = EMBENET_NODE_GetLocalTime();
-    // Schedule task using node's local time (invoke it after 2 seconds)
-    EMBENET_NODE_TaskSchedule(customServiceTaskId, EMBENET_NODE_TIME_SOURCE_LOCAL, current_time + 2000);
+    // Start the periodic task using node's local time (first invocation after at least 2 seconds)
+    app_task_start(customServiceTaskId, EMBENET_NODE_TIME_SOURCE_LOCAL, 2000);
 }
 
 void custom_service_stop(void) {
     printf("CUSTOM_SERVICE: Stopping service\n");
     // Cancel scheduled task
     EMBENET_NODE_TaskCancel(customServiceTaskId);
+    // The samples not sent yet cannot reach the border router any more
+    telemetry_batch_discard();
 }
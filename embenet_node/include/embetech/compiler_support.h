@@ -21,6 +21,16 @@
 
 #    define EMBEUTILS_INLINE __attribute__((always_inline))
 
+/**
+ * @brief Places the function in RAM, from where it runs without flash wait states and cache misses
+ *
+ * The function goes to the .ramfunc section, which the linker script places in RAM and the startup code copies there together with
+ * .data. It is never inlined, also with link time optimization, so that its code stays in RAM whoever calls it.
+ *
+ * Usage: EMBEUTILS_RAMFUNC void RADIO_IRQHandler(void) { ... }
+ */
+#    define EMBEUTILS_RAMFUNC __attribute__((section(".ramfunc"), noinline, used))
+
 #    ifdef __cplusplus
 ///@brief provides portable mean of using C99 restrict keyword
 #        define EMBEUTILS_RESTRICT __restrict
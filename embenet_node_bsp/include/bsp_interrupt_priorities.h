@@ -19,7 +19,7 @@ extern "C" {
  * @brief Interrupt priority order.
  */
 enum {
-    INTERRUPT_PRIORITY_HDLC_UART   = 2,
+    INTERRUPT_PRIORITY_HDLC_UART   = 4, // below the radio and the MAC timer, masked by the critical section as it reads the port timer
     INTERRUPT_PRIORITY_BUTTONS     = 7,
     INTERRUPT_PRIORITY_DEBUG_TIMER = 7,
     INTERRUPT_PRIORITY_DEBUG_UART  = 8,
@@ -21,6 +21,8 @@
 
 #include <stddef.h>
 
+#if !EMBENET_NODE_BSP_UART_DMA
+
 #define HDLC_UART          NRF_UART0                /* UART instance */
 #define HDLC_UART_IRQn     UARTE0_UART0_IRQn        /* IRQ number */
 #define HDLC_UART_TXPIN    6                        /* USART transmission pin */
@@ -107,3 +109,5 @@ void UARTE0_UART0_IRQHandler(void) {
         }
     }
 }
+
+#endif // !EMBENET_NODE_BSP_UART_DMA
@@ -0,0 +1,273 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET Node BSP for nRF52832
+@brief     Implementation of the HDLC uart communication with UARTE and EasyDMA
+
+Reception runs continuously into two DMA buffers switched by hardware (ENDRX -> STARTRX short), the next buffer is set up as soon
+as the previous one is started. Every received byte is counted by a TIMER in counter mode and restarts a second TIMER measuring the
+line idle time, both through PPI. A buffer is handed over when it gets full (ENDRX) and, partially, when the line goes idle, so
+the CPU is involved once per chunk instead of once per byte. Transmission sends whole chunks from memory.
+*/
+
+#include "bsp_interrupt_priorities.h"
+
+#include <embenet_node_nrf52_bsp_interface.h>
+#include <embenet_port_radio_extension.h>
+#include <embetech/expect.h>
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#pragma GCC diagnostic ignored "-Wconversion"
+#pragma GCC diagnostic ignored "-Wcast-align"
+#include <nrf_clock.h>
+#include <nrf_ppi.h>
+#include <nrf_timer.h>
+#include <nrf_uarte.h>
+#pragma GCC diagnostic pop
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if EMBENET_NODE_BSP_UART_DMA
+
+#define HDLC_UART        NRF_UARTE0        /* UARTE instance */
+#define HDLC_UART_IRQn   UARTE0_UART0_IRQn /* IRQ number */
+#define HDLC_UART_TXPIN  6                 /* USART transmission pin */
+#define HDLC_UART_RXPIN  8                 /* USART reception pin */
+#define HDLC_UART_RTSPIN 5                 /* USART request to send pin (used with hardware flow control) */
+#define HDLC_UART_CTSPIN 7                 /* USART clear to send pin (used with hardware flow control) */
+#ifndef HDLC_UART_BAUDRATE
+#    define HDLC_UART_BAUDRATE NRF_UARTE_BAUDRATE_115200 /* USART baudrate, up to NRF_UARTE_BAUDRATE_1000000 */
+#endif
+#ifndef HDLC_UART_HWFC
+#    define HDLC_UART_HWFC NRF_UARTE_HWFC_DISABLED /* RTS/CTS hardware flow control */
+#endif
+#ifndef HDLC_UART_IDLE_TIMEOUT_US
+#    define HDLC_UART_IDLE_TIMEOUT_US 200 /* received bytes are handed over after the line is idle for this long [us] */
+#endif
+
+#define HDLC_UART_RX_CHUNK_SIZE EMBENET_NODE_BSP_UARTE_RX_CHUNK /* size of each of the two DMA reception buffers */
+
+#define HDLC_UART_COUNTER           NRF_TIMER2       /* counts received bytes */
+#define HDLC_UART_IDLE_TIMER        NRF_TIMER3       /* measures the line idle time */
+#define HDLC_UART_IDLE_TIMER_IRQn   TIMER3_IRQn      /* IRQ number of the idle TIMER */
+#define HDLC_UART_PPI_COUNT         NRF_PPI_CHANNEL5 /* RXDRDY event -> counter COUNT task */
+#define HDLC_UART_PPI_IDLE          NRF_PPI_CHANNEL6 /* RXDRDY event -> idle TIMER CLEAR task, fork: idle TIMER START task */
+
+static EMBENET_NODE_BSP_UART_Callback_t    txCb;
+static EMBENET_NODE_BSP_UARTE_RxCallback_t rxCb;
+static void*                               context;
+
+static uint8_t  rxBuffer[2][HDLC_UART_RX_CHUNK_SIZE]; ///< DMA reception buffers
+static uint8_t  rxActive;                             ///< index of the buffer being filled
+static size_t   rxDelivered;                          ///< number of bytes of the active buffer already handed over
+static uint32_t rxBufferStart;                        ///< value of the byte counter at the beginning of the active buffer
+static bool     rxPaused;                             ///< true if the reception is not restarted after the active buffer
+static bool     rxStopped;                            ///< true if the reception has stopped because of the pause
+
+static void deliver(size_t end) {
+    if ((end > rxDelivered) && (NULL != rxCb)) {
+        rxCb(context, &rxBuffer[rxActive][rxDelivered], end - rxDelivered);
+    }
+    rxDelivered = end;
+}
+
+static uint32_t readByteCount(void) {
+    nrf_timer_task_trigger(HDLC_UART_COUNTER, NRF_TIMER_TASK_CAPTURE0);
+    return nrf_timer_cc_read(HDLC_UART_COUNTER, NRF_TIMER_CC_CHANNEL0);
+}
+
+static void rxTimersInit(void) {
+    nrf_timer_mode_set(HDLC_UART_COUNTER, NRF_TIMER_MODE_COUNTER);
+    nrf_timer_bit_width_set(HDLC_UART_COUNTER, NRF_TIMER_BIT_WIDTH_32);
+    nrf_timer_task_trigger(HDLC_UART_COUNTER, NRF_TIMER_TASK_CLEAR);
+    nrf_timer_task_trigger(HDLC_UART_COUNTER, NRF_TIMER_TASK_START);
+
+    nrf_timer_mode_set(HDLC_UART_IDLE_TIMER, NRF_TIMER_MODE_TIMER);
+    nrf_timer_bit_width_set(HDLC_UART_IDLE_TIMER, NRF_TIMER_BIT_WIDTH_16);
+    nrf_timer_frequency_set(HDLC_UART_IDLE_TIMER, NRF_TIMER_FREQ_1MHz);
+    nrf_timer_cc_write(HDLC_UART_IDLE_TIMER, NRF_TIMER_CC_CHANNEL0, HDLC_UART_IDLE_TIMEOUT_US);
+    nrf_timer_shorts_enable(HDLC_UART_IDLE_TIMER, NRF_TIMER_SHORT_COMPARE0_STOP_MASK | NRF_TIMER_SHORT_COMPARE0_CLEAR_MASK);
+    nrf_timer_event_clear(HDLC_UART_IDLE_TIMER, NRF_TIMER_EVENT_COMPARE0);
+    nrf_timer_int_enable(HDLC_UART_IDLE_TIMER, NRF_TIMER_INT_COMPARE0_MASK);
+
+    nrf_ppi_channel_endpoint_setup(HDLC_UART_PPI_COUNT, nrf_uarte_event_address_get(HDLC_UART, NRF_UARTE_EVENT_RXDRDY),
+                                   nrf_timer_task_address_get(HDLC_UART_COUNTER, NRF_TIMER_TASK_COUNT));
+    nrf_ppi_channel_endpoint_setup(HDLC_UART_PPI_IDLE, nrf_uarte_event_address_get(HDLC_UART, NRF_UARTE_EVENT_RXDRDY),
+                                   nrf_timer_task_address_get(HDLC_UART_IDLE_TIMER, NRF_TIMER_TASK_CLEAR));
+    nrf_ppi_fork_endpoint_setup(HDLC_UART_PPI_IDLE, nrf_timer_task_address_get(HDLC_UART_IDLE_TIMER, NRF_TIMER_TASK_START));
+    nrf_ppi_channel_enable(HDLC_UART_PPI_COUNT);
+    nrf_ppi_channel_enable(HDLC_UART_PPI_IDLE);
+
+    // idle interrupt hands over the same buffers as the UARTE interrupt, so both run at the same priority
+    NVIC_ClearPendingIRQ(HDLC_UART_IDLE_TIMER_IRQn);
+    NVIC_SetPriority(HDLC_UART_IDLE_TIMER_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), INTERRUPT_PRIORITY_HDLC_UART, INTERRUPT_SUBPRIORITY_HDLC_UART));
+    NVIC_EnableIRQ(HDLC_UART_IDLE_TIMER_IRQn);
+}
+
+static void rxTimersDeinit(void) {
+    NVIC_DisableIRQ(HDLC_UART_IDLE_TIMER_IRQn);
+    nrf_ppi_channel_disable(HDLC_UART_PPI_COUNT);
+    nrf_ppi_channel_disable(HDLC_UART_PPI_IDLE);
+    nrf_timer_int_disable(HDLC_UART_IDLE_TIMER, NRF_TIMER_INT_COMPARE0_MASK);
+    // SHUTDOWN releases the HFCLK request of the TIMERs
+    nrf_timer_task_trigger(HDLC_UART_IDLE_TIMER, NRF_TIMER_TASK_SHUTDOWN);
+    nrf_timer_task_trigger(HDLC_UART_COUNTER, NRF_TIMER_TASK_SHUTDOWN);
+}
+
+
+void EMBENET_NODE_BSP_UARTE_Init(const EMBENET_NODE_BSP_UART_Callback_t txEndCallback, const EMBENET_NODE_BSP_UARTE_RxCallback_t rxCallback, void* cbContext) {
+    // firstly lock external oscillator
+    EMBENET_RADIO_LockHfxo();
+
+    // Start HFCLK and wait for it to start.
+    nrf_clock_event_clear(NRF_CLOCK_EVENT_HFCLKSTARTED);
+    nrf_clock_task_trigger(NRF_CLOCK_TASK_HFCLKSTART);
+    while (!nrf_clock_event_check(NRF_CLOCK_EVENT_HFCLKSTARTED))
+        ;
+
+    txCb    = txEndCallback;
+    rxCb    = rxCallback;
+    context = cbContext;
+
+    rxActive      = 0;
+    rxDelivered   = 0;
+    rxBufferStart = 0;
+    rxPaused      = false;
+    rxStopped     = false;
+
+    nrf_uarte_baudrate_set(HDLC_UART, HDLC_UART_BAUDRATE);
+    nrf_uarte_txrx_pins_set(HDLC_UART, HDLC_UART_TXPIN, HDLC_UART_RXPIN);
+    if (NRF_UARTE_HWFC_ENABLED == HDLC_UART_HWFC) {
+        nrf_uarte_hwfc_pins_set(HDLC_UART, HDLC_UART_RTSPIN, HDLC_UART_CTSPIN);
+    }
+    nrf_uarte_configure(HDLC_UART, NRF_UARTE_PARITY_EXCLUDED, HDLC_UART_HWFC);
+    nrf_uarte_errorsrc_get_and_clear(HDLC_UART);
+
+    rxTimersInit();
+
+    NVIC_SetPriority(HDLC_UART_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), INTERRUPT_PRIORITY_HDLC_UART, INTERRUPT_SUBPRIORITY_HDLC_UART));
+    NVIC_EnableIRQ(HDLC_UART_IRQn);
+
+    nrf_uarte_event_clear(HDLC_UART, NRF_UARTE_EVENT_ENDTX);
+    nrf_uarte_event_clear(HDLC_UART, NRF_UARTE_EVENT_ENDRX);
+    nrf_uarte_event_clear(HDLC_UART, NRF_UARTE_EVENT_RXSTARTED);
+    nrf_uarte_event_clear(HDLC_UART, NRF_UARTE_EVENT_ERROR);
+    nrf_uarte_event_clear(HDLC_UART, NRF_UARTE_EVENT_RXTO);
+    nrf_uarte_int_enable(HDLC_UART, NRF_UARTE_INT_ENDTX_MASK | NRF_UARTE_INT_ENDRX_MASK | NRF_UARTE_INT_RXSTARTED_MASK | NRF_UARTE_INT_ERROR_MASK);
+
+    nrf_uarte_enable(HDLC_UART);
+
+    // the second buffer is set up when the first one is started
+    nrf_uarte_rx_buffer_set(HDLC_UART, rxBuffer[0], HDLC_UART_RX_CHUNK_SIZE);
+    nrf_uarte_shorts_enable(HDLC_UART, NRF_UARTE_SHORT_ENDRX_STARTRX);
+    nrf_uarte_task_trigger(HDLC_UART, NRF_UARTE_TASK_STARTRX);
+}
+
+
+void EMBENET_NODE_BSP_UARTE_Deinit(void) {
+    nrf_uarte_shorts_disable(HDLC_UART, NRF_UARTE_SHORT_ENDRX_STARTRX);
+    nrf_uarte_int_disable(HDLC_UART, NRF_UARTE_INT_ENDTX_MASK | NRF_UARTE_INT_ENDRX_MASK | NRF_UARTE_INT_RXSTARTED_MASK | NRF_UARTE_INT_ERROR_MASK);
+    NVIC_DisableIRQ(HDLC_UART_IRQn);
+
+    // UARTE must not be disabled while the DMA is still running
+    nrf_uarte_event_clear(HDLC_UART, NRF_UARTE_EVENT_RXTO);
+    nrf_uarte_task_trigger(HDLC_UART, NRF_UARTE_TASK_STOPRX);
+    while (!nrf_uarte_event_check(HDLC_UART, NRF_UARTE_EVENT_RXTO))
+        ;
+    nrf_uarte_event_clear(HDLC_UART, NRF_UARTE_EVENT_TXSTOPPED);
+    nrf_uarte_task_trigger(HDLC_UART, NRF_UARTE_TASK_STOPTX);
+    while (!nrf_uarte_event_check(HDLC_UART, NRF_UARTE_EVENT_TXSTOPPED))
+        ;
+
+    nrf_uarte_disable(HDLC_UART);
+    nrf_uarte_hwfc_pins_disconnect(HDLC_UART);
+    nrf_uarte_txrx_pins_disconnect(HDLC_UART);
+    rxTimersDeinit();
+
+    txCb    = NULL;
+    rxCb    = NULL;
+    context = NULL;
+    EMBENET_RADIO_UnlockHfxo();
+}
+
+
+void EMBENET_NODE_BSP_UARTE_Write(uint8_t const* data, size_t length) {
+    nrf_uarte_event_clear(HDLC_UART, NRF_UARTE_EVENT_ENDTX);
+    nrf_uarte_tx_buffer_set(HDLC_UART, data, length);
+    nrf_uarte_task_trigger(HDLC_UART, NRF_UARTE_TASK_STARTTX);
+}
+
+
+void EMBENET_NODE_BSP_UARTE_RxPause(void) {
+    nrf_uarte_shorts_disable(HDLC_UART, NRF_UARTE_SHORT_ENDRX_STARTRX);
+    rxPaused = true;
+}
+
+
+void EMBENET_NODE_BSP_UARTE_RxResume(void) {
+    // the pause is decided in the interrupts handing over the received bytes
+    NVIC_DisableIRQ(HDLC_UART_IRQn);
+    NVIC_DisableIRQ(HDLC_UART_IDLE_TIMER_IRQn);
+    if (rxPaused) {
+        rxPaused = false;
+        nrf_uarte_shorts_enable(HDLC_UART, NRF_UARTE_SHORT_ENDRX_STARTRX);
+        if (rxStopped) {
+            // the buffer set up on the last RXSTARTED is the active one now, the bytes waiting in the FIFO go there first
+            rxStopped = false;
+            nrf_uarte_task_trigger(HDLC_UART, NRF_UARTE_TASK_STARTRX);
+        }
+    }
+    NVIC_EnableIRQ(HDLC_UART_IDLE_TIMER_IRQn);
+    NVIC_EnableIRQ(HDLC_UART_IRQn);
+}
+
+
+void UARTE0_UART0_IRQHandler(void) {
+    if (!nrf_clock_hf_is_running(NRF_CLOCK_HFCLK_HIGH_ACCURACY)) {
+        EXPECT_ABORT("UART without HFXO will not work properly");
+    }
+
+    if (nrf_uarte_event_check(HDLC_UART, NRF_UARTE_EVENT_ERROR)) {
+        // framing or overrun error, the reception goes on
+        nrf_uarte_event_clear(HDLC_UART, NRF_UARTE_EVENT_ERROR);
+        nrf_uarte_errorsrc_get_and_clear(HDLC_UART);
+    }
+    // ENDRX of a buffer always precedes RXSTARTED of the next one
+    if (nrf_uarte_event_check(HDLC_UART, NRF_UARTE_EVENT_ENDRX)) {
+        nrf_uarte_event_clear(HDLC_UART, NRF_UARTE_EVENT_ENDRX);
+        // when the short has already restarted the reception, RXSTARTED is pending
+        rxStopped     = rxPaused && !nrf_uarte_event_check(HDLC_UART, NRF_UARTE_EVENT_RXSTARTED);
+        size_t amount = nrf_uarte_rx_amount_get(HDLC_UART);
+        deliver(amount);
+        rxBufferStart += (uint32_t)amount;
+        rxDelivered = 0;
+        rxActive ^= 1;
+    }
+    if (nrf_uarte_event_check(HDLC_UART, NRF_UARTE_EVENT_RXSTARTED)) {
+        nrf_uarte_event_clear(HDLC_UART, NRF_UARTE_EVENT_RXSTARTED);
+        // the UARTE has latched the pointer, the other buffer is used after this one is full
+        nrf_uarte_rx_buffer_set(HDLC_UART, rxBuffer[rxActive ^ 1], HDLC_UART_RX_CHUNK_SIZE);
+    }
+    if (nrf_uarte_event_check(HDLC_UART, NRF_UARTE_EVENT_ENDTX)) {
+        nrf_uarte_event_clear(HDLC_UART, NRF_UARTE_EVENT_ENDTX);
+        if (txCb) {
+            txCb(context);
+        }
+    }
+}
+
+
+void TIMER3_IRQHandler(void) {
+    nrf_timer_event_clear(HDLC_UART_IDLE_TIMER, NRF_TIMER_EVENT_COMPARE0);
+    if (rxStopped) {
+        // the counted bytes wait in the FIFO, not in memory
+        return;
+    }
+    // the line is idle, so all the counted bytes are already in memory
+    uint32_t received = readByteCount() - rxBufferStart;
+    deliver((received < HDLC_UART_RX_CHUNK_SIZE) ? received : HDLC_UART_RX_CHUNK_SIZE);
+}
+
+#endif // EMBENET_NODE_BSP_UART_DMA
@@ -9,41 +9,278 @@
 
 #include "embenet_aes128.h"
 
-#include <embetech/aes128.h>
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wsign-conversion"
-#pragma GCC diagnostic ignored "-Wcast-align"
-#pragma GCC diagnostic ignored "-Wconversion"
-#include "nrf52.h"
-#include "nrf_ecb.h"
-#pragma GCC diagnostic pop
+#include "embenet_port_aes128.h"
+#include "embenet_port_config.h"
+#include "embenet_port_ecb.h"
+#include <embetech/expect.h>
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <string.h>
 
-// static CRYP_HandleTypeDef hcryp;
-static uint8_t _key[16];
+/*
+The ECB peripheral only encrypts, so decryption is done in software. The key schedule is expanded once, when the key is set, straight
+into the round keys of the equivalent inverse cipher (FIPS-197 5.3.5), and every block is then decrypted with a single table of the
+combined InvSubBytes/InvMixColumns step, rotated for the other three rows. The S-boxes and the table are computed on initialization,
+which costs 1.5kB of RAM instead of flash. Words hold the columns of the state, most significant byte first.
+ */
+
+#define ROUNDS 10
+
+static uint8_t  sbox[256];                   ///< S-box, used by the key expansion
+static uint8_t  invSbox[256];                ///< inverse S-box, used by the last round
+static uint32_t invTable[256];               ///< InvSubBytes and InvMixColumns of a byte, in the first row
+static bool     tablesReady;                 ///< true if the tables are computed
+
+/// Key with its schedules: the ECB data structure holds the encryption key, the decryption schedule is expanded from it
+typedef struct {
+    EMBENET_ECB_Block ecb;                         ///< ECB data structure, holds the key
+    uint32_t          roundKeys[4 * (ROUNDS + 1)]; ///< round keys of the equivalent inverse cipher, in the order of use
+} KeyContext;
+
+/*
+The stack switches between a few keys (network key, PSK), always with EMBENET_AES128_SetKey. The keys it used last are kept expanded in
+a small cache, looked up by the key itself, so going back to one of them costs a comparison. The contexts created by the application
+are kept apart, in a pool addressed by handles, so that they are never evicted by the stack.
+ */
+
+/// keys recently used by the stack
+static struct {
+    KeyContext context; ///< key
+    uint32_t   lastUse; ///< value of stackKeyUseCounter when the key was last set
+    bool       valid;   ///< true if the entry holds a key
+} stackKeys[EMBENET_PORT_AES128_STACK_KEY_CACHE_SIZE];
+
+static uint32_t    stackKeyUseCounter; ///< incremented on every EMBENET_AES128_SetKey
+static KeyContext* stackKey;           ///< key set by the stack
+
+/// keys created by the application
+static struct {
+    KeyContext context; ///< key
+    bool       used;    ///< true if the entry is allocated
+} keyPool[EMBENET_PORT_AES128_KEY_POOL_SIZE];
+
+static inline uint8_t xtime(uint8_t x) {
+    return (uint8_t)((x << 1) ^ ((x & 0x80) ? 0x1b : 0x00));
+}
+
+static uint8_t mul(uint8_t x, uint8_t y) {
+    uint8_t product = 0;
+    while (0 != y) {
+        if (y & 1) {
+            product ^= x;
+        }
+        x = xtime(x);
+        y >>= 1;
+    }
+    return product;
+}
+
+static inline uint32_t ror8(uint32_t w) {
+    return (w >> 8) | (w << 24);
+}
+
+static inline uint8_t byteOf(uint32_t w, unsigned shift) {
+    return (uint8_t)(w >> shift);
+}
+
+static inline uint32_t loadWord(uint8_t const* bytes) {
+    return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8) | (uint32_t)bytes[3];
+}
+
+static inline void storeWord(uint8_t* bytes, uint32_t w) {
+    bytes[0] = byteOf(w, 24);
+    bytes[1] = byteOf(w, 16);
+    bytes[2] = byteOf(w, 8);
+    bytes[3] = byteOf(w, 0);
+}
+
+static void tablesInit(void) {
+    // walks the multiplicative group with generator 3 and its inverse, 3^-1 = 0xf6
+    uint8_t p = 1;
+    uint8_t q = 1;
+    do {
+        p = (uint8_t)(p ^ xtime(p));
+        q ^= (uint8_t)(q << 1);
+        q ^= (uint8_t)(q << 2);
+        q ^= (uint8_t)(q << 4);
+        if (q & 0x80) {
+            q ^= 0x09;
+        }
+        // affine transformation of q = p^-1
+        uint8_t s = (uint8_t)(q ^ (uint8_t)((q << 1) | (q >> 7)) ^ (uint8_t)((q << 2) | (q >> 6)) ^ (uint8_t)((q << 3) | (q >> 5)) ^
+                              (uint8_t)((q << 4) | (q >> 4)) ^ 0x63);
+        sbox[p] = s;
+    } while (1 != p);
+    sbox[0] = 0x63;
+
+    for (unsigned x = 0; x < 256; ++x) {
+        invSbox[sbox[x]] = (uint8_t)x;
+    }
+    for (unsigned x = 0; x < 256; ++x) {
+        uint8_t s   = invSbox[x];
+        invTable[x] = ((uint32_t)mul(s, 0x0e) << 24) | ((uint32_t)mul(s, 0x09) << 16) | ((uint32_t)mul(s, 0x0d) << 8) | (uint32_t)mul(s, 0x0b);
+    }
+}
+
+/**
+ * @brief Applies InvSubBytes and InvMixColumns to a column made of the given bytes.
+ */
+static inline uint32_t invColumn(uint8_t b0, uint8_t b1, uint8_t b2, uint8_t b3) {
+    return invTable[b0] ^ ror8(invTable[b1]) ^ ror8(ror8(invTable[b2])) ^ ror8(ror8(ror8(invTable[b3])));
+}
+
+/**
+ * @brief Applies InvSubBytes to a column made of the given bytes.
+ */
+static inline uint32_t invSubColumn(uint8_t b0, uint8_t b1, uint8_t b2, uint8_t b3) {
+    return ((uint32_t)invSbox[b0] << 24) | ((uint32_t)invSbox[b1] << 16) | ((uint32_t)invSbox[b2] << 8) | (uint32_t)invSbox[b3];
+}
+
+/**
+ * @brief Applies InvMixColumns to a column.
+ */
+static uint32_t invMixColumn(uint32_t w) {
+    // invTable holds InvSubBytes too, which is undone by SubBytes
+    return invColumn(sbox[byteOf(w, 24)], sbox[byteOf(w, 16)], sbox[byteOf(w, 8)], sbox[byteOf(w, 0)]);
+}
+
+static void keyExpand(KeyContext* context, uint8_t const key[16U]) {
+    uint32_t w[4 * (ROUNDS + 1)];
+    uint8_t  rcon = 1;
+    for (unsigned i = 0; i < 4; ++i) {
+        w[i] = loadWord(&key[4 * i]);
+    }
+    for (unsigned i = 4; i < 4 * (ROUNDS + 1); ++i) {
+        uint32_t t = w[i - 1];
+        if (0 == (i % 4)) {
+            // RotWord, SubWord and Rcon
+            t = ((uint32_t)sbox[byteOf(t, 16)] << 24) | ((uint32_t)sbox[byteOf(t, 8)] << 16) | ((uint32_t)sbox[byteOf(t, 0)] << 8) |
+                (uint32_t)sbox[byteOf(t, 24)];
+            t ^= (uint32_t)rcon << 24;
+            rcon = xtime(rcon);
+        }
+        w[i] = w[i - 4] ^ t;
+    }
+    // inverse cipher uses the round keys in reverse order, the middle ones with InvMixColumns applied
+    for (unsigned round = 0; round <= ROUNDS; ++round) {
+        for (unsigned c = 0; c < 4; ++c) {
+            uint32_t k                        = w[4 * (ROUNDS - round) + c];
+            context->roundKeys[4 * round + c] = ((0 == round) || (ROUNDS == round)) ? k : invMixColumn(k);
+        }
+    }
+    memcpy(context->ecb.key, key, 16);
+}
+
+static void keyEncrypt(KeyContext* context, uint8_t data[16U]) {
+    memcpy(context->ecb.cleartext, data, 16);
+    (void)EMBENET_ECB_Run(&context->ecb);
+    memcpy(data, context->ecb.ciphertext, 16);
+}
+
+static void keyDecrypt(KeyContext const* context, uint8_t data[16U]) {
+    uint32_t const* rk = context->roundKeys;
+    uint32_t        s0 = loadWord(&data[0]) ^ rk[0];
+    uint32_t        s1 = loadWord(&data[4]) ^ rk[1];
+    uint32_t        s2 = loadWord(&data[8]) ^ rk[2];
+    uint32_t        s3 = loadWord(&data[12]) ^ rk[3];
+    for (unsigned round = 1; round < ROUNDS; ++round) {
+        rk += 4;
+        // InvShiftRows takes row r of column c from column c - r
+        uint32_t t0 = invColumn(byteOf(s0, 24), byteOf(s3, 16), byteOf(s2, 8), byteOf(s1, 0)) ^ rk[0];
+        uint32_t t1 = invColumn(byteOf(s1, 24), byteOf(s0, 16), byteOf(s3, 8), byteOf(s2, 0)) ^ rk[1];
+        uint32_t t2 = invColumn(byteOf(s2, 24), byteOf(s1, 16), byteOf(s0, 8), byteOf(s3, 0)) ^ rk[2];
+        uint32_t t3 = invColumn(byteOf(s3, 24), byteOf(s2, 16), byteOf(s1, 8), byteOf(s0, 0)) ^ rk[3];
+        s0          = t0;
+        s1          = t1;
+        s2          = t2;
+        s3          = t3;
+    }
+    rk += 4;
+    // last round has no InvMixColumns
+    storeWord(&data[0], invSubColumn(byteOf(s0, 24), byteOf(s3, 16), byteOf(s2, 8), byteOf(s1, 0)) ^ rk[0]);
+    storeWord(&data[4], invSubColumn(byteOf(s1, 24), byteOf(s0, 16), byteOf(s3, 8), byteOf(s2, 0)) ^ rk[1]);
+    storeWord(&data[8], invSubColumn(byteOf(s2, 24), byteOf(s1, 16), byteOf(s0, 8), byteOf(s3, 0)) ^ rk[2]);
+    storeWord(&data[12], invSubColumn(byteOf(s3, 24), byteOf(s2, 16), byteOf(s1, 8), byteOf(s0, 0)) ^ rk[3]);
+}
 
 void EMBENET_AES128_Init(void) {
-    nrf_ecb_init();
+    EMBENET_ECB_Init();
+    if (!tablesReady) {
+        tablesInit();
+        tablesReady = true;
+    }
+    for (size_t i = 0; i < EMBENET_PORT_AES128_STACK_KEY_CACHE_SIZE; ++i) {
+        stackKeys[i].valid = false;
+    }
+    stackKey = &stackKeys[0].context;
 }
 
 void EMBENET_AES128_Deinit(void) {
-    // do nothing
-    nrf_ecb_task_trigger(NRF_ECB, NRF_ECB_TASK_STOPECB);
+    // stops the ECB peripheral
+    EMBENET_ECB_Init();
 }
 
 void EMBENET_AES128_SetKey(uint8_t const key[16U]) {
-    nrf_ecb_set_key(key);
-    memcpy(_key, key, 16);
+    size_t slot = 0;
+    stackKeyUseCounter++;
+    for (size_t i = 0; i < EMBENET_PORT_AES128_STACK_KEY_CACHE_SIZE; ++i) {
+        if (stackKeys[i].valid && (0 == memcmp(stackKeys[i].context.ecb.key, key, 16))) {
+            stackKeys[i].lastUse = stackKeyUseCounter;
+            stackKey             = &stackKeys[i].context;
+            return;
+        }
+        // free entry or else the least recently used one
+        if (!stackKeys[i].valid || (stackKeys[slot].valid && ((int32_t)(stackKeys[i].lastUse - stackKeys[slot].lastUse) < 0))) {
+            slot = i;
+        }
+    }
+    keyExpand(&stackKeys[slot].context, key);
+    stackKeys[slot].valid   = true;
+    stackKeys[slot].lastUse = stackKeyUseCounter;
+    stackKey                = &stackKeys[slot].context;
 }
 
 void EMBENET_AES128_Encrypt(uint8_t data[16U]) {
-    uint8_t tmp[16];
-    nrf_ecb_crypt(tmp, data);
-    memcpy(data, tmp, 16);
+    keyEncrypt(stackKey, data);
 }
 
 void EMBENET_AES128_Decrypt(uint8_t data[16U]) {
-    AES128_Decrypt(MODE_ECB, _key, 16, NULL, data, 16);
+    keyDecrypt(stackKey, data);
+}
+
+EMBENET_AES128_KeyHandle EMBENET_AES128_KeyCreate(uint8_t const key[16U]) {
+    EXPECT(NULL != key) OR_RETURN(EMBENET_AES128_KEY_HANDLE_INVALID);
+    if (!tablesReady) {
+        tablesInit();
+        tablesReady = true;
+    }
+    for (size_t i = 0; i < EMBENET_PORT_AES128_KEY_POOL_SIZE; ++i) {
+        if (!keyPool[i].used) {
+            keyExpand(&keyPool[i].context, key);
+            keyPool[i].used = true;
+            return (EMBENET_AES128_KeyHandle)i;
+        }
+    }
+    return EMBENET_AES128_KEY_HANDLE_INVALID;
+}
+
+void EMBENET_AES128_KeyDestroy(EMBENET_AES128_KeyHandle handle) {
+    EXPECT(handle < EMBENET_PORT_AES128_KEY_POOL_SIZE) OR_RETURN();
+    // the key does not stay in memory
+    memset(&keyPool[handle].context, 0, sizeof(keyPool[handle].context));
+    keyPool[handle].used = false;
+}
+
+bool EMBENET_AES128_KeyEncrypt(EMBENET_AES128_KeyHandle handle, uint8_t data[16U]) {
+    EXPECT((handle < EMBENET_PORT_AES128_KEY_POOL_SIZE) && keyPool[handle].used) OR_RETURN(false);
+    keyEncrypt(&keyPool[handle].context, data);
+    return true;
+}
+
+bool EMBENET_AES128_KeyDecrypt(EMBENET_AES128_KeyHandle handle, uint8_t data[16U]) {
+    EXPECT((handle < EMBENET_PORT_AES128_KEY_POOL_SIZE) && keyPool[handle].used) OR_RETURN(false);
+    keyDecrypt(&keyPool[handle].context, data);
+    return true;
 }
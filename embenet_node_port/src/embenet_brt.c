@@ -10,10 +10,13 @@
 
 #include "embenet_brt.h"
 
-#include "embenet_critical_section.h"
 #include "embenet_node_nrf52_bsp_interface.h"
+#include "embenet_port_brt.h"
 #include "embenet_port_config.h"
-#include "ring_buffer.h"
+#include "embenet_port_deferred.h"
+#include "embenet_port_timer_extension.h"
+#include "spsc_ring_buffer.h"
+#include <embetech/expect.h>
 
 #include <inttypes.h>
 #include <stdbool.h>
@@ -47,13 +50,37 @@ uint16_t openhdlc_crc(uint16_t crc, uint8_t byte) {
 }
 
 /* For openserial_asynch */
-#define OUTPUT_RING_BUFFER_SIZE 256 /*< output buffer size, in worst case a frame and a status frame could be send during one time slot */
-#define INPUT_RING_BUFFER_SIZE  512 /*< input buffer size */
-
+#define OUTPUT_RING_BUFFER_SIZE EMBENET_PORT_BRT_OUTPUT_BUFFER_SIZE /*< output buffer size, power of two */
+#define INPUT_RING_BUFFER_SIZE  1024                                /*< input buffer size, power of two */
+#define FRAME_QUEUE_SIZE        16                                  /*< number of received frames that can be delimited ahead of the stack, power of two */
+#define FRAME_OVERHEAD_MAX      6                                   /*< flags and the FCS, which may be escaped, of a frame */
+#define PACKET_SIZE_MAX         (EMBENET_BRT_MAX_FRAME_SIZE - 4)    /*< longest packet sent, without the flags and the FCS */
+
+#if (0 == OUTPUT_RING_BUFFER_SIZE) || (0 != (OUTPUT_RING_BUFFER_SIZE & (OUTPUT_RING_BUFFER_SIZE - 1)))
+#    error "EMBENET_PORT_BRT_OUTPUT_BUFFER_SIZE must be a power of two"
+#endif
+#if OUTPUT_RING_BUFFER_SIZE < (2 * PACKET_SIZE_MAX + FRAME_OVERHEAD_MAX)
+#    error "EMBENET_PORT_BRT_OUTPUT_BUFFER_SIZE must hold the longest frame with every byte escaped"
+#endif
+
+#if EMBENET_NODE_BSP_UART_DMA
+#    define RX_PAUSE_SPACE        (2 * EMBENET_NODE_BSP_UARTE_RX_CHUNK + 8) /*< reception is paused below this much free input buffer space */
+#    define RX_RESUME_SPACE       (INPUT_RING_BUFFER_SIZE / 2)              /*< and resumed when this much space is free again */
+#    define RX_PAUSE_FRAME_COUNT  (FRAME_QUEUE_SIZE - 4)                    /*< reception is also paused with this many frames pending */
+#    define RX_RESUME_FRAME_COUNT (FRAME_QUEUE_SIZE / 2)                    /*< and resumed when at most this many are left */
+#endif
+
+
+/*
+Both ring buffers are lock-free, with a single producer and a single consumer each: the input one is written by the RX interrupt and read
+by the main loop, the output one is written by the main loop and read by the TX interrupt. Output bytes are encoded in place into the free
+space of the output ring buffer and committed once per frame, and the transmission is kicked off after the commit: if the TX interrupt
+finds the buffer empty just before it, isTransmitting is already false when checked, and it cannot find it empty after.
+ */
 
 // ring buffer descriptors
-RingBuffer outputRingBufferDesc;
-RingBuffer inputRingBufferDesc;
+SpscRingBuffer outputRingBufferDesc;
+SpscRingBuffer inputRingBufferDesc;
 
 // input and output buffers
 uint8_t outputRingBuffer[OUTPUT_RING_BUFFER_SIZE];
@@ -63,23 +90,90 @@ uint8_t inputRingBuffer[INPUT_RING_BUFFER_SIZE];
 // true if transmission is in progress, otherwise false
 volatile bool isTransmitting;
 
+#if EMBENET_NODE_BSP_UART_DMA
+// number of bytes of the output ring buffer being sent by DMA
+static size_t txChunkLength;
+// true if the reception is paused because the stack lags behind
+static volatile bool rxPaused;
+#endif
+
+/*
+The RX interrupt only stores the received bytes, pauses the reception when needed and posts the delimiting to the deferred work. That one
+delimits the received frames: the input stream position right after each closing flag (a flag following a non-flag byte) is queued, so
+the main loop knows how many complete frames there are and decodes only those. The queue is single-producer/single-consumer like the
+ring buffers. When it is full, the last position is moved forward instead, so that no frame is left without an end. The bytes past the
+delimited position are never read by the main loop, so the deferred work scans them in the input ring buffer itself.
+ */
+
+/// queue of the positions (input ring buffer write index) of the ends of the received frames
+static struct {
+    uint32_t          end[FRAME_QUEUE_SIZE]; ///< positions right after the closing flags
+    volatile uint32_t writeIndex;            ///< number of frames delimited so far, changed only by the deferred work
+    volatile uint32_t readIndex;             ///< number of frames taken so far, changed only by the main loop
+    uint32_t          delimited;             ///< input stream position up to which the bytes are delimited
+    bool              lastWasFlag;           ///< true if the last delimited byte was a flag
+} frameQueue;
+
+static void rxDelimit(void* context);
+
+/// delimiting of the received bytes, posted by the RX interrupt
+static EMBENET_DEFERRED_Work rxDelimitWork = {.function = rxDelimit, .context = NULL, .level = EMBENET_DEFERRED_LEVEL_HIGH};
+
+#if EMBENET_PORT_BRT_AGGREGATION
+#    define AGGREGATE_CAPACITY (EMBENET_BRT_MAX_FRAME_SIZE - 4) /*< aggregated frame data size, without the flags and the FCS */
+
+/// packets waiting to be sent in an aggregated frame, as records of a length byte followed by the packet
+static struct {
+    bool              enabled;                    ///< true if the border router accepts aggregated frames
+    uint8_t           buffer[AGGREGATE_CAPACITY]; ///< records
+    size_t            length;                     ///< number of bytes in the buffer
+    EMBENET_TimeTicks deadline;                   ///< time at which the aggregated frame is sent at the latest
+} aggregate;
+#endif
+
+// FCS of the frame being sent
+static uint16_t txFcs;
+// time at which the transmission started
+static EMBENET_TimeTicks txStartTicks;
+
+/*
+Each statistic is updated from a single context, the RX interrupt (bytes in, overruns, input high-watermark), the deferred work of the
+reception (pending frame high-watermark), the TX interrupt (transmission time, which is also measured in the main loop while no transmission runs) or the main loop (the others),
+so no updates are lost. The statistics survive EMBENET_BRT_Init, which the stack calls on every link reset.
+ */
+static EMBENET_BRT_Stats stats;
+
+/// free space of the output ring buffer being filled by @ref uartWrite
+static struct {
+    uint8_t* span;       ///< beginning of the space
+    size_t   spanLength; ///< size of the space
+    size_t   used;       ///< number of bytes written, not committed yet
+} outputWriter;
+
 /**
- * @brief Sends byte through UART. Transmission is buffered. This function automatically handles transmission triggering.
- * @param[in] openstack_vars pointer to OpenWSN stack instance
+ * @brief Sends byte through UART. Transmission is buffered, it is triggered by @ref uartFlush.
  * @param[in] data Byte to send.
  */
 static void uartWrite(const uint8_t data);
 
+/**
+ * @brief Commits the bytes written with @ref uartWrite and triggers the transmission.
+ */
+static void uartFlush(void);
+
+/**
+ * @brief Marks the end of the transmission.
+ */
+static void txEnd(void);
+
 /**
  * @brief Sends data byte through UART. Automatically handles special characters recognition and substitution.
- * @param[in] openstack_vars pointer to OpenWSN stack instance
  * @param[in] byte Byte to send.
  */
 static void putByte(const uint8_t byte);
 
 /**
  * @brief Sends flag byte through UART.
- * @param[in] openstack_vars pointer to OpenWSN stack instance
  * @param[in] flag Flag byte to send.
  */
 static void putFlag(const uint8_t flag);
@@ -89,161 +183,462 @@ static void putFlag(const uint8_t flag);
  */
 void tx_isr(void* context);
 
+#if EMBENET_NODE_BSP_UART_DMA
+/**
+ * @brief RX interrupt handler, called with a chunk of received bytes.
+ */
+static void rx_chunk_isr(void* context, uint8_t const* data, size_t length);
+#else
 /**
  * @brief RX interrupt handler.
  */
 void rx_isr(void* context);
+#endif
+
+
+static void ringBuffersInit(void) {
+    SpscRingBuffer_Init(&inputRingBufferDesc, inputRingBuffer, INPUT_RING_BUFFER_SIZE);
+    SpscRingBuffer_Init(&outputRingBufferDesc, outputRingBuffer, OUTPUT_RING_BUFFER_SIZE);
+    outputWriter.spanLength = 0;
+    outputWriter.used       = 0;
+    frameQueue.writeIndex   = 0;
+    frameQueue.readIndex    = 0;
+    frameQueue.delimited    = 0;
+    frameQueue.lastWasFlag  = false;
+#if EMBENET_PORT_BRT_AGGREGATION
+    aggregate.length = 0;
+#endif
+#if EMBENET_NODE_BSP_UART_DMA
+    rxPaused = false;
+#endif
+}
+
+
+static inline size_t frameQueueGetLen(void) {
+    return (size_t)(uint32_t)(frameQueue.writeIndex - frameQueue.readIndex);
+}
+
+
+static void frameQueuePush(uint32_t end) {
+    if (frameQueueGetLen() < FRAME_QUEUE_SIZE) {
+        frameQueue.end[frameQueue.writeIndex & (FRAME_QUEUE_SIZE - 1)] = end;
+        frameQueue.writeIndex++;
+    } else {
+        // last entry is far ahead of the one being decoded, it may be extended safely
+        frameQueue.end[(frameQueue.writeIndex - 1) & (FRAME_QUEUE_SIZE - 1)] = end;
+    }
+}
+
+
+/**
+ * @brief Drops the queued frames whose bytes have all been read.
+ */
+static void frameQueueDropConsumed(void) {
+    while ((frameQueueGetLen() > 0) && ((int32_t)(frameQueue.end[frameQueue.readIndex & (FRAME_QUEUE_SIZE - 1)] - inputRingBufferDesc.readIndex) <= 0)) {
+        frameQueue.readIndex++;
+    }
+}
+
+
+#if EMBENET_NODE_BSP_UART_DMA
+/**
+ * @brief Pauses the reception, called from the RX interrupt, the reception callback of the UARTE driver.
+ */
+static void rxPause(void) {
+    if (!rxPaused) {
+        rxPaused = true;
+        EMBENET_NODE_BSP_UARTE_RxPause();
+    }
+}
+#endif
+
+
+/**
+ * @brief Stores the received bytes, called from the RX interrupt.
+ */
+static void rxPut(uint8_t const* data, size_t length) {
+    size_t written = SpscRingBuffer_Write(&inputRingBufferDesc, data, length);
+    size_t held    = SpscRingBuffer_GetLen(&inputRingBufferDesc);
+    stats.bytesIn += (uint32_t)length;
+    stats.rxOverruns += (uint32_t)(length - written);
+    if (held > stats.inputHighWatermark) {
+        stats.inputHighWatermark = (uint32_t)held;
+    }
+#if EMBENET_NODE_BSP_UART_DMA
+    // the frames are counted by the deferred work, up to the previous chunk; the driver allows pausing only from here
+    if ((SpscRingBuffer_GetSpace(&inputRingBufferDesc) < RX_PAUSE_SPACE) || (frameQueueGetLen() >= RX_PAUSE_FRAME_COUNT)) {
+        rxPause();
+    }
+#endif
+    if (0 != written) {
+        (void)EMBENET_DEFERRED_Post(&rxDelimitWork);
+    }
+}
+
+
+/**
+ * @brief Delimits the frames in the bytes stored since the last call, run as deferred work.
+ */
+static void rxDelimit(void* context) {
+    (void)context;
+    uint32_t written = inputRingBufferDesc.writeIndex;
+    for (uint32_t position = frameQueue.delimited; position != written; ++position) {
+        bool isFlag = (HDLC_FLAG == inputRingBuffer[position & (INPUT_RING_BUFFER_SIZE - 1)]);
+        if (isFlag && !frameQueue.lastWasFlag) {
+            frameQueuePush(position + 1);
+        }
+        frameQueue.lastWasFlag = isFlag;
+    }
+    frameQueue.delimited = written;
+    if (frameQueueGetLen() > stats.pendingFrameHighWatermark) {
+        stats.pendingFrameHighWatermark = (uint32_t)frameQueueGetLen();
+    }
+}
+
+
+/**
+ * @brief Resumes the reception when the stack has caught up, called from the main loop.
+ */
+static void rxResumeIfDrained(void) {
+#if EMBENET_NODE_BSP_UART_DMA
+    if (rxPaused && (SpscRingBuffer_GetSpace(&inputRingBufferDesc) >= RX_RESUME_SPACE) && (frameQueueGetLen() <= RX_RESUME_FRAME_COUNT)) {
+        // cleared after resuming, so that a pause decided meanwhile by the RX interrupt is decided again on the next chunk, not lost
+        EMBENET_NODE_BSP_UARTE_RxResume();
+        rxPaused = false;
+    }
+#endif
+}
 
 
 void EMBENET_BRT_Init(void) {
     // initialize ring buffers for input and output to store packets inside them
-    RingBuffer_Init(&inputRingBufferDesc, inputRingBuffer, INPUT_RING_BUFFER_SIZE);
-    RingBuffer_Init(&outputRingBufferDesc, outputRingBuffer, OUTPUT_RING_BUFFER_SIZE);
+    ringBuffersInit();
 
     isTransmitting = false;
+#if EMBENET_PORT_BRT_AGGREGATION
+    // the border router on the other end of a new link has not offered to take aggregated frames yet
+    aggregate.enabled = false;
+#endif
     // set callbacks
+#if EMBENET_NODE_BSP_UART_DMA
+    txChunkLength = 0;
+    EMBENET_NODE_BSP_UARTE_Init((EMBENET_NODE_BSP_UART_Callback_t)tx_isr, rx_chunk_isr, NULL);
+#else
     EMBENET_NODE_BSP_UART_Init((EMBENET_NODE_BSP_UART_Callback_t)tx_isr, (EMBENET_NODE_BSP_UART_Callback_t)rx_isr, NULL);
+#endif
 }
 
 
 void EMBENET_BRT_Deinit(void) {
     // set callbacks
+#if EMBENET_NODE_BSP_UART_DMA
+    EMBENET_NODE_BSP_UARTE_Deinit();
+#else
     EMBENET_NODE_BSP_UART_Deinit();
+#endif
     isTransmitting = false;
     // initialize ring buffers for input and output to store packets inside them
-    RingBuffer_Init(&inputRingBufferDesc, inputRingBuffer, INPUT_RING_BUFFER_SIZE);
-    RingBuffer_Init(&outputRingBufferDesc, outputRingBuffer, OUTPUT_RING_BUFFER_SIZE);
+    ringBuffersInit();
 }
 
 
-void EMBENET_BRT_Send(const void* packet, size_t packetLength) {
-    uint16_t finalCrc = HDLC_CRCINIT;
+static inline bool isEscaped(uint8_t byte) {
+    return (HDLC_FLAG == byte) || (HDLC_ESCAPE == byte);
+}
+
+
+/**
+ * @brief Adds the given bytes to the FCS of the frame being sent.
+ * @return number of the bytes that are escaped
+ */
+static size_t frameMeasure(uint8_t const* data, size_t length) {
+    size_t escapes = 0;
+    for (size_t i = 0; i < length; ++i) {
+        txFcs = openhdlc_crc(txFcs, data[i]);
+        escapes += isEscaped(data[i]) ? 1U : 0U;
+    }
+    return escapes;
+}
+
+
+static void frameAppend(uint8_t const* data, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        putByte(data[i]);
+    }
+}
+
+
+/**
+ * @brief Queues a frame made of the given header (may be empty) and data, if it fits in the output buffer.
+ *
+ * The FCS and the escaped length are found in a first pass over the bytes, so nothing is written unless the whole frame fits, and the
+ * second pass only escapes the bytes into the buffer.
+ * @return true if the frame is queued, false if it does not fit
+ */
+static bool frameSend(uint8_t const* header, size_t headerLength, uint8_t const* data, size_t dataLength) {
+    txFcs             = HDLC_CRCINIT;
+    size_t   escapes  = frameMeasure(header, headerLength) + frameMeasure(data, dataLength);
+    uint16_t finalCrc = (uint16_t)(~txFcs);
+    uint8_t  fcs[2]   = {(uint8_t)((finalCrc >> 0) & 0xff), (uint8_t)((finalCrc >> 8) & 0xff)};
+    escapes += (isEscaped(fcs[0]) ? 1U : 0U) + (isEscaped(fcs[1]) ? 1U : 0U);
+    if ((2 + headerLength + dataLength + sizeof(fcs) + escapes) > SpscRingBuffer_GetSpace(&outputRingBufferDesc)) {
+        return false;
+    }
 
-    uint8_t const* packetBytes = (uint8_t const*)packet;
-    // HDLC flag
     putFlag(HDLC_FLAG);
-    // address (eui64)
-    for (size_t i = 0; i < packetLength; ++i) {
-        finalCrc = openhdlc_crc(finalCrc, packetBytes[i]);
-        putByte(packetBytes[i]);
-    }
-    // writing CRC
-    finalCrc = (uint16_t)(~finalCrc);
-    putByte((uint8_t)((finalCrc >> 0) & 0xff));
-    putByte((uint8_t)((finalCrc >> 8) & 0xff));
+    frameAppend(header, headerLength);
+    frameAppend(data, dataLength);
+    frameAppend(fcs, sizeof(fcs));
     putFlag(HDLC_FLAG);
+    uartFlush();
+    stats.framesOut++;
+    return true;
 }
 
 
-size_t EMBENET_BRT_Receive(void* packetBuffer, size_t packetBufferSize) {
-    static uint8_t inputFrame[EMBENET_BRT_MAX_FRAME_SIZE];
-    static size_t  inputFrameDataIndex;
-    static bool    inputFrameReceiving;
-    static uint8_t lastDataByte;
+#if EMBENET_PORT_BRT_AGGREGATION
+/**
+ * @brief Sends the aggregated packets, unless they do not fit in the output buffer yet.
+ * @return true if there are no aggregated packets left
+ */
+static bool aggregateFlush(void) {
+    if ((aggregate.length > 0) && frameSend(NULL, 0, aggregate.buffer, aggregate.length)) {
+        aggregate.length = 0;
+    }
+    return (0 == aggregate.length);
+}
 
-    uint8_t dataByte;
-    bool    frameComplete = false;
 
-    while (RingBuffer_GetLen(&inputRingBufferDesc) > 0 && frameComplete == false) {
-        EMBENET_CRITICAL_SECTION_Enter();
-        RingBuffer_GetChar(&inputRingBufferDesc, &dataByte);
-        EMBENET_CRITICAL_SECTION_Exit();
+static void aggregatePoll(void) {
+    if ((aggregate.length > 0) && ((int64_t)(EMBENET_TIMER_ReadTicks() - aggregate.deadline) >= 0)) {
+        (void)aggregateFlush();
+    }
+}
 
 
-        if (false == inputFrameReceiving) {
-            // looking for new frame
-            if (HDLC_FLAG == dataByte) {
-                inputFrameReceiving = true;
-                inputFrameDataIndex = 0;
-            }
-        } else {
-            // already receiving frame
+static bool aggregateSend(uint8_t const* packet, size_t packetLength) {
+    uint8_t recordLength = (uint8_t)packetLength;
+    if (aggregate.length + 1 + packetLength > AGGREGATE_CAPACITY) {
+        if (!aggregateFlush()) {
+            // the packets aggregated so far must go out first
+            return false;
+        }
+        if (1 + packetLength > AGGREGATE_CAPACITY) {
+            // too long to wait for company, goes out alone
+            return frameSend(&recordLength, 1, packet, packetLength);
+        }
+    }
+    if (0 == aggregate.length) {
+        aggregate.deadline = EMBENET_TIMER_ReadTicks() + EMBENET_TIMER_UsToTicks(EMBENET_PORT_BRT_AGGREGATION_TIMEOUT_US);
+    }
+    aggregate.buffer[aggregate.length++] = recordLength;
+    memcpy(&aggregate.buffer[aggregate.length], packet, packetLength);
+    aggregate.length += packetLength;
+    return true;
+}
+#endif
+
+
+bool EMBENET_BRT_TrySend(const void* packet, size_t packetLength) {
+    uint8_t const* packetBytes = (uint8_t const*)packet;
+#if EMBENET_PORT_BRT_AGGREGATION
+    if (aggregate.enabled) {
+        aggregatePoll();
+        return aggregateSend(packetBytes, packetLength);
+    }
+#endif
+    return frameSend(NULL, 0, packetBytes, packetLength);
+}
+
+
+void EMBENET_BRT_Send(const void* packet, size_t packetLength) {
+    // the stack does not take refusals, a packet that does not fit is dropped whole rather than cut short on the line
+    if (!EMBENET_BRT_TrySend(packet, packetLength)) {
+        stats.packetsDropped++;
+    }
+}
+
+
+size_t EMBENET_BRT_GetOutputSpace(void) {
+    size_t space    = SpscRingBuffer_GetSpace(&outputRingBufferDesc);
+    size_t reserved = FRAME_OVERHEAD_MAX;
+#if EMBENET_PORT_BRT_AGGREGATION
+    if (aggregate.enabled) {
+        // the packet takes a record length byte, and the packets aggregated so far may have to go out before it
+        reserved += 2;
+        if (aggregate.length > 0) {
+            reserved += 2 * aggregate.length + FRAME_OVERHEAD_MAX;
+        }
+    }
+#endif
+    if (space <= reserved) {
+        return 0;
+    }
+    size_t packetLength = (space - reserved) / 2;
+    return (packetLength < PACKET_SIZE_MAX) ? packetLength : PACKET_SIZE_MAX;
+}
+
+
+void EMBENET_BRT_SetAggregation(bool enabled) {
+#if EMBENET_PORT_BRT_AGGREGATION
+    if (!enabled && !aggregateFlush()) {
+        // the border router does not take aggregated frames any more, the records that do not fit now cannot wait
+        for (size_t i = 0; i < aggregate.length; i += 1U + aggregate.buffer[i]) {
+            stats.packetsDropped++;
+        }
+        aggregate.length = 0;
+    }
+    aggregate.enabled = enabled;
+#else
+    (void)enabled;
+#endif
+}
+
+
+bool EMBENET_BRT_IsAggregationEnabled(void) {
+#if EMBENET_PORT_BRT_AGGREGATION
+    return aggregate.enabled;
+#else
+    return false;
+#endif
+}
+
+
+void EMBENET_BRT_Flush(void) {
+#if EMBENET_PORT_BRT_AGGREGATION
+    (void)aggregateFlush();
+#endif
+}
+
+
+/*
+Frames are decoded in a single pass, as the bytes are taken from the input ring buffer: each byte is de-escaped, added to the FCS and
+written into the frame of the decoder. The last two bytes of a frame are its FCS, so every byte is held back until two more bytes follow,
+and the FCS bytes never reach the frame. The FCS computed over the data and the FCS itself equals HDLC_CRCGOOD for a valid frame, which
+is checked on the closing flag. Only a valid frame that fits is copied to the caller's buffer, which is left untouched otherwise. Only
+bytes up to the end of the oldest delimited frame are decoded, so a call returns nothing until a whole frame is in.
+ */
+
+/// HDLC input frame decoder
+static struct {
+    bool     receiving; ///< true after an opening flag
+    bool     escaped;   ///< true if the last byte was an escape
+    bool     overflow;                              ///< true if the frame is too long, it is dropped on the closing flag
+    uint8_t  frame[EMBENET_BRT_MAX_FRAME_SIZE - 2]; ///< decoded bytes of the frame, without the flags and the FCS
+    size_t   length;                                ///< number of decoded bytes
+    uint16_t fcs;                                   ///< FCS of all the bytes of the frame so far
+    uint8_t  held[2];                               ///< last two bytes, which are the FCS if the frame ends here
+    uint8_t  heldCount;                             ///< number of bytes in held
+} decoder;
+
+static void decoderReset(void) {
+    decoder.receiving = true;
+    decoder.escaped   = false;
+    decoder.overflow  = false;
+    decoder.length    = 0;
+    decoder.fcs       = HDLC_CRCINIT;
+    decoder.heldCount = 0;
+}
+
+static void decoderPut(uint8_t dataByte) {
+    decoder.fcs = openhdlc_crc(decoder.fcs, dataByte);
+    if (decoder.heldCount < 2) {
+        decoder.held[decoder.heldCount++] = dataByte;
+        return;
+    }
+    if (decoder.length < sizeof(decoder.frame)) {
+        decoder.frame[decoder.length++] = decoder.held[0];
+    } else {
+        decoder.overflow = true;
+    }
+    decoder.held[0] = decoder.held[1];
+    decoder.held[1] = dataByte;
+}
+
+size_t EMBENET_BRT_Receive(void* packetBuffer, size_t packetBufferSize) {
+#if EMBENET_PORT_BRT_AGGREGATION
+    // the link is polled often, which keeps the aggregation timeout
+    aggregatePoll();
+#endif
+
+    // only the delimited frames are decoded, span by span
+    frameQueueDropConsumed();
+    while (frameQueueGetLen() > 0) {
+        uint32_t       end        = frameQueue.end[frameQueue.readIndex & (FRAME_QUEUE_SIZE - 1)];
+        uint8_t const* span;
+        size_t         spanLength = SpscRingBuffer_PeekRead(&inputRingBufferDesc, &span);
+        size_t         toEnd      = (size_t)(uint32_t)(end - inputRingBufferDesc.readIndex);
+        if (spanLength > toEnd) {
+            spanLength = toEnd;
+        }
+        for (size_t i = 0; i < spanLength; ++i) {
+            uint8_t dataByte = span[i];
             if (HDLC_FLAG == dataByte) {
-                if (HDLC_FLAG != lastDataByte) {
-                    // finished frame
-                    inputFrameReceiving = false;
-                    if (inputFrameDataIndex > 2) {
-                        frameComplete = true; // one frame at a time
-                    } else {
-                        // new frame may be ongoing
-                        inputFrameReceiving = true;
-                        inputFrameDataIndex = 0;
+                // closing flag of one frame is the opening flag of the next one, at least one data byte and the FCS make a frame
+                bool   complete = decoder.receiving && !decoder.overflow && (decoder.length > 0);
+                bool   valid    = complete && (HDLC_CRCGOOD == decoder.fcs);
+                size_t length   = decoder.length;
+                if (!complete) {
+                    // back-to-back flags are just idle fill
+                    if (decoder.receiving && (decoder.overflow || (decoder.heldCount > 0))) {
+                        stats.framingErrors++;
                     }
+                } else if (!valid) {
+                    stats.crcErrors++;
+                } else if (length > packetBufferSize) {
+                    stats.framingErrors++;
+                    valid = false;
                 } else {
-                    // two '~' at a time, repeating frame start
-                    inputFrameReceiving = true;
-                    inputFrameDataIndex = 0;
+                    memcpy(packetBuffer, decoder.frame, length);
                 }
-            } else {
-                // add byte to buffer
-                if (inputFrameDataIndex < sizeof(inputFrame)) {
-                    if (HDLC_ESCAPE != dataByte) {
-                        if (HDLC_ESCAPE != lastDataByte) {
-                            inputFrame[inputFrameDataIndex++] = dataByte;
-                        } else {
-                            inputFrame[inputFrameDataIndex++] = (dataByte ^ HDLC_ESCAPE_MASK);
-                        }
-                    }
+                decoderReset();
+                if (valid) {
+                    stats.framesIn++;
+                    SpscRingBuffer_CommitRead(&inputRingBufferDesc, i + 1);
+                    frameQueueDropConsumed();
+                    rxResumeIfDrained();
+                    return length;
+                }
+            } else if (decoder.receiving) {
+                if (HDLC_ESCAPE == dataByte) {
+                    decoder.escaped = true;
                 } else {
-                    inputFrameReceiving = false;
-                    inputFrameDataIndex = 0;
+                    decoderPut(decoder.escaped ? (dataByte ^ HDLC_ESCAPE_MASK) : dataByte);
+                    decoder.escaped = false;
                 }
             }
         }
-        lastDataByte = dataByte;
-    }
-
-    if (true == frameComplete && inputFrameDataIndex > 0) {
-        // full frame has been received, structure:
-        // - data: variable bytes count
-        // - CRC: 2B
-        // check CRC
-        uint16_t crc = HDLC_CRCINIT;
-        for (size_t index = 0; index < inputFrameDataIndex - 2; ++index) { // two last bytes are CRC bytes
-            crc = openhdlc_crc(crc, inputFrame[index]);
-        }
-        crc = (uint16_t)(~crc);
-        if ((((crc >> 0) & 0xff) == inputFrame[inputFrameDataIndex - 2]) && (((crc >> 8) & 0xff) == inputFrame[inputFrameDataIndex - 1])) { // two last bytes are CRC bytes
-            // CRC OK!
-            size_t returnSize = inputFrameDataIndex - 2;
-            // frame received, pretend last HDLC flag belongs to new frame
-            inputFrameReceiving = true;
-            inputFrameDataIndex = 0;
-            // copy data
-            if (packetBufferSize >= returnSize) { // data bytes count without CRC
-                memcpy(packetBuffer, &inputFrame[0], returnSize);
-                return returnSize;
-            } else {
-                memcpy(packetBuffer, &inputFrame[0], packetBufferSize);
-                return 0;
-            }
-        } else {
-            // frame malformed, pretend last HDLC flag belongs to new frame
-            inputFrameReceiving = true;
-            inputFrameDataIndex = 0;
-        }
+        SpscRingBuffer_CommitRead(&inputRingBufferDesc, spanLength);
+        frameQueueDropConsumed();
     }
+    rxResumeIfDrained();
 
     return 0;
 }
 
 void EMBENET_BRT_SendRaw(const void* data, size_t dataLength) {
-    for(size_t i = 0; i < dataLength; ++i) {
-        uartWrite(((uint8_t const*)data)[i]);
-    }
+    EMBENET_BRT_Flush();
+    uartFlush();
+    size_t written = SpscRingBuffer_Write(&outputRingBufferDesc, data, dataLength);
+    stats.bytesOut += (uint32_t)written;
+    stats.txStalls += (uint32_t)(dataLength - written);
+    uartFlush();
 }
 
 size_t EMBENET_BRT_ReceiveRaw(void* data, size_t dataBufferSize) {
-    EMBENET_CRITICAL_SECTION_Enter();
-    uint8_t* dataBytes = (uint8_t*)data;
-    while(RingBuffer_GetChar(&inputRingBufferDesc, dataBytes)) {
-        ++dataBytes;
-        if(dataBytes >= (uint8_t*)data + dataBufferSize) {
-            break;
-        }
-    }
-    EMBENET_CRITICAL_SECTION_Exit();
-    return (size_t)(dataBytes - (uint8_t*)data);
+    size_t length = SpscRingBuffer_Read(&inputRingBufferDesc, data, dataBufferSize);
+    frameQueueDropConsumed();
+    rxResumeIfDrained();
+    return length;
+}
+
+void EMBENET_BRT_GetStats(EMBENET_BRT_Stats* statsOut) {
+    EXPECT(NULL != statsOut) OR_RETURN();
+    *statsOut = stats;
+}
+
+size_t EMBENET_BRT_GetPendingFrameCount(void) {
+    return frameQueueGetLen();
 }
 
 void EMBENET_BRT_Reset(void) {
@@ -253,24 +648,77 @@ void EMBENET_BRT_Reset(void) {
 }
 
 bool EMBENET_BRT_IsBusy(void) {
+#if EMBENET_PORT_BRT_AGGREGATION
+    // aggregated packets count as being sent, polling for the end of the transmission sends them in time
+    aggregatePoll();
+    if (aggregate.length > 0) {
+        return true;
+    }
+#endif
     return isTransmitting;
 }
 
+static void txEnd(void) {
+    uint32_t transmissionTimeUs = EMBENET_TIMER_TicksToUs((uint32_t)(EMBENET_TIMER_ReadTicks() - txStartTicks));
+    if (transmissionTimeUs > stats.maxTransmissionTimeUs) {
+        stats.maxTransmissionTimeUs = transmissionTimeUs;
+    }
+    isTransmitting = false;
+}
+
+
+#if EMBENET_NODE_BSP_UART_DMA
+/*
+DMA transmits straight from the output ring buffer: the longest contiguous run of bytes at the read end of the buffer is sent as one chunk
+and it is released from the buffer only when the transmission is finished, so the writer never overwrites it.
+ */
+
+static void txStart(void) {
+    uint8_t const* chunk;
+    size_t         length = SpscRingBuffer_PeekRead(&outputRingBufferDesc, &chunk);
+    if (length > EMBENET_NODE_BSP_UARTE_MAX_TX_CHUNK) {
+        length = EMBENET_NODE_BSP_UARTE_MAX_TX_CHUNK;
+    }
+    txChunkLength = length;
+    if (length > 0) {
+        EMBENET_NODE_BSP_UARTE_Write(chunk, length);
+    } else {
+        // buffer is empty, transmitting is over for now
+        txEnd();
+    }
+}
+
 void tx_isr(void* context) {
     (void)(context);
+
+    SpscRingBuffer_CommitRead(&outputRingBufferDesc, txChunkLength);
+    txStart();
+}
+
+
+static void rx_chunk_isr(void* context, uint8_t const* data, size_t length) {
+    (void)(context);
+
+    rxPut(data, length);
+}
+#else
+static void txStart(void) {
     uint8_t chunk;
 
-    EMBENET_CRITICAL_SECTION_Enter();
     // get first byte from output ring buffer
-    if (true == RingBuffer_GetChar(&outputRingBufferDesc, &chunk)) {
+    if (1 == SpscRingBuffer_Read(&outputRingBufferDesc, &chunk, 1)) {
         // send it by uart
-
         EMBENET_NODE_BSP_UART_WriteByte(chunk);
     } else {
         // buffer is empty, transmitting is over for now
-        isTransmitting = false;
+        txEnd();
     }
-    EMBENET_CRITICAL_SECTION_Exit();
+}
+
+void tx_isr(void* context) {
+    (void)(context);
+
+    txStart();
 }
 
 
@@ -281,11 +729,9 @@ void rx_isr(void* context) {
     // read byte just received
     rxByte = EMBENET_NODE_BSP_UART_ReadByte();
 
-
-    EMBENET_CRITICAL_SECTION_Enter();
-    RingBuffer_PutChar(&inputRingBufferDesc, rxByte);
-    EMBENET_CRITICAL_SECTION_Exit();
+    rxPut(&rxByte, 1);
 }
+#endif
 
 
 static void putFlag(uint8_t flag) {
@@ -305,16 +751,32 @@ static void putByte(uint8_t byte) {
 
 
 static void uartWrite(uint8_t data) {
-    EMBENET_CRITICAL_SECTION_Enter();
-    if (true == isTransmitting) {
-        // put to FIFO buffer
-        RingBuffer_PutChar(&outputRingBufferDesc, data);
+    if (outputWriter.used == outputWriter.spanLength) {
+        // the span is full, the buffer may wrap around or the TX may have freed some space in the meantime
+        uartFlush();
+        outputWriter.spanLength = SpscRingBuffer_PeekWrite(&outputRingBufferDesc, &outputWriter.span);
+        if (0 == outputWriter.spanLength) {
+            // buffer is full, the byte is lost, which only raw data can hit since frames are checked to fit
+            stats.txStalls++;
+            return;
+        }
+    }
+    outputWriter.span[outputWriter.used++] = data;
+}
 
-    } else {
-        // change transmitting flag state
+
+static void uartFlush(void) {
+    SpscRingBuffer_CommitWrite(&outputRingBufferDesc, outputWriter.used);
+    stats.bytesOut += (uint32_t)outputWriter.used;
+    size_t held = SpscRingBuffer_GetLen(&outputRingBufferDesc);
+    if (held > stats.outputHighWatermark) {
+        stats.outputHighWatermark = (uint32_t)held;
+    }
+    outputWriter.used       = 0;
+    outputWriter.spanLength = 0;
+    if (false == isTransmitting) {
+        txStartTicks   = EMBENET_TIMER_ReadTicks();
         isTransmitting = true;
-        // put byte to uart
-        EMBENET_NODE_BSP_UART_WriteByte(data);
+        txStart();
     }
-    EMBENET_CRITICAL_SECTION_Exit();
 }
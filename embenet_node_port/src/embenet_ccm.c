@@ -0,0 +1,164 @@
+/**
+@file
+@license   Commercial
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET Node port for nRF52832
+@brief     Implementation of the frame-level CCM* authenticated encryption
+*/
+
+#include "embenet_port_ccm.h"
+
+#include "embenet_port_ecb.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define BLOCK_SIZE        16
+#define LENGTH_FIELD_SIZE 2      ///< size of the message length field (L)
+#define MAX_DATA_LENGTH   0xffff ///< longest message the length field can hold
+#define MAX_ADATA_LENGTH  0xfeff ///< longest additional data with a 2 byte length prefix
+
+/*
+The CBC-MAC is kept in the cleartext of its ECB data structure: the input bytes are XORed straight into it and once the block is full
+it is encrypted and the ciphertext becomes the next chaining value. The counter blocks are built in the cleartext of another structure
+and their ciphertext is the keystream. Both structures live on the stack, so the functions are reentrant.
+ */
+
+/// CBC-MAC state
+typedef struct {
+    EMBENET_ECB_Block ecb;  ///< chaining value in the cleartext
+    size_t            fill; ///< number of bytes XORed into the chaining value since the last encryption
+    bool              ok;   ///< false if any block failed
+} Mac;
+
+static void macRun(Mac* mac) {
+    mac->ok = EMBENET_ECB_Run(&mac->ecb) && mac->ok;
+    memcpy(mac->ecb.cleartext, mac->ecb.ciphertext, BLOCK_SIZE);
+    mac->fill = 0;
+}
+
+static void macUpdate(Mac* mac, uint8_t const* data, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        mac->ecb.cleartext[mac->fill++] ^= data[i];
+        if (BLOCK_SIZE == mac->fill) {
+            macRun(mac);
+        }
+    }
+}
+
+static void macPad(Mac* mac) {
+    // zero padding leaves the chaining value as it is
+    if (0 != mac->fill) {
+        macRun(mac);
+    }
+}
+
+static void macStart(Mac* mac, uint8_t const key[16U], uint8_t const nonce[EMBENET_CCM_NONCE_SIZE], uint8_t const* aData, size_t aDataLength,
+                     size_t mDataLength, size_t micLength) {
+    // B0: flags, nonce, message length
+    memcpy(mac->ecb.key, key, 16);
+    mac->ecb.cleartext[0] = (uint8_t)(((0 != aDataLength) ? 0x40 : 0x00) | (((0 != micLength) ? ((micLength - 2) / 2) : 0) << 3) | (LENGTH_FIELD_SIZE - 1));
+    memcpy(&mac->ecb.cleartext[1], nonce, EMBENET_CCM_NONCE_SIZE);
+    mac->ecb.cleartext[14] = (uint8_t)(mDataLength >> 8);
+    mac->ecb.cleartext[15] = (uint8_t)mDataLength;
+    mac->ok                = true;
+    macRun(mac);
+    if (0 != aDataLength) {
+        uint8_t aDataLengthField[2] = {(uint8_t)(aDataLength >> 8), (uint8_t)aDataLength};
+        macUpdate(mac, aDataLengthField, sizeof(aDataLengthField));
+        macUpdate(mac, aData, aDataLength);
+        macPad(mac);
+    }
+}
+
+static void counterSet(EMBENET_ECB_Block* ctr, uint16_t counter) {
+    ctr->cleartext[14] = (uint8_t)(counter >> 8);
+    ctr->cleartext[15] = (uint8_t)counter;
+}
+
+static void counterStart(EMBENET_ECB_Block* ctr, uint8_t const key[16U], uint8_t const nonce[EMBENET_CCM_NONCE_SIZE]) {
+    // A0: flags, nonce, counter
+    memcpy(ctr->key, key, 16);
+    ctr->cleartext[0] = LENGTH_FIELD_SIZE - 1;
+    memcpy(&ctr->cleartext[1], nonce, EMBENET_CCM_NONCE_SIZE);
+    counterSet(ctr, 0);
+}
+
+static bool argumentsValid(uint8_t const* key, uint8_t const* nonce, uint8_t const* aData, size_t aDataLength, uint8_t const* mData, size_t mDataLength,
+                           uint8_t const* mic, size_t micLength) {
+    return (NULL != key) && (NULL != nonce) && ((NULL != aData) || (0 == aDataLength)) && (aDataLength <= MAX_ADATA_LENGTH) && ((NULL != mData) || (0 == mDataLength)) &&
+           (mDataLength <= MAX_DATA_LENGTH) && ((NULL != mic) || (0 == micLength)) && ((0 == micLength) || (4 == micLength) || (8 == micLength) || (16 == micLength));
+}
+
+/**
+ * @brief Encrypts or decrypts the data in place, authenticating the plaintext along the way.
+ * @param[out] mac MAC state, not used if micLength is 0
+ * @param[out] s0 first keystream block, which masks the MIC
+ * @return true on success
+ */
+static bool process(uint8_t const key[16U], uint8_t const nonce[EMBENET_CCM_NONCE_SIZE], uint8_t const* aData, size_t aDataLength, uint8_t* mData,
+                    size_t mDataLength, size_t micLength, bool encrypt, Mac* mac, uint8_t s0[BLOCK_SIZE]) {
+    EMBENET_ECB_Block ctr;
+    bool              ok = true;
+
+    if (0 != micLength) {
+        macStart(mac, key, nonce, aData, aDataLength, mDataLength, micLength);
+    }
+    counterStart(&ctr, key, nonce);
+    ok = EMBENET_ECB_Run(&ctr);
+    memcpy(s0, ctr.ciphertext, BLOCK_SIZE);
+
+    uint16_t counter = 1;
+    for (size_t offset = 0; offset < mDataLength; offset += BLOCK_SIZE, ++counter) {
+        size_t length = ((mDataLength - offset) < BLOCK_SIZE) ? (mDataLength - offset) : BLOCK_SIZE;
+        if (encrypt && (0 != micLength)) {
+            macUpdate(mac, &mData[offset], length);
+        }
+        counterSet(&ctr, counter);
+        ok = EMBENET_ECB_Run(&ctr) && ok;
+        for (size_t i = 0; i < length; ++i) {
+            mData[offset + i] ^= ctr.ciphertext[i];
+        }
+        if (!encrypt && (0 != micLength)) {
+            macUpdate(mac, &mData[offset], length);
+        }
+    }
+    if (0 != micLength) {
+        macPad(mac);
+        ok = ok && mac->ok;
+    }
+    return ok;
+}
+
+bool EMBENET_CCM_Encrypt(uint8_t const key[16U], uint8_t const nonce[EMBENET_CCM_NONCE_SIZE], uint8_t const* aData, size_t aDataLength, uint8_t* mData,
+                         size_t mDataLength, uint8_t* mic, size_t micLength) {
+    if (!argumentsValid(key, nonce, aData, aDataLength, mData, mDataLength, mic, micLength)) {
+        return false;
+    }
+    Mac     mac;
+    uint8_t s0[BLOCK_SIZE];
+    bool    ok = process(key, nonce, aData, aDataLength, mData, mDataLength, micLength, true, &mac, s0);
+    for (size_t i = 0; i < micLength; ++i) {
+        mic[i] = mac.ecb.cleartext[i] ^ s0[i];
+    }
+    return ok;
+}
+
+bool EMBENET_CCM_Decrypt(uint8_t const key[16U], uint8_t const nonce[EMBENET_CCM_NONCE_SIZE], uint8_t const* aData, size_t aDataLength, uint8_t* mData,
+                         size_t mDataLength, uint8_t const* mic, size_t micLength) {
+    if (!argumentsValid(key, nonce, aData, aDataLength, mData, mDataLength, mic, micLength)) {
+        return false;
+    }
+    Mac     mac;
+    uint8_t s0[BLOCK_SIZE];
+    bool    ok = process(key, nonce, aData, aDataLength, mData, mDataLength, micLength, false, &mac, s0);
+    // compared in constant time
+    uint8_t difference = 0;
+    for (size_t i = 0; i < micLength; ++i) {
+        difference |= (uint8_t)(mic[i] ^ mac.ecb.cleartext[i] ^ s0[i]);
+    }
+    return ok && (0 == difference);
+}
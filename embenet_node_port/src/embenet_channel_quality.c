@@ -0,0 +1,238 @@
+/**
+@file
+@license   Commercial
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET Node port for nRF52832
+@brief     Per-channel link quality statistics and channel blacklisting
+
+*/
+
+#include "embenet_port_channel_quality.h"
+
+#include "embenet_critical_section.h"
+#include "embenet_port_channel_quality_internal.h"
+#include "embenet_port_radio_config.h"
+#include <embetech/expect.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define SCORE_MAX       255U                                                         ///< score of a channel without any failures
+#define PENALTY_BAD     (SCORE_MAX - EMBENET_CHANNEL_QUALITY_BAD_SCORE)              ///< penalty above which a channel is bad
+#define PENALTY_READMIT (PENALTY_BAD / 2U)                                           ///< penalty given to re-admitted channels
+#define RSSI_SHIFT      3U                                                           ///< RSSI is averaged with 1/8 weight of the new sample
+
+/// Statistics of a single channel
+typedef struct {
+    uint32_t rxOk;           ///< frames received with valid CRC
+    uint32_t rxCrcError;     ///< frames received with invalid CRC
+    uint32_t tx;             ///< transmitted frames
+    uint32_t txNoAck;        ///< transmitted frames that were not acknowledged
+    uint32_t rxOkMark;       ///< rxOk at the last evaluation
+    uint32_t rxCrcErrorMark; ///< rxCrcError at the last evaluation
+    uint32_t txMark;         ///< tx at the last evaluation
+    uint32_t txNoAckMark;    ///< txNoAck at the last evaluation
+    int16_t  rssiAvg;        ///< average RSSI, scaled by 2^RSSI_SHIFT
+    uint8_t  penalty;        ///< link quality score subtracted from SCORE_MAX, so that zeroed statistics describe a good channel
+    uint8_t  probation;      ///< evaluation periods spent on the blacklist
+} ChannelEntry;
+
+typedef struct {
+    ChannelEntry                      channels[EMBENET_CHANNEL_QUALITY_CHANNEL_COUNT]; ///< per-channel statistics
+    EMBENET_ChannelMask               blacklist;                                       ///< blacklist currently applied
+    uint8_t                           goodCount;                                       ///< number of channels not blacklisted
+    EMBENET_CHANNEL_QUALITY_AsnSource asnSource;                                       ///< ASN of the slot being processed by the stack
+    volatile uint8_t                  lastTxChannel;                                   ///< physical channel of the last transmission
+} Admin;
+static Admin admin;
+
+static const EMBENET_ChannelMask allChannels = (((EMBENET_ChannelMask)1) << EMBENET_CHANNEL_QUALITY_CHANNEL_COUNT) - 1;
+
+static inline bool isBlacklisted(EMBENET_ChannelMask blacklist, unsigned channel) {
+    return 0 != (blacklist & (((EMBENET_ChannelMask)1) << channel));
+}
+
+static unsigned countChannels(EMBENET_ChannelMask mask) {
+    unsigned count = 0;
+    for (; 0 != mask; mask &= mask - 1) {
+        ++count;
+    }
+    return count;
+}
+
+void EMBENET_CHANNEL_QUALITY_Reset(void) {
+    EMBENET_CRITICAL_SECTION_Enter();
+    memset(admin.channels, 0, sizeof(admin.channels));
+    admin.blacklist = 0;
+    admin.goodCount = EMBENET_CHANNEL_QUALITY_CHANNEL_COUNT;
+    EMBENET_CRITICAL_SECTION_Exit();
+}
+
+/*
+The stack hops as embenetMacChannelList[(ASN + channel offset) % 37], over a list that is the identity, so in a given slot the cells with
+channel offsets 0 to EMBENET_CHANNEL_QUALITY_CHANNEL_OFFSETS - 1 occupy a window of consecutive channels starting at ASN % 37. Good
+channels are never remapped, so that a node that has not received the blacklist yet still meets the others on them. A blacklisted
+channel is replaced by a good channel outside of the window, the n-th blacklisted channel of the window by the n-th good channel after
+it, so no two cells of the window share a channel: there are always enough good channels outside, as the window is not longer than
+EMBENET_CHANNEL_QUALITY_MIN_CHANNELS. The replacement depends only on the blacklist and the ASN, so it is the same on all nodes.
+ */
+
+static inline unsigned ringNext(unsigned channel) {
+    return (channel + 1U < EMBENET_CHANNEL_QUALITY_CHANNEL_COUNT) ? channel + 1U : 0U;
+}
+
+uint8_t EMBENET_CHANNEL_QUALITY_Map(uint8_t channel) {
+    EMBENET_ChannelMask blacklist = admin.blacklist;
+    if ((channel >= EMBENET_CHANNEL_QUALITY_CHANNEL_COUNT) || !isBlacklisted(blacklist, channel) || (NULL == admin.asnSource)) {
+        return channel;
+    }
+    unsigned windowStart = (unsigned)(admin.asnSource() % EMBENET_CHANNEL_QUALITY_CHANNEL_COUNT);
+    // rank of the channel among the blacklisted channels, counted from the start of the window
+    unsigned rank = 0;
+    unsigned ch   = windowStart;
+    for (; ch != channel; ch = ringNext(ch)) {
+        rank += isBlacklisted(blacklist, ch) ? 1U : 0U;
+    }
+    // the same rank among the good channels, counted from the end of the window; a channel beyond the window may wrap into it
+    rank %= admin.goodCount;
+    ch = windowStart;
+    for (unsigned i = 0; i < EMBENET_CHANNEL_QUALITY_CHANNEL_OFFSETS; ++i) {
+        ch = ringNext(ch);
+    }
+    for (;; ch = ringNext(ch)) {
+        if (!isBlacklisted(blacklist, ch)) {
+            if (0 == rank) {
+                return (uint8_t)ch;
+            }
+            rank--;
+        }
+    }
+}
+
+void EMBENET_CHANNEL_QUALITY_SetAsnSource(EMBENET_CHANNEL_QUALITY_AsnSource source) {
+    admin.asnSource = source;
+}
+
+void EMBENET_CHANNEL_QUALITY_OnTx(uint8_t channel) {
+    admin.lastTxChannel = channel;
+    if (channel < EMBENET_CHANNEL_QUALITY_CHANNEL_COUNT) {
+        admin.channels[channel].tx++;
+    }
+}
+
+void EMBENET_CHANNEL_QUALITY_OnRx(uint8_t channel, bool crcValid, int8_t rssi) {
+    if (channel >= EMBENET_CHANNEL_QUALITY_CHANNEL_COUNT) {
+        return;
+    }
+    ChannelEntry* entry  = &admin.channels[channel];
+    int16_t       scaled = (int16_t)(rssi * (1 << RSSI_SHIFT));
+    if ((0 == entry->rxOk) && (0 == entry->rxCrcError)) {
+        entry->rssiAvg = scaled;
+    } else {
+        entry->rssiAvg = (int16_t)(entry->rssiAvg + (scaled - entry->rssiAvg) / (1 << RSSI_SHIFT));
+    }
+    if (crcValid) {
+        entry->rxOk++;
+    } else {
+        entry->rxCrcError++;
+    }
+}
+
+void EMBENET_CHANNEL_QUALITY_OnPacketNoAck(void) {
+    uint8_t channel = admin.lastTxChannel;
+    if (channel < EMBENET_CHANNEL_QUALITY_CHANNEL_COUNT) {
+        admin.channels[channel].txNoAck++;
+    }
+}
+
+bool EMBENET_CHANNEL_QUALITY_GetStats(uint8_t channel, EMBENET_ChannelQualityStats* stats) {
+    EXPECT(NULL != stats) OR_RETURN(false);
+    if (channel >= EMBENET_CHANNEL_QUALITY_CHANNEL_COUNT) {
+        return false;
+    }
+    ChannelEntry const* entry = &admin.channels[channel];
+    stats->rxOk               = entry->rxOk;
+    stats->rxCrcError         = entry->rxCrcError;
+    stats->tx                 = entry->tx;
+    stats->txNoAck            = entry->txNoAck;
+    stats->rssi               = (int8_t)(entry->rssiAvg / (1 << RSSI_SHIFT));
+    stats->score              = (uint8_t)(SCORE_MAX - entry->penalty);
+    stats->blacklisted        = isBlacklisted(admin.blacklist, channel);
+    return true;
+}
+
+EMBENET_ChannelMask EMBENET_CHANNEL_QUALITY_Evaluate(void) {
+    EMBENET_ChannelMask proposal = 0;
+    uint8_t             bad[EMBENET_CHANNEL_QUALITY_CHANNEL_COUNT];
+    unsigned            badCount = 0;
+
+    for (unsigned ch = 0; ch < EMBENET_CHANNEL_QUALITY_CHANNEL_COUNT; ++ch) {
+        ChannelEntry* entry = &admin.channels[ch];
+        // counters are only incremented elsewhere, so the deltas are consistent enough without locking
+        uint32_t rxOk       = entry->rxOk - entry->rxOkMark;
+        uint32_t rxCrcError = entry->rxCrcError - entry->rxCrcErrorMark;
+        uint32_t tx         = entry->tx - entry->txMark;
+        uint32_t txNoAck    = entry->txNoAck - entry->txNoAckMark;
+        entry->rxOkMark += rxOk;
+        entry->rxCrcErrorMark += rxCrcError;
+        entry->txMark += tx;
+        entry->txNoAckMark += txNoAck;
+
+        uint32_t samples  = rxOk + rxCrcError + tx;
+        uint32_t failures = rxCrcError + txNoAck;
+        if (failures > samples) {
+            failures = samples;
+        }
+        if (samples >= EMBENET_CHANNEL_QUALITY_MIN_SAMPLES) {
+            uint32_t failureRatio = (SCORE_MAX * failures) / samples;
+            entry->penalty        = (uint8_t)(entry->penalty - entry->penalty / 4U + failureRatio / 4U);
+        }
+
+        if (isBlacklisted(admin.blacklist, ch)) {
+            // blacklisted channels are not used, so they are given a fresh chance after the probation
+            if (entry->probation < EMBENET_CHANNEL_QUALITY_PROBATION_PERIODS) {
+                entry->probation++;
+                proposal |= ((EMBENET_ChannelMask)1) << ch;
+            } else {
+                entry->penalty = (uint8_t)PENALTY_READMIT;
+            }
+        } else if (entry->penalty > PENALTY_BAD) {
+            // keep the candidates sorted, worst first
+            unsigned i = badCount++;
+            for (; (i > 0) && (admin.channels[bad[i - 1]].penalty < entry->penalty); --i) {
+                bad[i] = bad[i - 1];
+            }
+            bad[i] = (uint8_t)ch;
+        }
+    }
+
+    unsigned blacklistCount = countChannels(proposal);
+    for (unsigned i = 0; (i < badCount) && (EMBENET_CHANNEL_QUALITY_CHANNEL_COUNT - blacklistCount > EMBENET_CHANNEL_QUALITY_MIN_CHANNELS); ++i) {
+        proposal |= ((EMBENET_ChannelMask)1) << bad[i];
+        blacklistCount++;
+    }
+    return proposal;
+}
+
+bool EMBENET_CHANNEL_QUALITY_SetBlacklist(EMBENET_ChannelMask blacklist) {
+    blacklist &= allChannels;
+    if (EMBENET_CHANNEL_QUALITY_CHANNEL_COUNT - countChannels(blacklist) < EMBENET_CHANNEL_QUALITY_MIN_CHANNELS) {
+        return false;
+    }
+    EMBENET_CRITICAL_SECTION_Enter();
+    for (unsigned ch = 0; ch < EMBENET_CHANNEL_QUALITY_CHANNEL_COUNT; ++ch) {
+        if (!isBlacklisted(blacklist, ch)) {
+            admin.channels[ch].probation = 0;
+        }
+    }
+    admin.goodCount = (uint8_t)(EMBENET_CHANNEL_QUALITY_CHANNEL_COUNT - countChannels(blacklist));
+    admin.blacklist = blacklist;
+    EMBENET_CRITICAL_SECTION_Exit();
+    return true;
+}
+
+EMBENET_ChannelMask EMBENET_CHANNEL_QUALITY_GetBlacklist(void) {
+    return admin.blacklist;
+}
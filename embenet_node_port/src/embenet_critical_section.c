@@ -9,6 +9,10 @@
 
 #include "embenet_critical_section.h"
 
+#include "embenet_port_config.h"
+#include "embenet_port_critical_section.h"
+#include "embenet_port_interrupt_priorities.h"
+#include <embetech/compiler_support.h>
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wsign-conversion"
 #include "nrf_nvic.h"
@@ -16,23 +20,81 @@
 
 #include <stdint.h>
 
+/*
+With EMBENET_PORT_CRITICAL_SECTION_BASEPRI, the critical section raises BASEPRI instead of setting PRIMASK, so it masks only the interrupts
+at INTERRUPT_PRIORITY_CRITICAL_SECTION and below, the ones that share data with the stack and the port. Interrupts of higher priority
+are still taken; none of the port and the BSP are, as they must not use the critical section nor read the port timer.
+ */
+
+#if EMBENET_PORT_CRITICAL_SECTION_BASEPRI
+#    define MASK_BASEPRI ((uint32_t)INTERRUPT_PRIORITY_CRITICAL_SECTION << (8U - __NVIC_PRIO_BITS)) ///< BASEPRI masking the shared priorities
+#endif
+
+#if EMBENET_PORT_CRITICAL_SECTION_MEASURE
+#    define CPU_CYCLES_PER_US 64 ///< CPU clock [MHz]
+
+static uint32_t          enterCycles;     ///< cycle counter when the outermost critical section was entered
+static volatile uint32_t maxMaskedCycles; ///< longest critical section so far [CPU cycles]
+#endif
+
 static volatile int      irqNestCounter;
 static volatile uint32_t previousIrqState;
 
-void EMBENET_CRITICAL_SECTION_Enter(void) {
+EMBEUTILS_RAMFUNC void EMBENET_CRITICAL_SECTION_Enter(void) {
+#if EMBENET_PORT_CRITICAL_SECTION_BASEPRI
+    uint32_t irqState = __get_BASEPRI();
+    // never lowers the mask, also when called with a stricter one already set
+    __set_BASEPRI_MAX(MASK_BASEPRI);
+#else
     uint32_t irqState = __get_PRIMASK();
     __disable_irq();
+#endif
     if (0 == irqNestCounter) {
         previousIrqState = irqState;
+#if EMBENET_PORT_CRITICAL_SECTION_MEASURE
+        if (0 == (DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+            CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+            DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+        }
+        enterCycles = DWT->CYCCNT;
+#endif
     }
     ++irqNestCounter;
 }
-void EMBENET_CRITICAL_SECTION_Exit(void) {
+EMBEUTILS_RAMFUNC void EMBENET_CRITICAL_SECTION_Exit(void) {
     --irqNestCounter;
     if (irqNestCounter < 0) {
         irqNestCounter = 0;
     }
+#if EMBENET_PORT_CRITICAL_SECTION_MEASURE
+    if (0 == irqNestCounter) {
+        uint32_t maskedCycles = DWT->CYCCNT - enterCycles;
+        if (maskedCycles > maxMaskedCycles) {
+            maxMaskedCycles = maskedCycles;
+        }
+    }
+#endif
+#if EMBENET_PORT_CRITICAL_SECTION_BASEPRI
+    if (0 == irqNestCounter) {
+        __set_BASEPRI(previousIrqState);
+    }
+#else
     if (0 == irqNestCounter && 0 == previousIrqState) {
         __enable_irq();
     }
+#endif
+}
+
+uint32_t EMBENET_CRITICAL_SECTION_GetMaxMaskedTimeUs(void) {
+#if EMBENET_PORT_CRITICAL_SECTION_MEASURE
+    return maxMaskedCycles / CPU_CYCLES_PER_US;
+#else
+    return 0;
+#endif
+}
+
+void EMBENET_CRITICAL_SECTION_ResetMaxMaskedTime(void) {
+#if EMBENET_PORT_CRITICAL_SECTION_MEASURE
+    maxMaskedCycles = 0;
+#endif
 }
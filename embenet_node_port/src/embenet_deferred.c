@@ -0,0 +1,110 @@
+/**
+@file
+@license   Commercial
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET Node port for nRF52832
+@brief     Implementation of the deferred work
+*/
+
+#include "embenet_port_deferred.h"
+
+#include "embenet_port_config.h"
+#include "embenet_port_interrupt_priorities.h"
+#include <embetech/expect.h>
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#pragma GCC diagnostic ignored "-Wconversion"
+#pragma GCC diagnostic ignored "-Wcast-align"
+#include "nrf52.h"
+#pragma GCC diagnostic pop
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+Each level has a lock-free stack of posted items (a Treiber stack): producers push with a compare-and-swap (LDREX/STREX) on the head,
+the software interrupt takes the whole stack at once with an exchange and reverses it to run the items in the order they were posted.
+An item is pushed only by the producer that changed its pending flag from false to true, and the flag is cleared only after the item was
+taken off the stack, so an item is never linked twice and the head cannot suffer from ABA.
+ */
+
+/// Software interrupt of a level
+typedef struct {
+    IRQn_Type irq;         ///< interrupt running the items
+    uint32_t  priority;    ///< priority of the interrupt
+    uint32_t  subpriority; ///< subpriority of the interrupt
+} Level;
+
+static const Level levels[EMBENET_DEFERRED_LEVEL_COUNT] = {
+    [EMBENET_DEFERRED_LEVEL_HIGH] = {EMBENET_PORT_DEFERRED_HIGH_IRQn, INTERRUPT_PRIORITY_DEFERRED_HIGH, INTERRUPT_SUBPRIORITY_DEFERRED_HIGH},
+    [EMBENET_DEFERRED_LEVEL_LOW]  = {EMBENET_PORT_DEFERRED_LOW_IRQn, INTERRUPT_PRIORITY_DEFERRED_LOW, INTERRUPT_SUBPRIORITY_DEFERRED_LOW},
+};
+
+static EMBENET_DEFERRED_Work* volatile heads[EMBENET_DEFERRED_LEVEL_COUNT]; ///< items posted to each level, most recent first
+
+static void runLevel(EMBENET_DEFERRED_Level level) {
+    EMBENET_DEFERRED_Work* taken = __atomic_exchange_n(&heads[level], NULL, __ATOMIC_ACQUIRE);
+    // most recent first, reversed to make it the order of posting
+    EMBENET_DEFERRED_Work* work = NULL;
+    while (NULL != taken) {
+        EMBENET_DEFERRED_Work* next = taken->next;
+        taken->next                 = work;
+        work                        = taken;
+        taken                       = next;
+    }
+    while (NULL != work) {
+        EMBENET_DEFERRED_Work* next = work->next;
+        // from here on the item can be posted again, also by its own function
+        __atomic_store_n(&work->pending, false, __ATOMIC_RELEASE);
+        work->function(work->context);
+        work = next;
+    }
+}
+
+void EMBENET_DEFERRED_Init(void) {
+    for (unsigned i = 0; i < EMBENET_DEFERRED_LEVEL_COUNT; ++i) {
+        heads[i] = NULL;
+        NVIC_ClearPendingIRQ(levels[i].irq);
+        NVIC_SetPriority(levels[i].irq, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), levels[i].priority, levels[i].subpriority));
+        NVIC_EnableIRQ(levels[i].irq);
+    }
+}
+
+void EMBENET_DEFERRED_Setup(EMBENET_DEFERRED_Work* work, EMBENET_DEFERRED_Level level, EMBENET_DEFERRED_Function function, void* context) {
+    EXPECT(NULL != work) OR_RETURN();
+    EXPECT(NULL != function) OR_RETURN();
+    EXPECT(level < EMBENET_DEFERRED_LEVEL_COUNT) OR_RETURN();
+    work->function = function;
+    work->context  = context;
+    work->level    = level;
+    work->pending  = false;
+    work->next     = NULL;
+}
+
+bool EMBENET_DEFERRED_Post(EMBENET_DEFERRED_Work* work) {
+    EXPECT(NULL != work) OR_RETURN(false);
+    if (__atomic_exchange_n(&work->pending, true, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    EMBENET_DEFERRED_Work* volatile* head = &heads[work->level];
+    EMBENET_DEFERRED_Work*           next = __atomic_load_n(head, __ATOMIC_RELAXED);
+    do {
+        work->next = next;
+    } while (!__atomic_compare_exchange_n(head, &next, work, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    NVIC_SetPendingIRQ(levels[work->level].irq);
+    return true;
+}
+
+bool EMBENET_DEFERRED_IsPending(EMBENET_DEFERRED_Work const* work) {
+    return (NULL != work) && work->pending;
+}
+
+void EMBENET_PORT_DEFERRED_HIGH_IRQ_HANDLER(void) {
+    runLevel(EMBENET_DEFERRED_LEVEL_HIGH);
+}
+
+void EMBENET_PORT_DEFERRED_LOW_IRQ_HANDLER(void) {
+    runLevel(EMBENET_DEFERRED_LEVEL_LOW);
+}
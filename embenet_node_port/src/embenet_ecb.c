@@ -0,0 +1,164 @@
+/**
+@file
+@license   Commercial
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET Node port for nRF52832
+@brief     Implementation of the shared access to the AES ECB peripheral
+*/
+
+#include "embenet_port_ecb.h"
+
+#include "embenet_critical_section.h"
+#include "embenet_port_interrupt_priorities.h"
+#include <embetech/expect.h>
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#pragma GCC diagnostic ignored "-Wconversion"
+#pragma GCC diagnostic ignored "-Wcast-align"
+#include "nrf52.h"
+#include "nrf_ecb.h"
+#pragma GCC diagnostic pop
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define BLOCK_SIZE 16
+
+/// result of the batch block, taken over from the peripheral by @ref EMBENET_ECB_Run
+typedef enum {
+    BLOCK_RESULT_NONE,
+    BLOCK_RESULT_DONE,
+    BLOCK_RESULT_FAILED,
+} BlockResult;
+
+static EMBENET_ECB_Batch* volatile activeBatch;   ///< batch in progress, NULL if none
+static volatile bool               batchInFlight; ///< true while a block of the batch is on the peripheral
+static volatile BlockResult        storedResult;  ///< result of the batch block, if its events were consumed by EMBENET_ECB_Run
+
+static void batchStartBlock(EMBENET_ECB_Batch* batch) {
+    memcpy(batch->ecb.cleartext, &batch->blocks[BLOCK_SIZE * batch->done], BLOCK_SIZE);
+    nrf_ecb_data_pointer_set(NRF_ECB, &batch->ecb);
+    batchInFlight = true;
+    nrf_ecb_task_trigger(NRF_ECB, NRF_ECB_TASK_STARTECB);
+}
+
+void EMBENET_ECB_Init(void) {
+    NVIC_DisableIRQ(ECB_IRQn);
+    nrf_ecb_task_trigger(NRF_ECB, NRF_ECB_TASK_STOPECB);
+    nrf_ecb_int_disable(NRF_ECB, ECB_INTENSET_ENDECB_Msk | ECB_INTENSET_ERRORECB_Msk);
+    nrf_ecb_event_clear(NRF_ECB, NRF_ECB_EVENT_ENDECB);
+    nrf_ecb_event_clear(NRF_ECB, NRF_ECB_EVENT_ERRORECB);
+    EMBENET_ECB_Batch* aborted = activeBatch;
+    activeBatch                = NULL;
+    batchInFlight              = false;
+    storedResult               = BLOCK_RESULT_NONE;
+    if (NULL != aborted) {
+        // the owner of the batch is told, so that it does not wait for it forever
+        aborted->callback(aborted->context, false);
+    }
+
+    NVIC_ClearPendingIRQ(ECB_IRQn);
+    NVIC_SetPriority(ECB_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), INTERRUPT_PRIORITY_ECB, INTERRUPT_SUBPRIORITY_ECB));
+    NVIC_EnableIRQ(ECB_IRQn);
+}
+
+bool EMBENET_ECB_Run(EMBENET_ECB_Block* block) {
+    EMBENET_CRITICAL_SECTION_Enter();
+    if (batchInFlight && (BLOCK_RESULT_NONE == storedResult)) {
+        // the batch block in progress is completed first, its result is handed over to the interrupt
+        while (!nrf_ecb_event_check(NRF_ECB, NRF_ECB_EVENT_ENDECB) && !nrf_ecb_event_check(NRF_ECB, NRF_ECB_EVENT_ERRORECB)) {
+            ;
+        }
+        storedResult = nrf_ecb_event_check(NRF_ECB, NRF_ECB_EVENT_ENDECB) ? BLOCK_RESULT_DONE : BLOCK_RESULT_FAILED;
+        nrf_ecb_event_clear(NRF_ECB, NRF_ECB_EVENT_ENDECB);
+        nrf_ecb_event_clear(NRF_ECB, NRF_ECB_EVENT_ERRORECB);
+    }
+    nrf_ecb_data_pointer_set(NRF_ECB, block);
+    nrf_ecb_task_trigger(NRF_ECB, NRF_ECB_TASK_STARTECB);
+    while (!nrf_ecb_event_check(NRF_ECB, NRF_ECB_EVENT_ENDECB) && !nrf_ecb_event_check(NRF_ECB, NRF_ECB_EVENT_ERRORECB)) {
+        ;
+    }
+    bool done = nrf_ecb_event_check(NRF_ECB, NRF_ECB_EVENT_ENDECB);
+    nrf_ecb_event_clear(NRF_ECB, NRF_ECB_EVENT_ENDECB);
+    nrf_ecb_event_clear(NRF_ECB, NRF_ECB_EVENT_ERRORECB);
+    if (BLOCK_RESULT_NONE != storedResult) {
+        NVIC_SetPendingIRQ(ECB_IRQn);
+    }
+    EMBENET_CRITICAL_SECTION_Exit();
+    return done;
+}
+
+bool EMBENET_ECB_StartBatch(EMBENET_ECB_Batch* batch, uint8_t const key[16U], uint8_t* blocks, size_t blockCount, EMBENET_ECB_BatchCallback callback, void* context) {
+    EXPECT(NULL != batch) OR_RETURN(false);
+    EXPECT(NULL != key) OR_RETURN(false);
+    EXPECT((NULL != blocks) && (0 != blockCount)) OR_RETURN(false);
+    EXPECT(NULL != callback) OR_RETURN(false);
+
+    bool started = false;
+    EMBENET_CRITICAL_SECTION_Enter();
+    if (NULL == activeBatch) {
+        memcpy(batch->ecb.key, key, 16);
+        batch->blocks     = blocks;
+        batch->blockCount = blockCount;
+        batch->done       = 0;
+        batch->callback   = callback;
+        batch->context    = context;
+        activeBatch       = batch;
+        nrf_ecb_event_clear(NRF_ECB, NRF_ECB_EVENT_ENDECB);
+        nrf_ecb_event_clear(NRF_ECB, NRF_ECB_EVENT_ERRORECB);
+        nrf_ecb_int_enable(NRF_ECB, ECB_INTENSET_ENDECB_Msk | ECB_INTENSET_ERRORECB_Msk);
+        batchStartBlock(batch);
+        started = true;
+    }
+    EMBENET_CRITICAL_SECTION_Exit();
+    return started;
+}
+
+bool EMBENET_ECB_IsBatchActive(void) {
+    return NULL != activeBatch;
+}
+
+void ECB_IRQHandler(void) {
+    EMBENET_CRITICAL_SECTION_Enter();
+    BlockResult result = storedResult;
+    storedResult       = BLOCK_RESULT_NONE;
+    if (nrf_ecb_event_check(NRF_ECB, NRF_ECB_EVENT_ENDECB)) {
+        nrf_ecb_event_clear(NRF_ECB, NRF_ECB_EVENT_ENDECB);
+        result = BLOCK_RESULT_DONE;
+    } else if (nrf_ecb_event_check(NRF_ECB, NRF_ECB_EVENT_ERRORECB)) {
+        nrf_ecb_event_clear(NRF_ECB, NRF_ECB_EVENT_ERRORECB);
+        result = BLOCK_RESULT_FAILED;
+    }
+    EMBENET_ECB_Batch* batch = activeBatch;
+    if (!batchInFlight || (NULL == batch) || (BLOCK_RESULT_NONE == result)) {
+        // left over from a block encrypted by EMBENET_ECB_Run
+        EMBENET_CRITICAL_SECTION_Exit();
+        return;
+    }
+    batchInFlight = false;
+
+    bool finished = true;
+    bool success  = false;
+    if (BLOCK_RESULT_DONE == result) {
+        memcpy(&batch->blocks[BLOCK_SIZE * batch->done], batch->ecb.ciphertext, BLOCK_SIZE);
+        batch->done++;
+        success = true;
+        if (batch->done < batch->blockCount) {
+            batchStartBlock(batch);
+            finished = false;
+        }
+    }
+    if (finished) {
+        nrf_ecb_int_disable(NRF_ECB, ECB_INTENSET_ENDECB_Msk | ECB_INTENSET_ERRORECB_Msk);
+        activeBatch = NULL;
+    }
+    EMBENET_CRITICAL_SECTION_Exit();
+
+    if (finished) {
+        // a new batch may be started from the callback
+        batch->callback(batch->context, success);
+    }
+}
@@ -0,0 +1,229 @@
+/**
+@file
+@license   Commercial
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET Node port for nRF52832
+@brief     Scheduled HFXO controller
+*/
+
+#include "embenet_port_hfxo.h"
+
+#include "embenet_critical_section.h"
+#include "embenet_port_config.h"
+#include "embenet_port_deferred.h"
+#include "embenet_port_interrupt_priorities.h"
+#include "embenet_port_timer_extension.h"
+#include "embenet_timer.h"
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#pragma GCC diagnostic ignored "-Wconversion"
+#pragma GCC diagnostic ignored "-Wcast-align"
+#include "nrf52.h"
+#include "nrf_clock.h"
+#include "nrf_ppi.h"
+#include "nrf_rtc.h"
+#pragma GCC diagnostic pop
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// HFXO states
+typedef enum {
+    HFXO_STATE_OFF = 0,   //!< stopped
+    HFXO_STATE_SCHEDULED, //!< stopped, start is armed on the RTC compare channel
+    HFXO_STATE_STARTING,  //!< started, not stable yet
+    HFXO_STATE_RUNNING,   //!< stable
+} HfxoState;
+
+typedef struct {
+    volatile HfxoState state;        ///< current state
+    bool               initialized;  ///< true after @ref EMBENET_HFXO_Init
+    bool               inUse;        ///< true between @ref EMBENET_HFXO_Request and @ref EMBENET_HFXO_Release
+    bool               requested;    ///< true if @ref EMBENET_HFXO_Request was called since the last MAC compare
+    bool               nextUseValid; ///< true if nextUse was announced
+    EMBENET_TimeUs     nextUse;      ///< last announced time of use
+    EMBENET_TimeUs     startTime;    ///< time at which the HFXO was (or is going to be) started
+    EMBENET_TimeUs     startupUs;    ///< startup time used for scheduling
+} Admin;
+static Admin admin;
+
+static void compareHandled(void* context);
+
+/// HFXO decision after a MAC compare, posted by the timer interrupt
+static EMBENET_DEFERRED_Work compareHandledWork = {.function = compareHandled, .context = NULL, .level = EMBENET_DEFERRED_LEVEL_HIGH};
+
+static void start(EMBENET_TimeUs now) {
+    EMBENET_TIMER_ClearEventCompare(EMBENET_PORT_TIMER_CC_HFXO);
+    if (HFXO_STATE_SCHEDULED == admin.state && (EMBENET_TimeUs)(now - admin.startTime) < EMBENET_TIMER_GetMaxCompareDuration()) {
+        // PPI has already triggered the start, the HFCLKSTARTED event is on its way
+        admin.state = HFXO_STATE_STARTING;
+        return;
+    }
+    nrf_clock_event_clear(NRF_CLOCK_EVENT_HFCLKSTARTED);
+    nrf_clock_task_trigger(NRF_CLOCK_TASK_HFCLKSTART);
+    admin.startTime = now;
+    admin.state     = HFXO_STATE_STARTING;
+}
+
+static void stop(void) {
+    EMBENET_TIMER_ClearEventCompare(EMBENET_PORT_TIMER_CC_HFXO);
+    nrf_clock_task_trigger(NRF_CLOCK_TASK_HFCLKSTOP);
+    nrf_clock_event_clear(NRF_CLOCK_EVENT_HFCLKSTARTED);
+    admin.state = HFXO_STATE_OFF;
+}
+
+static void arm(EMBENET_TimeUs useTime, EMBENET_TimeUs now) {
+    EMBENET_TimeUs startAt = useTime - admin.startupUs - EMBENET_PORT_HFXO_MARGIN_US;
+    EMBENET_TimeUs subTickRemainder;
+    if (EMBENET_TIMER_SetEventCompare(EMBENET_PORT_TIMER_CC_HFXO, startAt, &subTickRemainder)) {
+        admin.startTime = startAt - subTickRemainder;
+        admin.state     = HFXO_STATE_SCHEDULED;
+    } else if ((EMBENET_TimeUs)(useTime - now) < EMBENET_TIMER_GetMaxCompareDuration()) {
+        // the use is closer than the startup time, start right away
+        start(now);
+    } else {
+        // the use is too far away to be armed, it will be announced again
+        EMBENET_TIMER_ClearEventCompare(EMBENET_PORT_TIMER_CC_HFXO);
+        admin.state = HFXO_STATE_OFF;
+    }
+}
+
+static void stopOrLinger(EMBENET_TimeUs now) {
+    EMBENET_TimeUs untilNextUse = admin.nextUse - now;
+    if (!admin.nextUseValid || (untilNextUse >= EMBENET_TIMER_GetMaxCompareDuration())) {
+        // next use is not known yet, the decision is made when it is announced
+        return;
+    }
+    if (untilNextUse < EMBENET_PORT_HFXO_LINGER_US) {
+        // back-to-back use, restarting the crystal would cost more than keeping it running
+        return;
+    }
+    stop();
+    arm(admin.nextUse, now);
+}
+
+static void stopUntilNextUse(EMBENET_TimeUs now) {
+    stop();
+    if (admin.nextUseValid && ((EMBENET_TimeUs)(admin.nextUse - now) < EMBENET_TIMER_GetMaxCompareDuration())) {
+        arm(admin.nextUse, now);
+    }
+}
+
+void EMBENET_HFXO_Init(void) {
+    EMBENET_CRITICAL_SECTION_Enter();
+    nrf_ppi_channel_endpoint_setup(EMBENET_PORT_HFXO_PPI, nrf_rtc_event_address_get(EMBENET_PORT_TIMER, RTC_CHANNEL_EVENT_ADDR(EMBENET_PORT_TIMER_CC_HFXO)),
+                                   nrf_clock_task_address_get(NRF_CLOCK_TASK_HFCLKSTART));
+    nrf_ppi_channel_enable(EMBENET_PORT_HFXO_PPI);
+    EMBENET_TIMER_ClearEventCompare(EMBENET_PORT_TIMER_CC_HFXO);
+
+    admin.state        = nrf_clock_hf_is_running(NRF_CLOCK_HFCLK_HIGH_ACCURACY) ? HFXO_STATE_RUNNING : HFXO_STATE_OFF;
+    admin.inUse        = false;
+    admin.requested    = false;
+    admin.nextUseValid = false;
+    admin.startupUs    = EMBENET_PORT_HFXO_STARTUP_US;
+    admin.initialized  = true;
+
+    nrf_clock_int_enable(NRF_CLOCK_INT_HF_STARTED_MASK);
+    NVIC_ClearPendingIRQ(POWER_CLOCK_IRQn);
+    NVIC_SetPriority(POWER_CLOCK_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), INTERRUPT_PRIORITY_HFXO, INTERRUPT_SUBPRIORITY_HFXO));
+    NVIC_EnableIRQ(POWER_CLOCK_IRQn);
+    EMBENET_CRITICAL_SECTION_Exit();
+}
+
+void EMBENET_HFXO_Request(void) {
+    EMBENET_CRITICAL_SECTION_Enter();
+    admin.inUse     = true;
+    admin.requested = true;
+    if ((HFXO_STATE_OFF == admin.state) || (HFXO_STATE_SCHEDULED == admin.state)) {
+        start(EMBENET_TIMER_ReadCounter());
+    }
+    EMBENET_CRITICAL_SECTION_Exit();
+}
+
+void EMBENET_HFXO_Wait(void) {
+    if (HFXO_STATE_RUNNING == admin.state) {
+        return;
+    }
+    if (HFXO_STATE_STARTING != admin.state) {
+        EMBENET_HFXO_Request();
+    }
+    // the prediction was late; the event is checked too, as the interrupt is masked if called from a critical section
+    while ((HFXO_STATE_RUNNING != admin.state) && !nrf_clock_event_check(NRF_CLOCK_EVENT_HFCLKSTARTED))
+        ;
+}
+
+void EMBENET_HFXO_Release(void) {
+    EMBENET_CRITICAL_SECTION_Enter();
+    admin.inUse = false;
+    if ((HFXO_STATE_RUNNING == admin.state) || (HFXO_STATE_STARTING == admin.state)) {
+        stopOrLinger(EMBENET_TIMER_ReadCounter());
+    }
+    EMBENET_CRITICAL_SECTION_Exit();
+}
+
+void EMBENET_HFXO_Stop(void) {
+    EMBENET_CRITICAL_SECTION_Enter();
+    if (!admin.inUse && ((HFXO_STATE_RUNNING == admin.state) || (HFXO_STATE_STARTING == admin.state))) {
+        stopUntilNextUse(EMBENET_TIMER_ReadCounter());
+    }
+    EMBENET_CRITICAL_SECTION_Exit();
+}
+
+void EMBENET_HFXO_Schedule(EMBENET_TimeUs useTime) {
+    if (!admin.initialized) {
+        return;
+    }
+    EMBENET_CRITICAL_SECTION_Enter();
+    EMBENET_TimeUs now = EMBENET_TIMER_ReadCounter();
+    admin.nextUse      = useTime;
+    admin.nextUseValid = true;
+    if ((HFXO_STATE_OFF == admin.state) || (HFXO_STATE_SCHEDULED == admin.state)) {
+        arm(useTime, now);
+    } else if (!admin.inUse) {
+        stopOrLinger(now);
+    }
+    EMBENET_CRITICAL_SECTION_Exit();
+}
+
+/**
+ * @brief Stops the HFXO if the MAC compare just handled did not request it, run as deferred work.
+ */
+static void compareHandled(void* context) {
+    (void)context;
+    EMBENET_CRITICAL_SECTION_Enter();
+    bool started = (HFXO_STATE_STARTING == admin.state) || (HFXO_STATE_RUNNING == admin.state);
+    if (started && !admin.requested && !admin.inUse) {
+        // the compare the crystal was started (or kept running) for needed no radio, so it is not kept until the next one
+        stopUntilNextUse(EMBENET_TIMER_ReadCounter());
+    }
+    admin.requested = false;
+    EMBENET_CRITICAL_SECTION_Exit();
+}
+
+void EMBENET_HFXO_OnCompare(void) {
+    if (!admin.initialized) {
+        return;
+    }
+    // the decision is not urgent, it is taken after the timer interrupt
+    (void)EMBENET_DEFERRED_Post(&compareHandledWork);
+}
+
+EMBENET_TimeUs EMBENET_HFXO_GetStartupTime(void) {
+    return admin.startupUs;
+}
+
+void POWER_CLOCK_IRQHandler(void) {
+    if (nrf_clock_event_check(NRF_CLOCK_EVENT_HFCLKSTARTED)) {
+        nrf_clock_event_clear(NRF_CLOCK_EVENT_HFCLKSTARTED);
+        if ((HFXO_STATE_STARTING == admin.state) || (HFXO_STATE_SCHEDULED == admin.state)) {
+            // measured time includes the interrupt latency, which only makes the schedule more conservative
+            EMBENET_TimeUs measured = EMBENET_TIMER_ReadCounter() - admin.startTime;
+            if (measured < EMBENET_TIMER_GetMaxCompareDuration()) {
+                // follow longer startups immediately, shorter ones slowly
+                admin.startupUs = (measured > admin.startupUs) ? measured : admin.startupUs - (admin.startupUs - measured) / 8;
+            }
+        }
+        admin.state = HFXO_STATE_RUNNING;
+    }
+}
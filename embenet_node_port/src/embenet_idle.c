@@ -0,0 +1,67 @@
+/**
+@file
+@license   Commercial
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET Node port for nRF52832
+@brief     Implementation of the idle support
+*/
+
+#include "embenet_port_idle.h"
+
+#include "embenet_port_brt.h"
+#include "embenet_port_config.h"
+#include "embenet_port_timer_extension.h"
+#include "embenet_port_vtimer.h"
+#include "embenet_timer.h"
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#pragma GCC diagnostic ignored "-Wconversion"
+#pragma GCC diagnostic ignored "-Wcast-align"
+#include "nrf52.h"
+#pragma GCC diagnostic pop
+
+#include <stdbool.h>
+#include <stdint.h>
+
+static uint64_t sleepTime; ///< total time slept [us]
+
+#if EMBENET_PORT_IDLE_MAX_SLEEP_US > 0
+static EMBENET_VTIMER_Timer wakeupTimer;
+
+static void onWakeup(void* context) {
+    (void)context;
+    // taking the interrupt is enough to end the sleep
+}
+#endif
+
+void EMBENET_IDLE_Init(void) {
+    sleepTime = 0;
+    // interrupts pended while masked (e.g. by BASEPRI) end the sleep as well
+    SCB->SCR |= SCB_SCR_SEVONPEND_Msk;
+#if EMBENET_PORT_IDLE_MAX_SLEEP_US > 0
+    EMBENET_VTIMER_Start(&wakeupTimer, EMBENET_PORT_IDLE_MAX_SLEEP_US, EMBENET_PORT_IDLE_MAX_SLEEP_US, onWakeup, NULL);
+#endif
+}
+
+bool EMBENET_IDLE_HasPendingWork(void) {
+    // received frames are delimited in the UART interrupt, but decoded only by EMBENET_NODE_Proc
+    return EMBENET_BRT_GetPendingFrameCount() > 0;
+}
+
+uint32_t EMBENET_IDLE_GetTimeToNextDeadline(void) {
+    uint32_t timerTicks = EMBENET_TIMER_GetTicksToCompare();
+    uint32_t timerUs    = (UINT32_MAX == timerTicks) ? UINT32_MAX : EMBENET_TIMER_TicksToUs(timerTicks);
+    uint32_t vtimerUs   = EMBENET_VTIMER_GetTimeToNextExpiration();
+    return (timerUs < vtimerUs) ? timerUs : vtimerUs;
+}
+
+void EMBENET_IDLE_Sleep(void) {
+    if (EMBENET_IDLE_HasPendingWork()) {
+        return;
+    }
+    EMBENET_TimeUs start = EMBENET_TIMER_ReadCounter();
+    // an event left over from an interrupt already handled only makes this one return early, the next call sleeps
+    __WFE();
+    sleepTime += (EMBENET_TimeUs)(EMBENET_TIMER_ReadCounter() - start);
+}
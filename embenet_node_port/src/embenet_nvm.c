@@ -0,0 +1,254 @@
+/**
+@file
+@license   Commercial
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET Node port for nRF52832
+@brief     Non-volatile key-value store in flash
+
+Page layout, in words:
+ - magic, written last when the page is formatted,
+ - generation, incremented by every compaction; the valid page with the highest one is the active page,
+ - records: header (key | length << 16), value padded with 0xFF to whole words, CRC-32 of the header and the value.
+A record with length 0 deletes the key. The first header equal to 0xFFFFFFFF marks the end of the records.
+
+*/
+
+#include "embenet_port_nvm.h"
+
+#include "embenet_port_config.h"
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#pragma GCC diagnostic ignored "-Wconversion"
+#pragma GCC diagnostic ignored "-Wcast-align"
+#include "nrf52.h"
+#include "nrf52_bitfields.h"
+#pragma GCC diagnostic pop
+
+#include <string.h>
+
+#define PAGE_MAGIC   0x4D564E45U // "ENVM"
+#define PAGE_WORDS   (EMBENET_PORT_NVM_PAGE_SIZE / sizeof(uint32_t))
+#define HEADER_WORDS 2
+#define ERASED_WORD  0xFFFFFFFFU
+
+// flash pages reserved by the linker script
+extern uint32_t __start_embenet_nvm[];
+extern uint32_t __stop_embenet_nvm[];
+
+static size_t pageCount;
+static size_t activePage;
+static size_t writeOffset; ///< word offset of the next record in the active page
+
+static uint32_t* pageAddress(size_t page) {
+    return &__start_embenet_nvm[page * PAGE_WORDS];
+}
+
+static size_t dataWords(size_t length) {
+    return (length + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+}
+
+static uint32_t crc32(uint32_t crc, uint8_t const* bytes, size_t length) {
+    crc = ~crc;
+    for (size_t i = 0; i < length; ++i) {
+        crc ^= bytes[i];
+        for (unsigned bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xEDB88320U & (0U - (crc & 1U)));
+        }
+    }
+    return ~crc;
+}
+
+static uint32_t recordCrc(uint32_t header, void const* value, size_t length) {
+    return crc32(crc32(0, (uint8_t const*)&header, sizeof(header)), (uint8_t const*)value, length);
+}
+
+static void waitReady(void) {
+    while (0 == (NRF_NVMC->READY & NVMC_READY_READY_Msk)) {
+        ;
+    }
+}
+
+static void writeWords(uint32_t* destination, uint32_t const* source, size_t count) {
+    NRF_NVMC->CONFIG = NVMC_CONFIG_WEN_Wen << NVMC_CONFIG_WEN_Pos;
+    waitReady();
+    for (size_t i = 0; i < count; ++i) {
+        destination[i] = source[i];
+        waitReady();
+    }
+    NRF_NVMC->CONFIG = NVMC_CONFIG_WEN_Ren << NVMC_CONFIG_WEN_Pos;
+    waitReady();
+}
+
+static void erasePage(size_t page) {
+    NRF_NVMC->CONFIG = NVMC_CONFIG_WEN_Een << NVMC_CONFIG_WEN_Pos;
+    waitReady();
+    NRF_NVMC->ERASEPAGE = (uint32_t)(uintptr_t)pageAddress(page);
+    waitReady();
+    NRF_NVMC->CONFIG = NVMC_CONFIG_WEN_Ren << NVMC_CONFIG_WEN_Pos;
+    waitReady();
+}
+
+/**
+ * Gets the offset of the record following the given one.
+ * @return offset of the next record, PAGE_WORDS if the record is broken or runs past the page
+ */
+static size_t nextRecord(uint32_t const* page, size_t offset) {
+    size_t length = page[offset] >> 16;
+    if (length > EMBENET_NVM_MAX_VALUE_SIZE) {
+        return PAGE_WORDS;
+    }
+    size_t next = offset + 1 + dataWords(length) + 1;
+    return (next > PAGE_WORDS) ? PAGE_WORDS : next;
+}
+
+static bool isRecordValid(uint32_t const* page, size_t offset) {
+    uint32_t header = page[offset];
+    size_t   length = header >> 16;
+    return recordCrc(header, &page[offset + 1], length) == page[offset + 1 + dataWords(length)];
+}
+
+/// Iterates the offsets of the records of a page, up to the end marker
+#define FOR_EACH_RECORD(page, offset) for (size_t offset = HEADER_WORDS; (offset < PAGE_WORDS) && (ERASED_WORD != (page)[offset]); offset = nextRecord((page), offset))
+
+/**
+ * Finds the last valid record of the key in the active page.
+ * @return offset of the record, 0 if none
+ */
+static size_t findLatest(uint16_t key) {
+    uint32_t const* page   = pageAddress(activePage);
+    size_t          latest = 0;
+    FOR_EACH_RECORD(page, offset) {
+        if ((key == (page[offset] & 0xFFFFU)) && isRecordValid(page, offset)) {
+            latest = offset;
+        }
+    }
+    return latest;
+}
+
+static size_t findWriteOffset(void) {
+    uint32_t const* page = pageAddress(activePage);
+    size_t          end  = HEADER_WORDS;
+    FOR_EACH_RECORD(page, offset) {
+        end = nextRecord(page, offset);
+    }
+    return end;
+}
+
+static void formatPage(size_t page, uint32_t generation) {
+    uint32_t magic = PAGE_MAGIC;
+    // the magic is written last, a page formatted only partly stays invalid
+    writeWords(&pageAddress(page)[1], &generation, 1);
+    writeWords(&pageAddress(page)[0], &magic, 1);
+}
+
+static bool appendRecord(uint16_t key, void const* value, size_t length) {
+    size_t words = 1 + dataWords(length) + 1;
+    if (writeOffset + words > PAGE_WORDS) {
+        if (!EMBENET_NVM_Compact() || (writeOffset + words > PAGE_WORDS)) {
+            return false;
+        }
+    }
+    uint32_t record[1 + (EMBENET_NVM_MAX_VALUE_SIZE / sizeof(uint32_t))];
+    record[0] = (uint32_t)key | ((uint32_t)length << 16);
+    if (length > 0) {
+        memset(&record[1], 0xFF, dataWords(length) * sizeof(uint32_t));
+        memcpy(&record[1], value, length);
+    }
+    uint32_t crc = recordCrc(record[0], &record[1], length);
+
+    uint32_t* destination = &pageAddress(activePage)[writeOffset];
+    // the CRC is written last, a record written only partly is ignored
+    writeWords(destination, record, words - 1);
+    writeWords(&destination[words - 1], &crc, 1);
+    writeOffset += words;
+    return true;
+}
+
+bool EMBENET_NVM_Init(void) {
+    pageCount = (size_t)(__stop_embenet_nvm - __start_embenet_nvm) / PAGE_WORDS;
+    if (pageCount < 2) {
+        return false;
+    }
+    bool     found      = false;
+    uint32_t generation = 0;
+    for (size_t i = 0; i < pageCount; ++i) {
+        uint32_t const* page = pageAddress(i);
+        if ((PAGE_MAGIC == page[0]) && (!found || (page[1] > generation))) {
+            found      = true;
+            generation = page[1];
+            activePage = i;
+        }
+    }
+    if (!found) {
+        activePage = 0;
+        erasePage(activePage);
+        formatPage(activePage, 0);
+    }
+    writeOffset = findWriteOffset();
+    return true;
+}
+
+size_t EMBENET_NVM_Read(uint16_t key, void* value, size_t size) {
+    size_t offset = findLatest(key);
+    if (0 == offset) {
+        return 0;
+    }
+    uint32_t const* page   = pageAddress(activePage);
+    size_t          length = page[offset] >> 16;
+    if (NULL != value) {
+        memcpy(value, &page[offset + 1], (length < size) ? length : size);
+    }
+    return length;
+}
+
+bool EMBENET_NVM_Write(uint16_t key, void const* value, size_t length) {
+    if ((EMBENET_NVM_KEY_INVALID == key) || (NULL == value) || (0 == length) || (length > EMBENET_NVM_MAX_VALUE_SIZE)) {
+        return false;
+    }
+    return appendRecord(key, value, length);
+}
+
+bool EMBENET_NVM_Delete(uint16_t key) {
+    if (EMBENET_NVM_KEY_INVALID == key) {
+        return false;
+    }
+    if (0 == EMBENET_NVM_Read(key, NULL, 0)) {
+        return true;
+    }
+    return appendRecord(key, NULL, 0);
+}
+
+size_t EMBENET_NVM_GetFreeSpace(void) {
+    return (PAGE_WORDS - writeOffset) * sizeof(uint32_t);
+}
+
+size_t EMBENET_NVM_GetRecordSize(size_t length) {
+    return (1 + dataWords(length) + 1) * sizeof(uint32_t);
+}
+
+bool EMBENET_NVM_Compact(void) {
+    if (pageCount < 2) {
+        return false;
+    }
+    uint32_t const* source     = pageAddress(activePage);
+    size_t          next       = (activePage + 1) % pageCount;
+    uint32_t*       target     = pageAddress(next);
+    size_t          nextOffset = HEADER_WORDS;
+
+    erasePage(next);
+    FOR_EACH_RECORD(source, offset) {
+        uint32_t header = source[offset];
+        size_t   length = header >> 16;
+        // only the latest value of every key is kept, deletions are dropped
+        if ((0 != length) && (offset == findLatest((uint16_t)(header & 0xFFFFU)))) {
+            size_t words = nextRecord(source, offset) - offset;
+            writeWords(&target[nextOffset], &source[offset], words);
+            nextOffset += words;
+        }
+    }
+    formatPage(next, source[1] + 1);
+    activePage  = next;
+    writeOffset = nextOffset;
+    return true;
+}
@@ -0,0 +1,122 @@
+/**
+@file
+@license   Commercial
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET Node port for nRF52832
+@brief     Implementation of the packet pool
+ */
+
+#include "embenet_port_packet_pool.h"
+
+#include "embenet_critical_section.h"
+#include "embenet_port_config.h"
+#include <embetech/expect.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define ALL_BLOCKS_MASK ((uint32_t)(UINT64_C(0xFFFFFFFF) >> (32 - EMBENET_PORT_PACKET_POOL_BLOCK_COUNT))) ///< bit of every block
+
+/*
+A bit of 'usedMask' is set for every allocated block, so a free block is found with a single count of trailing zeros and the zero
+initialized pool is all free, without an init call to order against the radio. The reference counts and the statistics are changed
+only in the critical section. The blocks are word aligned, the radio EasyDMA and the holders may access them by words.
+ */
+
+/// Pool
+static struct {
+    uint8_t  blocks[EMBENET_PORT_PACKET_POOL_BLOCK_COUNT][EMBENET_PACKET_POOL_BLOCK_SIZE] __attribute__((aligned(4))); ///< storage
+    uint8_t  refCounts[EMBENET_PORT_PACKET_POOL_BLOCK_COUNT];                                                       ///< references to every block
+    uint32_t usedMask;                                                                                              ///< bit mask of allocated blocks
+    uint32_t inUse;                                                                                                 ///< number of allocated blocks
+    uint32_t highWatermark;                                                                                         ///< most blocks allocated at once
+    uint32_t allocFailures;                                                                                         ///< allocations with no free block
+} pool;
+
+/// Index of the block with the given data, -1 if not in the pool
+static inline int getBlockIndex(void const* data) {
+    uintptr_t offset = (uintptr_t)data - (uintptr_t)pool.blocks;
+    if (offset >= sizeof(pool.blocks)) {
+        return -1;
+    }
+    return (int)(offset / EMBENET_PACKET_POOL_BLOCK_SIZE);
+}
+
+uint8_t* EMBENET_PACKET_POOL_Alloc(void) {
+    uint8_t* block = NULL;
+    EMBENET_CRITICAL_SECTION_Enter();
+    uint32_t freeMask = ~pool.usedMask & ALL_BLOCKS_MASK;
+    if (0 != freeMask) {
+        unsigned index = (unsigned)__builtin_ctz(freeMask);
+        pool.usedMask |= (1U << index);
+        pool.refCounts[index] = 1;
+        pool.inUse++;
+        if (pool.inUse > pool.highWatermark) {
+            pool.highWatermark = pool.inUse;
+        }
+        block = pool.blocks[index];
+    } else {
+        pool.allocFailures++;
+    }
+    EMBENET_CRITICAL_SECTION_Exit();
+    return block;
+}
+
+bool EMBENET_PACKET_POOL_Retain(void const* data) {
+    int index = getBlockIndex(data);
+    EXPECT(index >= 0) OR_RETURN(false);
+    bool retained = false;
+    EMBENET_CRITICAL_SECTION_Enter();
+    if ((0 != pool.refCounts[index]) && (UINT8_MAX != pool.refCounts[index])) {
+        pool.refCounts[index]++;
+        retained = true;
+    }
+    EMBENET_CRITICAL_SECTION_Exit();
+    return retained;
+}
+
+void EMBENET_PACKET_POOL_Release(void const* data) {
+    int index = getBlockIndex(data);
+    EXPECT(index >= 0) OR_RETURN();
+    EMBENET_CRITICAL_SECTION_Enter();
+    // a release of a free block is ignored, it would free the block under its next owner
+    if (0 != pool.refCounts[index]) {
+        pool.refCounts[index]--;
+        if (0 == pool.refCounts[index]) {
+            pool.usedMask &= ~(1U << index);
+            pool.inUse--;
+        }
+    }
+    EMBENET_CRITICAL_SECTION_Exit();
+}
+
+uint8_t* EMBENET_PACKET_POOL_GetBlock(void const* data) {
+    int index = getBlockIndex(data);
+    if ((index < 0) || (0 == pool.refCounts[index])) {
+        return NULL;
+    }
+    return pool.blocks[index];
+}
+
+unsigned EMBENET_PACKET_POOL_GetRefCount(void const* data) {
+    int index = getBlockIndex(data);
+    return (index < 0) ? 0 : pool.refCounts[index];
+}
+
+void EMBENET_PACKET_POOL_GetStats(EMBENET_PacketPoolStats* stats) {
+    EXPECT(NULL != stats) OR_RETURN();
+    EMBENET_CRITICAL_SECTION_Enter();
+    stats->blockCount    = EMBENET_PORT_PACKET_POOL_BLOCK_COUNT;
+    stats->inUse         = pool.inUse;
+    stats->highWatermark = pool.highWatermark;
+    stats->allocFailures = pool.allocFailures;
+    EMBENET_CRITICAL_SECTION_Exit();
+}
+
+void EMBENET_PACKET_POOL_ResetHighWatermark(void) {
+    EMBENET_CRITICAL_SECTION_Enter();
+    pool.highWatermark = pool.inUse;
+    EMBENET_CRITICAL_SECTION_Exit();
+}
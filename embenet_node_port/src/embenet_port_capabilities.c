@@ -9,18 +9,41 @@
 
 #include "embenet_port_capabilities.h"
 
+#include "embenet_port_config.h"
+#include "embenet_port_radio_config.h"
 #include "embenet_timer.h"
 
+#if EMBENET_PORT_TIMER_HIRES
+// timestamps are no longer quantized to the port timer tick, which makes one tick (30.5us) of the guard time unnecessary
+#    define SHORT_GUARD_TIME_US ((300 / 2) - 30)
+#else
+#    define SHORT_GUARD_TIME_US (300 / 2)
+#endif
+
+#if EMBENET_RADIO_PHY_PROFILE == EMBENET_RADIO_PHY_PROFILE_BLE_2MBIT
+// full 127B frame takes 540us on air instead of 1080us
+const EMBENET_MAC_Timings embenetMacTimings = {
+    .TsTxOffsetUs     = 1700,                                  //
+    .TsTxAckDelayUs   = 1000,                                  //
+    .TsLongGTUs       = (1000 / 2),                            //
+    .TsShortGTUs      = SHORT_GUARD_TIME_US,                   //
+    .TsSlotDurationUs = EMBENET_RADIO_2MBIT_MIN_SLOT_DURATION, //
+    .wdRadioTxUs      = 500,                                   //
+    .wdDataDurationUs = 1000,                                  //
+    .wdAckDurationUs  = 500                                    //
+};
+#else
 const EMBENET_MAC_Timings embenetMacTimings = {
-    .TsTxOffsetUs     = 1700,       //
-    .TsTxAckDelayUs   = 1000,       //
-    .TsLongGTUs       = (1000 / 2), //
-    .TsShortGTUs      = (300 / 2),  //
-    .TsSlotDurationUs = 5000,       //
-    .wdRadioTxUs      = 500,        //
-    .wdDataDurationUs = 2000,       //
-    .wdAckDurationUs  = 1000        //
+    .TsTxOffsetUs     = 1700,                                  //
+    .TsTxAckDelayUs   = 1000,                                  //
+    .TsLongGTUs       = (1000 / 2),                            //
+    .TsShortGTUs      = SHORT_GUARD_TIME_US,                   //
+    .TsSlotDurationUs = EMBENET_RADIO_1MBIT_MIN_SLOT_DURATION, //
+    .wdRadioTxUs      = 500,                                   //
+    .wdDataDurationUs = 2000,                                  //
+    .wdAckDurationUs  = 1000                                   //
 };
+#endif
 
 const size_t  embenetMacChannelListSize = 37;
 const uint8_t embenetMacChannelList[]   = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36};
@@ -11,12 +11,19 @@
 #include "embenet_radio.h"
 
 #include "embenet_critical_section.h"
+#include "embenet_port_capabilities.h"
+#include "embenet_port_channel_quality_internal.h"
 #include "embenet_port_config.h"
+#include "embenet_port_hfxo.h"
 #include "embenet_port_interrupt_priorities.h"
+#include "embenet_port_nvm.h"
+#include "embenet_port_packet_pool.h"
 #include "embenet_port_radio_config.h"
 #include "embenet_port_radio_extension.h"
+#include "embenet_port_timer_extension.h"
 #include "embenet_random.h"
 #include "embenet_timer.h"
+#include <embetech/compiler_support.h>
 #include <embetech/expect.h>
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wsign-conversion"
@@ -25,7 +32,10 @@
 #include "nrf52.h"
 #include "nrf52_bitfields.h"
 #include "nrf_clock.h"
+#include "nrf_ppi.h"
 #include "nrf_radio.h"
+#include "nrf_rtc.h"
+#include "nrf_timer.h"
 #pragma GCC diagnostic pop
 
 #include <stdbool.h>
@@ -35,6 +45,9 @@
 #define CRC_LENGTH     2        ///< Length of CRC in 802.15.4 frames [bytes]
 #define CRC_POLYNOMIAL 0x011021 ///< Polynomial used for CRC calculation in 802.15.4 frames
 
+#define CALIBRATION_TIMEOUT_US 3000 ///< longest wait for a RADIO event during the calibration, covers a whole frame at 1Mbit [us]
+#define CALIBRATION_VERSION    2    ///< layout of the calibration kept in the non-volatile store
+
 /// driver states
 typedef enum {
     EMBENET_RADIO_STATE_UNINITIALIZED = 0, //!< uninitialized
@@ -51,16 +64,83 @@ typedef enum {
 } RadioState;
 
 
+/// PHY profile description
+typedef struct {
+    nrf_radio_mode_t            mode;                ///< modulation
+    nrf_radio_preamble_length_t preambleLength;      ///< preamble length
+    EMBENET_TimeUs              txTxStartCorrection; ///< see EMBENET_RADIO_TX_TX_START_CORRECTION
+    EMBENET_TimeUs              txRxStartCorrection; ///< see EMBENET_RADIO_TX_RX_START_CORRECTION
+    EMBENET_TimeUs              txRxEndCorrection;   ///< see EMBENET_RADIO_TX_RX_END_CORRECTION
+    EMBENET_TimeUs              minSlotDuration;     ///< shortest slot in which a full frame exchange fits
+    EMBENET_RADIO_Capabilities  capabilities;        ///< capabilities reported to the stack
+} PhyProfile;
+
+// timings and corrections are replaced by the calibration
+static PhyProfile phyProfiles[] = {
+    [EMBENET_RADIO_PHY_BLE_1MBIT] = {.mode                = NRF_RADIO_MODE_BLE_1MBIT,
+                                     .preambleLength      = NRF_RADIO_PREAMBLE_LENGTH_8BIT,
+                                     .txTxStartCorrection = EMBENET_RADIO_1MBIT_TX_TX_START_CORRECTION,
+                                     .txRxStartCorrection = EMBENET_RADIO_1MBIT_TX_RX_START_CORRECTION,
+                                     .txRxEndCorrection   = EMBENET_RADIO_1MBIT_TX_RX_END_CORRECTION,
+                                     .minSlotDuration     = EMBENET_RADIO_1MBIT_MIN_SLOT_DURATION,
+                                     .capabilities        = {.idleToTxReady   = EMBENET_RADIO_IdleToTxReady,
+                                                             .idleToRxReady   = EMBENET_RADIO_IdleToRxReady,
+                                                             .activeToTxReady = EMBENET_RADIO_ActiveToTxReady,
+                                                             .activeToRxReady = EMBENET_RADIO_ActiveToRxReady,
+                                                             .txDelay         = EMBENET_RADIO_TxDelay,
+                                                             .rxDelay         = EMBENET_RADIO_RxDelay,
+                                                             .txRxStartDelay  = EMBENET_RADIO_1MBIT_TX_RX_START_CORRECTION,
+                                                             .sensitivity     = EMBENET_RADIO_SENSITIVITY,
+                                                             .maxOutputPower  = EMBENET_RADIO_MAX_OUTPUT_POWER,
+                                                             .minOutputPower  = EMBENET_RADIO_MIN_OUTPUT_POWER}},
+    [EMBENET_RADIO_PHY_BLE_2MBIT] = {.mode                = NRF_RADIO_MODE_BLE_2MBIT,
+                                     .preambleLength      = NRF_RADIO_PREAMBLE_LENGTH_16BIT,
+                                     .txTxStartCorrection = EMBENET_RADIO_2MBIT_TX_TX_START_CORRECTION,
+                                     .txRxStartCorrection = EMBENET_RADIO_2MBIT_TX_RX_START_CORRECTION,
+                                     .txRxEndCorrection   = EMBENET_RADIO_2MBIT_TX_RX_END_CORRECTION,
+                                     .minSlotDuration     = EMBENET_RADIO_2MBIT_MIN_SLOT_DURATION,
+                                     .capabilities        = {.idleToTxReady   = EMBENET_RADIO_IdleToTxReady,
+                                                             .idleToRxReady   = EMBENET_RADIO_IdleToRxReady,
+                                                             .activeToTxReady = EMBENET_RADIO_ActiveToTxReady,
+                                                             .activeToRxReady = EMBENET_RADIO_ActiveToRxReady,
+                                                             .txDelay         = EMBENET_RADIO_TxDelay,
+                                                             .rxDelay         = EMBENET_RADIO_RxDelay,
+                                                             .txRxStartDelay  = EMBENET_RADIO_2MBIT_TX_RX_START_CORRECTION,
+                                                             .sensitivity     = EMBENET_RADIO_2MBIT_SENSITIVITY,
+                                                             .maxOutputPower  = EMBENET_RADIO_MAX_OUTPUT_POWER,
+                                                             .minOutputPower  = EMBENET_RADIO_MIN_OUTPUT_POWER}},
+};
+
 // structure to hold radio variables and states
 typedef struct {
     bool                     lockHfxo;              ///< if true, @EMBENET_RADIO_Idle does not turn off HFXO
     EMBENET_RADIO_CaptureCbt onStartOfFrameHandler; ///< handler to method called when start of frame interrupt occurs
     EMBENET_RADIO_CaptureCbt onEndOfFrameHandler;   ///< handler to method called when end of frame interrupt occurs
     void*                    handlersContext;       ///< context passed to hanlders
-    uint8_t                  frame[EMBENET_RADIO_MAX_PSDU_LENGTH + 1];
+    uint8_t*                 rxFrame;               ///< packet pool block used for reception, byte 0 holds the LENGTH field
+    uint8_t*                 txFrame;               ///< lent block referenced by the radio while it is transmitted from, NULL if none
+    uint8_t                  channel;               ///< physical channel of the last TX or RX, after blacklist remapping
 } Admin;
 static Admin admin;
 
+#define PHY_PROFILE_COUNT (sizeof(phyProfiles) / sizeof(phyProfiles[0]))
+
+/// Results of the calibration
+static struct {
+    bool                      valid[PHY_PROFILE_COUNT];   ///< true if the profile is calibrated
+    EMBENET_RADIO_Calibration results[PHY_PROFILE_COUNT]; ///< measured timings, without the margin
+} calibration;
+
+#if EMBENET_PORT_RADIO_CALIBRATION_PERSIST
+/// Calibration kept in the non-volatile store
+typedef struct {
+    uint32_t                  version;
+    EMBENET_RADIO_Calibration results[PHY_PROFILE_COUNT];
+} StoredCalibration;
+#endif
+
+static PhyProfile* phy = &phyProfiles[EMBENET_RADIO_PHY_PROFILE]; ///< PHY profile in use
+
 static volatile RadioState state; ///< radio driver state
 
 #pragma GCC diagnostic push
@@ -83,6 +163,33 @@ static const char*     getStateName(void) {
 }
 #pragma GCC diagnostic pop
 
+_Static_assert(EMBENET_PACKET_POOL_BLOCK_SIZE >= (EMBENET_RADIO_MAX_PSDU_LENGTH + 1), "a packet pool block must hold the LENGTH field and the longest PSDU");
+
+/*
+Frame buffers are packet pool blocks. The block in 'rxFrame' is always held by the radio and is the reception target, it is taken from
+the pool on init. Other blocks may be lent to the user for composing outgoing frames (@ref EMBENET_RADIO_AcquireFrameBuffer) or may be
+taken together with the received frame (@ref EMBENET_RADIO_TakeReceivedFrame). In both cases PACKETPTR points directly at the block, so no
+frame copy is needed. A lent block being transmitted is referenced by the radio until the next frame is prepared, so its holders may give
+it back right after TxEnable. Lent blocks are given back via @ref EMBENET_RADIO_ReleaseFrameBuffer or @ref EMBENET_PACKET_POOL_Release.
+ */
+
+/// Lent block with the given PSDU, NULL if the PSDU is not at the beginning of a lent block
+static inline uint8_t* getLentFrame(uint8_t const* psdu) {
+    uint8_t* frame = EMBENET_PACKET_POOL_GetBlock(psdu);
+    if ((NULL == frame) || (frame == admin.rxFrame) || (psdu != &frame[1])) {
+        return NULL;
+    }
+    return frame;
+}
+
+/// Gives back the reference to the block transmitted last
+static inline void txFrameRelease(void) {
+    if (NULL != admin.txFrame) {
+        EMBENET_PACKET_POOL_Release(admin.txFrame);
+        admin.txFrame = NULL;
+    }
+}
+
 static inline void setChannel(uint8_t channel) {
     if (channel > EMBENET_RADIO_MAX_CHANNEL) {
         channel = EMBENET_RADIO_MAX_CHANNEL;
@@ -115,30 +222,132 @@ static inline void setPower(int8_t power) {
 }
 
 /*
-There are separate functions for setting, waiting and turning off the HFXO.
-HFXO is turned on in @ref EMBENET_RADIO_EnableTx and in @ref EMBENET_RADIO_EnableRx.
-HFXO is checked against being stable in @ref EMBENET_RADIO_TxNow and @ref EMBENET_RADIO_RxNow.
-Between these two groups of functions, the stack does some work, during which the HFXO can stabilize in the background.
+HFXO is controlled by the HFXO controller (see embenet_port_hfxo.h). It is usually started ahead of the slot, announced by the timer
+port, so @ref EMBENET_RADIO_TxNow and @ref EMBENET_RADIO_RxNow find it stable. @ref EMBENET_RADIO_TxEnable and @ref EMBENET_RADIO_RxEnable
+start it right away if the prediction missed, and @ref EMBENET_RADIO_Idle releases it, which keeps it running for back-to-back slots.
+ */
+
+
+/*
+ADDRESS and END events are captured by a 1MHz TIMER through the pre-programmed PPI channels 26 and 27, at the very moment they occur.
+The ISR captures the same TIMER again and reads the port timer right after; the difference of the two captures is the interrupt latency,
+which is subtracted from the port timer reading. The timestamps do not depend on how late the ISR runs. With the high resolution clock
+enabled, the port timer reading captures the TIMER once more, so the last capture matches the reading exactly.
  */
 
-static inline void hfclkWait(void) {
-    while (!nrf_clock_event_check(NRF_CLOCK_EVENT_HFCLKSTARTED))
-        ;
+static inline void timestampInit(void) {
+    nrf_timer_task_trigger(EMBENET_PORT_RADIO_TIMESTAMP_TIMER, NRF_TIMER_TASK_STOP);
+    nrf_timer_mode_set(EMBENET_PORT_RADIO_TIMESTAMP_TIMER, NRF_TIMER_MODE_TIMER);
+    nrf_timer_bit_width_set(EMBENET_PORT_RADIO_TIMESTAMP_TIMER, NRF_TIMER_BIT_WIDTH_32);
+    nrf_timer_frequency_set(EMBENET_PORT_RADIO_TIMESTAMP_TIMER, NRF_TIMER_FREQ_1MHz);
+    nrf_timer_task_trigger(EMBENET_PORT_RADIO_TIMESTAMP_TIMER, NRF_TIMER_TASK_CLEAR);
+    nrf_ppi_channel_enable(EMBENET_PORT_RADIO_TIMESTAMP_PPI_ADDRESS);
+    nrf_ppi_channel_enable(EMBENET_PORT_RADIO_TIMESTAMP_PPI_END);
+}
+
+static inline void timestampStart(void) {
+    nrf_timer_task_trigger(EMBENET_PORT_RADIO_TIMESTAMP_TIMER, NRF_TIMER_TASK_START);
+    // the same TIMER interpolates the port timer readings while the radio is active
+    EMBENET_TIMER_HiResStart();
+}
+
+static inline void timestampStop(void) {
+    EMBENET_TIMER_HiResStop();
+    // SHUTDOWN releases the HFCLK request of the TIMER
+    nrf_timer_task_trigger(EMBENET_PORT_RADIO_TIMESTAMP_TIMER, NRF_TIMER_TASK_SHUTDOWN);
+}
+
+static inline EMBEUTILS_INLINE EMBENET_TimeUs timestampGet(nrf_timer_cc_channel_t captureChannel, EMBENET_TimeUs now, uint32_t timerNow) {
+    return now - (EMBENET_TimeUs)(timerNow - nrf_timer_cc_read(EMBENET_PORT_RADIO_TIMESTAMP_TIMER, captureChannel));
+}
+
+
+/*
+Scheduled start is done in two hardware stages, so that the radio is started with no CPU involvement and with sub-tick resolution:
+the RTC compare event starts a 1MHz TIMER at the beginning of the RTC tick in which the start time falls, and the TIMER compare event
+triggers TXEN/RXEN after the remaining sub-tick time.
+ */
+
+static inline EMBEUTILS_INLINE void scheduledStartCancel(void) {
+    nrf_ppi_channel_disable(EMBENET_PORT_RADIO_START_PPI_RTC);
+    nrf_ppi_channel_disable(EMBENET_PORT_RADIO_START_PPI_TIMER);
+    EMBENET_TIMER_ClearEventCompare(EMBENET_PORT_TIMER_CC_RADIO_START);
+    nrf_timer_task_trigger(EMBENET_PORT_RADIO_START_TIMER, NRF_TIMER_TASK_STOP);
+    nrf_timer_task_trigger(EMBENET_PORT_RADIO_START_TIMER, NRF_TIMER_TASK_CLEAR);
+}
+
+static inline void scheduledStartInit(void) {
+    nrf_timer_mode_set(EMBENET_PORT_RADIO_START_TIMER, NRF_TIMER_MODE_TIMER);
+    nrf_timer_bit_width_set(EMBENET_PORT_RADIO_START_TIMER, NRF_TIMER_BIT_WIDTH_16);
+    nrf_timer_frequency_set(EMBENET_PORT_RADIO_START_TIMER, NRF_TIMER_FREQ_1MHz);
+    nrf_timer_shorts_enable(EMBENET_PORT_RADIO_START_TIMER, NRF_TIMER_SHORT_COMPARE0_STOP_MASK | NRF_TIMER_SHORT_COMPARE0_CLEAR_MASK);
+    nrf_ppi_channel_endpoint_setup(EMBENET_PORT_RADIO_START_PPI_RTC,
+                                   nrf_rtc_event_address_get(EMBENET_PORT_TIMER, RTC_CHANNEL_EVENT_ADDR(EMBENET_PORT_TIMER_CC_RADIO_START)),
+                                   nrf_timer_task_address_get(EMBENET_PORT_RADIO_START_TIMER, NRF_TIMER_TASK_START));
+    scheduledStartCancel();
+}
+
+static inline EMBEUTILS_INLINE bool scheduledStartArm(nrf_radio_task_t radioTask, EMBENET_TimeUs startTime) {
+    bool           armed;
+    EMBENET_TimeUs subTickRemainder;
+
+    scheduledStartCancel();
+    EMBENET_CRITICAL_SECTION_Enter();
+    // the RTC channel is armed at least two ticks ahead, which leaves enough time to set up the second stage within this critical section
+    armed = EMBENET_TIMER_SetEventCompare(EMBENET_PORT_TIMER_CC_RADIO_START, startTime, &subTickRemainder);
+    if (armed) {
+        // TIMER compare event is generated when the counter increments to CC, so the smallest usable value is 1
+        nrf_timer_cc_write(EMBENET_PORT_RADIO_START_TIMER, NRF_TIMER_CC_CHANNEL0, (subTickRemainder > 0) ? subTickRemainder : 1);
+        nrf_ppi_channel_endpoint_setup(EMBENET_PORT_RADIO_START_PPI_TIMER, nrf_timer_event_address_get(EMBENET_PORT_RADIO_START_TIMER, NRF_TIMER_EVENT_COMPARE0),
+                                       nrf_radio_task_address_get(radioTask));
+        nrf_ppi_channel_enable(EMBENET_PORT_RADIO_START_PPI_TIMER);
+        nrf_ppi_channel_enable(EMBENET_PORT_RADIO_START_PPI_RTC);
+    }
+    EMBENET_CRITICAL_SECTION_Exit();
+    return armed;
+}
+
+
+static void applyPhyProfile(void) {
+    nrf_radio_mode_set(phy->mode);
+
+    nrf_radio_packet_conf_t packetConf = {
+        .lflen      = 8,                             // LENGTH field is 8 bit long
+        .s0len      = 0,                             // S0 field disabled
+        .s1len      = 0,                             // S1 field disabled
+        .s1incl     = 0,                             // S1 field not included
+        .plen       = phy->preambleLength,           // 8 bit preamble for 1Mbit, 16 bit for 2Mbit
+        .maxlen     = EMBENET_RADIO_MAX_PSDU_LENGTH, // maximum packet length
+        .statlen    = 0,                             // static length disabled
+        .balen      = 3,                             // base address has 3B (+1B of prefix)
+        .big_endian = false,                         // transmission bit order
+        .whiteen    = true                           // no whitening at the beginning};
+    };
+    nrf_radio_packet_configure(&packetConf);
 }
 
-static inline void hfclkTurnOn(void) {
-    nrf_clock_event_clear(NRF_CLOCK_EVENT_HFCLKSTARTED);
-    nrf_clock_task_trigger(NRF_CLOCK_TASK_HFCLKSTART);
+EMBENET_RADIO_Status EMBENET_RADIO_SetPhyProfile(EMBENET_RADIO_PhyProfile profile) {
+    if ((EMBENET_RADIO_STATE_IDLE != state) && (EMBENET_RADIO_STATE_UNINITIALIZED != state)) {
+        return EMBENET_RADIO_STATUS_WRONG_STATE;
+    }
+    if (((size_t)profile >= PHY_PROFILE_COUNT) || (phyProfiles[profile].minSlotDuration > embenetMacTimings.TsSlotDurationUs)) {
+        return EMBENET_RADIO_STATUS_PARAMETER_ARG1_OUT_OF_BOUNDS;
+    }
+    phy = &phyProfiles[profile];
+    if (EMBENET_RADIO_STATE_IDLE == state) {
+        applyPhyProfile();
+    }
+    return EMBENET_RADIO_STATUS_SUCCESS;
 }
 
-static inline void hfclkTurnOff(void) {
-    nrf_clock_task_trigger(NRF_CLOCK_TASK_HFCLKSTOP);
+EMBENET_RADIO_PhyProfile EMBENET_RADIO_GetPhyProfile(void) {
+    return (EMBENET_RADIO_PhyProfile)(phy - phyProfiles);
 }
 
 
 void EMBENET_RADIO_LockHfxo(void) {
-    hfclkTurnOn();
-    hfclkWait();
+    EMBENET_HFXO_Request();
+    EMBENET_HFXO_Wait();
     admin.lockHfxo = true;
 }
 
@@ -146,9 +355,322 @@ void EMBENET_RADIO_UnlockHfxo(void) {
     admin.lockHfxo = false;
 }
 
+/*
+The calibration runs the same TxEnable/TxNow/RxEnable/RxNow path that the stack uses and polls the RADIO events; only the RADIO
+interrupt is disabled, the other interrupts keep running. Every point measured is a RADIO event captured by the timestamp TIMER through PPI:
+READY on the capture channel of END, which is read before the END of the frame can overwrite it, ADDRESS and END on their own. The
+CPU only captures the moment a driver function is called, which is where the stack starts counting too. The transitions from the idle
+state are measured with HFXO stopped, so they include its startup, as the constants they replace do, and are timed by the port timer.
+Every round sends three frames of the
+longest length, at the lowest power, so the copy of the frame and the disabling after it are measured in the worst case.
+ */
+
+static const uint8_t calibrationFrame[EMBENET_RADIO_MAX_PSDU_LENGTH]; ///< payload of the calibration frames
+
+/// Measurements of one PHY profile
+typedef struct {
+    EMBENET_RADIO_Calibration longest;           ///< longest times measured
+    uint32_t                  correctionSum;     ///< sum of the measured preamble and address times
+    uint32_t                  correctionSamples; ///< number of the measured preamble and address times
+} CalibrationRun;
+
+static inline uint32_t calibrationNow(void) {
+    // the port timer readings capture the same channel from the interrupts
+    EMBENET_CRITICAL_SECTION_Enter();
+    nrf_timer_task_trigger(EMBENET_PORT_RADIO_TIMESTAMP_TIMER, NRF_TIMER_TASK_CAPTURE0);
+    uint32_t now = nrf_timer_cc_read(EMBENET_PORT_RADIO_TIMESTAMP_TIMER, NRF_TIMER_CC_CHANNEL0);
+    EMBENET_CRITICAL_SECTION_Exit();
+    return now;
+}
+
+/**
+ * @brief Measures the time from a port timer reading to a TIMER capture.
+ *
+ * The TIMER runs from the less accurate internal oscillator until HFXO is started, so the transitions from the idle state are measured by
+ * the port timer, and only the time since the capture by the TIMER. The reading is rounded down to a tick, which only lengthens the result.
+ * @param[in] start port timer reading
+ * @param[in] capture TIMER capture
+ * @return time from the reading to the capture [us]
+ */
+static EMBENET_TimeUs calibrationSince(EMBENET_TimeUs start, uint32_t capture) {
+    EMBENET_CRITICAL_SECTION_Enter();
+    nrf_timer_task_trigger(EMBENET_PORT_RADIO_TIMESTAMP_TIMER, NRF_TIMER_TASK_CAPTURE0);
+    uint32_t       timerNow = nrf_timer_cc_read(EMBENET_PORT_RADIO_TIMESTAMP_TIMER, NRF_TIMER_CC_CHANNEL0);
+    EMBENET_TimeUs now      = EMBENET_TIMER_ReadCounter();
+    EMBENET_CRITICAL_SECTION_Exit();
+    return now - (EMBENET_TimeUs)(timerNow - capture) - start;
+}
+
+static bool calibrationWait(nrf_radio_event_t event, uint32_t since) {
+    while (!nrf_radio_event_check(event)) {
+        if ((calibrationNow() - since) > CALIBRATION_TIMEOUT_US) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Waits for the READY event enabled after @ref calibrationPrepare and reads its capture.
+ * @param[in] since TIMER capture the timeout is counted from
+ * @param[out] ready TIMER capture of the READY event
+ * @return true if the radio got ready in time and the capture was not overwritten by the END event
+ */
+static bool calibrationWaitReady(uint32_t since, uint32_t* ready) {
+    if (!calibrationWait(NRF_RADIO_EVENT_READY, since)) {
+        return false;
+    }
+    *ready = nrf_timer_cc_read(EMBENET_PORT_RADIO_TIMESTAMP_TIMER, NRF_TIMER_CC_CHANNEL2);
+    return !nrf_radio_event_check(NRF_RADIO_EVENT_END);
+}
+
+static inline void calibrationPrepare(void) {
+    nrf_radio_event_clear(NRF_RADIO_EVENT_READY);
+    nrf_radio_event_clear(NRF_RADIO_EVENT_END);
+    nrf_radio_event_clear(NRF_RADIO_EVENT_DISABLED);
+}
+
+static inline void calibrationKeepLongest(EMBENET_TimeUs* longest, uint32_t measured) {
+    if (measured > *longest) {
+        *longest = measured;
+    }
+}
+
+/**
+ * @brief Stops HFXO, so that the next transition from the idle state includes its startup.
+ * @return true if HFXO stopped in time
+ */
+static bool calibrationStopHfxo(void) {
+    admin.lockHfxo = false;
+    EMBENET_HFXO_Release();
+    EMBENET_HFXO_Stop();
+    uint32_t since = calibrationNow();
+    while (nrf_clock_hf_is_running(NRF_CLOCK_HFCLK_HIGH_ACCURACY)) {
+        if ((calibrationNow() - since) > CALIBRATION_TIMEOUT_US) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Waits for the end of the frame started by @ref EMBENET_RADIO_TxNow and measures its preamble and address.
+ * @param[in,out] run measurements of the PHY profile
+ * @param[in] ready TIMER capture of the READY event, which starts the transmission through the READY-START short
+ * @param[out] endTime TIMER capture of the END event
+ * @return true if the frame was sent in time
+ */
+static bool calibrationSent(CalibrationRun* run, uint32_t ready, uint32_t* endTime) {
+    if (!calibrationWait(NRF_RADIO_EVENT_END, ready)) {
+        return false;
+    }
+    run->correctionSum += nrf_timer_cc_read(EMBENET_PORT_RADIO_TIMESTAMP_TIMER, NRF_TIMER_CC_CHANNEL1) - ready;
+    run->correctionSamples++;
+    *endTime = nrf_timer_cc_read(EMBENET_PORT_RADIO_TIMESTAMP_TIMER, NRF_TIMER_CC_CHANNEL2);
+    return true;
+}
+
+/**
+ * @brief Measures all the timings of the PHY profile in use once.
+ * @param[in,out] run measurements of the PHY profile
+ * @return true if the radio responded in time
+ */
+static bool calibrationRound(CalibrationRun* run) {
+    EMBENET_RADIO_Calibration* result = &run->longest;
+    uint32_t                   start;
+    EMBENET_TimeUs             idleStart;
+    uint32_t                   ready = 0;
+    uint32_t                   end   = 0;
+    bool                       responded;
+
+    // idle to TX ready, with HFXO stopped; the TIMER is started by the enable functions, it must already run for the first capture
+    responded = calibrationStopHfxo();
+    nrf_timer_task_trigger(EMBENET_PORT_RADIO_TIMESTAMP_TIMER, NRF_TIMER_TASK_START);
+    calibrationPrepare();
+    start     = calibrationNow();
+    idleStart = EMBENET_TIMER_ReadCounter();
+    (void)EMBENET_RADIO_TxEnable(EMBENET_PORT_RADIO_CALIBRATION_CHANNEL, EMBENET_RADIO_MIN_OUTPUT_POWER, calibrationFrame, sizeof(calibrationFrame));
+    (void)EMBENET_RADIO_TxNow();
+    responded = responded && calibrationWaitReady(start, &ready);
+    if (responded) {
+        calibrationKeepLongest(&result->idleToTxReady, calibrationSince(idleStart, ready));
+        responded = calibrationSent(run, ready, &end);
+    }
+    if (responded) {
+        // switching to the reception of an ACK
+        calibrationPrepare();
+        (void)EMBENET_RADIO_RxEnable(EMBENET_PORT_RADIO_CALIBRATION_CHANNEL);
+        (void)EMBENET_RADIO_RxNow();
+        responded = calibrationWaitReady(end, &ready);
+        calibrationKeepLongest(&result->activeToRxReady, ready - end);
+    }
+    (void)EMBENET_RADIO_Idle();
+
+    // the delays of the start of TX and RX, with HFXO running as the stack has it by then
+    admin.lockHfxo = true;
+    EMBENET_HFXO_Request();
+    EMBENET_HFXO_Wait();
+    if (responded) {
+        (void)EMBENET_RADIO_TxEnable(EMBENET_PORT_RADIO_CALIBRATION_CHANNEL, EMBENET_RADIO_MIN_OUTPUT_POWER, calibrationFrame, sizeof(calibrationFrame));
+        calibrationPrepare();
+        start = calibrationNow();
+        (void)EMBENET_RADIO_TxNow();
+        responded = calibrationWaitReady(start, &ready) && calibrationSent(run, ready, &end);
+        calibrationKeepLongest(&result->txDelay, ready - start);
+    }
+    if (responded) {
+        // switching to the transmission of an ACK
+        calibrationPrepare();
+        (void)EMBENET_RADIO_TxEnable(EMBENET_PORT_RADIO_CALIBRATION_CHANNEL, EMBENET_RADIO_MIN_OUTPUT_POWER, calibrationFrame, sizeof(calibrationFrame));
+        (void)EMBENET_RADIO_TxNow();
+        responded = calibrationWaitReady(end, &ready) && calibrationSent(run, ready, &end);
+        calibrationKeepLongest(&result->activeToTxReady, ready - end);
+    }
+    (void)EMBENET_RADIO_Idle();
+    if (responded) {
+        nrf_timer_task_trigger(EMBENET_PORT_RADIO_TIMESTAMP_TIMER, NRF_TIMER_TASK_START);
+        (void)EMBENET_RADIO_RxEnable(EMBENET_PORT_RADIO_CALIBRATION_CHANNEL);
+        calibrationPrepare();
+        start = calibrationNow();
+        (void)EMBENET_RADIO_RxNow();
+        responded = calibrationWaitReady(start, &ready);
+        calibrationKeepLongest(&result->rxDelay, ready - start);
+    }
+    (void)EMBENET_RADIO_Idle();
+
+    // idle to RX ready, with HFXO stopped
+    responded = responded && calibrationStopHfxo();
+    if (responded) {
+        nrf_timer_task_trigger(EMBENET_PORT_RADIO_TIMESTAMP_TIMER, NRF_TIMER_TASK_START);
+        calibrationPrepare();
+        start     = calibrationNow();
+        idleStart = EMBENET_TIMER_ReadCounter();
+        (void)EMBENET_RADIO_RxEnable(EMBENET_PORT_RADIO_CALIBRATION_CHANNEL);
+        (void)EMBENET_RADIO_RxNow();
+        responded = calibrationWaitReady(start, &ready);
+        if (responded) {
+            calibrationKeepLongest(&result->idleToRxReady, calibrationSince(idleStart, ready));
+        }
+    }
+    (void)EMBENET_RADIO_Idle();
+    return responded;
+}
+
+/**
+ * @brief Replaces the timings of a PHY profile with the calibrated ones.
+ * @param[in,out] profile PHY profile
+ * @param[in] result measured timings
+ */
+static void calibrationApply(PhyProfile* profile, EMBENET_RADIO_Calibration const* result) {
+    // the receiver chain delay is not measured, it is kept on top of the measured preamble and address time
+    EMBENET_TimeUs receiverDelay          = profile->txRxStartCorrection - profile->txTxStartCorrection;
+    profile->txTxStartCorrection          = result->txTxStartCorrection;
+    profile->txRxStartCorrection          = result->txTxStartCorrection + receiverDelay;
+    profile->capabilities.idleToTxReady   = result->idleToTxReady + EMBENET_PORT_RADIO_CALIBRATION_MARGIN_US;
+    profile->capabilities.idleToRxReady   = result->idleToRxReady + EMBENET_PORT_RADIO_CALIBRATION_MARGIN_US;
+    profile->capabilities.activeToTxReady = result->activeToTxReady + EMBENET_PORT_RADIO_CALIBRATION_MARGIN_US;
+    profile->capabilities.activeToRxReady = result->activeToRxReady + EMBENET_PORT_RADIO_CALIBRATION_MARGIN_US;
+    profile->capabilities.txDelay         = result->txDelay + EMBENET_PORT_RADIO_CALIBRATION_MARGIN_US;
+    profile->capabilities.rxDelay         = result->rxDelay + EMBENET_PORT_RADIO_CALIBRATION_MARGIN_US;
+    profile->capabilities.txRxStartDelay  = profile->txRxStartCorrection;
+}
+
+#if EMBENET_PORT_RADIO_CALIBRATION_PERSIST
+/**
+ * @brief Keeps the longer of the measured and the stored time.
+ * @return true if the measured time is longer
+ */
+static bool calibrationMerge(EMBENET_TimeUs* measured, EMBENET_TimeUs stored) {
+    if (*measured > stored) {
+        return true;
+    }
+    *measured = stored;
+    return false;
+}
+#endif
+
+/**
+ * @brief Calibrates all the PHY profiles, with the RADIO interrupt disabled and the other interrupts enabled.
+ * @return true if all the profiles are calibrated
+ */
+static bool calibrate(void) {
+    PhyProfile* selected  = phy;
+    bool        lockHfxo  = admin.lockHfxo;
+    bool        completed = true;
+
+#if EMBENET_PORT_RADIO_CALIBRATION_PERSIST
+    StoredCalibration stored;
+    bool              storeReady = EMBENET_NVM_Init();
+    bool              hasStored  = storeReady && (sizeof(stored) == EMBENET_NVM_Read(EMBENET_PORT_RADIO_CALIBRATION_NVM_KEY, &stored, sizeof(stored))) &&
+                     (CALIBRATION_VERSION == stored.version);
+    bool              longer     = !hasStored;
+#endif
+
+    nrf_ppi_channel_endpoint_setup(EMBENET_PORT_RADIO_CALIBRATION_PPI_READY, nrf_radio_event_address_get(NRF_RADIO_EVENT_READY),
+                                   nrf_timer_task_address_get(EMBENET_PORT_RADIO_TIMESTAMP_TIMER, NRF_TIMER_TASK_CAPTURE2));
+    nrf_ppi_channel_enable(EMBENET_PORT_RADIO_CALIBRATION_PPI_READY);
+    for (size_t i = 0; i < PHY_PROFILE_COUNT; ++i) {
+        CalibrationRun run       = {0};
+        bool           responded = true;
+        phy                      = &phyProfiles[i];
+        applyPhyProfile();
+        for (unsigned round = 0; responded && (round < EMBENET_PORT_RADIO_CALIBRATION_ROUNDS); ++round) {
+            responded = calibrationRound(&run);
+        }
+        // both ends are PPI captures, the samples only differ by the 1us resolution; the correction is subtracted from the
+        // timestamps, so it is averaged rather than padded like the times
+        EMBENET_RADIO_Calibration result = run.longest;
+        if (run.correctionSamples > 0) {
+            result.txTxStartCorrection = (run.correctionSum + run.correctionSamples / 2) / run.correctionSamples;
+        }
+#if EMBENET_PORT_RADIO_CALIBRATION_PERSIST
+        if (hasStored && !responded) {
+            result    = stored.results[i];
+            responded = true;
+        } else if (hasStored) {
+            EMBENET_RADIO_Calibration const* previous = &stored.results[i];
+            longer |= calibrationMerge(&result.idleToTxReady, previous->idleToTxReady);
+            longer |= calibrationMerge(&result.idleToRxReady, previous->idleToRxReady);
+            longer |= calibrationMerge(&result.activeToTxReady, previous->activeToTxReady);
+            longer |= calibrationMerge(&result.activeToRxReady, previous->activeToRxReady);
+            longer |= calibrationMerge(&result.txDelay, previous->txDelay);
+            longer |= calibrationMerge(&result.rxDelay, previous->rxDelay);
+        }
+        stored.results[i] = result;
+#endif
+        if (responded) {
+            calibration.results[i] = result;
+            calibration.valid[i]   = true;
+            calibrationApply(&phyProfiles[i], &result);
+        }
+        completed = completed && responded;
+    }
+    nrf_ppi_channel_disable(EMBENET_PORT_RADIO_CALIBRATION_PPI_READY);
+    phy = selected;
+    applyPhyProfile();
+    admin.lockHfxo = false;
+    EMBENET_HFXO_Release();
+    if (lockHfxo) {
+        EMBENET_RADIO_LockHfxo();
+    }
+
+#if EMBENET_PORT_RADIO_CALIBRATION_PERSIST
+    // written only when the times grow, which happens a few times over the life of the chip
+    if (storeReady && completed && longer) {
+        stored.version = CALIBRATION_VERSION;
+        (void)EMBENET_NVM_Write(EMBENET_PORT_RADIO_CALIBRATION_NVM_KEY, &stored, sizeof(stored));
+    }
+#endif
+    return completed;
+}
+
 EMBENET_RADIO_Status EMBENET_RADIO_Init(void) {
     // default state
     EMBENET_RADIO_Deinit();
+    admin.rxFrame = EMBENET_PACKET_POOL_Alloc();
+    if (NULL == admin.rxFrame) {
+        return EMBENET_RADIO_STATUS_GENERAL_ERROR;
+    }
 
     // reset peripheral
     nrf_radio_power_set(false);
@@ -159,23 +681,8 @@ EMBENET_RADIO_Status EMBENET_RADIO_Init(void) {
     nrf_radio_shorts_enable(NRF_RADIO_SHORT_END_DISABLE_MASK);       // shortcut between END event and DISABLE task
     nrf_radio_shorts_enable(NRF_RADIO_SHORT_ADDRESS_RSSISTART_MASK); // shortcut between ADDRESS event and RSSISTART task
 
-    // modulation
-    nrf_radio_mode_set(NRF_RADIO_MODE_BLE_1MBIT);
-
-    // packet config
-    nrf_radio_packet_conf_t packetConf = {
-        .lflen      = 8,                             // LENGTH field is 8 bit long
-        .s0len      = 0,                             // S0 field disabled
-        .s1len      = 0,                             // S1 field disabled
-        .s1incl     = 0,                             // S1 field not included
-        .plen       = 0,                             // 8 bit preamble
-        .maxlen     = EMBENET_RADIO_MAX_PSDU_LENGTH, // maximum packet length
-        .statlen    = 0,                             // static length disabled
-        .balen      = 3,                             // base address has 3B (+1B of prefix)
-        .big_endian = false,                         // transmission bit order
-        .whiteen    = true                           // no whitening at the beginning};
-    };
-    nrf_radio_packet_configure(&packetConf);
+    // modulation and packet config
+    applyPhyProfile();
     nrf_radio_base0_set(0xE7E7E7E7); // configure radio address registers (same as Nordic ESB default values)
     nrf_radio_base1_set(0x43434343);
     nrf_radio_prefix0_set(0x23C343E7);
@@ -185,7 +692,17 @@ EMBENET_RADIO_Status EMBENET_RADIO_Init(void) {
     nrf_radio_crc_configure(CRC_LENGTH, NRF_RADIO_CRC_ADDR_SKIP, CRC_POLYNOMIAL);
     nrf_radio_crcinit_set(0xFFFFFFFF);
     nrf_radio_modecnf0_set(true, 2);
-    nrf_radio_packetptr_set(admin.frame);
+    nrf_radio_packetptr_set(admin.rxFrame);
+
+    // HFXO, scheduled start and event timestamps
+    EMBENET_HFXO_Init();
+    scheduledStartInit();
+    timestampInit();
+    state = EMBENET_RADIO_STATE_IDLE;
+#if EMBENET_PORT_RADIO_CALIBRATION
+    // the interrupts are not enabled yet, the calibration polls the RADIO events
+    (void)calibrate();
+#endif
 
     // interrupts
     nrf_radio_int_enable(NRF_RADIO_INT_ADDRESS_MASK); // address (SFD) sent or received
@@ -213,13 +730,20 @@ void EMBENET_RADIO_Deinit(void) {
     admin.onStartOfFrameHandler = NULL;
     admin.onEndOfFrameHandler   = NULL;
     admin.lockHfxo              = false;
-    state                       = EMBENET_RADIO_STATE_UNINITIALIZED;
+    txFrameRelease();
+    if (NULL != admin.rxFrame) {
+        EMBENET_PACKET_POOL_Release(admin.rxFrame);
+        admin.rxFrame = NULL;
+    }
+    state = EMBENET_RADIO_STATE_UNINITIALIZED;
 }
 
 EMBENET_RADIO_Status EMBENET_RADIO_Idle(void) {
+    scheduledStartCancel();
     nrf_radio_task_trigger(NRF_RADIO_TASK_DISABLE);
+    timestampStop();
     if (!admin.lockHfxo) {
-        hfclkTurnOff();
+        EMBENET_HFXO_Release();
     }
 
     state = EMBENET_RADIO_STATE_IDLE;
@@ -228,11 +752,11 @@ EMBENET_RADIO_Status EMBENET_RADIO_Idle(void) {
 }
 
 EMBENET_RADIO_Status EMBENET_RADIO_TxEnable(EMBENET_RADIO_Channel channel, EMBENET_RADIO_Power txp, uint8_t const* psdu, size_t psduLen) {
-    if (!admin.lockHfxo) {
-        hfclkTurnOn();
-    }
+    EMBENET_HFXO_Request();
+    timestampStart();
 
-    setChannel(channel);
+    admin.channel = EMBENET_CHANNEL_QUALITY_Map(channel);
+    setChannel(admin.channel);
     setPower(txp);
 
     // this short may be disabled or enabled by @EMBENET_RADIO_StartContinuousTx
@@ -247,16 +771,26 @@ EMBENET_RADIO_Status EMBENET_RADIO_TxEnable(EMBENET_RADIO_Channel channel, EMBEN
     if (psduLen < EMBENET_RADIO_MIN_PSDU_LENGTH) {
         return EMBENET_RADIO_STATUS_GENERAL_ERROR;
     }
-    admin.frame[0] = (uint8_t)psduLen;
-    memcpy(&admin.frame[1], psdu, psduLen);
+    txFrameRelease();
+    uint8_t* frame = getLentFrame(psdu);
+    if ((NULL != frame) && EMBENET_PACKET_POOL_Retain(frame)) {
+        admin.txFrame = frame;
+    } else {
+        // the PSDU is not in a lent frame buffer, so it has to be copied next to the LENGTH field
+        frame = admin.rxFrame;
+        memmove(&frame[1], psdu, psduLen);
+    }
+    frame[0] = (uint8_t)psduLen;
+    nrf_radio_packetptr_set(frame);
 
     state = EMBENET_RADIO_STATE_TX_PREPARED;
 
     return EMBENET_RADIO_STATUS_SUCCESS;
 }
 
-EMBENET_RADIO_Status EMBENET_RADIO_TxNow(void) {
-    hfclkWait();
+EMBEUTILS_RAMFUNC EMBENET_RADIO_Status EMBENET_RADIO_TxNow(void) {
+    scheduledStartCancel();
+    EMBENET_HFXO_Wait();
 
     nrf_radio_task_trigger(NRF_RADIO_TASK_TXEN);
 
@@ -266,23 +800,26 @@ EMBENET_RADIO_Status EMBENET_RADIO_TxNow(void) {
 }
 
 EMBENET_RADIO_Status EMBENET_RADIO_RxEnable(EMBENET_RADIO_Channel channel) {
-    if (!admin.lockHfxo) {
-        hfclkTurnOn();
-    }
+    EMBENET_HFXO_Request();
+    timestampStart();
 
-    setChannel(channel);
+    admin.channel = EMBENET_CHANNEL_QUALITY_Map(channel);
+    setChannel(admin.channel);
     // this short may be disabled or enabled by @EMBENET_RADIO_StartContinuousTx
     nrf_radio_shorts_enable(NRF_RADIO_SHORT_READY_START_MASK);
     nrf_radio_shorts_disable(NRF_RADIO_SHORT_END_START_MASK);
     nrf_radio_shorts_enable(NRF_RADIO_SHORT_END_DISABLE_MASK);
+    txFrameRelease();
+    nrf_radio_packetptr_set(admin.rxFrame);
 
     state = EMBENET_RADIO_STATE_RX_PREPARED;
 
     return EMBENET_RADIO_STATUS_SUCCESS;
 }
 
-EMBENET_RADIO_Status EMBENET_RADIO_RxNow(void) {
-    hfclkWait();
+EMBEUTILS_RAMFUNC EMBENET_RADIO_Status EMBENET_RADIO_RxNow(void) {
+    scheduledStartCancel();
+    EMBENET_HFXO_Wait();
 
     nrf_radio_task_trigger(NRF_RADIO_TASK_RXEN);
 
@@ -291,26 +828,92 @@ EMBENET_RADIO_Status EMBENET_RADIO_RxNow(void) {
     return EMBENET_RADIO_STATUS_SUCCESS;
 }
 
+EMBEUTILS_RAMFUNC EMBENET_RADIO_Status EMBENET_RADIO_TxAt(EMBENET_TimeUs startTime) {
+    if ((EMBENET_RADIO_STATE_TX_PREPARED != state) && (EMBENET_RADIO_STATE_TX_FRAME != state)) {
+        return EMBENET_RADIO_STATUS_WRONG_STATE;
+    }
+    EMBENET_HFXO_Wait();
+
+    if (!scheduledStartArm(NRF_RADIO_TASK_TXEN, startTime)) {
+        return EMBENET_RADIO_STATUS_GENERAL_ERROR;
+    }
+
+    state = EMBENET_RADIO_STATE_TX_FRAME;
+
+    return EMBENET_RADIO_STATUS_SUCCESS;
+}
+
+EMBEUTILS_RAMFUNC EMBENET_RADIO_Status EMBENET_RADIO_RxAt(EMBENET_TimeUs startTime) {
+    if ((EMBENET_RADIO_STATE_RX_PREPARED != state) && (EMBENET_RADIO_STATE_RX_LISTENING != state)) {
+        return EMBENET_RADIO_STATUS_WRONG_STATE;
+    }
+    EMBENET_HFXO_Wait();
+
+    if (!scheduledStartArm(NRF_RADIO_TASK_RXEN, startTime)) {
+        return EMBENET_RADIO_STATUS_GENERAL_ERROR;
+    }
+
+    state = EMBENET_RADIO_STATE_RX_LISTENING;
+
+    return EMBENET_RADIO_STATUS_SUCCESS;
+}
+
 EMBENET_RADIO_RxInfo EMBENET_RADIO_GetReceivedFrame(uint8_t* buffer, size_t bufferLength) {
-    EMBENET_RADIO_RxInfo info             = {.crcValid = nrf_radio_crc_status_check(), .lqi = 0, .mpduLength = admin.frame[0], .rssi = (int8_t)(-nrf_radio_rssi_sample_get())};
+    uint8_t const*       frame            = admin.rxFrame;
+    EMBENET_RADIO_RxInfo info             = {.crcValid = nrf_radio_crc_status_check(), .lqi = 0, .mpduLength = frame[0], .rssi = (int8_t)(-nrf_radio_rssi_sample_get())};
     size_t               dataAmountToCopy = info.mpduLength;
     if (dataAmountToCopy > bufferLength) {
         dataAmountToCopy = bufferLength;
     }
-    memcpy(buffer, &admin.frame[1], dataAmountToCopy);
+    if (buffer != &frame[1]) {
+        memcpy(buffer, &frame[1], dataAmountToCopy);
+    }
+    EMBENET_CHANNEL_QUALITY_OnRx(admin.channel, info.crcValid, info.rssi);
+
+    return info;
+}
 
+uint8_t* EMBENET_RADIO_AcquireFrameBuffer(void) {
+    uint8_t* frame = EMBENET_PACKET_POOL_Alloc();
+    return (NULL != frame) ? &frame[1] : NULL;
+}
+
+EMBENET_RADIO_RxInfo EMBENET_RADIO_TakeReceivedFrame(uint8_t const** psdu) {
+    EMBENET_CRITICAL_SECTION_Enter();
+    uint8_t*             next  = EMBENET_PACKET_POOL_Alloc();
+    uint8_t const*       frame = admin.rxFrame;
+    EMBENET_RADIO_RxInfo info  = {.crcValid = nrf_radio_crc_status_check(), .lqi = 0, .mpduLength = frame[0], .rssi = (int8_t)(-nrf_radio_rssi_sample_get())};
+    if (NULL != next) {
+        // hand over the received block, with the radio's reference, and receive the next frame into a new one
+        admin.rxFrame = next;
+        nrf_radio_packetptr_set(next);
+        *psdu = &frame[1];
+    } else {
+        *psdu = NULL;
+    }
+    EMBENET_CRITICAL_SECTION_Exit();
+    EMBENET_CHANNEL_QUALITY_OnRx(admin.channel, info.crcValid, info.rssi);
     return info;
 }
 
+void EMBENET_RADIO_ReleaseFrameBuffer(uint8_t const* psdu) {
+    // anything but a lent buffer is ignored, the reception block in particular is still written by EasyDMA
+    uint8_t* frame = getLentFrame(psdu);
+    if (NULL != frame) {
+        EMBENET_PACKET_POOL_Release(frame);
+    }
+}
+
 
 EMBENET_RADIO_Status EMBENET_RADIO_StartContinuousTx(EMBENET_RADIO_ContinuousTxMode mode, EMBENET_RADIO_Channel channel, EMBENET_RADIO_Power txp) {
     switch (mode) {
         case EMBENET_RADIO_CONTINUOUS_TX_MODE_PN9:
-            hfclkWait();
-            admin.frame[0] = EMBENET_RADIO_MAX_PSDU_LENGTH;
-            for (size_t i = 1; i < sizeof(admin.frame); ++i) {
-                admin.frame[i] = (uint8_t)EMBENET_RANDOM_Get();
+            EMBENET_HFXO_Wait();
+            admin.rxFrame[0] = EMBENET_RADIO_MAX_PSDU_LENGTH;
+            for (size_t i = 1; i <= EMBENET_RADIO_MAX_PSDU_LENGTH; ++i) {
+                admin.rxFrame[i] = (uint8_t)EMBENET_RANDOM_Get();
             }
+            nrf_radio_packetptr_set(admin.rxFrame);
 
             setPower(txp);
             setChannel(channel);
@@ -321,7 +924,7 @@ EMBENET_RADIO_Status EMBENET_RADIO_StartContinuousTx(EMBENET_RADIO_ContinuousTxM
             state = EMBENET_RADIO_STATE_TX_CONTINUOUS_PN9;
             break;
         case EMBENET_RADIO_CONTINUOUS_TX_MODE_CARRIER:
-            hfclkWait();
+            EMBENET_HFXO_Wait();
             setPower(txp);
             setChannel(channel);
             nrf_radio_shorts_disable(NRF_RADIO_SHORT_READY_START_MASK);
@@ -335,43 +938,63 @@ EMBENET_RADIO_Status EMBENET_RADIO_StartContinuousTx(EMBENET_RADIO_ContinuousTxM
     return EMBENET_RADIO_STATUS_SUCCESS;
 }
 
+EMBENET_RADIO_Status EMBENET_RADIO_Calibrate(void) {
+    if (EMBENET_RADIO_STATE_IDLE != state) {
+        return EMBENET_RADIO_STATUS_WRONG_STATE;
+    }
+    NVIC_DisableIRQ(RADIO_IRQn);
+    bool completed = calibrate();
+    // the events polled by the calibration must not reach the frame handlers
+    NVIC_ClearPendingIRQ(RADIO_IRQn);
+    NVIC_EnableIRQ(RADIO_IRQn);
+    return completed ? EMBENET_RADIO_STATUS_SUCCESS : EMBENET_RADIO_STATUS_GENERAL_ERROR;
+}
+
+bool EMBENET_RADIO_GetCalibration(EMBENET_RADIO_PhyProfile profile, EMBENET_RADIO_Calibration* result) {
+    if (((size_t)profile >= PHY_PROFILE_COUNT) || !calibration.valid[profile] || (NULL == result)) {
+        return false;
+    }
+    *result = calibration.results[profile];
+    return true;
+}
+
 EMBENET_RADIO_Capabilities const* EMBENET_RADIO_GetCapabilities(void) {
-    static EMBENET_RADIO_Capabilities timings = {.idleToTxReady   = EMBENET_RADIO_IdleToTxReady,
-                                                 .idleToRxReady   = EMBENET_RADIO_IdleToRxReady,
-                                                 .activeToTxReady = EMBENET_RADIO_ActiveToTxReady,
-                                                 .activeToRxReady = EMBENET_RADIO_ActiveToRxReady,
-                                                 .txDelay         = EMBENET_RADIO_TxDelay,
-                                                 .rxDelay         = EMBENET_RADIO_RxDelay,
-                                                 .txRxStartDelay  = EMBENET_RADIO_TX_RX_START_CORRECTION,
-                                                 .sensitivity     = EMBENET_RADIO_SENSITIVITY,
-                                                 .maxOutputPower  = EMBENET_RADIO_MAX_OUTPUT_POWER,
-                                                 .minOutputPower  = EMBENET_RADIO_MIN_OUTPUT_POWER};
-    return &timings;
-}
-
-
-void RADIO_IRQHandler(void) {
-    EMBENET_TimeUs now = EMBENET_TIMER_ReadCounter();
+    return &phy->capabilities;
+}
+
+
+// runs from RAM as do the slot start functions, the frame handlers of the stack stay in flash
+EMBEUTILS_RAMFUNC void RADIO_IRQHandler(void) {
+    nrf_timer_task_trigger(EMBENET_PORT_RADIO_TIMESTAMP_TIMER, NRF_TIMER_TASK_CAPTURE0);
+    EMBENET_TimeUs now      = EMBENET_TIMER_ReadCounter();
+    uint32_t       timerNow = nrf_timer_cc_read(EMBENET_PORT_RADIO_TIMESTAMP_TIMER, NRF_TIMER_CC_CHANNEL0);
     if (nrf_radio_event_check(NRF_RADIO_EVENT_ADDRESS)) {
         nrf_radio_event_clear(NRF_RADIO_EVENT_ADDRESS);
+        if (EMBENET_RADIO_STATE_TX_FRAME == state) {
+            // a prepared transmission may be cancelled, so it is counted only once the frame is on the air
+            EMBENET_CHANNEL_QUALITY_OnTx(admin.channel);
+        }
         if (admin.onStartOfFrameHandler && (EMBENET_RADIO_STATE_TX_CONTINUOUS_PN9 != state)) {
+            // corrections below are the on-air time of preamble and address and the receiver delay, not the ISR latency
+            EMBENET_TimeUs timestamp = timestampGet(NRF_TIMER_CC_CHANNEL1, now, timerNow);
             if (EMBENET_RADIO_STATE_TX_FRAME == state) {
-                now -= EMBENET_RADIO_TX_TX_START_CORRECTION;
+                timestamp -= phy->txTxStartCorrection;
             }
             if (EMBENET_RADIO_STATE_RX_LISTENING == state) {
                 state = EMBENET_RADIO_STATE_RX_FRAME;
-                now -= EMBENET_RADIO_TX_RX_START_CORRECTION;
+                timestamp -= phy->txRxStartCorrection;
             }
-            admin.onStartOfFrameHandler(admin.handlersContext, now);
+            admin.onStartOfFrameHandler(admin.handlersContext, timestamp);
         }
     }
     if (nrf_radio_event_check(NRF_RADIO_EVENT_END)) {
         nrf_radio_event_clear(NRF_RADIO_EVENT_END);
+        EMBENET_TimeUs timestamp = timestampGet(NRF_TIMER_CC_CHANNEL2, now, timerNow);
         if (EMBENET_RADIO_STATE_RX_FRAME == state) {
-            now -= EMBENET_RADIO_TX_RX_END_CORRECTION;
+            timestamp -= phy->txRxEndCorrection;
         }
         if (admin.onEndOfFrameHandler && (EMBENET_RADIO_STATE_TX_CONTINUOUS_PN9 != state)) {
-            admin.onEndOfFrameHandler(admin.handlersContext, now);
+            admin.onEndOfFrameHandler(admin.handlersContext, timestamp);
         }
     }
 }
@@ -6,31 +6,234 @@
 @purpose   embeNET Node port for nRF52832
 @brief     Random number generator
 
+Random numbers come from AES-128 in counter mode running on the ECB peripheral, with the key and the counter set up and reseeded by the
+update function of the CTR_DRBG of NIST SP 800-90A (no derivation function). It is not an SP 800-90A DRBG: the output is generated ahead
+in two halves of a buffer, and the key is not updated after every draw, only at reseeds, so the output drawn since the last reseed can be
+recovered from a compromised state. While one half is consumed, the other one is encrypted in an ECB batch, so a draw is normally a copy
+from the buffer. If the next half is not ready yet, a single block is encrypted on the spot (about 7us). The seed is collected from the RNG
+peripheral by EMBENET_RANDOM_Init (see embenet_port_random.h). The entropy for reseeding is collected in the background by the RNG, from
+its interrupt, with bias correction enabled, and the key and the counter are replaced with it every EMBENET_PORT_RANDOM_RESEED_BLOCKS blocks.
+
 */
 
 #include "embenet_random.h"
 
+#include "embenet_critical_section.h"
+#include "embenet_port_config.h"
+#include "embenet_port_ecb.h"
+#include "embenet_port_interrupt_priorities.h"
+#include "embenet_port_random.h"
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wsign-conversion"
 #pragma GCC diagnostic ignored "-Wconversion"
 #pragma GCC diagnostic ignored "-Wcast-align"
+#include "nrf52.h"
 #include "nrf_rng.h"
 #pragma GCC diagnostic pop
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
-uint32_t EMBENET_RANDOM_Get(void) {
-    uint32_t randomValue = 0;
+#define BLOCK_SIZE  16
+#define SEED_SIZE   32 // key and V
+#define HALF_BLOCKS (EMBENET_PORT_RANDOM_BUFFER_BLOCKS / 2)
+#define HALF_SIZE   (HALF_BLOCKS * BLOCK_SIZE)
 
-    for (unsigned i = 0; i < 4; ++i) {
-        nrf_rng_error_correction_enable();
-        nrf_rng_shorts_enable(NRF_RNG_SHORT_VALRDY_STOP_MASK);
-        nrf_rng_event_clear(NRF_RNG_EVENT_VALRDY);
-        nrf_rng_task_trigger(NRF_RNG_TASK_START);
-        while (false == nrf_rng_event_get(NRF_RNG_EVENT_VALRDY))
+#if (EMBENET_PORT_RANDOM_BUFFER_BLOCKS < 2) || (0 != (EMBENET_PORT_RANDOM_BUFFER_BLOCKS % 2))
+#    error "EMBENET_PORT_RANDOM_BUFFER_BLOCKS must be even and at least 2"
+#endif
+
+/// DRBG working state
+static struct {
+    bool     seeded;            ///< true once instantiated
+    uint32_t blocksSinceReseed; ///< blocks generated since the last reseed
+    uint8_t  key[BLOCK_SIZE];   ///< AES key
+    uint8_t  v[BLOCK_SIZE];     ///< counter
+} drbg;
+
+/// Entropy collected by EMBENET_RANDOM_Init for the seed, then by the RNG interrupt for the reseeds
+static struct {
+    uint8_t         bytes[SEED_SIZE];
+    volatile size_t length;
+} pool;
+
+/// DRBG output generated ahead
+static struct {
+    uint8_t           halves[2][HALF_SIZE] __attribute__((aligned(4)));
+    volatile bool     ready[2]; ///< true if the half can be consumed
+    volatile bool     busy[2];  ///< true while the half is being encrypted in a batch
+    uint8_t           current;  ///< half being consumed
+    size_t            offset;   ///< bytes consumed from the current half
+    EMBENET_ECB_Batch batch;
+} output;
+
+static void incrementV(void) {
+    for (size_t i = BLOCK_SIZE; i-- > 0;) {
+        if (0 != ++drbg.v[i]) {
+            break;
+        }
+    }
+}
+
+/// Encrypts the next counter value
+static void generateBlock(uint8_t* out) {
+    EMBENET_ECB_Block block;
+    memcpy(block.key, drbg.key, BLOCK_SIZE);
+    incrementV();
+    memcpy(block.cleartext, drbg.v, BLOCK_SIZE);
+    // only the CCM and AAR peripherals can abort the ECB, none of them is used by the port
+    while (!EMBENET_ECB_Run(&block)) {
+        ;
+    }
+    memcpy(out, block.ciphertext, BLOCK_SIZE);
+    drbg.blocksSinceReseed++;
+}
+
+/// CTR_DRBG_Update: new key and counter from the next two blocks combined with the provided data
+static void update(uint8_t const providedData[SEED_SIZE]) {
+    uint8_t temp[SEED_SIZE];
+    generateBlock(&temp[0]);
+    generateBlock(&temp[BLOCK_SIZE]);
+    for (size_t i = 0; i < SEED_SIZE; ++i) {
+        temp[i] ^= providedData[i];
+    }
+    memcpy(drbg.key, &temp[0], BLOCK_SIZE);
+    memcpy(drbg.v, &temp[BLOCK_SIZE], BLOCK_SIZE);
+    memset(temp, 0, sizeof(temp));
+}
+
+static void poolStart(void) {
+    pool.length = 0;
+    nrf_rng_event_clear(NRF_RNG_EVENT_VALRDY);
+    nrf_rng_int_enable(NRF_RNG_INT_VALRDY_MASK);
+    nrf_rng_task_trigger(NRF_RNG_TASK_START);
+}
+
+/// Instantiates the DRBG with the seed collected by EMBENET_RANDOM_Init
+static void instantiate(void) {
+    memset(drbg.key, 0, BLOCK_SIZE);
+    memset(drbg.v, 0, BLOCK_SIZE);
+    update(pool.bytes);
+    memset(pool.bytes, 0, sizeof(pool.bytes));
+    drbg.blocksSinceReseed = 0;
+    drbg.seeded            = true;
+
+    output.ready[0] = false;
+    output.ready[1] = false;
+    output.busy[0]  = false;
+    output.busy[1]  = false;
+    output.current  = 0;
+    output.offset   = HALF_SIZE;
+
+    // from now on entropy is collected in the background
+    NVIC_ClearPendingIRQ(RNG_IRQn);
+    NVIC_SetPriority(RNG_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), INTERRUPT_PRIORITY_RNG, INTERRUPT_SUBPRIORITY_RNG));
+    NVIC_EnableIRQ(RNG_IRQn);
+    poolStart();
+}
+
+static void reseedIfDue(void) {
+    if ((drbg.blocksSinceReseed >= EMBENET_PORT_RANDOM_RESEED_BLOCKS) && (SEED_SIZE == pool.length)) {
+        update(pool.bytes);
+        drbg.blocksSinceReseed = 0;
+        memset(pool.bytes, 0, sizeof(pool.bytes));
+        poolStart();
+    }
+}
+
+static void onHalfEncrypted(void* context, bool success) {
+    uint8_t half       = (uint8_t)(uintptr_t)context;
+    output.busy[half]  = false;
+    output.ready[half] = success;
+}
+
+/// Starts generating the given half in the background, or generates it right away if the ECB is busy with another batch
+static void refill(uint8_t half) {
+    uint8_t* blocks = output.halves[half];
+    for (size_t i = 0; i < HALF_BLOCKS; ++i) {
+        incrementV();
+        memcpy(&blocks[i * BLOCK_SIZE], drbg.v, BLOCK_SIZE);
+    }
+    drbg.blocksSinceReseed += HALF_BLOCKS;
+    output.busy[half] = true;
+    if (!EMBENET_ECB_StartBatch(&output.batch, drbg.key, blocks, HALF_BLOCKS, onHalfEncrypted, (void*)(uintptr_t)half)) {
+        output.busy[half] = false;
+        for (size_t i = 0; i < HALF_BLOCKS; ++i) {
+            generateBlock(&blocks[i * BLOCK_SIZE]);
+        }
+        output.ready[half] = true;
+    }
+}
+
+void EMBENET_RANDOM_Init(void) {
+    if (drbg.seeded || (SEED_SIZE == pool.length)) {
+        return;
+    }
+    // the wait is outside of the critical section, the RNG interrupt is only enabled once the DRBG is instantiated
+    nrf_rng_error_correction_enable();
+    nrf_rng_shorts_disable(NRF_RNG_SHORT_VALRDY_STOP_MASK);
+    nrf_rng_event_clear(NRF_RNG_EVENT_VALRDY);
+    nrf_rng_task_trigger(NRF_RNG_TASK_START);
+    for (size_t i = 0; i < SEED_SIZE; ++i) {
+        while (false == nrf_rng_event_get(NRF_RNG_EVENT_VALRDY)) {
             ;
-        randomValue |= (uint32_t)nrf_rng_random_value_get() << (i * 8);
+        }
+        nrf_rng_event_clear(NRF_RNG_EVENT_VALRDY);
+        pool.bytes[i] = nrf_rng_random_value_get();
     }
+    nrf_rng_task_trigger(NRF_RNG_TASK_STOP);
+    pool.length = SEED_SIZE;
+}
+
+uint32_t EMBENET_RANDOM_Get(void) {
+    uint32_t randomValue;
+    if (!drbg.seeded) {
+        // drawn before EMBENET_RANDOM_Init, the caller waits for the seed
+        EMBENET_RANDOM_Init();
+    }
+    EMBENET_CRITICAL_SECTION_Enter();
+    if (!drbg.seeded) {
+        instantiate();
+    }
+    reseedIfDue();
+
+    uint8_t next = (uint8_t)(output.current ^ 1U);
+    if ((output.offset >= HALF_SIZE) && output.ready[next]) {
+        // the consumed half is generated anew while the other one is used
+        output.ready[output.current] = false;
+        refill(output.current);
+        output.current = next;
+        output.offset  = 0;
+    }
+    if (!output.ready[next] && !output.busy[next]) {
+        // right after the instantiation, or the batch was aborted
+        refill(next);
+    }
+
+    if ((output.offset < HALF_SIZE) && output.ready[output.current]) {
+        memcpy(&randomValue, &output.halves[output.current][output.offset], sizeof(randomValue));
+        output.offset += sizeof(randomValue);
+    } else {
+        // the buffer is not ready yet, the draw costs one block
+        uint8_t block[BLOCK_SIZE];
+        generateBlock(block);
+        memcpy(&randomValue, block, sizeof(randomValue));
+    }
+    EMBENET_CRITICAL_SECTION_Exit();
     return randomValue;
 }
+
+void RNG_IRQHandler(void) {
+    nrf_rng_event_clear(NRF_RNG_EVENT_VALRDY);
+    size_t length = pool.length;
+    if (length < SEED_SIZE) {
+        pool.bytes[length] = nrf_rng_random_value_get();
+        pool.length        = length + 1;
+    }
+    if (pool.length >= SEED_SIZE) {
+        nrf_rng_task_trigger(NRF_RNG_TASK_STOP);
+        nrf_rng_int_disable(NRF_RNG_INT_VALRDY_MASK);
+    }
+}
@@ -11,31 +11,126 @@
 
 #include "embenet_critical_section.h"
 #include "embenet_port_config.h"
+#include "embenet_port_hfxo.h"
 #include "embenet_port_interrupt_priorities.h"
+#include "embenet_port_timer_extension.h"
+#include <embetech/compiler_support.h>
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wsign-conversion"
 #pragma GCC diagnostic ignored "-Wconversion"
 #pragma GCC diagnostic ignored "-Wcast-align"
 #include "nrf_clock.h"
+#include "nrf_ppi.h"
 #include "nrf_rtc.h"
+#include "nrf_timer.h"
 #pragma GCC diagnostic pop
 
 #include <stdbool.h>
 #include <stdint.h>
 
 #define GUARD_US                   62
-#define SCALE_FACTOR               (uint64_t)(1000000000)  // scaling factor for the purpose of reducing integer calculating errors
-#define PERIOD_SCALED_UP           (uint64_t)(30517578125) // scaled up period by @ref SCALE_FACTOR
+#define GUARD_TICKS                2
 #define TIMER_MAX_VALUE            (uint32_t)0xFFFFFF
+#define TIMER_BITS                 24
 #define MAX_COMPARE_DURATION_TICKS 0x7FFFFF
 #define MAX_COMPARE_DURATION_US    (EMBENET_TimeUs)(250000000) // max value reduced by MSB of used timer expressed in us (approximation)
-#define OVERFLOW_EXTENSION_US      (uint64_t)(512000000)
+#define OVERFLOW_EXTENSION_US      (EMBENET_TimeUs)(512000000)
 
 static EMBENET_TIMER_CompareCallback callback;
 static void*                         callbackContext;
-static volatile uint64_t             timerValueExtension;
+static volatile uint32_t             overflowCount; // generation of the seqlock protecting the time readers
 static volatile bool                 softwareIrq;
 
+#if EMBENET_PORT_TIMER_HIRES
+static volatile bool           hiresActive; // true while RTC ticks are captured by the TIMER
+static volatile uint32_t       hiresSince;  // port timer ticks (lower 32 bits) at which the capture was enabled, no anchor until the next tick
+static volatile uint32_t       stopTicks;   // port timer ticks (lower 32 bits) at which the high resolution clock was stopped
+static volatile EMBENET_TimeUs stopTime;    // last high resolution reading, readings in the same tick must not be earlier
+#endif
+
+
+/*
+The readers below are lock-free and can be called from any context, with or without interrupts disabled.
+overflowCount acts as the generation of a seqlock: it is only changed by @ref EMBENET_PORT_TIMER_IRQ_HANDLER, together with
+clearing the OVF flag, and a reader that observes it changing retries. Within one generation:
+(1) the counter may overflow after being read, OVF flag is then set but the extension is not incremented yet - OVF FLAG MUST BE CHECKED!
+(2) if the OVF flag is set, the counter is read again, as the first reading may have been taken just before the overflow
+The readers, the compare setters and the interrupt handler run from RAM, with the helpers below always inlined into them.
+ */
+
+static inline EMBEUTILS_INLINE EMBENET_TimeTicks readNowTicks(void) {
+    uint32_t overflows;
+    uint32_t ticks;
+    bool     overflowPending;
+    do {
+        overflows       = overflowCount;
+        ticks           = nrf_rtc_counter_get(EMBENET_PORT_TIMER);
+        overflowPending = nrf_rtc_event_pending(EMBENET_PORT_TIMER, NRF_RTC_EVENT_OVERFLOW);
+        if (overflowPending) {
+            ticks = nrf_rtc_counter_get(EMBENET_PORT_TIMER);
+        }
+    } while (overflows != overflowCount);
+    if (overflowPending) {
+        overflows++;
+    }
+    return ((EMBENET_TimeTicks)overflows << TIMER_BITS) | ticks;
+}
+
+static inline EMBEUTILS_INLINE EMBENET_TimeUs readNow(uint32_t* counter) {
+    EMBENET_TimeTicks now = readNowTicks();
+    *counter              = (uint32_t)now & TIMER_MAX_VALUE;
+    // the extension wraps together with EMBENET_TimeUs
+    return EMBENET_TIMER_TicksToUs(*counter) + (EMBENET_TimeUs)(now >> TIMER_BITS) * OVERFLOW_EXTENSION_US;
+}
+
+#if EMBENET_PORT_TIMER_HIRES
+/*
+While the radio is active, every RTC tick captures the 1MHz TIMER through PPI (the anchor). A reading captures the TIMER again, the
+difference with the anchor is the time since the beginning of the current tick. The anchor is taken anew on every tick, so the drift
+of the TIMER clock never accumulates beyond one tick. The reading is repeated if a tick passes in the meantime, so that the anchor and
+the tick count always match. Another reader preempting this one may overwrite the capture, which only makes the reading a bit later.
+ */
+static inline EMBEUTILS_INLINE EMBENET_TimeUs readNowHiRes(void) {
+    uint32_t          counter;
+    EMBENET_TimeUs    now;
+    EMBENET_TimeTicks ticks;
+    uint32_t          elapsed;
+    do {
+        ticks = readNowTicks();
+        nrf_timer_task_trigger(EMBENET_PORT_TIMER_HIRES_TIMER, NRF_TIMER_TASK_CAPTURE0);
+        elapsed = nrf_timer_cc_read(EMBENET_PORT_TIMER_HIRES_TIMER, EMBENET_PORT_TIMER_HIRES_CC_NOW) -
+                  nrf_timer_cc_read(EMBENET_PORT_TIMER_HIRES_TIMER, EMBENET_PORT_TIMER_HIRES_CC_ANCHOR);
+        now = readNow(&counter);
+    } while ((uint32_t)ticks != (uint32_t)readNowTicks());
+
+    if (!hiresActive || ((uint32_t)ticks == hiresSince)) {
+        // stopped in the meantime or no anchor yet
+        return now;
+    }
+    // the anchor may be captured a few cycles after the counter increments, the reading must not reach the next tick
+    EMBENET_TimeUs tickDuration = EMBENET_TIMER_TicksToUs(counter + 1) - EMBENET_TIMER_TicksToUs(counter);
+    return now + ((elapsed < tickDuration) ? elapsed : (tickDuration - 1));
+}
+#endif
+
+static inline EMBEUTILS_INLINE EMBENET_TimeUs readCounter(void) {
+    uint32_t counter;
+#if EMBENET_PORT_TIMER_HIRES
+    if (hiresActive) {
+        return readNowHiRes();
+    }
+    EMBENET_TimeTicks ticks = readNowTicks();
+    EMBENET_TimeUs    now   = readNow(&counter);
+    // readings taken just after the stop, in the same tick, continue from the last high resolution reading
+    if (((uint32_t)ticks == stopTicks) && ((int32_t)(stopTime - now) > 0)) {
+        return stopTime;
+    }
+    return now;
+#else
+    return readNow(&counter);
+#endif
+}
+
 
 void EMBENET_TIMER_Init(EMBENET_TIMER_CompareCallback compareCallback, void* context) {
     // Start LFCLK and wait for it to start.
@@ -63,8 +158,15 @@ void EMBENET_TIMER_Init(EMBENET_TIMER_CompareCallback compareCallback, void* con
     callback        = compareCallback;
     callbackContext = context;
 
-    timerValueExtension = 0;
-    softwareIrq         = false;
+    overflowCount = 0;
+    softwareIrq   = false;
+
+#if EMBENET_PORT_TIMER_HIRES
+    hiresActive = false;
+    stopTicks   = UINT32_MAX;
+    nrf_ppi_channel_endpoint_setup(EMBENET_PORT_TIMER_HIRES_PPI, nrf_rtc_event_address_get(EMBENET_PORT_TIMER, NRF_RTC_EVENT_TICK),
+                                   nrf_timer_task_address_get(EMBENET_PORT_TIMER_HIRES_TIMER, NRF_TIMER_TASK_CAPTURE3));
+#endif
 }
 
 
@@ -75,49 +177,129 @@ void EMBENET_TIMER_Deinit(void) {
 }
 
 
-void EMBENET_TIMER_SetCompare(EMBENET_TimeUs compareValue) {
+EMBEUTILS_RAMFUNC void EMBENET_TIMER_SetCompare(EMBENET_TimeUs compareValue) {
     EMBENET_CRITICAL_SECTION_Enter();
     // cancel previous or ongoing
     nrf_rtc_int_enable(EMBENET_PORT_TIMER, NRF_RTC_INT_COMPARE0_MASK); // make sure that the interrupt is active (first compare)
 
     // get current time and counter
-    uint32_t       counter = nrf_rtc_counter_get(EMBENET_PORT_TIMER);
-    EMBENET_TimeUs now     = (EMBENET_TimeUs)((uint64_t)counter * PERIOD_SCALED_UP / SCALE_FACTOR + timerValueExtension);
-    if (nrf_rtc_event_pending(EMBENET_PORT_TIMER, NRF_RTC_EVENT_OVERFLOW)) {
-        counter = nrf_rtc_counter_get(EMBENET_PORT_TIMER);
-        now     = (EMBENET_TimeUs)((uint64_t)counter * PERIOD_SCALED_UP / SCALE_FACTOR + timerValueExtension + OVERFLOW_EXTENSION_US);
-    }
+    uint32_t       counter;
+    EMBENET_TimeUs now = readNow(&counter);
 
     EMBENET_TimeUs delta = compareValue - now;
     if ((EMBENET_TimeUs)(delta - GUARD_US) < MAX_COMPARE_DURATION_US) {
         // arm the compare interrupt
-        nrf_rtc_cc_set(EMBENET_PORT_TIMER, 0, (counter + (uint32_t)((uint64_t)(delta)*SCALE_FACTOR / PERIOD_SCALED_UP)) & TIMER_MAX_VALUE);
+        nrf_rtc_cc_set(EMBENET_PORT_TIMER, EMBENET_PORT_TIMER_CC_MAC, (counter + EMBENET_TIMER_UsToTicks(delta)) & TIMER_MAX_VALUE);
     } else {
         // compareValue is too close to current value and timer will be late, interrupt is triggered immediately
         NVIC_SetPendingIRQ(EMBENET_PORT_TIMER_IRQn);
         softwareIrq = true;
     }
+    // the MAC compare precedes radio activity, so it is the earliest hint of when the HFXO will be needed
+    EMBENET_HFXO_Schedule(compareValue);
 
     EMBENET_CRITICAL_SECTION_Exit();
 }
 
 
-EMBENET_TimeUs EMBENET_TIMER_ReadCounter(void) {
-    // note that during assembly of the actual time, the counter may increment and overflow itself
+EMBEUTILS_RAMFUNC EMBENET_TimeUs EMBENET_TIMER_ReadCounter(void) {
+    // lock-free, reading the time does not add to the interrupt latency
+    return readCounter();
+}
+
+
+void EMBENET_TIMER_HiResStart(void) {
+#if EMBENET_PORT_TIMER_HIRES
+    if (hiresActive) {
+        return;
+    }
     EMBENET_CRITICAL_SECTION_Enter();
-    // this thing is sopthisticated
-    // it can be called from nonpriviledged mode (1) and from @ref EMBENET_PORT_TIMER_IRQ_HANDLER ISR (2)
-    // (1A) after entering the critical section and before getting the timer value it can increment and overflow,
-    // OVF flag will be set and timerValueExtension will be not incremented - OVF FLAG MUST BE CHECKED!
-    // (1B) during code execution inside the critical section timer may increment and overflow itself - no harm
-    // (2) before entering critical section timerValueExtension may not be incremented and OVF flag will be set - OVF FLAG MUST BE CHECKED!
-    uint64_t now = (uint64_t)nrf_rtc_counter_get(EMBENET_PORT_TIMER) * PERIOD_SCALED_UP / SCALE_FACTOR + timerValueExtension;
-    if (nrf_rtc_event_pending(EMBENET_PORT_TIMER, NRF_RTC_EVENT_OVERFLOW)) {
-        now = (uint64_t)nrf_rtc_counter_get(EMBENET_PORT_TIMER) * PERIOD_SCALED_UP / SCALE_FACTOR + timerValueExtension + OVERFLOW_EXTENSION_US;
+    nrf_rtc_event_clear(EMBENET_PORT_TIMER, NRF_RTC_EVENT_TICK);
+    nrf_rtc_event_enable(EMBENET_PORT_TIMER, NRF_RTC_INT_TICK_MASK);
+    nrf_ppi_channel_enable(EMBENET_PORT_TIMER_HIRES_PPI);
+    // the first anchor is captured when the counter increments past the current value
+    hiresSince  = (uint32_t)readNowTicks();
+    hiresActive = true;
+    EMBENET_CRITICAL_SECTION_Exit();
+#endif
+}
+
+
+void EMBENET_TIMER_HiResStop(void) {
+#if EMBENET_PORT_TIMER_HIRES
+    if (!hiresActive) {
+        return;
+    }
+    EMBENET_CRITICAL_SECTION_Enter();
+    stopTime    = readNowHiRes();
+    stopTicks   = (uint32_t)readNowTicks();
+    hiresActive = false;
+    // the RTC TICK event keeps the 32kHz clock domain busy, it is only enabled while needed
+    nrf_ppi_channel_disable(EMBENET_PORT_TIMER_HIRES_PPI);
+    nrf_rtc_event_disable(EMBENET_PORT_TIMER, NRF_RTC_INT_TICK_MASK);
+    EMBENET_CRITICAL_SECTION_Exit();
+#endif
+}
+
+
+EMBEUTILS_RAMFUNC EMBENET_TimeTicks EMBENET_TIMER_ReadTicks(void) {
+    return readNowTicks();
+}
+
+
+EMBEUTILS_RAMFUNC bool EMBENET_TIMER_SetEventCompare(uint32_t channel, EMBENET_TimeUs compareValue, EMBENET_TimeUs* subTickRemainder) {
+    bool armed = false;
+    EMBENET_CRITICAL_SECTION_Enter();
+    uint32_t       counter;
+    EMBENET_TimeUs now = readNow(&counter);
+
+    // 'now' is the beginning of the current tick, so the RTC gets at least two full ticks to match the compare value
+    EMBENET_TimeUs delta = compareValue - now;
+    if ((EMBENET_TimeUs)(delta - GUARD_US) < MAX_COMPARE_DURATION_US) {
+        uint32_t ticks    = EMBENET_TIMER_UsToTicks(delta);
+        *subTickRemainder = delta - EMBENET_TIMER_TicksToUs(ticks);
+        nrf_rtc_event_clear(EMBENET_PORT_TIMER, RTC_CHANNEL_EVENT_ADDR(channel));
+        nrf_rtc_cc_set(EMBENET_PORT_TIMER, channel, (counter + ticks) & TIMER_MAX_VALUE);
+        nrf_rtc_event_enable(EMBENET_PORT_TIMER, RTC_CHANNEL_INT_MASK(channel));
+        armed = true;
     }
     EMBENET_CRITICAL_SECTION_Exit();
+    return armed;
+}
+
+
+bool EMBENET_TIMER_SetEventCompareTicks(uint32_t channel, EMBENET_TimeTicks compareTicks) {
+    bool armed = false;
+    EMBENET_CRITICAL_SECTION_Enter();
+    EMBENET_TimeTicks delta = compareTicks - readNowTicks();
+    if ((delta >= GUARD_TICKS) && (delta <= MAX_COMPARE_DURATION_TICKS)) {
+        nrf_rtc_event_clear(EMBENET_PORT_TIMER, RTC_CHANNEL_EVENT_ADDR(channel));
+        nrf_rtc_cc_set(EMBENET_PORT_TIMER, channel, (uint32_t)compareTicks & TIMER_MAX_VALUE);
+        nrf_rtc_event_enable(EMBENET_PORT_TIMER, RTC_CHANNEL_INT_MASK(channel));
+        armed = true;
+    }
+    EMBENET_CRITICAL_SECTION_Exit();
+    return armed;
+}
 
-    return (EMBENET_TimeUs)(now);
+
+EMBEUTILS_RAMFUNC void EMBENET_TIMER_ClearEventCompare(uint32_t channel) {
+    nrf_rtc_event_disable(EMBENET_PORT_TIMER, RTC_CHANNEL_INT_MASK(channel));
+    nrf_rtc_event_clear(EMBENET_PORT_TIMER, RTC_CHANNEL_EVENT_ADDR(channel));
+}
+
+
+uint32_t EMBENET_TIMER_GetTicksToCompare(void) {
+    uint32_t ticks = UINT32_MAX;
+    EMBENET_CRITICAL_SECTION_Enter();
+    if (softwareIrq || nrf_rtc_event_pending(EMBENET_PORT_TIMER, NRF_RTC_EVENT_COMPARE_0)) {
+        ticks = 0;
+    } else if (nrf_rtc_int_is_enabled(EMBENET_PORT_TIMER, NRF_RTC_INT_COMPARE0_MASK)) {
+        // the interrupt is disabled once the compare fires, so an enabled interrupt means the compare is still ahead
+        ticks = (nrf_rtc_cc_get(EMBENET_PORT_TIMER, EMBENET_PORT_TIMER_CC_MAC) - nrf_rtc_counter_get(EMBENET_PORT_TIMER)) & TIMER_MAX_VALUE;
+    }
+    EMBENET_CRITICAL_SECTION_Exit();
+    return ticks;
 }
 
 
@@ -126,10 +308,13 @@ EMBENET_TimeUs EMBENET_TIMER_GetMaxCompareDuration(void) {
 }
 
 
-void EMBENET_PORT_TIMER_IRQ_HANDLER(void) {
+EMBEUTILS_RAMFUNC void EMBENET_PORT_TIMER_IRQ_HANDLER(void) {
     if (nrf_rtc_event_pending(EMBENET_PORT_TIMER, NRF_RTC_EVENT_OVERFLOW)) {
+        // a reader preempting this handler must see either both or none of the changes
+        EMBENET_CRITICAL_SECTION_Enter();
         nrf_rtc_event_clear(EMBENET_PORT_TIMER, NRF_RTC_EVENT_OVERFLOW);
-        timerValueExtension += (uint64_t)OVERFLOW_EXTENSION_US;
+        overflowCount++;
+        EMBENET_CRITICAL_SECTION_Exit();
     }
     if (nrf_rtc_event_pending(EMBENET_PORT_TIMER, NRF_RTC_EVENT_COMPARE_0) || softwareIrq) {
         nrf_rtc_event_clear(EMBENET_PORT_TIMER, NRF_RTC_EVENT_COMPARE_0);
@@ -139,5 +324,6 @@ void EMBENET_PORT_TIMER_IRQ_HANDLER(void) {
         if (callback != NULL) {
             callback(callbackContext);
         }
+        EMBENET_HFXO_OnCompare();
     }
 }
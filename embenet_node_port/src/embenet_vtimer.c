@@ -0,0 +1,175 @@
+/**
+@file
+@license   Commercial
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET Node port for nRF52832
+@brief     Implementation of virtual timers
+*/
+
+#include "embenet_port_vtimer.h"
+
+#include "embenet_critical_section.h"
+#include "embenet_port_config.h"
+#include "embenet_port_interrupt_priorities.h"
+#include "embenet_port_timer_extension.h"
+#include <embetech/expect.h>
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#pragma GCC diagnostic ignored "-Wconversion"
+#pragma GCC diagnostic ignored "-Wcast-align"
+#include "nrf52.h"
+#include "nrf_egu.h"
+#include "nrf_ppi.h"
+#include "nrf_rtc.h"
+#pragma GCC diagnostic pop
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MAX_ARM_TICKS 0x400000 ///< deadlines further away are reached in steps, well within the compare range of the port timer
+
+static EMBENET_VTIMER_Timer* head; ///< queue of active timers, sorted by deadline
+
+static inline bool isBefore(uint64_t a, uint64_t b) {
+    return (int64_t)(a - b) < 0;
+}
+
+static void insert(EMBENET_VTIMER_Timer* timer) {
+    EMBENET_VTIMER_Timer** link = &head;
+    // timers with equal deadlines expire in the order they were started
+    while ((NULL != *link) && !isBefore(timer->deadline, (*link)->deadline)) {
+        link = &(*link)->next;
+    }
+    timer->next   = *link;
+    *link         = timer;
+    timer->active = true;
+}
+
+static void unlink(EMBENET_VTIMER_Timer* timer) {
+    for (EMBENET_VTIMER_Timer** link = &head; NULL != *link; link = &(*link)->next) {
+        if (timer == *link) {
+            *link = timer->next;
+            break;
+        }
+    }
+    timer->next   = NULL;
+    timer->active = false;
+}
+
+static void rearm(void) {
+    if (NULL == head) {
+        EMBENET_TIMER_ClearEventCompare(EMBENET_PORT_TIMER_CC_VTIMER);
+        return;
+    }
+    EMBENET_TimeTicks now    = EMBENET_TIMER_ReadTicks();
+    EMBENET_TimeTicks target = head->deadline;
+    if (isBefore(now + MAX_ARM_TICKS, target)) {
+        target = now + MAX_ARM_TICKS;
+    }
+    if (!EMBENET_TIMER_SetEventCompareTicks(EMBENET_PORT_TIMER_CC_VTIMER, target)) {
+        // deadline is too close or already passed, dispatch right away
+        nrf_egu_task_trigger(EMBENET_PORT_VTIMER_EGU, NRF_EGU_TASK_TRIGGER0);
+    }
+}
+
+void EMBENET_VTIMER_Init(void) {
+    EMBENET_CRITICAL_SECTION_Enter();
+    head = NULL;
+    EMBENET_TIMER_ClearEventCompare(EMBENET_PORT_TIMER_CC_VTIMER);
+    nrf_ppi_channel_endpoint_setup(EMBENET_PORT_VTIMER_PPI, nrf_rtc_event_address_get(EMBENET_PORT_TIMER, RTC_CHANNEL_EVENT_ADDR(EMBENET_PORT_TIMER_CC_VTIMER)),
+                                   nrf_egu_task_address_get(EMBENET_PORT_VTIMER_EGU, NRF_EGU_TASK_TRIGGER0));
+    nrf_ppi_channel_enable(EMBENET_PORT_VTIMER_PPI);
+    nrf_egu_event_clear(EMBENET_PORT_VTIMER_EGU, NRF_EGU_EVENT_TRIGGERED0);
+    nrf_egu_int_enable(EMBENET_PORT_VTIMER_EGU, NRF_EGU_INT_TRIGGERED0);
+
+    NVIC_ClearPendingIRQ(EMBENET_PORT_VTIMER_IRQn);
+    NVIC_SetPriority(EMBENET_PORT_VTIMER_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), INTERRUPT_PRIORITY_VTIMER, INTERRUPT_SUBPRIORITY_VTIMER));
+    NVIC_EnableIRQ(EMBENET_PORT_VTIMER_IRQn);
+    EMBENET_CRITICAL_SECTION_Exit();
+}
+
+void EMBENET_VTIMER_Start(EMBENET_VTIMER_Timer* timer, uint32_t delayUs, uint32_t periodUs, EMBENET_VTIMER_Callback callback, void* context) {
+    EXPECT(NULL != timer) OR_RETURN();
+    EXPECT(NULL != callback) OR_RETURN();
+    EMBENET_CRITICAL_SECTION_Enter();
+    if (timer->active) {
+        unlink(timer);
+    }
+    timer->deadline = EMBENET_TIMER_ReadTicks() + EMBENET_TIMER_UsToTicks(delayUs);
+    timer->period   = EMBENET_TIMER_UsToTicks(periodUs);
+    if ((0 != periodUs) && (0 == timer->period)) {
+        timer->period = 1; // shortest period the port timer can do
+    }
+    timer->callback = callback;
+    timer->context  = context;
+    insert(timer);
+    if (head == timer) {
+        rearm();
+    }
+    EMBENET_CRITICAL_SECTION_Exit();
+}
+
+void EMBENET_VTIMER_Stop(EMBENET_VTIMER_Timer* timer) {
+    EXPECT(NULL != timer) OR_RETURN();
+    EMBENET_CRITICAL_SECTION_Enter();
+    if (timer->active) {
+        bool wasFirst = (head == timer);
+        unlink(timer);
+        if (wasFirst) {
+            rearm();
+        }
+    }
+    EMBENET_CRITICAL_SECTION_Exit();
+}
+
+bool EMBENET_VTIMER_IsActive(EMBENET_VTIMER_Timer const* timer) {
+    return (NULL != timer) && timer->active;
+}
+
+uint32_t EMBENET_VTIMER_GetTimeToNextExpiration(void) {
+    uint32_t timeUs = UINT32_MAX;
+    EMBENET_CRITICAL_SECTION_Enter();
+    if (NULL != head) {
+        EMBENET_TimeTicks now = EMBENET_TIMER_ReadTicks();
+        if (!isBefore(now, head->deadline)) {
+            timeUs = 0;
+        } else if ((head->deadline - now) < MAX_ARM_TICKS) {
+            timeUs = EMBENET_TIMER_TicksToUs((uint32_t)(head->deadline - now));
+        } else {
+            // the compare channel is only armed this far ahead, the wakeup comes no later than that
+            timeUs = EMBENET_TIMER_TicksToUs(MAX_ARM_TICKS);
+        }
+    }
+    EMBENET_CRITICAL_SECTION_Exit();
+    return timeUs;
+}
+
+void EMBENET_PORT_VTIMER_IRQ_HANDLER(void) {
+    nrf_egu_event_clear(EMBENET_PORT_VTIMER_EGU, NRF_EGU_EVENT_TRIGGERED0);
+
+    EMBENET_CRITICAL_SECTION_Enter();
+    // 'now' is not refreshed, so that a short periodic timer cannot keep the loop running forever
+    EMBENET_TimeTicks now = EMBENET_TIMER_ReadTicks();
+    while ((NULL != head) && !isBefore(now, head->deadline)) {
+        EMBENET_VTIMER_Timer* timer = head;
+        unlink(timer);
+        if (0 != timer->period) {
+            // periodic timers do not drift, expirations missed entirely are skipped
+            timer->deadline += timer->period;
+            if (!isBefore(now, timer->deadline)) {
+                timer->deadline = now + timer->period;
+            }
+            insert(timer);
+        }
+        EMBENET_VTIMER_Callback callback = timer->callback;
+        void*                   context  = timer->context;
+        // the callback may start and stop timers, including this one
+        EMBENET_CRITICAL_SECTION_Exit();
+        callback(context);
+        EMBENET_CRITICAL_SECTION_Enter();
+    }
+    rearm();
+    EMBENET_CRITICAL_SECTION_Exit();
+}
@@ -2,8 +2,13 @@
 #define EMBENET_NODE_NRF52_BSP_INTERFACE_H_
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
+#ifndef EMBENET_NODE_BSP_UART_DMA
+#    define EMBENET_NODE_BSP_UART_DMA 1 // 1: UARTE with EasyDMA (EMBENET_NODE_BSP_UARTE_*), 0: legacy UART with per-byte interrupts
+#endif
+
 /**
  * @brief UART callback type
  * @param[in] context optional context that will be passed to the callbacks upon calling
@@ -32,4 +37,47 @@ void EMBENET_NODE_BSP_UART_WriteByte(const uint8_t c);
 /// @brief Reads byte from RX register. Does not wait for data.
 uint8_t EMBENET_NODE_BSP_UART_ReadByte(void);
 
+/**
+ * @brief UARTE reception callback type
+ * @param[in] context optional context that will be passed to the callbacks upon calling
+ * @param[in] data received bytes, valid only during the call
+ * @param[in] length number of received bytes
+ */
+typedef void (*EMBENET_NODE_BSP_UARTE_RxCallback_t)(void* context, uint8_t const* data, size_t length);
+
+/**
+ * @brief Initializes UARTE with EasyDMA (GPIO, clocks, peripherals, etc.).
+ *
+ * Received bytes are delivered in chunks: whenever one of the DMA buffers gets full and when the line goes idle.
+ *
+ * @param[in] txEndCallback Callback to be called when the transmission started with @ref EMBENET_NODE_BSP_UARTE_Write is finished
+ * @param[in] rxCallback Callback to be called with received bytes
+ * @param[in] context optional context that will be passed to the callbacks upon calling
+ */
+void EMBENET_NODE_BSP_UARTE_Init(const EMBENET_NODE_BSP_UART_Callback_t txEndCallback, const EMBENET_NODE_BSP_UARTE_RxCallback_t rxCallback, void* context);
+
+/// @brief Deinitializes UARTE
+void EMBENET_NODE_BSP_UARTE_Deinit(void);
+
+/**
+ * @brief Starts DMA transmission. Must not be called before the previous transmission is finished.
+ * @param[in] data bytes to send, must be in RAM and stay valid until the transmission is finished
+ * @param[in] length number of bytes to send, at most @ref EMBENET_NODE_BSP_UARTE_MAX_TX_CHUNK
+ */
+void EMBENET_NODE_BSP_UARTE_Write(uint8_t const* data, size_t length);
+
+/**
+ * @brief Stops the reception after the DMA buffer being filled, until @ref EMBENET_NODE_BSP_UARTE_RxResume.
+ *
+ * With hardware flow control enabled, the UARTE deactivates RTS when its FIFO fills up, so the peer stops sending. Must be called from
+ * the reception callback.
+ */
+void EMBENET_NODE_BSP_UARTE_RxPause(void);
+
+/// @brief Restarts the reception stopped with @ref EMBENET_NODE_BSP_UARTE_RxPause.
+void EMBENET_NODE_BSP_UARTE_RxResume(void);
+
+#define EMBENET_NODE_BSP_UARTE_MAX_TX_CHUNK 255 // longest DMA transmission (TXD.MAXCNT is 8 bit on nRF52832)
+#define EMBENET_NODE_BSP_UARTE_RX_CHUNK     64  // size of each of the two DMA reception buffers
+
 #endif // EMBENET_NODE_NRF52_BSP_INTERFACE_H_ included
\ No newline at end of file
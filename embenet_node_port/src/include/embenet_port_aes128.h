@@ -0,0 +1,62 @@
+/**
+@file
+@license   Commercial
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET Node port for nRF52832
+@brief     AES-128 key contexts
+
+Keys used by the application (e.g. for payload encryption) are expanded once into contexts taken from a small fixed pool
+(EMBENET_PORT_AES128_KEY_POOL_SIZE) and then selected by handle, so switching keys from block to block costs nothing, and the key set by
+the stack is left alone. Encryption runs on the ECB peripheral, decryption in software.
+
+*/
+
+#ifndef EMBENET_PORT_AES128_H_
+#define EMBENET_PORT_AES128_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint8_t EMBENET_AES128_KeyHandle; ///< Identifier of a key context
+
+#define EMBENET_AES128_KEY_HANDLE_INVALID 0xff ///< Special value of EMBENET_AES128_KeyHandle that informs that there is no key context
+
+/**
+ * @brief Creates a key context.
+ * @param[in] key 16 byte key
+ * @return handle of the context or EMBENET_AES128_KEY_HANDLE_INVALID if the pool is exhausted
+ */
+EMBENET_AES128_KeyHandle EMBENET_AES128_KeyCreate(uint8_t const key[16U]);
+
+/**
+ * @brief Destroys a key context, wiping the key.
+ * @param[in] handle handle of the context (as returned by @ref EMBENET_AES128_KeyCreate)
+ */
+void EMBENET_AES128_KeyDestroy(EMBENET_AES128_KeyHandle handle);
+
+/**
+ * @brief Encrypts a 16 byte block in place.
+ * @param[in] handle handle of the context
+ * @param[in,out] data block to encrypt
+ * @return true on success, false if the handle is invalid
+ */
+bool EMBENET_AES128_KeyEncrypt(EMBENET_AES128_KeyHandle handle, uint8_t data[16U]);
+
+/**
+ * @brief Decrypts a 16 byte block in place.
+ * @param[in] handle handle of the context
+ * @param[in,out] data block to decrypt
+ * @return true on success, false if the handle is invalid
+ */
+bool EMBENET_AES128_KeyDecrypt(EMBENET_AES128_KeyHandle handle, uint8_t data[16U]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EMBENET_PORT_AES128_H_
@@ -0,0 +1,113 @@
+/**
+@file
+@license   Commercial
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET Node port for nRF52832
+@brief     Border router communication extensions
+
+The reception interrupt delimits complete HDLC frames as they arrive and queues their positions, so the application can tell how many
+frames wait for the stack and let it take them all before going on. When the input buffer or the frame queue is close to full, the
+reception is paused, which (with hardware flow control) stops the border router until the stack catches up.
+
+With EMBENET_PORT_BRT_AGGREGATION, packets sent to a border router that supports it can be packed into shared frames, saving the flags and
+the FCS of each packet. An aggregated frame carries records made of a length byte followed by that many packet bytes, under a single
+FCS. The frame is sent when the next packet does not fit, when EMBENET_PORT_BRT_AGGREGATION_TIMEOUT_US passes after its first packet
+(checked whenever the stack polls the link) or on @ref EMBENET_BRT_Flush. Frames from the border router are not aggregated. Once
+enabled, every frame sent is made of records, also a packet too long to share a frame.
+
+Frames are queued whole or not at all: the encoded length of a frame is found before any of it is written to the output buffer, so a
+full buffer never leaves a truncated frame on the line. The stack sends with EMBENET_BRT_Send, which drops (and counts) the packets that
+do not fit. The application can check the space with @ref EMBENET_BRT_GetOutputSpace, or send with @ref EMBENET_BRT_TrySend and keep
+the packet itself until it is accepted. The output buffer is EMBENET_PORT_BRT_OUTPUT_BUFFER_SIZE bytes, by default much larger on the
+root (IS_ROOT), through which the whole uplink of the network leaves.
+
+The link keeps running statistics (@ref EMBENET_BRT_Stats) for sizing the buffers and the baud rate. The counters only grow (and wrap
+around), so the changes over a period are found by subtracting two readouts.
+
+*/
+
+#ifndef EMBENET_PORT_BRT_H_
+#define EMBENET_PORT_BRT_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Border router link statistics
+typedef struct {
+    uint32_t bytesIn;                   ///< number of bytes received
+    uint32_t bytesOut;                  ///< number of bytes queued for transmission (HDLC encoded)
+    uint32_t framesIn;                  ///< number of valid frames received
+    uint32_t framesOut;                 ///< number of frames sent
+    uint32_t crcErrors;                 ///< number of received frames dropped because of a wrong FCS
+    uint32_t framingErrors;             ///< number of received frames dropped because they were too short, or too long for the link or the receive buffer
+    uint32_t rxOverruns;                ///< number of received bytes lost because the input buffer was full
+    uint32_t txStalls;                  ///< number of raw bytes lost because the output buffer was full
+    uint32_t packetsDropped;            ///< number of packets sent by the stack and dropped because the output buffer had no room for them
+    uint32_t inputHighWatermark;        ///< highest number of bytes held in the input buffer
+    uint32_t outputHighWatermark;       ///< highest number of bytes held in the output buffer
+    uint32_t pendingFrameHighWatermark; ///< highest number of received frames waiting for the stack
+    uint32_t maxTransmissionTimeUs;     ///< longest time the transmission was continuously in progress [us]
+} EMBENET_BRT_Stats;
+
+/**
+ * @brief Gets the border router link statistics.
+ * @param[out] stats statistics since the startup
+ */
+void EMBENET_BRT_GetStats(EMBENET_BRT_Stats* stats);
+
+/**
+ * @brief Gets the number of complete frames received from the border router and not taken by the stack yet.
+ * @return number of frames
+ */
+size_t EMBENET_BRT_GetPendingFrameCount(void);
+
+/**
+ * @brief Gets the space left in the output buffer.
+ * @return length of the longest packet that is sure to be accepted by @ref EMBENET_BRT_TrySend now, 0 if the buffer is close to full
+ */
+size_t EMBENET_BRT_GetOutputSpace(void);
+
+/**
+ * @brief Sends data packet to LBR if there is room for it in the output buffer.
+ *
+ * Unlike EMBENET_BRT_Send, nothing is dropped: if the packet does not fit, the output buffer is left as it was and the caller may try
+ * again once the transmission frees some space.
+ * @param[in] packet data as byte-oriented buffer
+ * @param[in] packetLength in bytes
+ * @return true if the packet is queued for transmission, false if it does not fit
+ */
+bool EMBENET_BRT_TrySend(const void* packet, size_t packetLength);
+
+/**
+ * @brief Enables or disables the aggregated framing of the sent packets.
+ *
+ * Must be enabled only after the border router offers to take aggregated frames, which the root negotiates with it over UDP (see
+ * brt_aggregation.h in the demo). @ref EMBENET_BRT_Init, called by the stack whenever the link is re-established, disables it until
+ * the border router offers again. Disabling sends the packets aggregated so far. Has no effect unless EMBENET_PORT_BRT_AGGREGATION is set.
+ * @param[in] enabled true to aggregate the packets
+ */
+void EMBENET_BRT_SetAggregation(bool enabled);
+
+/**
+ * @brief Checks if the sent packets are aggregated.
+ * @return true if packets are aggregated
+ */
+bool EMBENET_BRT_IsAggregationEnabled(void);
+
+/**
+ * @brief Sends the packets aggregated so far right away. Does nothing if there are none, or if they do not fit in the output buffer
+ * yet, in which case they are sent once they do.
+ */
+void EMBENET_BRT_Flush(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EMBENET_PORT_BRT_H_
@@ -0,0 +1,66 @@
+/**
+@file
+@license   Commercial
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET Node port for nRF52832
+@brief     Frame-level CCM* authenticated encryption
+
+Encrypts and authenticates a whole frame in one call, as specified for IEEE 802.15.4 (CCM* with a 13 byte nonce and a 2 byte length
+field, MIC of 0, 4, 8 or 16 bytes). The blocks are encrypted by the ECB peripheral straight from a data structure owned by this module,
+holding the key given to the call, so the key used by the stack is not disturbed.
+
+The CCM peripheral of the nRF52832 cannot be used for this: it implements the Bluetooth LE flavour of CCM only (fixed 4 byte MIC, nonce
+made of a packet counter and an IV, a single byte of additional data), so neither the IEEE 802.15.4 nonce nor the MAC header as
+additional data fit in.
+
+*/
+
+#ifndef EMBENET_PORT_CCM_H_
+#define EMBENET_PORT_CCM_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EMBENET_CCM_NONCE_SIZE 13 ///< size of the nonce [bytes]
+
+/**
+ * @brief Encrypts and authenticates a frame.
+ * @param[in] key 16 byte key
+ * @param[in] nonce nonce, must never be reused with the same key
+ * @param[in] aData additional data, authenticated but not encrypted (e.g. the MAC header), may be NULL if aDataLength is 0
+ * @param[in] aDataLength length of the additional data [bytes]
+ * @param[in,out] mData data to encrypt, overwritten with the ciphertext, may be NULL if mDataLength is 0
+ * @param[in] mDataLength length of the data to encrypt [bytes]
+ * @param[out] mic place for the MIC
+ * @param[in] micLength length of the MIC: 0 (encryption only), 4, 8 or 16 [bytes]
+ * @return true on success, false if the arguments are invalid
+ */
+bool EMBENET_CCM_Encrypt(uint8_t const key[16U], uint8_t const nonce[EMBENET_CCM_NONCE_SIZE], uint8_t const* aData, size_t aDataLength, uint8_t* mData,
+                         size_t mDataLength, uint8_t* mic, size_t micLength);
+
+/**
+ * @brief Decrypts a frame and checks its authenticity.
+ * @param[in] key 16 byte key
+ * @param[in] nonce nonce the frame was encrypted with
+ * @param[in] aData additional data, may be NULL if aDataLength is 0
+ * @param[in] aDataLength length of the additional data [bytes]
+ * @param[in,out] mData data to decrypt, overwritten with the plaintext, may be NULL if mDataLength is 0
+ * @param[in] mDataLength length of the data to decrypt [bytes]
+ * @param[in] mic received MIC
+ * @param[in] micLength length of the MIC: 0 (encryption only), 4, 8 or 16 [bytes]
+ * @return true if the MIC matches, false if it does not (the plaintext must be discarded then) or the arguments are invalid
+ */
+bool EMBENET_CCM_Decrypt(uint8_t const key[16U], uint8_t const nonce[EMBENET_CCM_NONCE_SIZE], uint8_t const* aData, size_t aDataLength, uint8_t* mData,
+                         size_t mDataLength, uint8_t const* mic, size_t micLength);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EMBENET_PORT_CCM_H_
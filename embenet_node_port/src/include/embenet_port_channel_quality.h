@@ -0,0 +1,113 @@
+/**
+@file
+@license   Commercial
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET Node port for nRF52832
+@brief     Per-channel link quality statistics and channel blacklisting
+
+The port keeps reception (CRC, RSSI) and transmission (acknowledged or not) statistics for every data channel. Periodic evaluation
+of these statistics yields a proposed blacklist of channels with poor link quality. Once a blacklist is applied, the radio port
+transparently remaps every blacklisted channel requested by the stack onto a good channel. The remapping is a pure function of
+the blacklist and the ASN, so all nodes that apply the same blacklist hop over the same set of physical channels and stay in sync;
+in a given slot, cells with different channel offsets below EMBENET_CHANNEL_QUALITY_CHANNEL_OFFSETS never share a channel. Good
+channels are never remapped, so a node that has not applied the blacklist yet still meets the others on them.
+
+*/
+
+#ifndef EMBENET_PORT_CHANNEL_QUALITY_H_
+#define EMBENET_PORT_CHANNEL_QUALITY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Number of data channels covered by the statistics (channels 0 - 36)
+#define EMBENET_CHANNEL_QUALITY_CHANNEL_COUNT 37
+
+/// Bit mask of data channels, bit n corresponds to channel n
+typedef uint64_t EMBENET_ChannelMask;
+
+/// Link quality statistics of a single data channel
+typedef struct {
+    uint32_t rxOk;        ///< number of frames received with valid CRC
+    uint32_t rxCrcError;  ///< number of frames received with invalid CRC
+    uint32_t tx;          ///< number of transmitted frames
+    uint32_t txNoAck;     ///< number of transmitted frames that were not acknowledged
+    int8_t   rssi;        ///< average RSSI of frames received on this channel [dBm]
+    uint8_t  score;       ///< link quality score, from 0 (worst) to 255 (best)
+    bool     blacklisted; ///< true if the channel is currently blacklisted
+} EMBENET_ChannelQualityStats;
+
+/**
+ * @brief Gets the Absolute Slot Number of the slot being processed by the stack.
+ * @note Called from the radio driver, in the context of the stack slot processing.
+ */
+typedef uint64_t (*EMBENET_CHANNEL_QUALITY_AsnSource)(void);
+
+/**
+ * @brief Clears all statistics and removes the blacklist.
+ */
+void EMBENET_CHANNEL_QUALITY_Reset(void);
+
+/**
+ * @brief Accounts a missing acknowledgement to the channel of the last transmission.
+ *
+ * Intended to be called from the @ref EMBENET_TRACE_PacketNoAck trace handler.
+ */
+void EMBENET_CHANNEL_QUALITY_OnPacketNoAck(void);
+
+/**
+ * @brief Gets the statistics of the given data channel.
+ * @param[in] channel data channel
+ * @param[out] stats statistics of the channel
+ * @retval true statistics were returned
+ * @retval false channel is not a data channel
+ */
+bool EMBENET_CHANNEL_QUALITY_GetStats(uint8_t channel, EMBENET_ChannelQualityStats* stats);
+
+/**
+ * @brief Evaluates the statistics gathered since the previous evaluation and proposes a new blacklist.
+ *
+ * Channels whose score drops below @ref EMBENET_CHANNEL_QUALITY_BAD_SCORE are proposed for blacklisting, worst first, as long as at
+ * least @ref EMBENET_CHANNEL_QUALITY_MIN_CHANNELS channels remain. A blacklisted channel is proposed for re-admission after it spent
+ * @ref EMBENET_CHANNEL_QUALITY_PROBATION_PERIODS evaluation periods on the blacklist. The proposal is not applied automatically.
+ *
+ * @return proposed blacklist
+ */
+EMBENET_ChannelMask EMBENET_CHANNEL_QUALITY_Evaluate(void);
+
+/**
+ * @brief Sets the source of the ASN the remapping depends on, usually EMBENET_NODE_GetNetworkAsn.
+ *
+ * No channel is remapped until the source is set.
+ *
+ * @param[in] source ASN source
+ */
+void EMBENET_CHANNEL_QUALITY_SetAsnSource(EMBENET_CHANNEL_QUALITY_AsnSource source);
+
+/**
+ * @brief Applies a blacklist.
+ *
+ * The blacklist has to be the same on all nodes of the network, so it is usually distributed by the application.
+ *
+ * @param[in] blacklist channels to blacklist, bits above the last data channel are ignored
+ * @retval true the blacklist was applied
+ * @retval false the blacklist leaves less than @ref EMBENET_CHANNEL_QUALITY_MIN_CHANNELS channels, it was not applied
+ */
+bool EMBENET_CHANNEL_QUALITY_SetBlacklist(EMBENET_ChannelMask blacklist);
+
+/**
+ * @brief Gets the blacklist currently applied.
+ * @return blacklist
+ */
+EMBENET_ChannelMask EMBENET_CHANNEL_QUALITY_GetBlacklist(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EMBENET_PORT_CHANNEL_QUALITY_H_
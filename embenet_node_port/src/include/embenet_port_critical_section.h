@@ -0,0 +1,38 @@
+/**
+@file
+@license   Commercial
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET Node port for nRF52832
+@brief     Critical section measurements
+
+With EMBENET_PORT_CRITICAL_SECTION_MEASURE, the duration of every outermost critical section is measured with the DWT cycle counter and the
+longest one is kept: it is the worst-case latency the critical sections add to the masked interrupts (the radio and the timer among them).
+
+*/
+
+#ifndef EMBENET_PORT_CRITICAL_SECTION_H_
+#define EMBENET_PORT_CRITICAL_SECTION_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Gets the longest time interrupts were masked by a critical section.
+ * @return longest critical section since the startup or the last reset [us], 0 if the measurement is not enabled
+ */
+uint32_t EMBENET_CRITICAL_SECTION_GetMaxMaskedTimeUs(void);
+
+/**
+ * @brief Restarts the measurement of the longest critical section.
+ */
+void EMBENET_CRITICAL_SECTION_ResetMaxMaskedTime(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EMBENET_PORT_CRITICAL_SECTION_H_
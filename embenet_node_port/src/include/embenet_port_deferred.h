@@ -0,0 +1,87 @@
+/**
+@file
+@license   Commercial
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET Node port for nRF52832
+@brief     Deferred work
+
+Lets an interrupt handler do only the time-critical part of its job (e.g. capturing a timestamp) and hand the rest over to a software
+interrupt of lower priority. There are two levels: EMBENET_DEFERRED_LEVEL_HIGH runs right below the radio and the MAC timer, so it never
+delays them but still preempts the virtual timers and the application, EMBENET_DEFERRED_LEVEL_LOW runs below everything except the debug
+peripherals (see INTERRUPT_PRIORITY_DEFERRED_HIGH/LOW).
+
+Work items are provided by the user. Posting is lock-free and can be done from any context, including interrupts above
+INTERRUPT_PRIORITY_CRITICAL_SECTION: an item is linked into the queue of its level with a compare-and-swap and the software interrupt is
+pended. Items posted again before they run are coalesced and run once, so data handed over with an item should be kept next to it, e.g.
+in a structure embedding the item, and accumulated rather than overwritten. Within a level, items run in the order they were posted.
+
+*/
+
+#ifndef EMBENET_PORT_DEFERRED_H_
+#define EMBENET_PORT_DEFERRED_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Priority level the deferred work runs at
+typedef enum {
+    EMBENET_DEFERRED_LEVEL_HIGH = 0, ///< right below the radio and the MAC timer
+    EMBENET_DEFERRED_LEVEL_LOW  = 1, ///< below everything except the debug peripherals
+    EMBENET_DEFERRED_LEVEL_COUNT
+} EMBENET_DEFERRED_Level;
+
+/**
+ * @brief Deferred work function.
+ * @note Called from the software interrupt of the level of the work item.
+ * @param[in] context context given to @ref EMBENET_DEFERRED_Setup
+ */
+typedef void (*EMBENET_DEFERRED_Function)(void* context);
+
+/// Deferred work item, the storage is provided by the user and must stay valid while the item is posted
+typedef struct EMBENET_DEFERRED_Work {
+    EMBENET_DEFERRED_Function              function; ///< called when the item runs
+    void*                                  context;  ///< passed to the function
+    EMBENET_DEFERRED_Level                 level;    ///< level the item runs at
+    volatile bool                          pending;  ///< true from posting until the function is called
+    struct EMBENET_DEFERRED_Work* volatile next;     ///< next item in the queue
+} EMBENET_DEFERRED_Work;
+
+/**
+ * @brief Initializes the deferred work queues and their software interrupts.
+ */
+void EMBENET_DEFERRED_Init(void);
+
+/**
+ * @brief Prepares a work item. Must not be called while the item is pending.
+ * @param[in] work work item
+ * @param[in] level level the item runs at
+ * @param[in] function called when the item runs
+ * @param[in] context passed to the function
+ */
+void EMBENET_DEFERRED_Setup(EMBENET_DEFERRED_Work* work, EMBENET_DEFERRED_Level level, EMBENET_DEFERRED_Function function, void* context);
+
+/**
+ * @brief Posts a work item to run at its level. Can be called from any context.
+ * @param[in] work work item prepared with @ref EMBENET_DEFERRED_Setup
+ * @retval true the item was queued
+ * @retval false the item was already pending, it runs once for both posts
+ */
+bool EMBENET_DEFERRED_Post(EMBENET_DEFERRED_Work* work);
+
+/**
+ * @brief Checks if a work item is waiting to run.
+ * @param[in] work work item
+ * @return true from posting until its function is called
+ */
+bool EMBENET_DEFERRED_IsPending(EMBENET_DEFERRED_Work const* work);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EMBENET_PORT_DEFERRED_H_
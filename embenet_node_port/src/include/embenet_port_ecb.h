@@ -0,0 +1,90 @@
+/**
+ @file
+ @license   Commercial
+ @copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+ @version   1.1.4417
+ @purpose   ECB engine.
+ @brief     Shared access to the AES ECB peripheral.
+
+ The ECB peripheral reads the key and the cleartext from, and writes the ciphertext to, a data structure pointed to by ECBDATAPTR. Every
+ user keeps its own structure, so the key does not have to be reprogrammed when users take turns, and the pointer is set for each
+ block. Blocks are encrypted with interrupts disabled (about 7us each), so users in interrupts and in the main loop cannot interleave.
+
+ Many blocks (e.g. a CTR keystream) can also be encrypted in a batch, without blocking: the blocks are chained off the ENDECB interrupt
+ and a callback tells when all of them are done, so the CPU is free in the meantime. A single block encrypted in between by
+ @ref EMBENET_ECB_Run waits for the batch block in progress and does not disturb the batch.
+
+ */
+
+#ifndef EMBENET_PORT_ECB_H_
+#define EMBENET_PORT_ECB_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// ECB data structure, as read and written by the peripheral (word aligned)
+typedef struct {
+    uint8_t key[16];        ///< key, most significant byte first
+    uint8_t cleartext[16];  ///< block to encrypt
+    uint8_t ciphertext[16]; ///< encrypted block
+} __attribute__((aligned(4))) EMBENET_ECB_Block;
+
+/**
+ * @brief Batch completion callback.
+ * @note Called from the ECB interrupt (see INTERRUPT_PRIORITY_ECB).
+ * @param[in] context context passed to @ref EMBENET_ECB_StartBatch
+ * @param[in] success true if all the blocks were encrypted, false if the batch was aborted by a peripheral of higher priority (CCM, AAR)
+ *                    or by @ref EMBENET_ECB_Init
+ */
+typedef void (*EMBENET_ECB_BatchCallback)(void* context, bool success);
+
+/// Batch descriptor, the storage is provided by the user and must stay valid until the batch is complete
+typedef struct {
+    EMBENET_ECB_Block         ecb;        ///< ECB data structure the blocks are encrypted in
+    uint8_t*                  blocks;     ///< blocks to encrypt in place, 16 bytes each
+    size_t                    blockCount; ///< number of blocks
+    size_t                    done;       ///< number of blocks encrypted so far
+    EMBENET_ECB_BatchCallback callback;   ///< called on completion
+    void*                     context;    ///< passed to the callback
+} EMBENET_ECB_Batch;
+
+/**
+ * @brief Initializes the ECB peripheral. A batch in progress is aborted.
+ */
+void EMBENET_ECB_Init(void);
+
+/**
+ * @brief Starts encrypting blocks in a batch.
+ * @param[in] batch batch descriptor
+ * @param[in] key 16 byte key
+ * @param[in,out] blocks blocks to encrypt, overwritten with the ciphertext, must stay valid until the batch is complete
+ * @param[in] blockCount number of blocks
+ * @param[in] callback called when all the blocks are encrypted
+ * @param[in] context passed to the callback
+ * @return true if the batch is started, false if the arguments are invalid or another batch is in progress
+ */
+bool EMBENET_ECB_StartBatch(EMBENET_ECB_Batch* batch, uint8_t const key[16U], uint8_t* blocks, size_t blockCount, EMBENET_ECB_BatchCallback callback, void* context);
+
+/**
+ * @brief Checks if a batch is in progress.
+ * @return true if a batch is in progress
+ */
+bool EMBENET_ECB_IsBatchActive(void);
+
+/**
+ * @brief Encrypts the cleartext of the given data structure into its ciphertext.
+ * @param[in,out] block ECB data structure
+ * @return true on success, false if the encryption was aborted by a peripheral of higher priority (CCM, AAR)
+ */
+bool EMBENET_ECB_Run(EMBENET_ECB_Block* block);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EMBENET_PORT_ECB_H_
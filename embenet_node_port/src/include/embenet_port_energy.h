@@ -0,0 +1,41 @@
+/**
+@file
+@license   Commercial
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET Node port for nRF52832
+@brief     Energy model of the board
+
+Currents of the nRF52832 on the nRF52-DK (3V, DC/DC regulator enabled) and the charge of the radio preparations, as measured for the port.
+They turn the time spent in each state (as given by EMBENET_NODE_DIAG_GetRadioDutyCycleRaw and @ref EMBENET_IDLE_GetSleepTime) into
+charge. The radio preparation (ramp-up, from the enable to the ready state) is accounted per operation instead of by time. Boards with a
+different supply or regulator override the values at build time.
+
+*/
+
+#ifndef EMBENET_PORT_ENERGY_H_
+#define EMBENET_PORT_ENERGY_H_
+
+#ifndef EMBENET_ENERGY_IDLE_CURRENT_UA
+#    define EMBENET_ENERGY_IDLE_CURRENT_UA 5 ///< system idle, RTC running, RAM retained [uA]
+#endif
+#ifndef EMBENET_ENERGY_CPU_CURRENT_UA
+#    define EMBENET_ENERGY_CPU_CURRENT_UA 3700 ///< CPU running from flash, on top of the idle current [uA]
+#endif
+#ifndef EMBENET_ENERGY_TX_CURRENT_UA
+#    define EMBENET_ENERGY_TX_CURRENT_UA 17500 ///< radio transmitting [uA]
+#endif
+#ifndef EMBENET_ENERGY_RX_CURRENT_UA
+#    define EMBENET_ENERGY_RX_CURRENT_UA 13000 ///< radio listening or receiving [uA]
+#endif
+#ifndef EMBENET_ENERGY_TX_PREPARATION_PAH
+#    define EMBENET_ENERGY_TX_PREPARATION_PAH 2000 ///< preparation of a transmission, 8mA for 450us + 600us [pAh]
+#endif
+#ifndef EMBENET_ENERGY_RX_PREPARATION_PAH
+#    define EMBENET_ENERGY_RX_PREPARATION_PAH 500 ///< preparation of a reception, 7.8mA for 560us [pAh]
+#endif
+#ifndef EMBENET_ENERGY_TX_NO_FRAME_PREPARATION_PAH
+#    define EMBENET_ENERGY_TX_NO_FRAME_PREPARATION_PAH 750 ///< preparation of a transmission with no frame to send, 7.8mA for 330us [pAh]
+#endif
+
+#endif // EMBENET_PORT_ENERGY_H_
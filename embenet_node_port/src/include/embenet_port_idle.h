@@ -0,0 +1,66 @@
+/**
+@file
+@license   Commercial
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET Node port for nRF52832
+@brief     Idle support for the main loop
+
+Everything the stack does between slots is started by an interrupt: the MAC timer, the radio, the BRT UART or a virtual timer. The main
+loop can therefore sleep after EMBENET_NODE_Proc until the next interrupt. @ref EMBENET_IDLE_Sleep waits for an event (WFE) instead of an
+interrupt: the event register is set by every interrupt taken since the previous WFE, so an interrupt that came after the main loop last
+checked for work makes the CPU return immediately instead of being lost. A periodic wakeup (EMBENET_PORT_IDLE_MAX_SLEEP_US) bounds the
+latency of work that is polled from the main loop rather than signalled by an interrupt.
+
+*/
+
+#ifndef EMBENET_PORT_IDLE_H_
+#define EMBENET_PORT_IDLE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initializes the idle support.
+ *
+ * Must be called after @ref EMBENET_VTIMER_Init.
+ */
+void EMBENET_IDLE_Init(void);
+
+/**
+ * @brief Checks if the port has work queued for EMBENET_NODE_Proc that is not signalled by an interrupt (e.g. received BRT frames).
+ * @return true if EMBENET_NODE_Proc should be called again before sleeping
+ */
+bool EMBENET_IDLE_HasPendingWork(void);
+
+/**
+ * @brief Gets the time left until the next interrupt the port has scheduled: the MAC timer compare or a virtual timer.
+ *
+ * Radio, UART and GPIO interrupts may come earlier.
+ *
+ * @return time to the next scheduled interrupt [us], 0 if it is already due, UINT32_MAX if nothing is scheduled
+ */
+uint32_t EMBENET_IDLE_GetTimeToNextDeadline(void);
+
+/**
+ * @brief Puts the CPU to sleep until the next interrupt, unless there is pending work (see @ref EMBENET_IDLE_HasPendingWork).
+ *
+ * Meant to be called at the end of every main loop iteration, from thread mode and outside of critical sections.
+ */
+void EMBENET_IDLE_Sleep(void);
+
+/**
+ * @brief Gets the total time spent in @ref EMBENET_IDLE_Sleep, including the interrupts that ended the sleep.
+ * @return time slept since the startup [us]
+ */
+uint64_t EMBENET_IDLE_GetSleepTime(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EMBENET_PORT_IDLE_H_
@@ -0,0 +1,88 @@
+/**
+@file
+@license   Commercial
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET Node port for nRF52832
+@brief     Non-volatile key-value store in flash
+
+Small values (e.g. credentials, calibration) are kept in the flash pages the linker script reserves for the store (the NVM memory region,
+between __start_embenet_nvm and __stop_embenet_nvm). The store is log-structured: a write appends a new record to the active page and a
+read returns the last valid record of the key, so a value is never rewritten in place. When the active page is full, the latest values
+are copied to the next page, which becomes the active one, so the pages are erased in turn and wear evenly. Every record ends with a
+CRC written last and the header of a page is written after the values are copied into it, so a record or a compaction interrupted by a
+reset is ignored and the previous values are kept.
+
+Writing a word takes about 41us and erasing a page about 85ms, during which the CPU is stalled, interrupts included. Writes should be
+made in the free windows of the schedule, and the store compacted with @ref EMBENET_NVM_Compact while the node is not in the network.
+*/
+
+#ifndef EMBENET_PORT_NVM_H_
+#define EMBENET_PORT_NVM_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EMBENET_NVM_MAX_VALUE_SIZE 256    ///< longest value [bytes]
+#define EMBENET_NVM_KEY_INVALID    0xFFFF ///< key that cannot be used
+
+/**
+ * @brief Initializes the store, formatting it if it holds no valid page.
+ * @return true on success, false if the linker script reserves less than two pages
+ */
+bool EMBENET_NVM_Init(void);
+
+/**
+ * @brief Reads a value.
+ * @param[in] key key of the value
+ * @param[out] value place for the value, may be NULL to get the length only
+ * @param[in] size size of the place [bytes], the value is truncated to it
+ * @return length of the stored value [bytes], 0 if there is no value
+ */
+size_t EMBENET_NVM_Read(uint16_t key, void* value, size_t size);
+
+/**
+ * @brief Writes a value, compacting the store first if the active page is full.
+ * @param[in] key key of the value
+ * @param[in] value value
+ * @param[in] length length of the value, 1 to EMBENET_NVM_MAX_VALUE_SIZE [bytes]
+ * @return true if written, false otherwise
+ */
+bool EMBENET_NVM_Write(uint16_t key, void const* value, size_t length);
+
+/**
+ * @brief Deletes a value.
+ * @param[in] key key of the value
+ * @return true if deleted or not stored, false otherwise
+ */
+bool EMBENET_NVM_Delete(uint16_t key);
+
+/**
+ * @brief Gets the space left in the active page, i.e. how much can be written before a compaction erases a page.
+ * @return free space [bytes]
+ */
+size_t EMBENET_NVM_GetFreeSpace(void);
+
+/**
+ * @brief Gets the space a write of the given length takes.
+ * @param[in] length length of the value [bytes]
+ * @return space taken in the page [bytes]
+ */
+size_t EMBENET_NVM_GetRecordSize(size_t length);
+
+/**
+ * @brief Copies the latest values to the next page and erases it first.
+ * @return true on success, false otherwise
+ */
+bool EMBENET_NVM_Compact(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EMBENET_PORT_NVM_H_
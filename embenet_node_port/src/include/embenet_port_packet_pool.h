@@ -0,0 +1,90 @@
+/**
+@file
+@license   Commercial
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET Node port for nRF52832
+@brief     Pool of reference-counted packet buffers shared by the radio and the application
+
+The pool is a fixed array of EMBENET_PORT_PACKET_POOL_BLOCK_COUNT blocks of @ref EMBENET_PACKET_POOL_BLOCK_SIZE bytes, each with a
+reference count. A block is free while its count is zero. The radio receives and transmits in place in pool blocks (see
+@ref EMBENET_RADIO_TakeReceivedFrame), so one block can carry a frame from the radio to the application and the border router link,
+and back, without being copied: every holder takes a reference and gives it back when done, and the last one frees the block.
+
+Every function accepts a pointer anywhere inside a block, so a holder may keep a pointer to the part of the packet it handles (e.g. the
+payload after the headers). All functions may be called from interrupts that are allowed to use the critical section.
+
+*/
+
+#ifndef EMBENET_PORT_PACKET_POOL_H_
+#define EMBENET_PORT_PACKET_POOL_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Size of a block: a radio frame, the LENGTH field and the longest PSDU, padded to a word [bytes]
+#define EMBENET_PACKET_POOL_BLOCK_SIZE 132
+
+/// Packet pool statistics
+typedef struct {
+    uint32_t blockCount;    ///< number of blocks in the pool
+    uint32_t inUse;         ///< number of blocks allocated now
+    uint32_t highWatermark; ///< largest number of blocks allocated at once since the startup or the last reset
+    uint32_t allocFailures; ///< number of allocations that found no free block, only grows
+} EMBENET_PacketPoolStats;
+
+/**
+ * @brief Allocates a block, with a single reference held by the caller.
+ * @return beginning of @ref EMBENET_PACKET_POOL_BLOCK_SIZE bytes of storage or NULL if no block is free
+ */
+uint8_t* EMBENET_PACKET_POOL_Alloc(void);
+
+/**
+ * @brief Takes another reference to an allocated block.
+ * @param[in] data pointer into the block
+ * @retval true the reference was taken
+ * @retval false data is not in an allocated block or the reference count is at its limit
+ */
+bool EMBENET_PACKET_POOL_Retain(void const* data);
+
+/**
+ * @brief Gives back a reference to a block. The block is freed when the last reference is given back.
+ * @param[in] data pointer into the block
+ */
+void EMBENET_PACKET_POOL_Release(void const* data);
+
+/**
+ * @brief Finds the allocated block that holds the given data.
+ * @param[in] data pointer
+ * @return beginning of the block or NULL if data is not in an allocated block
+ */
+uint8_t* EMBENET_PACKET_POOL_GetBlock(void const* data);
+
+/**
+ * @brief Gets the number of references to a block.
+ * @param[in] data pointer into the block
+ * @return reference count, 0 if the block is free or data is not in the pool
+ */
+unsigned EMBENET_PACKET_POOL_GetRefCount(void const* data);
+
+/**
+ * @brief Gets the pool statistics.
+ * @param[out] stats statistics
+ */
+void EMBENET_PACKET_POOL_GetStats(EMBENET_PacketPoolStats* stats);
+
+/**
+ * @brief Restarts the high-watermark from the number of blocks allocated now.
+ */
+void EMBENET_PACKET_POOL_ResetHighWatermark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EMBENET_PORT_PACKET_POOL_H_
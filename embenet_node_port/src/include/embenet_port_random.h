@@ -0,0 +1,33 @@
+/**
+@file
+@license   Commercial
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET Node port for nRF52832
+@brief     Seeding of the random number generator
+
+The random number generator (EMBENET_RANDOM_Get) needs a seed from the RNG peripheral, which takes a few ms to collect. The seed is
+collected by @ref EMBENET_RANDOM_Init at startup, so that no draw has to wait for it. A draw made before still works: it collects the
+seed itself, outside of the critical section, so only the caller waits.
+
+*/
+
+#ifndef EMBENET_PORT_RANDOM_H_
+#define EMBENET_PORT_RANDOM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Collects the seed of the random number generator, waiting for the RNG (a few ms).
+ *
+ * Meant to be called once at startup, from the main loop, before the stack is initialized. Does nothing once the seed is collected.
+ */
+void EMBENET_RANDOM_Init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EMBENET_PORT_RANDOM_H_
@@ -0,0 +1,83 @@
+/**
+@file
+@license   Commercial
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET Node port for nRF52832
+@brief     Virtual timers
+
+Any number of one-shot or periodic timers multiplexed on a single auxiliary compare channel of the port timer, independent of the
+MAC timer. The timers are kept in a list sorted by deadline, the compare channel is always armed for the earliest one. The compare
+event is routed through PPI to an event generator unit, so expired timers are dispatched from a low priority interrupt and never
+delay the MAC timer or the radio.
+
+*/
+
+#ifndef EMBENET_PORT_VTIMER_H_
+#define EMBENET_PORT_VTIMER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Virtual timer callback.
+ * @note Called from the virtual timer interrupt (see INTERRUPT_PRIORITY_VTIMER).
+ * @param[in] context context passed to @ref EMBENET_VTIMER_Start
+ */
+typedef void (*EMBENET_VTIMER_Callback)(void* context);
+
+/// Virtual timer descriptor, the storage is provided by the user and must stay valid while the timer is active
+typedef struct EMBENET_VTIMER_Timer {
+    uint64_t                     deadline; ///< expiration time [port timer ticks]
+    uint32_t                     period;   ///< period [port timer ticks], 0 for one-shot timers
+    EMBENET_VTIMER_Callback      callback; ///< called on expiration
+    void*                        context;  ///< passed to the callback
+    bool                         active;   ///< true while the timer is in the queue
+    struct EMBENET_VTIMER_Timer* next;     ///< next timer in the queue
+} EMBENET_VTIMER_Timer;
+
+/**
+ * @brief Initializes the virtual timers.
+ *
+ * Must be called after the port timer is initialized (i.e. after EMBENET_NODE_Init).
+ */
+void EMBENET_VTIMER_Init(void);
+
+/**
+ * @brief Starts (or restarts) a virtual timer.
+ * @param[in] timer timer descriptor
+ * @param[in] delayUs time to the first expiration [us]
+ * @param[in] periodUs period of the following expirations [us], 0 for a one-shot timer
+ * @param[in] callback called on every expiration
+ * @param[in] context passed to the callback
+ */
+void EMBENET_VTIMER_Start(EMBENET_VTIMER_Timer* timer, uint32_t delayUs, uint32_t periodUs, EMBENET_VTIMER_Callback callback, void* context);
+
+/**
+ * @brief Stops a virtual timer. Does nothing if the timer is not active.
+ * @param[in] timer timer descriptor
+ */
+void EMBENET_VTIMER_Stop(EMBENET_VTIMER_Timer* timer);
+
+/**
+ * @brief Checks if a virtual timer is active.
+ * @param[in] timer timer descriptor
+ * @return true if the timer is going to expire
+ */
+bool EMBENET_VTIMER_IsActive(EMBENET_VTIMER_Timer const* timer);
+
+/**
+ * @brief Gets the time left until the earliest active timer expires.
+ * @return time to the next expiration [us], 0 if a timer is already due, UINT32_MAX if no timer is active
+ */
+uint32_t EMBENET_VTIMER_GetTimeToNextExpiration(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EMBENET_PORT_VTIMER_H_
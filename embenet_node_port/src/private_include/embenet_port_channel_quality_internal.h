@@ -0,0 +1,48 @@
+/**
+ @file
+ @license   Commercial
+ @copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+ @version   1.1.4417
+ @purpose   Channel quality internal functions.
+ @brief     Channel quality functionalities used by the radio port.
+
+ */
+
+#ifndef EMBENET_PORT_CHANNEL_QUALITY_INTERNAL_H_
+#define EMBENET_PORT_CHANNEL_QUALITY_INTERNAL_H_
+
+#include "embenet_port_channel_quality.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Maps the channel requested by the stack onto the physical channel according to the applied blacklist and the current ASN.
+ * @param[in] channel channel requested by the stack
+ * @return physical channel to tune to, advertising channels are returned unchanged
+ */
+uint8_t EMBENET_CHANNEL_QUALITY_Map(uint8_t channel);
+
+/**
+ * @brief Accounts a transmission on the given physical channel.
+ * @param[in] channel physical channel
+ */
+void EMBENET_CHANNEL_QUALITY_OnTx(uint8_t channel);
+
+/**
+ * @brief Accounts a reception on the given physical channel.
+ * @param[in] channel physical channel
+ * @param[in] crcValid true if the received frame had a valid CRC
+ * @param[in] rssi RSSI of the received frame [dBm]
+ */
+void EMBENET_CHANNEL_QUALITY_OnRx(uint8_t channel, bool crcValid, int8_t rssi);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EMBENET_PORT_CHANNEL_QUALITY_INTERNAL_H_
@@ -26,6 +26,57 @@
 
 #define EMBENET_BRT_MAX_FRAME_SIZE 200 // EMBENET_BRT_MAX_DATA_SIZE + HDLC markings + CRC
 
+#ifndef EMBENET_PORT_BRT_AGGREGATION
+#    if defined(IS_ROOT) && (1 == IS_ROOT)
+#        define EMBENET_PORT_BRT_AGGREGATION 1 // 1: packets may be aggregated into shared frames once enabled with EMBENET_BRT_SetAggregation
+#    else
+#        define EMBENET_PORT_BRT_AGGREGATION 0 // only the root has a border router link
+#    endif
+#endif
+#ifndef EMBENET_PORT_BRT_AGGREGATION_TIMEOUT_US
+#    define EMBENET_PORT_BRT_AGGREGATION_TIMEOUT_US 2000 // an aggregated frame is sent at the latest this long after its first packet [us]
+#endif
+#ifndef EMBENET_PORT_BRT_OUTPUT_BUFFER_SIZE
+#    if defined(IS_ROOT) && (1 == IS_ROOT)
+#        define EMBENET_PORT_BRT_OUTPUT_BUFFER_SIZE 2048 // the whole uplink of the network leaves the root through this buffer, power of two
+#    else
+#        define EMBENET_PORT_BRT_OUTPUT_BUFFER_SIZE 512 // output buffer size, at least the longest frame with every byte escaped, power of two
+#    endif
+#endif
+
+// ###################################################################################################
+//  Critical section
+// ###################################################################################################
+
+#ifndef EMBENET_PORT_CRITICAL_SECTION_BASEPRI
+#    define EMBENET_PORT_CRITICAL_SECTION_BASEPRI 1 // 1: mask only INTERRUPT_PRIORITY_CRITICAL_SECTION and below (BASEPRI), 0: mask all interrupts (PRIMASK)
+#endif
+#ifndef EMBENET_PORT_CRITICAL_SECTION_MEASURE
+#    define EMBENET_PORT_CRITICAL_SECTION_MEASURE 0 // 1: measure the longest critical section with the DWT cycle counter
+#endif
+
+// ###################################################################################################
+//  AES-128
+// ###################################################################################################
+
+#ifndef EMBENET_PORT_AES128_STACK_KEY_CACHE_SIZE
+#    define EMBENET_PORT_AES128_STACK_KEY_CACHE_SIZE 3 // number of keys set by the stack kept expanded (network key, PSK, K1)
+#endif
+#ifndef EMBENET_PORT_AES128_KEY_POOL_SIZE
+#    define EMBENET_PORT_AES128_KEY_POOL_SIZE 4 // number of keys the application can create
+#endif
+
+// ###################################################################################################
+//  Random numbers
+// ###################################################################################################
+
+#ifndef EMBENET_PORT_RANDOM_BUFFER_BLOCKS
+#    define EMBENET_PORT_RANDOM_BUFFER_BLOCKS 4 // 16 byte blocks of DRBG output generated ahead in the background, even, at least 2
+#endif
+#ifndef EMBENET_PORT_RANDOM_RESEED_BLOCKS
+#    define EMBENET_PORT_RANDOM_RESEED_BLOCKS 256 // the DRBG is reseeded with fresh entropy after generating this many blocks
+#endif
+
 // ###################################################################################################
 //  Timer
 // ###################################################################################################
@@ -34,4 +85,118 @@
 #define EMBENET_PORT_TIMER_IRQn        RTC1_IRQn
 #define EMBENET_PORT_TIMER_IRQ_HANDLER RTC1_IRQHandler
 
+#define EMBENET_PORT_TIMER_CC_MAC         0 // compare channel used by EMBENET_TIMER_SetCompare
+#define EMBENET_PORT_TIMER_CC_RADIO_START 1 // compare channel used for scheduled radio start
+#define EMBENET_PORT_TIMER_CC_HFXO        2 // compare channel used for predictive HFXO start
+#define EMBENET_PORT_TIMER_CC_VTIMER      3 // compare channel used by virtual timers
+
+// ###################################################################################################
+//  Radio scheduled start (RTC compare -> TIMER start -> TIMER compare -> RADIO TXEN/RXEN)
+// ###################################################################################################
+
+#define EMBENET_PORT_RADIO_START_TIMER     NRF_TIMER1       // TIMER counting the sub-tick remainder of the start time
+#define EMBENET_PORT_RADIO_START_PPI_RTC   NRF_PPI_CHANNEL0 // RTC compare event -> TIMER start task
+#define EMBENET_PORT_RADIO_START_PPI_TIMER NRF_PPI_CHANNEL1 // TIMER compare event -> RADIO TXEN/RXEN task
+
+// ###################################################################################################
+//  Radio event timestamps (RADIO ADDRESS/END -> TIMER capture, pre-programmed PPI channels)
+// ###################################################################################################
+
+#define EMBENET_PORT_RADIO_TIMESTAMP_TIMER       NRF_TIMER0        // 1MHz TIMER running while the radio is active
+#define EMBENET_PORT_RADIO_TIMESTAMP_PPI_ADDRESS NRF_PPI_CHANNEL26 // fixed: RADIO ADDRESS event -> TIMER0 CAPTURE[1] task
+#define EMBENET_PORT_RADIO_TIMESTAMP_PPI_END     NRF_PPI_CHANNEL27 // fixed: RADIO END event -> TIMER0 CAPTURE[2] task
+
+// ###################################################################################################
+//  Radio calibration (RADIO events -> TIMER capture, on request)
+// ###################################################################################################
+
+#ifndef EMBENET_PORT_RADIO_CALIBRATION
+#    define EMBENET_PORT_RADIO_CALIBRATION 0 // 1: the radio timings are also measured at init, 0: only when EMBENET_RADIO_Calibrate is called
+#endif
+#ifndef EMBENET_PORT_RADIO_CALIBRATION_ROUNDS
+#    define EMBENET_PORT_RADIO_CALIBRATION_ROUNDS 4 // measurements of every timing, the longest one is kept
+#endif
+#ifndef EMBENET_PORT_RADIO_CALIBRATION_MARGIN_US
+#    define EMBENET_PORT_RADIO_CALIBRATION_MARGIN_US 10 // added to the measured times, covers the 1us resolution and the ISR jitter [us]
+#endif
+#ifndef EMBENET_PORT_RADIO_CALIBRATION_CHANNEL
+#    define EMBENET_PORT_RADIO_CALIBRATION_CHANNEL 39 // channel of the calibration frames, sent at the lowest power, outside the channel quality statistics
+#endif
+#ifndef EMBENET_PORT_RADIO_CALIBRATION_PERSIST
+#    define EMBENET_PORT_RADIO_CALIBRATION_PERSIST 0 // 1: the longest times ever measured are kept in the non-volatile store
+#endif
+#define EMBENET_PORT_RADIO_CALIBRATION_PPI_READY NRF_PPI_CHANNEL7 // RADIO READY event -> TIMER0 CAPTURE[2] task, only while calibrating
+#define EMBENET_PORT_RADIO_CALIBRATION_NVM_KEY 0x8001 // key of the calibration in the non-volatile store, the keys of the port have the MSB set
+
+// ###################################################################################################
+//  High resolution clock (RTC TICK -> TIMER capture, only while the radio is active)
+// ###################################################################################################
+
+#ifndef EMBENET_PORT_TIMER_HIRES
+#    define EMBENET_PORT_TIMER_HIRES 0 // 1: port timer reads have 1us resolution while the radio is active
+#endif
+#define EMBENET_PORT_TIMER_HIRES_TIMER     EMBENET_PORT_RADIO_TIMESTAMP_TIMER // the radio timestamp TIMER, running while the radio is active
+#define EMBENET_PORT_TIMER_HIRES_CC_NOW    NRF_TIMER_CC_CHANNEL0              // TIMER capture of the current time, shared with the radio ISR
+#define EMBENET_PORT_TIMER_HIRES_CC_ANCHOR NRF_TIMER_CC_CHANNEL3              // TIMER capture of the last RTC tick
+#define EMBENET_PORT_TIMER_HIRES_PPI       NRF_PPI_CHANNEL4                   // RTC TICK event -> TIMER CAPTURE[3] task
+
+// ###################################################################################################
+//  HFXO (RTC compare -> CLOCK HFCLKSTART)
+// ###################################################################################################
+
+#define EMBENET_PORT_HFXO_PPI NRF_PPI_CHANNEL2 // RTC compare event -> CLOCK HFCLKSTART task
+
+#ifndef EMBENET_PORT_HFXO_STARTUP_US
+#    define EMBENET_PORT_HFXO_STARTUP_US 400 // initial HFXO startup time, replaced by measurements [us]
+#endif
+#ifndef EMBENET_PORT_HFXO_MARGIN_US
+#    define EMBENET_PORT_HFXO_MARGIN_US 61 // HFXO is started this much earlier than the measured startup time requires (2 RTC ticks) [us]
+#endif
+#ifndef EMBENET_PORT_HFXO_LINGER_US
+#    define EMBENET_PORT_HFXO_LINGER_US 6000 // HFXO is kept running when the next use is closer than this (covers back-to-back slots) [us]
+#endif
+
+// ###################################################################################################
+//  Virtual timers (RTC compare -> EGU -> low priority interrupt)
+// ###################################################################################################
+
+#define EMBENET_PORT_VTIMER_PPI         NRF_PPI_CHANNEL3 // RTC compare event -> EGU trigger task
+#define EMBENET_PORT_VTIMER_EGU         NRF_EGU1
+#define EMBENET_PORT_VTIMER_IRQn        SWI1_EGU1_IRQn
+#define EMBENET_PORT_VTIMER_IRQ_HANDLER SWI1_EGU1_IRQHandler
+
+// ###################################################################################################
+//  Deferred work (software interrupts)
+// ###################################################################################################
+
+#define EMBENET_PORT_DEFERRED_HIGH_IRQn        SWI0_EGU0_IRQn
+#define EMBENET_PORT_DEFERRED_HIGH_IRQ_HANDLER SWI0_EGU0_IRQHandler
+#define EMBENET_PORT_DEFERRED_LOW_IRQn         SWI2_EGU2_IRQn
+#define EMBENET_PORT_DEFERRED_LOW_IRQ_HANDLER  SWI2_EGU2_IRQHandler
+
+// ###################################################################################################
+//  Idle
+// ###################################################################################################
+
+#ifndef EMBENET_PORT_IDLE_MAX_SLEEP_US
+#    define EMBENET_PORT_IDLE_MAX_SLEEP_US 0 // the CPU is woken up at least this often for work polled from the main loop, 0: never [us]
+#endif
+
+// ###################################################################################################
+//  Non-volatile store (NVMC, flash pages reserved by the linker script)
+// ###################################################################################################
+
+#define EMBENET_PORT_NVM_PAGE_SIZE 4096 // size of a flash page of the nRF52832, the unit of erasing [bytes]
+
+// ###################################################################################################
+//  Packet pool (reference-counted blocks shared by the radio and the application)
+// ###################################################################################################
+
+#ifndef EMBENET_PORT_PACKET_POOL_BLOCK_COUNT
+#    define EMBENET_PORT_PACKET_POOL_BLOCK_COUNT 2 // number of blocks, the radio always holds one as its reception target, the other one is for zero-copy users
+#endif
+#if (EMBENET_PORT_PACKET_POOL_BLOCK_COUNT < 2) || (EMBENET_PORT_PACKET_POOL_BLOCK_COUNT > 32)
+#    error "EMBENET_PORT_PACKET_POOL_BLOCK_COUNT must be in range 2..32"
+#endif
+
 #endif // EMBENET_PORT_CONFIG_H_ included
@@ -0,0 +1,84 @@
+/**
+ @file
+ @license   Commercial
+ @copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+ @version   1.1.4417
+ @purpose   HFXO controller.
+ @brief     Scheduled start and stop of the high frequency crystal oscillator used by the radio.
+
+ The timer port announces every MAC compare to the controller, which starts the HFXO (RTC compare -> PPI -> HFCLKSTART) a calibrated
+ startup time ahead, so that the crystal is already stable when the radio is enabled. When the radio goes idle, the HFXO is kept running
+ if the next announced use is closer than @ref EMBENET_PORT_HFXO_LINGER_US. Not every compare leads to radio activity, so once the stack
+ has handled a compare without requesting the HFXO, the crystal is stopped again and armed for the next compare. The HFCLKSTARTED event
+ is handled in interrupt, which also measures the actual startup time.
+
+ */
+
+#ifndef EMBENET_PORT_HFXO_H_
+#define EMBENET_PORT_HFXO_H_
+
+#include "embenet_timer.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initializes the HFXO controller.
+ */
+void EMBENET_HFXO_Init(void);
+
+/**
+ * @brief Starts the HFXO immediately, unless it is already running or starting.
+ */
+void EMBENET_HFXO_Request(void);
+
+/**
+ * @brief Waits until the HFXO is stable.
+ *
+ * Returns immediately when the HFXO was started in advance.
+ */
+void EMBENET_HFXO_Wait(void);
+
+/**
+ * @brief Informs that the HFXO is no longer needed.
+ *
+ * The HFXO is stopped, unless the next use is close enough to keep it running.
+ */
+void EMBENET_HFXO_Release(void);
+
+/**
+ * @brief Stops the HFXO right away, unless it is in use, even if the next use is close.
+ *
+ * Used by the radio calibration to measure the transitions from the idle state with the HFXO startup.
+ */
+void EMBENET_HFXO_Stop(void);
+
+/**
+ * @brief Announces the next time at which the HFXO may be needed.
+ * @param[in] useTime time of the next use (same time base as @ref EMBENET_TIMER_ReadCounter)
+ */
+void EMBENET_HFXO_Schedule(EMBENET_TimeUs useTime);
+
+/**
+ * @brief Informs that the stack has handled a MAC compare.
+ *
+ * The HFXO started or kept running for the compare is stopped if it was not requested while the compare was handled. Called from the timer
+ * interrupt, the decision is taken in the high level deferred work.
+ */
+void EMBENET_HFXO_OnCompare(void);
+
+/**
+ * @brief Gets the HFXO startup time used for scheduling.
+ * @return startup time [us]
+ */
+EMBENET_TimeUs EMBENET_HFXO_GetStartupTime(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EMBENET_PORT_HFXO_H_
@@ -18,6 +18,14 @@
 enum {
     INTERRUPT_PRIORITY_EMBENET_TIMER = 3,
     INTERRUPT_PRIORITY_RADIO         = 3,
+    INTERRUPT_PRIORITY_HFXO          = 2, // above radio and timer, so that HFCLKSTARTED is noticed while they run
+    INTERRUPT_PRIORITY_VTIMER        = 6, // below radio, timer and high deferred work, above low deferred work and thread mode
+    INTERRUPT_PRIORITY_ECB           = 6, // level of the virtual timers, taken after them (subpriority)
+    INTERRUPT_PRIORITY_RNG           = 7, // entropy collected in the background, never urgent
+    INTERRUPT_PRIORITY_DEFERRED_HIGH = 4, // deferred work, right below the radio and the timer, level of the border router UART
+    INTERRUPT_PRIORITY_DEFERRED_LOW  = 7, // deferred work, below everything but the debug peripherals
+
+    INTERRUPT_PRIORITY_CRITICAL_SECTION = 2, // highest priority of the interrupts using the critical section (HFXO), masked together with all below
 };
 
 /**
@@ -26,6 +34,12 @@ enum {
 enum {
     INTERRUPT_SUBPRIORITY_RADIO         = 0,
     INTERRUPT_SUBPRIORITY_EMBENET_TIMER = 1,
+    INTERRUPT_SUBPRIORITY_HFXO          = 0,
+    INTERRUPT_SUBPRIORITY_VTIMER        = 0,
+    INTERRUPT_SUBPRIORITY_ECB           = 1,
+    INTERRUPT_SUBPRIORITY_RNG           = 1,
+    INTERRUPT_SUBPRIORITY_DEFERRED_HIGH = 0,
+    INTERRUPT_SUBPRIORITY_DEFERRED_LOW  = 0,
 };
 
 
@@ -21,13 +21,9 @@
 
 // RADIO_TxNow -> TX ISR 85us, (45us of radio preparing and power ramping, 40us of preamble and address field transmission)
 
-// IDLE current 5uA
-// TX current 17,5mA
-// RX curretn 13mA
-// LISTEN current 13mA
-// preparation energy tx 2nAh (8mA przez 450us + 600us)
-// preparation energy rx 500pAh (7,8mA przez 560us)
-// preparation energy tx no frame 750pAh (7,8mA przez 330us)
+// currents and preparation charges: see embenet_port_energy.h
+
+// defaults of the capabilities and of the start corrections below, replaced by the measurements of EMBENET_RADIO_Calibrate
 
 #define EMBENET_RADIO_IdleToTxReady   (400)
 #define EMBENET_RADIO_IdleToRxReady   (400)
@@ -37,9 +33,40 @@
 #define EMBENET_RADIO_RxDelay         EMBENET_RADIO_TxDelay // between GO signal and start listening - cannot measure but could be the same as delayTx
 
 
-#define EMBENET_RADIO_TX_TX_START_CORRECTION (40) // time difference between start of frame ISR and actual first bit being sent by radio
-#define EMBENET_RADIO_TX_RX_END_CORRECTION   (10) // time difference between end of frame ISR on receiver and transmitter side (receiver - sender)
-#define EMBENET_RADIO_TX_RX_START_CORRECTION (50) // additional 10us takes the transceiver to trigger start of frame ISR on receiver side
+//###################################################################################################
+// PHY PROFILES
+//###################################################################################################
+
+#define EMBENET_RADIO_PHY_PROFILE_BLE_1MBIT 0 // BLE 1Mbit, 8 bit preamble
+#define EMBENET_RADIO_PHY_PROFILE_BLE_2MBIT 1 // BLE 2Mbit, 16 bit preamble, half of the 1Mbit airtime
+
+#ifndef EMBENET_RADIO_PHY_PROFILE
+#    define EMBENET_RADIO_PHY_PROFILE EMBENET_RADIO_PHY_PROFILE_BLE_1MBIT // profile selected at build time, MAC timings follow this profile
+#endif
+
+// BLE 1Mbit: 1B preamble + 4B address = 40us
+#define EMBENET_RADIO_1MBIT_TX_TX_START_CORRECTION (40)   // time difference between start of frame ISR and actual first bit being sent by radio
+#define EMBENET_RADIO_1MBIT_TX_RX_END_CORRECTION   (10)   // time difference between end of frame ISR on receiver and transmitter side (receiver - sender)
+#define EMBENET_RADIO_1MBIT_TX_RX_START_CORRECTION (50)   // additional 10us takes the transceiver to trigger start of frame ISR on receiver side
+#define EMBENET_RADIO_1MBIT_MIN_SLOT_DURATION      (5000) // shortest slot in which a full frame and its ACK fit
+
+// BLE 2Mbit: 2B preamble + 4B address = 24us, receiver chain delay is about half of the one at 1Mbit
+#define EMBENET_RADIO_2MBIT_TX_TX_START_CORRECTION (24)
+#define EMBENET_RADIO_2MBIT_TX_RX_END_CORRECTION   (5)
+#define EMBENET_RADIO_2MBIT_TX_RX_START_CORRECTION (29)
+#define EMBENET_RADIO_2MBIT_MIN_SLOT_DURATION      (4000)
+
+#if EMBENET_RADIO_PHY_PROFILE == EMBENET_RADIO_PHY_PROFILE_BLE_1MBIT
+#    define EMBENET_RADIO_TX_TX_START_CORRECTION EMBENET_RADIO_1MBIT_TX_TX_START_CORRECTION
+#    define EMBENET_RADIO_TX_RX_END_CORRECTION   EMBENET_RADIO_1MBIT_TX_RX_END_CORRECTION
+#    define EMBENET_RADIO_TX_RX_START_CORRECTION EMBENET_RADIO_1MBIT_TX_RX_START_CORRECTION
+#elif EMBENET_RADIO_PHY_PROFILE == EMBENET_RADIO_PHY_PROFILE_BLE_2MBIT
+#    define EMBENET_RADIO_TX_TX_START_CORRECTION EMBENET_RADIO_2MBIT_TX_TX_START_CORRECTION
+#    define EMBENET_RADIO_TX_RX_END_CORRECTION   EMBENET_RADIO_2MBIT_TX_RX_END_CORRECTION
+#    define EMBENET_RADIO_TX_RX_START_CORRECTION EMBENET_RADIO_2MBIT_TX_RX_START_CORRECTION
+#else
+#    error "Unsupported EMBENET_RADIO_PHY_PROFILE"
+#endif
 
 //###################################################################################################
 // PHY SETTINGS
@@ -47,7 +74,8 @@
 #ifndef EMBENET_RADIO_MAX_OUTPUT_POWER_REDUCTION
 #    define EMBENET_RADIO_MAX_OUTPUT_POWER_REDUCTION 0
 #endif
-#define EMBENET_RADIO_SENSITIVITY      (-100) /**< [dBm], does not consider as neighbor if RSSI will be lower */
+#define EMBENET_RADIO_SENSITIVITY       (-100) /**< [dBm], does not consider as neighbor if RSSI will be lower */
+#define EMBENET_RADIO_2MBIT_SENSITIVITY (-96)  /**< [dBm], 2Mbit receiver is about 4dB less sensitive */
 #define EMBENET_RADIO_MIN_CHANNEL      0
 #define EMBENET_RADIO_MAX_CHANNEL      39
 #define EMBENET_RADIO_CHANNEL_COUNT    40
@@ -57,4 +85,34 @@
 #define EMBENET_RADIO_POWER_OFFSET_HP  2
 #define EMBENET_RADIO_POWER_OFFSET     2
 
+//###################################################################################################
+// FRAME BUFFERS
+//###################################################################################################
+// the frame buffers are packet pool blocks, see EMBENET_PORT_PACKET_POOL_BLOCK_COUNT in embenet_port_config.h
+
+//###################################################################################################
+// CHANNEL QUALITY
+//###################################################################################################
+#ifndef EMBENET_CHANNEL_QUALITY_MIN_SAMPLES
+#    define EMBENET_CHANNEL_QUALITY_MIN_SAMPLES 8 // frames needed in an evaluation period to update the score of a channel
+#endif
+#ifndef EMBENET_CHANNEL_QUALITY_BAD_SCORE
+#    define EMBENET_CHANNEL_QUALITY_BAD_SCORE 160 // channels scoring below are proposed for blacklisting (~63% success ratio)
+#endif
+#ifndef EMBENET_CHANNEL_QUALITY_PROBATION_PERIODS
+#    define EMBENET_CHANNEL_QUALITY_PROBATION_PERIODS 10 // evaluation periods a channel stays blacklisted before it is re-admitted
+#endif
+#ifndef EMBENET_CHANNEL_QUALITY_MIN_CHANNELS
+#    define EMBENET_CHANNEL_QUALITY_MIN_CHANNELS 16 // data channels that are never blacklisted below
+#endif
+#if (EMBENET_CHANNEL_QUALITY_MIN_CHANNELS < 1) || (EMBENET_CHANNEL_QUALITY_MIN_CHANNELS > 37)
+#    error "EMBENET_CHANNEL_QUALITY_MIN_CHANNELS must be in range 1..37"
+#endif
+#ifndef EMBENET_CHANNEL_QUALITY_CHANNEL_OFFSETS
+#    define EMBENET_CHANNEL_QUALITY_CHANNEL_OFFSETS 16 // channel offsets 0..N-1 used by the schedule, their cells never share a remapped channel
+#endif
+#if (EMBENET_CHANNEL_QUALITY_CHANNEL_OFFSETS < 1) || (EMBENET_CHANNEL_QUALITY_CHANNEL_OFFSETS > EMBENET_CHANNEL_QUALITY_MIN_CHANNELS)
+#    error "EMBENET_CHANNEL_QUALITY_CHANNEL_OFFSETS must be in range 1..EMBENET_CHANNEL_QUALITY_MIN_CHANNELS"
+#endif
+
 #endif /* EMBENET_PORT_RADIO_CONFIG_H_ */
@@ -11,10 +11,22 @@
 #ifndef EMBENET_PORT_RADIO_EXTENSION_H_
 #define EMBENET_PORT_RADIO_EXTENSION_H_
 
+#include "embenet_radio.h"
+#include "embenet_timer.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/// PHY profiles supported by the radio
+typedef enum {
+    EMBENET_RADIO_PHY_BLE_1MBIT = 0, ///< BLE 1Mbit
+    EMBENET_RADIO_PHY_BLE_2MBIT = 1, ///< BLE 2Mbit
+} EMBENET_RADIO_PhyProfile;
+
 /**
  * @brief Locks HFXO. Radio will not turn it off when going to idle state. Enables HFXO if it is not enabled.
  * @note If it happens that HFXO is not enabled, this function can block for ~300us while waiting for HFXO to start.
@@ -27,6 +39,124 @@ void EMBENET_RADIO_LockHfxo(void);
  */
 void EMBENET_RADIO_UnlockHfxo(void);
 
+/**
+ * @brief Selects the PHY profile used by the radio.
+ *
+ * The profile selected at build time (EMBENET_RADIO_PHY_PROFILE) is used by default. Each profile carries its own modulation, preamble,
+ * timing corrections and @ref EMBENET_RADIO_Capabilities. The MAC timings are fixed at build time, so a profile can only be selected if
+ * a full frame exchange of that profile fits in the configured slot duration.
+ *
+ * @note Should be called before the stack is started, while the radio is idle.
+ *
+ * @param[in] profile PHY profile to use
+ * @retval EMBENET_RADIO_STATUS_SUCCESS the profile is in use
+ * @retval EMBENET_RADIO_STATUS_WRONG_STATE the radio is not idle
+ * @retval EMBENET_RADIO_STATUS_PARAMETER_ARG1_OUT_OF_BOUNDS unknown profile or the profile does not fit in the slot duration
+ */
+EMBENET_RADIO_Status EMBENET_RADIO_SetPhyProfile(EMBENET_RADIO_PhyProfile profile);
+
+/**
+ * @brief Gets the PHY profile used by the radio.
+ * @return PHY profile in use
+ */
+EMBENET_RADIO_PhyProfile EMBENET_RADIO_GetPhyProfile(void);
+
+/**
+ * @brief Schedules the transmission prepared with @ref EMBENET_RADIO_TxEnable to start at the given time.
+ *
+ * This is the hardware-triggered counterpart of @ref EMBENET_RADIO_TxNow. TXEN is triggered through PPI exactly at startTime, so the start
+ * does not depend on interrupt latency. The schedule is cancelled by @ref EMBENET_RADIO_Idle, @ref EMBENET_RADIO_TxNow, @ref EMBENET_RADIO_RxNow
+ * and by scheduling another start.
+ *
+ * @param[in] startTime time at which TXEN is triggered (same time base as @ref EMBENET_TIMER_ReadCounter), must be at least 62us in the future
+ * @retval EMBENET_RADIO_STATUS_SUCCESS the start was scheduled
+ * @retval EMBENET_RADIO_STATUS_WRONG_STATE transmission was not prepared
+ * @retval EMBENET_RADIO_STATUS_GENERAL_ERROR startTime is too close or too far in the future
+ */
+EMBENET_RADIO_Status EMBENET_RADIO_TxAt(EMBENET_TimeUs startTime);
+
+/**
+ * @brief Schedules listening prepared with @ref EMBENET_RADIO_RxEnable to start at the given time.
+ *
+ * This is the hardware-triggered counterpart of @ref EMBENET_RADIO_RxNow, see @ref EMBENET_RADIO_TxAt.
+ *
+ * @param[in] startTime time at which RXEN is triggered (same time base as @ref EMBENET_TIMER_ReadCounter), must be at least 62us in the future
+ * @retval EMBENET_RADIO_STATUS_SUCCESS the start was scheduled
+ * @retval EMBENET_RADIO_STATUS_WRONG_STATE listening was not prepared
+ * @retval EMBENET_RADIO_STATUS_GENERAL_ERROR startTime is too close or too far in the future
+ */
+EMBENET_RADIO_Status EMBENET_RADIO_RxAt(EMBENET_TimeUs startTime);
+
+/**
+ * @brief Lends one of the radio frame buffers to the caller.
+ *
+ * The returned pointer points at the PSDU area of a packet pool block that the radio can transmit from directly. When it is passed as the
+ * psdu argument to @ref EMBENET_RADIO_TxEnable the frame is not copied, and the radio keeps its own reference to the block until the next
+ * frame is prepared. The buffer stays lent until @ref EMBENET_RADIO_ReleaseFrameBuffer is called; further references may be taken
+ * with @ref EMBENET_PACKET_POOL_Retain.
+ *
+ * @return pointer to @ref EMBENET_RADIO_MAX_PSDU_LENGTH bytes of PSDU storage or NULL if no buffer is free
+ */
+uint8_t* EMBENET_RADIO_AcquireFrameBuffer(void);
+
+/**
+ * @brief Takes over the buffer holding the last received frame.
+ *
+ * This is the zero-copy counterpart of @ref EMBENET_RADIO_GetReceivedFrame. Instead of copying the frame out, the buffer the frame was received
+ * into is lent to the caller and the radio switches reception to a free packet pool block. The buffer may be passed on to other layers
+ * with @ref EMBENET_PACKET_POOL_Retain and must be given back with @ref EMBENET_RADIO_ReleaseFrameBuffer.
+ *
+ * @param[out] psdu set to the received PSDU or to NULL if no free buffer was available to continue reception; in the latter case the frame
+ *                  stays in the radio and can still be copied out with @ref EMBENET_RADIO_GetReceivedFrame
+ * @return @ref EMBENET_RADIO_RxInfo of the received frame
+ */
+EMBENET_RADIO_RxInfo EMBENET_RADIO_TakeReceivedFrame(uint8_t const** psdu);
+
+/**
+ * @brief Returns a lent frame buffer to the radio, i.e. gives back a reference to its packet pool block.
+ * @param[in] psdu pointer obtained from @ref EMBENET_RADIO_AcquireFrameBuffer or @ref EMBENET_RADIO_TakeReceivedFrame
+ */
+void EMBENET_RADIO_ReleaseFrameBuffer(uint8_t const* psdu);
+
+/// Radio timings measured on this chip for one PHY profile, the longest of all the calibration rounds [us]
+typedef struct {
+    EMBENET_TimeUs idleToTxReady;       ///< @ref EMBENET_RADIO_TxEnable called in the idle state, HFXO stopped, to the READY event
+    EMBENET_TimeUs idleToRxReady;       ///< @ref EMBENET_RADIO_RxEnable called in the idle state, HFXO stopped, to the READY event
+    EMBENET_TimeUs activeToTxReady;     ///< END event of a frame to the READY event of the transmission enabled right after it
+    EMBENET_TimeUs activeToRxReady;     ///< END event of a frame to the READY event of the reception enabled right after it
+    EMBENET_TimeUs txDelay;             ///< @ref EMBENET_RADIO_TxNow to the radio ramped up and sending
+    EMBENET_TimeUs rxDelay;             ///< @ref EMBENET_RADIO_RxNow to the radio ramped up and listening
+    EMBENET_TimeUs txTxStartCorrection; ///< first bit sent to the ADDRESS event, i.e. preamble and address on air, averaged
+} EMBENET_RADIO_Calibration;
+
+/**
+ * @brief Measures the radio timings of every PHY profile and reports them in @ref EMBENET_RADIO_Capabilities instead of the constants.
+ *
+ * Runs only when called, and from @ref EMBENET_RADIO_Init when EMBENET_PORT_RADIO_CALIBRATION is enabled. The RADIO events are captured by the
+ * timestamp TIMER through PPI, while a few frames are sent at the lowest power on EMBENET_PORT_RADIO_CALIBRATION_CHANNEL. The transitions from
+ * the idle state are measured up to the READY event with HFXO stopped, the transitions from the end of a frame up to the next READY event. A
+ * margin is added to the measured times. The start of frame corrections follow the measured preamble and address time, averaged over the
+ * frames; the delays of the receiver chain cannot be measured by a single chip, they keep their configured values. With
+ * EMBENET_PORT_RADIO_CALIBRATION_PERSIST, the longest times measured so far are kept in the non-volatile store and used when longer than the
+ * new measurements.
+ *
+ * @note Must be called from the main loop while the radio is idle and the stack is not started; the interrupts other than the RADIO one keep
+ * running. Takes about 20ms.
+ *
+ * @retval EMBENET_RADIO_STATUS_SUCCESS all the profiles are calibrated
+ * @retval EMBENET_RADIO_STATUS_WRONG_STATE the radio is not idle
+ * @retval EMBENET_RADIO_STATUS_GENERAL_ERROR the radio did not respond in time, the profiles affected keep their previous timings
+ */
+EMBENET_RADIO_Status EMBENET_RADIO_Calibrate(void);
+
+/**
+ * @brief Gets the timings measured for the given PHY profile, without the margin.
+ * @param[in] profile PHY profile
+ * @param[out] calibration measured timings
+ * @return true if the profile is calibrated
+ */
+bool EMBENET_RADIO_GetCalibration(EMBENET_RADIO_PhyProfile profile, EMBENET_RADIO_Calibration* calibration);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,120 @@
+/**
+ @file
+ @license   Commercial
+ @copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+ @version   1.1.4417
+ @purpose   Timer extensions functions.
+ @brief     Additional timer funcitonalities used by other port modules.
+
+ */
+
+#ifndef EMBENET_PORT_TIMER_EXTENSION_H_
+#define EMBENET_PORT_TIMER_EXTENSION_H_
+
+#include "embenet_timer.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+The port timer ticks at 32768Hz, so one tick lasts exactly 15625/512us. Conversions below are exact (they give the same results as
+multiplying or dividing by the tick period with unlimited precision and rounding down) and use no division: the multiplication by the
+tick period is a 32x32->64 bit multiply and a shift, and the division by 15625 is a multiplication by its precomputed reciprocal.
+For 32-bit operands multiplying by ceil(2^45 / 15625) and shifting by 45 is exact, as (ceil(2^45 / 15625) * 15625 - 2^45) * 2^32 < 2^45.
+ */
+#define EMBENET_TIMER_TICK_US_NUMERATOR   15625U       ///< tick period numerator [us]
+#define EMBENET_TIMER_TICK_US_SHIFT       9U           ///< tick period denominator is 2^EMBENET_TIMER_TICK_US_SHIFT
+#define EMBENET_TIMER_DIV15625_RECIPROCAL 2251799814U  ///< ceil(2^45 / 15625)
+#define EMBENET_TIMER_DIV15625_SHIFT      45U          ///< shift matching @ref EMBENET_TIMER_DIV15625_RECIPROCAL
+
+typedef uint64_t EMBENET_TimeTicks; ///< Type to store time in port timer ticks, extended with the overflow count
+
+/**
+ * @brief Converts port timer ticks to microseconds.
+ * @param[in] ticks number of ticks
+ * @return time [us], rounded down and wrapped the same way as @ref EMBENET_TimeUs
+ */
+static inline EMBENET_TimeUs EMBENET_TIMER_TicksToUs(uint32_t ticks) {
+    return (EMBENET_TimeUs)(((uint64_t)ticks * EMBENET_TIMER_TICK_US_NUMERATOR) >> EMBENET_TIMER_TICK_US_SHIFT);
+}
+
+/**
+ * @brief Converts microseconds to port timer ticks.
+ * @param[in] us time [us]
+ * @return number of ticks, rounded down
+ */
+static inline uint32_t EMBENET_TIMER_UsToTicks(EMBENET_TimeUs us) {
+    uint32_t quotient  = (uint32_t)(((uint64_t)us * EMBENET_TIMER_DIV15625_RECIPROCAL) >> EMBENET_TIMER_DIV15625_SHIFT);
+    uint32_t remainder = (uint32_t)us - quotient * EMBENET_TIMER_TICK_US_NUMERATOR;
+    uint32_t fraction  = (uint32_t)(((uint64_t)(remainder << EMBENET_TIMER_TICK_US_SHIFT) * EMBENET_TIMER_DIV15625_RECIPROCAL) >> EMBENET_TIMER_DIV15625_SHIFT);
+    return (quotient << EMBENET_TIMER_TICK_US_SHIFT) + fraction;
+}
+
+/**
+ * @brief Reads the port timer in ticks.
+ *
+ * Gives the same time as @ref EMBENET_TIMER_ReadCounter, without any conversion and without wrapping.
+ *
+ * @return current time [ticks]
+ */
+EMBENET_TimeTicks EMBENET_TIMER_ReadTicks(void);
+
+/**
+ * @brief Starts the high resolution clock.
+ *
+ * While it runs, @ref EMBENET_TIMER_ReadCounter interpolates between the port timer ticks with the 1MHz TIMER, re-anchored to the port timer
+ * on every tick, so the readings have 1us resolution instead of one tick. The TIMER must already be running. Does nothing if the high
+ * resolution clock is disabled (see EMBENET_PORT_TIMER_HIRES).
+ */
+void EMBENET_TIMER_HiResStart(void);
+
+/**
+ * @brief Stops the high resolution clock. Readings go back to the resolution of one port timer tick, without going back in time.
+ */
+void EMBENET_TIMER_HiResStop(void);
+
+/**
+ * @brief Tick-native variant of @ref EMBENET_TIMER_SetEventCompare.
+ * @param[in] channel compare channel to use, must not be the channel used by @ref EMBENET_TIMER_SetCompare
+ * @param[in] compareTicks time at which the event is requested (same time base as @ref EMBENET_TIMER_ReadTicks)
+ * @retval true the channel was armed
+ * @retval false compareTicks is too close or too far in the future, the channel was not armed
+ */
+bool EMBENET_TIMER_SetEventCompareTicks(uint32_t channel, EMBENET_TimeTicks compareTicks);
+
+/**
+ * @brief Arms one of the auxiliary compare channels of the port timer to generate an event (for PPI) at the given time.
+ *
+ * The compare event is generated at the beginning of the timer tick in which compareValue falls. The time between the event and compareValue
+ * (always shorter than one timer tick) is returned through subTickRemainder, so that the caller can compensate it e.g. with a high frequency
+ * timer. No interrupt is generated for the auxiliary channels.
+ *
+ * @param[in] channel compare channel to use, must not be the channel used by @ref EMBENET_TIMER_SetCompare
+ * @param[in] compareValue time at which the event is requested (same time base as @ref EMBENET_TIMER_ReadCounter)
+ * @param[out] subTickRemainder time between the compare event and compareValue [us]
+ * @retval true the channel was armed
+ * @retval false compareValue is too close or too far in the future, the channel was not armed
+ */
+bool EMBENET_TIMER_SetEventCompare(uint32_t channel, EMBENET_TimeUs compareValue, EMBENET_TimeUs* subTickRemainder);
+
+/**
+ * @brief Disarms an auxiliary compare channel armed with @ref EMBENET_TIMER_SetEventCompare.
+ * @param[in] channel compare channel to disarm
+ */
+void EMBENET_TIMER_ClearEventCompare(uint32_t channel);
+
+/**
+ * @brief Gets the time left until the compare set with @ref EMBENET_TIMER_SetCompare fires.
+ * @return time to the compare interrupt [ticks], 0 if it is already due, UINT32_MAX if no compare is pending
+ */
+uint32_t EMBENET_TIMER_GetTicksToCompare(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EMBENET_PORT_TIMER_EXTENSION_H_ */
@@ -0,0 +1,122 @@
+/**
+ @file
+ @license   Commercial
+ @copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+ @version   1.1.4417
+ @purpose   Lock-free ring buffer
+ @brief     Single-producer/single-consumer ring buffer with bulk and zero-copy access.
+
+ Unlike @ref RingBuffer, the buffer can be shared between one producer and one consumer running in different contexts (e.g. an ISR and
+ the main loop) without any critical section: the write index is only changed by the producer and the read index only by the consumer.
+ Both indexes run freely and are reduced modulo the buffer size, which must be a power of two, so that a full buffer can be told apart
+ from an empty one with no extra state. Besides bulk copies, contiguous spans of the buffer can be accessed in place (peek) and released
+ afterwards (commit), e.g. to be sent or received by DMA.
+
+ */
+
+#ifndef SPSC_RING_BUFFER_H_
+#define SPSC_RING_BUFFER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Structure describing the ring buffer. */
+typedef struct {
+    uint8_t*          dataBuffer;     ///< pointer to the area of memory, where data will be stored
+    size_t            dataBufferSize; ///< size of the data buffer (in bytes), a power of two
+    volatile uint32_t writeIndex;     ///< number of bytes written so far, changed only by the producer
+    volatile uint32_t readIndex;      ///< number of bytes read so far, changed only by the consumer
+} SpscRingBuffer;
+
+/**
+ * Initializes the given ring buffer structure. Must not be called while the buffer is in use.
+ *
+ * @param ringBuffer pointer to a \ref SpscRingBuffer structure
+ * @param dataBuffer pointer to a location in memory, where the ring buffer data will be stored
+ * @param dataBufferSize size in bytes of the dataBuffer, must be a power of two
+ * @return true if all arguments are valid and the ring buffer is initialized successfully, false otherwise
+ */
+bool SpscRingBuffer_Init(SpscRingBuffer* ringBuffer, uint8_t* dataBuffer, size_t dataBufferSize);
+
+/**
+ * Gets the length (in bytes) of the data stored in the given ring buffer.
+ *
+ * @param ringBuffer pointer to a \ref SpscRingBuffer structure
+ * @return length (in bytes) of the data stored in the ring buffer
+ */
+size_t SpscRingBuffer_GetLen(const SpscRingBuffer* ringBuffer);
+
+/**
+ * Returns the space (in bytes) left in the given buffer.
+ *
+ * @param ringBuffer pointer to a \ref SpscRingBuffer structure
+ * @return space (in bytes) of the ring buffer (how much characters can be still written to it)
+ */
+size_t SpscRingBuffer_GetSpace(const SpscRingBuffer* ringBuffer);
+
+/**
+ * Appends data to the ring buffer (producer only). Writes as much as fits.
+ *
+ * @param ringBuffer pointer to a \ref SpscRingBuffer structure
+ * @param data data to append
+ * @param length length of the data (in bytes)
+ * @return number of bytes written
+ */
+size_t SpscRingBuffer_Write(SpscRingBuffer* ringBuffer, const void* data, size_t length);
+
+/**
+ * Pulls out data from the ring buffer (consumer only).
+ *
+ * @param ringBuffer pointer to a \ref SpscRingBuffer structure
+ * @param data place where the data will be stored
+ * @param length size of the data (in bytes)
+ * @return number of bytes read
+ */
+size_t SpscRingBuffer_Read(SpscRingBuffer* ringBuffer, void* data, size_t length);
+
+/**
+ * Gets the longest contiguous span of free space (producer only). The span is filled in place and appended with
+ * \ref SpscRingBuffer_CommitWrite.
+ *
+ * @param ringBuffer pointer to a \ref SpscRingBuffer structure
+ * @param span pointer to a place where the beginning of the span will be stored
+ * @return length of the span (in bytes), 0 if the buffer is full
+ */
+size_t SpscRingBuffer_PeekWrite(SpscRingBuffer* ringBuffer, uint8_t** span);
+
+/**
+ * Appends the given number of bytes filled in place (producer only).
+ *
+ * @param ringBuffer pointer to a \ref SpscRingBuffer structure
+ * @param length number of bytes, at most the length returned by \ref SpscRingBuffer_PeekWrite
+ */
+void SpscRingBuffer_CommitWrite(SpscRingBuffer* ringBuffer, size_t length);
+
+/**
+ * Gets the longest contiguous span of the stored data (consumer only). The data stays in the buffer until it is released with
+ * \ref SpscRingBuffer_CommitRead.
+ *
+ * @param ringBuffer pointer to a \ref SpscRingBuffer structure
+ * @param span pointer to a place where the beginning of the span will be stored
+ * @return length of the span (in bytes), 0 if the buffer is empty
+ */
+size_t SpscRingBuffer_PeekRead(const SpscRingBuffer* ringBuffer, uint8_t const** span);
+
+/**
+ * Releases the given number of bytes from the beginning of the stored data (consumer only).
+ *
+ * @param ringBuffer pointer to a \ref SpscRingBuffer structure
+ * @param length number of bytes, at most the length returned by \ref SpscRingBuffer_PeekRead
+ */
+void SpscRingBuffer_CommitRead(SpscRingBuffer* ringBuffer, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SPSC_RING_BUFFER_H_
@@ -0,0 +1,108 @@
+/**
+@file
+@license   Commercial
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET Node port for nRF52832
+@brief     Implementation of the lock-free ring buffer
+*/
+
+#include "spsc_ring_buffer.h"
+
+#include <string.h>
+
+/*
+A single core executes both sides in program order, so the only reordering to prevent is the one done by the compiler: the data must
+be in the buffer before the index announcing it is written, and it must be read out before the index releasing it is written.
+ */
+#define COMPILER_BARRIER() __asm volatile("" ::: "memory")
+
+static inline size_t offsetOf(const SpscRingBuffer* ringBuffer, uint32_t index) {
+    return (size_t)index & (ringBuffer->dataBufferSize - 1);
+}
+
+bool SpscRingBuffer_Init(SpscRingBuffer* ringBuffer, uint8_t* dataBuffer, size_t dataBufferSize) {
+    if ((NULL == ringBuffer) || (NULL == dataBuffer) || (0 == dataBufferSize) || (0 != (dataBufferSize & (dataBufferSize - 1)))) {
+        return false;
+    }
+    ringBuffer->dataBuffer     = dataBuffer;
+    ringBuffer->dataBufferSize = dataBufferSize;
+    ringBuffer->writeIndex     = 0;
+    ringBuffer->readIndex      = 0;
+    return true;
+}
+
+size_t SpscRingBuffer_GetLen(const SpscRingBuffer* ringBuffer) {
+    return (size_t)(uint32_t)(ringBuffer->writeIndex - ringBuffer->readIndex);
+}
+
+size_t SpscRingBuffer_GetSpace(const SpscRingBuffer* ringBuffer) {
+    return ringBuffer->dataBufferSize - SpscRingBuffer_GetLen(ringBuffer);
+}
+
+size_t SpscRingBuffer_PeekWrite(SpscRingBuffer* ringBuffer, uint8_t** span) {
+    size_t offset = offsetOf(ringBuffer, ringBuffer->writeIndex);
+    size_t space  = SpscRingBuffer_GetSpace(ringBuffer);
+    size_t toEnd  = ringBuffer->dataBufferSize - offset;
+    *span         = &ringBuffer->dataBuffer[offset];
+    COMPILER_BARRIER();
+    return (space < toEnd) ? space : toEnd;
+}
+
+void SpscRingBuffer_CommitWrite(SpscRingBuffer* ringBuffer, size_t length) {
+    COMPILER_BARRIER();
+    ringBuffer->writeIndex += (uint32_t)length;
+}
+
+size_t SpscRingBuffer_PeekRead(const SpscRingBuffer* ringBuffer, uint8_t const** span) {
+    size_t offset = offsetOf(ringBuffer, ringBuffer->readIndex);
+    size_t length = SpscRingBuffer_GetLen(ringBuffer);
+    size_t toEnd  = ringBuffer->dataBufferSize - offset;
+    *span         = &ringBuffer->dataBuffer[offset];
+    COMPILER_BARRIER();
+    return (length < toEnd) ? length : toEnd;
+}
+
+void SpscRingBuffer_CommitRead(SpscRingBuffer* ringBuffer, size_t length) {
+    COMPILER_BARRIER();
+    ringBuffer->readIndex += (uint32_t)length;
+}
+
+size_t SpscRingBuffer_Write(SpscRingBuffer* ringBuffer, const void* data, size_t length) {
+    uint8_t const* bytes   = (uint8_t const*)data;
+    size_t         written = 0;
+    // at most two spans: up to the end of the buffer and from its beginning
+    while (written < length) {
+        uint8_t* span;
+        size_t   spanLength = SpscRingBuffer_PeekWrite(ringBuffer, &span);
+        if (0 == spanLength) {
+            break;
+        }
+        if (spanLength > length - written) {
+            spanLength = length - written;
+        }
+        memcpy(span, &bytes[written], spanLength);
+        SpscRingBuffer_CommitWrite(ringBuffer, spanLength);
+        written += spanLength;
+    }
+    return written;
+}
+
+size_t SpscRingBuffer_Read(SpscRingBuffer* ringBuffer, void* data, size_t length) {
+    uint8_t* bytes = (uint8_t*)data;
+    size_t   read  = 0;
+    while (read < length) {
+        uint8_t const* span;
+        size_t         spanLength = SpscRingBuffer_PeekRead(ringBuffer, &span);
+        if (0 == spanLength) {
+            break;
+        }
+        if (spanLength > length - read) {
+            spanLength = length - read;
+        }
+        memcpy(&bytes[read], span, spanLength);
+        SpscRingBuffer_CommitRead(ringBuffer, spanLength);
+        read += spanLength;
+    }
+    return read;
+}
@@ -0,0 +1,362 @@
+/**
+ @file
+ @license   Commercial
+ @copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+ @version   1.1.4417
+ @purpose   Host tests of the embeNET Node port for nRF52832
+ @brief     Thin mocks of the BSP and of the peripherals used by the port modules built on the host.
+
+ */
+
+#include "host_mocks.h"
+
+#include "embenet_critical_section.h"
+#include "embenet_node_nrf52_bsp_interface.h"
+#include "embenet_port_config.h"
+#include "embenet_port_ecb.h"
+#include "embenet_port_timer_extension.h"
+#include "nrf52.h"
+#include "nrf52_bitfields.h"
+#include <embetech/expect.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// ###################################################################################################
+//  NVIC
+// ###################################################################################################
+
+void EMBENET_PORT_DEFERRED_HIGH_IRQ_HANDLER(void);
+void EMBENET_PORT_DEFERRED_LOW_IRQ_HANDLER(void);
+
+static struct {
+    uint32_t enabled; ///< bit of every enabled interrupt
+    uint32_t pending; ///< bit of every pending interrupt
+} nvic;
+
+void NVIC_EnableIRQ(IRQn_Type irq) {
+    nvic.enabled |= (1U << irq);
+}
+
+void NVIC_ClearPendingIRQ(IRQn_Type irq) {
+    nvic.pending &= ~(1U << irq);
+}
+
+void NVIC_SetPendingIRQ(IRQn_Type irq) {
+    nvic.pending |= (1U << irq);
+}
+
+/// Runs the enabled pending interrupts, higher priority first, as they would on the return from the interrupt they were pended from
+static void runPendingIrqs(void) {
+    static const struct {
+        IRQn_Type irq;
+        void (*handler)(void);
+    } handlers[] = {
+        {EMBENET_PORT_DEFERRED_HIGH_IRQn, EMBENET_PORT_DEFERRED_HIGH_IRQ_HANDLER},
+        {EMBENET_PORT_DEFERRED_LOW_IRQn, EMBENET_PORT_DEFERRED_LOW_IRQ_HANDLER},
+    };
+    size_t i = 0;
+    while (i < sizeof(handlers) / sizeof(handlers[0])) {
+        uint32_t bit = 1U << handlers[i].irq;
+        if (0 != (nvic.pending & nvic.enabled & bit)) {
+            nvic.pending &= ~bit;
+            handlers[i].handler();
+            // the handler may have pended an interrupt of higher priority
+            i = 0;
+        } else {
+            ++i;
+        }
+    }
+}
+
+// ###################################################################################################
+//  UARTE
+// ###################################################################################################
+
+static struct {
+    EMBENET_NODE_BSP_UART_Callback_t    txEndCallback;
+    EMBENET_NODE_BSP_UARTE_RxCallback_t rxCallback;
+    void*                               context;
+    uint8_t const*                      txChunk;  ///< chunk being sent, NULL if none
+    size_t                              txLength; ///< length of the chunk
+    bool                                rxPaused;
+} uarte;
+
+void EMBENET_NODE_BSP_UARTE_Init(const EMBENET_NODE_BSP_UART_Callback_t txEndCallback, const EMBENET_NODE_BSP_UARTE_RxCallback_t rxCallback, void* context) {
+    uarte.txEndCallback = txEndCallback;
+    uarte.rxCallback    = rxCallback;
+    uarte.context       = context;
+    uarte.txChunk       = NULL;
+    uarte.txLength      = 0;
+    uarte.rxPaused      = false;
+}
+
+void EMBENET_NODE_BSP_UARTE_Deinit(void) {
+    uarte.txEndCallback = NULL;
+    uarte.rxCallback    = NULL;
+    uarte.txChunk       = NULL;
+}
+
+void EMBENET_NODE_BSP_UARTE_Write(uint8_t const* data, size_t length) {
+    uarte.txChunk  = data;
+    uarte.txLength = length;
+}
+
+void EMBENET_NODE_BSP_UARTE_RxPause(void) {
+    uarte.rxPaused = true;
+}
+
+void EMBENET_NODE_BSP_UARTE_RxResume(void) {
+    uarte.rxPaused = false;
+}
+
+size_t HOST_MOCKS_UarteDrainTx(uint8_t* sink, size_t sinkSize) {
+    size_t sent = 0;
+    while (NULL != uarte.txChunk) {
+        uint8_t const* chunk  = uarte.txChunk;
+        size_t         length = uarte.txLength;
+        if ((NULL != sink) && (sent < sinkSize)) {
+            memcpy(&sink[sent], chunk, (length < sinkSize - sent) ? length : (sinkSize - sent));
+        }
+        sent += length;
+        // the end of the transfer either starts the next chunk or ends the transmission
+        uarte.txChunk = NULL;
+        uarte.txEndCallback(uarte.context);
+    }
+    return sent;
+}
+
+void HOST_MOCKS_UarteReceive(uint8_t const* data, size_t length) {
+    uarte.rxCallback(uarte.context, data, length);
+    runPendingIrqs();
+}
+
+bool HOST_MOCKS_UarteIsRxPaused(void) {
+    return uarte.rxPaused;
+}
+
+// ###################################################################################################
+//  Timer
+// ###################################################################################################
+
+uint64_t HOST_MOCKS_NowNs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000U + (uint64_t)now.tv_nsec;
+}
+
+EMBENET_TimeTicks EMBENET_TIMER_ReadTicks(void) {
+    // 32768 ticks per second
+    return (HOST_MOCKS_NowNs() << 15) / 1000000000U;
+}
+
+EMBENET_TimeUs EMBENET_TIMER_ReadCounter(void) {
+    return (EMBENET_TimeUs)(HOST_MOCKS_NowNs() / 1000U);
+}
+
+// ###################################################################################################
+//  Critical section
+// ###################################################################################################
+
+// the tests run in a single thread, with no interrupts to mask
+
+void EMBENET_CRITICAL_SECTION_Enter(void) {
+}
+
+void EMBENET_CRITICAL_SECTION_Exit(void) {
+}
+
+// ###################################################################################################
+//  ECB
+// ###################################################################################################
+
+/*
+The peripheral is replaced with a plain byte-oriented AES-128 encryption (FIPS-197), fast enough for the tests. A batch is encrypted
+right away, with the callback called before EMBENET_ECB_StartBatch returns.
+ */
+
+static uint8_t sbox[256];
+static bool    sboxReady;
+
+static inline uint8_t rotl8(uint8_t x, unsigned shift) {
+    return (uint8_t)((x << shift) | (x >> (8U - shift)));
+}
+
+static inline uint8_t xtime(uint8_t x) {
+    return (uint8_t)((x << 1) ^ ((x & 0x80U) ? 0x1bU : 0x00U));
+}
+
+static void sboxInit(void) {
+    // p runs over the multiplicative group generated by 3, q over the inverses of its elements
+    uint8_t p = 1;
+    uint8_t q = 1;
+    do {
+        p = (uint8_t)(p ^ xtime(p));
+        q = (uint8_t)(q ^ (q << 1));
+        q = (uint8_t)(q ^ (q << 2));
+        q = (uint8_t)(q ^ (q << 4));
+        if (q & 0x80U) {
+            q ^= 0x09U;
+        }
+        sbox[p] = (uint8_t)(q ^ rotl8(q, 1) ^ rotl8(q, 2) ^ rotl8(q, 3) ^ rotl8(q, 4) ^ 0x63U);
+    } while (1 != p);
+    sbox[0]   = 0x63;
+    sboxReady = true;
+}
+
+static void encryptBlock(uint8_t const key[16], uint8_t const in[16], uint8_t out[16]) {
+    uint8_t roundKey[16];
+    uint8_t state[16];
+    uint8_t rcon = 1;
+    if (!sboxReady) {
+        sboxInit();
+    }
+    memcpy(roundKey, key, sizeof(roundKey));
+    for (size_t i = 0; i < 16; ++i) {
+        state[i] = (uint8_t)(in[i] ^ roundKey[i]);
+    }
+    for (unsigned round = 1; round <= 10; ++round) {
+        // SubBytes and ShiftRows, the state is column-major
+        uint8_t shifted[16];
+        for (size_t column = 0; column < 4; ++column) {
+            for (size_t row = 0; row < 4; ++row) {
+                shifted[4 * column + row] = sbox[state[4 * ((column + row) % 4) + row]];
+            }
+        }
+        // MixColumns, all but the last round
+        for (size_t column = 0; column < 4; ++column) {
+            uint8_t* c = &shifted[4 * column];
+            if (round < 10) {
+                uint8_t all = (uint8_t)(c[0] ^ c[1] ^ c[2] ^ c[3]);
+                uint8_t c0  = c[0];
+                c[0]        = (uint8_t)(c[0] ^ all ^ xtime((uint8_t)(c[0] ^ c[1])));
+                c[1]        = (uint8_t)(c[1] ^ all ^ xtime((uint8_t)(c[1] ^ c[2])));
+                c[2]        = (uint8_t)(c[2] ^ all ^ xtime((uint8_t)(c[2] ^ c[3])));
+                c[3]        = (uint8_t)(c[3] ^ all ^ xtime((uint8_t)(c[3] ^ c0)));
+            }
+        }
+        // next round key
+        uint8_t temp[4] = {sbox[roundKey[13]], sbox[roundKey[14]], sbox[roundKey[15]], sbox[roundKey[12]]};
+        temp[0] ^= rcon;
+        rcon = xtime(rcon);
+        for (size_t i = 0; i < 16; ++i) {
+            roundKey[i] ^= (i < 4) ? temp[i] : roundKey[i - 4];
+        }
+        for (size_t i = 0; i < 16; ++i) {
+            state[i] = (uint8_t)(shifted[i] ^ roundKey[i]);
+        }
+    }
+    memcpy(out, state, sizeof(state));
+}
+
+void EMBENET_ECB_Init(void) {
+}
+
+bool EMBENET_ECB_Run(EMBENET_ECB_Block* block) {
+    encryptBlock(block->key, block->cleartext, block->ciphertext);
+    return true;
+}
+
+bool EMBENET_ECB_StartBatch(EMBENET_ECB_Batch* batch, uint8_t const key[16U], uint8_t* blocks, size_t blockCount, EMBENET_ECB_BatchCallback callback, void* context) {
+    for (size_t i = 0; i < blockCount; ++i) {
+        encryptBlock(key, &blocks[16 * i], &blocks[16 * i]);
+    }
+    batch->done = blockCount;
+    callback(context, true);
+    return true;
+}
+
+bool EMBENET_ECB_IsBatchActive(void) {
+    return false;
+}
+
+// ###################################################################################################
+//  Flash (NVMC)
+// ###################################################################################################
+
+#define FLASH_PAGE_COUNT 2 ///< pages reserved for the store, as by the linker script
+#define FLASH_PAGE_WORDS (EMBENET_PORT_NVM_PAGE_SIZE / sizeof(uint32_t))
+#define FLASH_WORDS      (FLASH_PAGE_COUNT * FLASH_PAGE_WORDS)
+#define STRINGIFY_(x)    #x
+#define STRINGIFY(x)     STRINGIFY_(x)
+
+/*
+The pages of the store are a plain array, with the linker script symbols around it. The driver writes words with plain stores and waits
+for READY after every one, so every wait compares the array with its copy of the last programmed state: a changed word is programmed
+(its bits can only be cleared, as in flash), or reverted if the power is cut off. A page erase is carried out on the first wait after
+ERASEPAGE is written.
+ */
+
+uint32_t __start_embenet_nvm[FLASH_WORDS] __attribute__((aligned(4)));
+__asm__(".globl __stop_embenet_nvm\n.set __stop_embenet_nvm, __start_embenet_nvm + " STRINGIFY(FLASH_PAGE_COUNT * EMBENET_PORT_NVM_PAGE_SIZE));
+
+NRF_NVMC_Type HOST_MOCKS_Nvmc = {.READY = 1U};
+
+static struct {
+    uint32_t programmed[FLASH_WORDS]; ///< flash content after the last wait
+    size_t   wordsLeft;               ///< words programmed before the power is cut off, SIZE_MAX if never
+    unsigned faults;                  ///< accesses the flash does not allow
+} flash;
+
+uint32_t HOST_MOCKS_NvmcPoll(void) {
+    if (0 != HOST_MOCKS_Nvmc.ERASEPAGE) {
+        size_t page = (size_t)(uint32_t)(HOST_MOCKS_Nvmc.ERASEPAGE - (uint32_t)(uintptr_t)__start_embenet_nvm) / EMBENET_PORT_NVM_PAGE_SIZE;
+        if ((NVMC_CONFIG_WEN_Een != HOST_MOCKS_Nvmc.CONFIG) || (page >= FLASH_PAGE_COUNT)) {
+            flash.faults++;
+        } else {
+            memset(&flash.programmed[page * FLASH_PAGE_WORDS], 0xFF, EMBENET_PORT_NVM_PAGE_SIZE);
+            memset(&__start_embenet_nvm[page * FLASH_PAGE_WORDS], 0xFF, EMBENET_PORT_NVM_PAGE_SIZE);
+        }
+        HOST_MOCKS_Nvmc.ERASEPAGE = 0;
+    }
+    for (size_t i = 0; i < FLASH_WORDS; ++i) {
+        if (__start_embenet_nvm[i] == flash.programmed[i]) {
+            continue;
+        }
+        if ((NVMC_CONFIG_WEN_Wen != HOST_MOCKS_Nvmc.CONFIG) || (0 != (__start_embenet_nvm[i] & ~flash.programmed[i]))) {
+            flash.faults++;
+        }
+        if (0 == flash.wordsLeft) {
+            __start_embenet_nvm[i] = flash.programmed[i];
+            continue;
+        }
+        if (SIZE_MAX != flash.wordsLeft) {
+            flash.wordsLeft--;
+        }
+        flash.programmed[i] &= __start_embenet_nvm[i];
+        __start_embenet_nvm[i] = flash.programmed[i];
+    }
+    return 1U;
+}
+
+void HOST_MOCKS_FlashErase(void) {
+    memset(flash.programmed, 0xFF, sizeof(flash.programmed));
+    memset(__start_embenet_nvm, 0xFF, sizeof(__start_embenet_nvm));
+    HOST_MOCKS_Nvmc.CONFIG    = NVMC_CONFIG_WEN_Ren;
+    HOST_MOCKS_Nvmc.ERASEPAGE = 0;
+    flash.wordsLeft = SIZE_MAX;
+    flash.faults    = 0;
+}
+
+void HOST_MOCKS_FlashCutOff(size_t words) {
+    flash.wordsLeft = words;
+}
+
+uint32_t const* HOST_MOCKS_FlashGetPage(size_t page) {
+    return &__start_embenet_nvm[page * FLASH_PAGE_WORDS];
+}
+
+unsigned HOST_MOCKS_FlashGetFaults(void) {
+    return flash.faults;
+}
+
+// ###################################################################################################
+//  Expect
+// ###################################################################################################
+
+void EXPECT_OnAbortHandler(char const* why, char const* file, int line) {
+    fprintf(stderr, "Aborted: %s %s:%i\n", why, file, line);
+    abort();
+}
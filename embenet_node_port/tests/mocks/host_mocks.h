@@ -0,0 +1,83 @@
+/**
+ @file
+ @license   Commercial
+ @copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+ @version   1.1.4417
+ @purpose   Host tests of the embeNET Node port for nRF52832
+ @brief     Thin mocks of the BSP and of the peripherals used by the port modules built on the host.
+
+ The UARTE mock keeps the callbacks given on initialization and the chunk being sent, so a test completes the DMA transfers itself, one
+ chunk at a time, and feeds the received bytes as the DMA would. The software interrupts pended by the reception interrupt, which run the
+ deferred work, run as it returns, so they have to be enabled with EMBENET_DEFERRED_Init first. The ECB mock encrypts in software, synchronously, and the timer mock
+ follows the host monotonic clock. The critical section does nothing, the tests run in a single thread. The flash pages of the
+ non-volatile store are emulated in RAM, with the programming rules of the flash checked and power cut-offs simulated.
+
+ */
+
+#ifndef HOST_MOCKS_H_
+#define HOST_MOCKS_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Completes the UARTE transmissions until the driver has nothing more to send.
+ * @param[out] sink buffer the sent bytes are copied to, may be NULL
+ * @param[in] sinkSize size of the buffer, the bytes beyond it are discarded
+ * @return number of bytes sent
+ */
+size_t HOST_MOCKS_UarteDrainTx(uint8_t* sink, size_t sinkSize);
+
+/**
+ * @brief Passes received bytes to the UARTE driver, as its reception interrupt would, and runs the interrupts pended meanwhile.
+ * @param[in] data received bytes
+ * @param[in] length number of bytes
+ */
+void HOST_MOCKS_UarteReceive(uint8_t const* data, size_t length);
+
+/**
+ * @brief Checks if the UARTE reception is paused by the driver.
+ * @return true if paused
+ */
+bool HOST_MOCKS_UarteIsRxPaused(void);
+
+/**
+ * @brief Reads the host monotonic clock.
+ * @return time [ns]
+ */
+uint64_t HOST_MOCKS_NowNs(void);
+
+/**
+ * @brief Erases the whole emulated flash, as on a new device, and clears the faults and the cut-off.
+ */
+void HOST_MOCKS_FlashErase(void);
+
+/**
+ * @brief Cuts the power off after the given number of programmed words: the later writes are lost until the next cut-off setting.
+ * @param[in] words number of words still programmed, SIZE_MAX to never cut the power off
+ */
+void HOST_MOCKS_FlashCutOff(size_t words);
+
+/**
+ * @brief Gets a flash page of the store.
+ * @param[in] page page index
+ * @return words of the page
+ */
+uint32_t const* HOST_MOCKS_FlashGetPage(size_t page);
+
+/**
+ * @brief Gets the number of flash accesses the flash does not allow (bits set by a write, a write or an erase not enabled) so far.
+ * @return number of faults
+ */
+unsigned HOST_MOCKS_FlashGetFaults(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_MOCKS_H_
@@ -0,0 +1,59 @@
+/**
+ @file
+ @license   Commercial
+ @copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+ @version   1.1.4417
+ @purpose   Host tests of the embeNET Node port for nRF52832
+ @brief     Stand-in for the device header, with just what the port modules built on the host need.
+
+ */
+
+#ifndef NRF52_H
+#define NRF52_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/// Interrupts of the port modules built on the host
+typedef enum {
+    SWI0_EGU0_IRQn = 20,
+    SWI2_EGU2_IRQn = 22,
+} IRQn_Type;
+
+/// Resets the device, which ends the test program on the host
+static inline void NVIC_SystemReset(void) {
+    abort();
+}
+
+static inline uint32_t NVIC_GetPriorityGrouping(void) {
+    return 0;
+}
+
+static inline uint32_t NVIC_EncodePriority(uint32_t priorityGroup, uint32_t preemptPriority, uint32_t subPriority) {
+    (void)priorityGroup;
+    (void)subPriority;
+    return preemptPriority;
+}
+
+static inline void NVIC_SetPriority(IRQn_Type irq, uint32_t priority) {
+    (void)irq;
+    (void)priority;
+}
+
+/// The interrupts are emulated by host_mocks.c: a pending interrupt that is enabled runs when the mocked interrupt it was pended from returns
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_ClearPendingIRQ(IRQn_Type irq);
+void NVIC_SetPendingIRQ(IRQn_Type irq);
+
+/// Non-volatile memory controller, emulated by host_mocks.c over the flash pages of the store
+typedef struct {
+    volatile uint32_t READY;     ///< always ready, flash operations complete synchronously
+    volatile uint32_t CONFIG;    ///< write and erase enable
+    volatile uint32_t ERASEPAGE; ///< low 32 bits of the address of the page to erase
+} NRF_NVMC_Type;
+
+extern NRF_NVMC_Type HOST_MOCKS_Nvmc;
+
+#define NRF_NVMC (&HOST_MOCKS_Nvmc)
+
+#endif // NRF52_H
@@ -0,0 +1,32 @@
+/**
+ @file
+ @license   Commercial
+ @copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+ @version   1.1.4417
+ @purpose   Host tests of the embeNET Node port for nRF52832
+ @brief     Stand-in for the device bit fields, with just what the port modules built on the host need.
+
+ The NVMC driver waits for READY after every flash access. The READY mask is read through HOST_MOCKS_NvmcPoll, which applies the access
+ to the emulated flash before returning the real mask.
+
+ */
+
+#ifndef NRF52_BITFIELDS_H
+#define NRF52_BITFIELDS_H
+
+#include <stdint.h>
+
+/**
+ * @brief Applies the accesses made to the emulated flash since the last call.
+ * @return READY mask
+ */
+uint32_t HOST_MOCKS_NvmcPoll(void);
+
+#define NVMC_READY_READY_Msk (HOST_MOCKS_NvmcPoll())
+
+#define NVMC_CONFIG_WEN_Pos (0UL)
+#define NVMC_CONFIG_WEN_Ren (0UL)
+#define NVMC_CONFIG_WEN_Wen (1UL)
+#define NVMC_CONFIG_WEN_Een (2UL)
+
+#endif // NRF52_BITFIELDS_H
@@ -0,0 +1,362 @@
+/**
+ @file
+ @license   Commercial
+ @copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+ @version   1.1.4417
+ @purpose   Host tests of the embeNET Node port for nRF52832
+ @brief     Microbenchmarks of the port modules built on the host.
+
+ Every benchmark is run in batches sized to take about BATCH_NS each, and the fastest of BATCH_COUNT batches is reported, in ns per
+ operation, which filters out most of the noise of a shared host. The results can be written to a baseline file and later compared
+ with it: a benchmark slower than its baseline by more than the tolerance is reported as a regression and fails the run. The host is
+ not the target, so only the ratios between runs on the same host carry over, not the absolute numbers.
+
+ usage: port_bench [--quick] [--baseline FILE] [--write FILE] [--tolerance PERCENT]
+
+ */
+
+#include "embenet_aes128.h"
+#include "embenet_brt.h"
+#include "embenet_port_brt.h"
+#include "embenet_port_deferred.h"
+#include "embenet_port_timer_extension.h"
+#include "host_mocks.h"
+#include "spsc_ring_buffer.h"
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// FCS step of the HDLC codec, not in any header
+uint16_t openhdlc_crc(uint16_t crc, uint8_t byte);
+
+#define BATCH_NS          20000000U // duration of a batch [ns]
+#define QUICK_BATCH_NS    1000000U  // duration of a batch with --quick [ns]
+#define BATCH_COUNT       5         // number of batches, the fastest counts
+#define DEFAULT_TOLERANCE 20.0      // slowdown reported as a regression [%]
+#define MAX_BENCHMARKS    16
+#define NAME_SIZE         32
+
+/// Benchmark: runs the given number of operations and returns the number of bytes they processed (0 if not relevant)
+typedef size_t (*BenchmarkFunction)(size_t operations);
+
+typedef struct {
+    char const*       name;
+    BenchmarkFunction run;
+    void (*setup)(void); ///< called once before the batches, may be NULL
+} Benchmark;
+
+typedef struct {
+    char   name[NAME_SIZE];
+    double nsPerOperation;
+} Result;
+
+static volatile uint32_t sink; ///< keeps the results from being optimized away
+
+static uint8_t packet[196];
+static uint8_t encodedFrame[512];
+static size_t  encodedFrameLength;
+
+// ###################################################################################################
+//  HDLC
+// ###################################################################################################
+
+static void fillPacket(void) {
+    for (size_t i = 0; i < sizeof(packet); ++i) {
+        // about 1 in 32 bytes to escape, as in random data
+        packet[i] = (uint8_t)((0 == (i % 32)) ? 0x7e : (i * 37 + 11));
+    }
+}
+
+static void hdlcSetup(void) {
+    fillPacket();
+    EMBENET_BRT_Deinit();
+    EMBENET_BRT_Init();
+    (void)EMBENET_BRT_TrySend(packet, sizeof(packet));
+    encodedFrameLength = HOST_MOCKS_UarteDrainTx(encodedFrame, sizeof(encodedFrame));
+}
+
+static size_t hdlcEncode(size_t operations, size_t length) {
+    for (size_t i = 0; i < operations; ++i) {
+        (void)EMBENET_BRT_TrySend(packet, length);
+        sink += (uint32_t)HOST_MOCKS_UarteDrainTx(NULL, 0);
+    }
+    return operations * length;
+}
+
+static size_t hdlcEncode16(size_t operations) {
+    return hdlcEncode(operations, 16);
+}
+
+static size_t hdlcEncode196(size_t operations) {
+    return hdlcEncode(operations, sizeof(packet));
+}
+
+static size_t hdlcDecode196(size_t operations) {
+    uint8_t received[256];
+    for (size_t i = 0; i < operations; ++i) {
+        HOST_MOCKS_UarteReceive(encodedFrame, encodedFrameLength);
+        sink += (uint32_t)EMBENET_BRT_Receive(received, sizeof(received));
+    }
+    return operations * sizeof(packet);
+}
+
+static size_t crc16(size_t operations) {
+    uint16_t crc = 0xffff;
+    for (size_t i = 0; i < operations; ++i) {
+        for (size_t j = 0; j < sizeof(packet); ++j) {
+            crc = openhdlc_crc(crc, packet[j]);
+        }
+    }
+    sink += crc;
+    return operations * sizeof(packet);
+}
+
+// ###################################################################################################
+//  Ring buffer
+// ###################################################################################################
+
+static uint8_t        ringStorage[1024];
+static SpscRingBuffer ringBuffer;
+
+static void ringSetup(void) {
+    fillPacket();
+    (void)SpscRingBuffer_Init(&ringBuffer, ringStorage, sizeof(ringStorage));
+}
+
+static size_t ringWriteRead(size_t operations, size_t length) {
+    uint8_t out[64];
+    for (size_t i = 0; i < operations; ++i) {
+        sink += (uint32_t)SpscRingBuffer_Write(&ringBuffer, packet, length);
+        sink += (uint32_t)SpscRingBuffer_Read(&ringBuffer, out, length);
+    }
+    return operations * length;
+}
+
+static size_t ringWriteRead1(size_t operations) {
+    return ringWriteRead(operations, 1);
+}
+
+static size_t ringWriteRead64(size_t operations) {
+    return ringWriteRead(operations, 64);
+}
+
+// ###################################################################################################
+//  Timer
+// ###################################################################################################
+
+static size_t usToTicks(size_t operations) {
+    uint32_t value = 12345;
+    uint32_t sum   = 0;
+    for (size_t i = 0; i < operations; ++i) {
+        sum += EMBENET_TIMER_UsToTicks(value);
+        value = value * 1664525U + 1013904223U;
+    }
+    sink += sum;
+    return 0;
+}
+
+static size_t ticksToUs(size_t operations) {
+    uint32_t value = 12345;
+    uint32_t sum   = 0;
+    for (size_t i = 0; i < operations; ++i) {
+        sum += EMBENET_TIMER_TicksToUs(value);
+        value = value * 1664525U + 1013904223U;
+    }
+    sink += sum;
+    return 0;
+}
+
+// ###################################################################################################
+//  AES-128
+// ###################################################################################################
+
+#define BENCH_KEY_COUNT 8 // more than the keys of the stack kept expanded, so that every change of key is expanded anew
+
+static uint8_t keys[BENCH_KEY_COUNT][16];
+
+static void aesSetup(void) {
+    for (size_t k = 0; k < BENCH_KEY_COUNT; ++k) {
+        for (size_t i = 0; i < 16; ++i) {
+            keys[k][i] = (uint8_t)(k * 16 + i);
+        }
+    }
+    EMBENET_AES128_Init();
+    EMBENET_AES128_SetKey(keys[0]);
+}
+
+static size_t aesDecrypt(size_t operations) {
+    uint8_t block[16] = {0};
+    for (size_t i = 0; i < operations; ++i) {
+        EMBENET_AES128_Decrypt(block);
+    }
+    sink += block[0];
+    return operations * sizeof(block);
+}
+
+static size_t aesSetKeyExpand(size_t operations) {
+    for (size_t i = 0; i < operations; ++i) {
+        EMBENET_AES128_SetKey(keys[i % BENCH_KEY_COUNT]);
+    }
+    return 0;
+}
+
+static size_t aesSetKeyCached(size_t operations) {
+    for (size_t i = 0; i < operations; ++i) {
+        EMBENET_AES128_SetKey(keys[i % 2]);
+    }
+    return 0;
+}
+
+// ###################################################################################################
+//  Runner
+// ###################################################################################################
+
+static Benchmark const benchmarks[] = {
+    {"hdlc_encode_16", hdlcEncode16, hdlcSetup},
+    {"hdlc_encode_196", hdlcEncode196, hdlcSetup},
+    {"hdlc_decode_196", hdlcDecode196, hdlcSetup},
+    {"crc16_196", crc16, fillPacket},
+    {"ring_write_read_1", ringWriteRead1, ringSetup},
+    {"ring_write_read_64", ringWriteRead64, ringSetup},
+    {"timer_us_to_ticks", usToTicks, NULL},
+    {"timer_ticks_to_us", ticksToUs, NULL},
+    {"aes128_decrypt_block", aesDecrypt, aesSetup},
+    {"aes128_set_key_expand", aesSetKeyExpand, aesSetup},
+    {"aes128_set_key_cached", aesSetKeyCached, aesSetup},
+};
+
+#define BENCHMARK_COUNT (sizeof(benchmarks) / sizeof(benchmarks[0]))
+
+static double measure(Benchmark const* benchmark, uint64_t batchNs, size_t* bytesPerOperation) {
+    if (NULL != benchmark->setup) {
+        benchmark->setup();
+    }
+    // batch size doubled until it takes long enough
+    size_t   operations = 1;
+    uint64_t elapsed    = 0;
+    while (true) {
+        uint64_t start = HOST_MOCKS_NowNs();
+        benchmark->run(operations);
+        elapsed = HOST_MOCKS_NowNs() - start;
+        if (elapsed >= batchNs / 4) {
+            break;
+        }
+        operations *= 2;
+    }
+    operations = (size_t)((double)operations * (double)batchNs / (double)elapsed) + 1;
+
+    double best = 0;
+    for (unsigned batch = 0; batch < BATCH_COUNT; ++batch) {
+        uint64_t start = HOST_MOCKS_NowNs();
+        size_t   bytes = benchmark->run(operations);
+        double   ns    = (double)(HOST_MOCKS_NowNs() - start) / (double)operations;
+        if ((0 == batch) || (ns < best)) {
+            best = ns;
+        }
+        *bytesPerOperation = bytes / operations;
+    }
+    return best;
+}
+
+static size_t loadBaseline(char const* path, Result* results, size_t capacity) {
+    FILE* file = fopen(path, "r");
+    if (NULL == file) {
+        printf("Unable to open baseline %s\n", path);
+        return 0;
+    }
+    size_t count = 0;
+    char   line[128];
+    while ((count < capacity) && (NULL != fgets(line, sizeof(line), file))) {
+        if (('#' == line[0]) || ('\n' == line[0])) {
+            continue;
+        }
+        if (2 == sscanf(line, "%31s %lf", results[count].name, &results[count].nsPerOperation)) {
+            count++;
+        }
+    }
+    fclose(file);
+    return count;
+}
+
+static bool writeBaseline(char const* path, Result const* results, size_t count) {
+    FILE* file = fopen(path, "w");
+    if (NULL == file) {
+        printf("Unable to write baseline %s\n", path);
+        return false;
+    }
+    fprintf(file, "# port_bench baseline: benchmark, ns per operation\n");
+    for (size_t i = 0; i < count; ++i) {
+        fprintf(file, "%s %.2f\n", results[i].name, results[i].nsPerOperation);
+    }
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    uint64_t    batchNs      = BATCH_NS;
+    char const* baselinePath = NULL;
+    char const* writePath    = NULL;
+    double      tolerance    = DEFAULT_TOLERANCE;
+    for (int i = 1; i < argc; ++i) {
+        if (0 == strcmp(argv[i], "--quick")) {
+            batchNs = QUICK_BATCH_NS;
+        } else if ((0 == strcmp(argv[i], "--baseline")) && (i + 1 < argc)) {
+            baselinePath = argv[++i];
+        } else if ((0 == strcmp(argv[i], "--write")) && (i + 1 < argc)) {
+            writePath = argv[++i];
+        } else if ((0 == strcmp(argv[i], "--tolerance")) && (i + 1 < argc)) {
+            tolerance = atof(argv[++i]);
+        } else {
+            printf("usage: %s [--quick] [--baseline FILE] [--write FILE] [--tolerance PERCENT]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    // the link delimits the received frames in the deferred work
+    EMBENET_DEFERRED_Init();
+
+    Result baseline[MAX_BENCHMARKS];
+    size_t baselineCount = (NULL != baselinePath) ? loadBaseline(baselinePath, baseline, MAX_BENCHMARKS) : 0;
+    if ((NULL != baselinePath) && (0 == baselineCount)) {
+        return EXIT_FAILURE;
+    }
+
+    Result   results[BENCHMARK_COUNT];
+    unsigned regressions = 0;
+    printf("%-24s %12s %10s %10s\n", "benchmark", "ns/op", "MB/s", "baseline");
+    for (size_t i = 0; i < BENCHMARK_COUNT; ++i) {
+        size_t bytesPerOperation = 0;
+        double ns                = measure(&benchmarks[i], batchNs, &bytesPerOperation);
+        snprintf(results[i].name, sizeof(results[i].name), "%s", benchmarks[i].name);
+        results[i].nsPerOperation = ns;
+
+        printf("%-24s %12.2f", benchmarks[i].name, ns);
+        if (0 != bytesPerOperation) {
+            printf(" %10.1f", (double)bytesPerOperation * 1000.0 / ns);
+        } else {
+            printf(" %10s", "-");
+        }
+        for (size_t j = 0; j < baselineCount; ++j) {
+            if (0 == strcmp(baseline[j].name, benchmarks[i].name)) {
+                double change = (ns / baseline[j].nsPerOperation - 1.0) * 100.0;
+                printf(" %+9.1f%%", change);
+                if (change > tolerance) {
+                    printf("  REGRESSION");
+                    regressions++;
+                }
+            }
+        }
+        printf("\n");
+    }
+
+    if ((NULL != writePath) && !writeBaseline(writePath, results, BENCHMARK_COUNT)) {
+        return EXIT_FAILURE;
+    }
+    if (0 != regressions) {
+        printf("%u benchmarks slower than the baseline by more than %.0f%%\n", regressions, tolerance);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
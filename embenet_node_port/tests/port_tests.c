@@ -0,0 +1,504 @@
+/**
+ @file
+ @license   Commercial
+ @copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+ @version   1.1.4417
+ @purpose   Host tests of the embeNET Node port for nRF52832
+ @brief     Checks of the port modules built on the host, which the benchmarks rely on to measure working code.
+
+ */
+
+#include "embenet_aes128.h"
+#include "embenet_brt.h"
+#include "embenet_port_aes128.h"
+#include "embenet_port_brt.h"
+#include "embenet_port_channel_quality.h"
+#include "embenet_port_channel_quality_internal.h"
+#include "embenet_port_config.h"
+#include "embenet_port_deferred.h"
+#include "embenet_port_nvm.h"
+#include "embenet_port_packet_pool.h"
+#include "embenet_port_radio_config.h"
+#include "embenet_port_timer_extension.h"
+#include "host_mocks.h"
+#include "spsc_ring_buffer.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/// FCS step of the HDLC codec, not in any header
+uint16_t openhdlc_crc(uint16_t crc, uint8_t byte);
+
+static unsigned failures;
+
+#define CHECK(expr)                                                                                                                        \
+    do {                                                                                                                                   \
+        if (!(expr)) {                                                                                                                     \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr);                                                               \
+            failures++;                                                                                                                    \
+        }                                                                                                                                  \
+    } while (0)
+
+static void testCrc(void) {
+    // CRC-16/X-25 check value
+    uint8_t const data[] = "123456789";
+    uint16_t      crc    = 0xffff;
+    for (size_t i = 0; i < 9; ++i) {
+        crc = openhdlc_crc(crc, data[i]);
+    }
+    uint16_t fcs = (uint16_t)~crc;
+    CHECK(0x906e == fcs);
+}
+
+static void testHdlcRoundTrip(void) {
+    static uint8_t encoded[4096];
+    uint8_t        packet[196];
+    uint8_t        received[256];
+    EMBENET_BRT_Init();
+    for (size_t length = 1; length <= sizeof(packet); ++length) {
+        for (size_t i = 0; i < length; ++i) {
+            // plenty of bytes to escape
+            packet[i] = (uint8_t)((i % 3) ? (0x7d + (i % 2)) : (i * 7 + length));
+        }
+        CHECK(EMBENET_BRT_TrySend(packet, length));
+        size_t encodedLength = HOST_MOCKS_UarteDrainTx(encoded, sizeof(encoded));
+        CHECK(encodedLength <= 2 * length + 6);
+        HOST_MOCKS_UarteReceive(encoded, encodedLength);
+        CHECK(length == EMBENET_BRT_Receive(received, sizeof(received)));
+        CHECK(0 == memcmp(packet, received, length));
+    }
+    // a corrupted frame is dropped
+    packet[0] = 0x55;
+    CHECK(EMBENET_BRT_TrySend(packet, 10));
+    size_t encodedLength = HOST_MOCKS_UarteDrainTx(encoded, sizeof(encoded));
+    encoded[3] ^= 0x01;
+    HOST_MOCKS_UarteReceive(encoded, encodedLength);
+    CHECK(0 == EMBENET_BRT_Receive(received, sizeof(received)));
+    EMBENET_BRT_Deinit();
+}
+
+static void testBrtOutputFull(void) {
+    static uint8_t encoded[8192];
+    uint8_t        packet[100];
+    uint8_t        received[256];
+    memset(packet, 0x7e, sizeof(packet));
+    EMBENET_BRT_Init();
+    EMBENET_BRT_Stats before;
+    EMBENET_BRT_GetStats(&before);
+
+    // with the transmission stalled, whole frames are queued until the space runs out, and the space query never overpromises
+    size_t queued = 0;
+    while (EMBENET_BRT_GetOutputSpace() >= sizeof(packet)) {
+        CHECK(EMBENET_BRT_TrySend(packet, sizeof(packet)));
+        queued++;
+    }
+    CHECK(queued > 0);
+    CHECK(!EMBENET_BRT_TrySend(packet, sizeof(packet)));
+    EMBENET_BRT_Send(packet, sizeof(packet));
+
+    EMBENET_BRT_Stats after;
+    EMBENET_BRT_GetStats(&after);
+    CHECK(1 == after.packetsDropped - before.packetsDropped);
+    CHECK(0 == after.txStalls - before.txStalls);
+
+    // every queued frame arrives intact
+    size_t encodedLength = HOST_MOCKS_UarteDrainTx(encoded, sizeof(encoded));
+    CHECK(encodedLength < sizeof(encoded));
+    size_t decoded = 0;
+    for (size_t offset = 0; offset < encodedLength; offset += 256) {
+        // in chunks, the input buffer may be smaller than the output one
+        HOST_MOCKS_UarteReceive(&encoded[offset], (encodedLength - offset < 256) ? (encodedLength - offset) : 256);
+        while (sizeof(packet) == EMBENET_BRT_Receive(received, sizeof(received))) {
+            CHECK(0 == memcmp(packet, received, sizeof(packet)));
+            decoded++;
+        }
+    }
+    CHECK(queued == decoded);
+    EMBENET_BRT_Deinit();
+}
+
+static void testBrtReceiveBuffer(void) {
+    static uint8_t encoded[1024];
+    uint8_t        packet[50];
+    uint8_t        received[256];
+    for (size_t i = 0; i < sizeof(packet); ++i) {
+        packet[i] = (uint8_t)(i * 11);
+    }
+    EMBENET_BRT_Init();
+    EMBENET_BRT_Stats before;
+    EMBENET_BRT_GetStats(&before);
+
+    // a frame longer than the buffer is dropped, and nothing is copied
+    CHECK(EMBENET_BRT_TrySend(packet, sizeof(packet)));
+    size_t encodedLength = HOST_MOCKS_UarteDrainTx(encoded, sizeof(encoded));
+    HOST_MOCKS_UarteReceive(encoded, encodedLength);
+    memset(received, 0xa5, sizeof(received));
+    CHECK(0 == EMBENET_BRT_Receive(received, sizeof(packet) - 1));
+    CHECK((0xa5 == received[0]) && (0 == memcmp(received, &received[1], sizeof(received) - 1)));
+
+    // so is a frame with a wrong FCS
+    CHECK(EMBENET_BRT_TrySend(packet, sizeof(packet)));
+    encodedLength = HOST_MOCKS_UarteDrainTx(encoded, sizeof(encoded));
+    encoded[5] ^= 0x01;
+    HOST_MOCKS_UarteReceive(encoded, encodedLength);
+    CHECK(0 == EMBENET_BRT_Receive(received, sizeof(received)));
+    CHECK((0xa5 == received[0]) && (0 == memcmp(received, &received[1], sizeof(received) - 1)));
+
+    EMBENET_BRT_Stats after;
+    EMBENET_BRT_GetStats(&after);
+    CHECK(1 == after.framingErrors - before.framingErrors);
+    CHECK(1 == after.crcErrors - before.crcErrors);
+
+    // back-to-back frames, sharing the flag between them, are received into whichever buffers the caller passes
+    uint8_t other[sizeof(packet)];
+    CHECK(EMBENET_BRT_TrySend(packet, sizeof(packet)));
+    encodedLength = HOST_MOCKS_UarteDrainTx(encoded, sizeof(encoded));
+    CHECK(EMBENET_BRT_TrySend(packet, 10));
+    encodedLength += HOST_MOCKS_UarteDrainTx(&encoded[encodedLength - 1], sizeof(encoded) - encodedLength) - 1;
+    HOST_MOCKS_UarteReceive(encoded, encodedLength);
+    CHECK(sizeof(packet) == EMBENET_BRT_Receive(received, sizeof(received)));
+    CHECK(0 == memcmp(packet, received, sizeof(packet)));
+    CHECK(10 == EMBENET_BRT_Receive(other, sizeof(other)));
+    CHECK(0 == memcmp(packet, other, 10));
+    EMBENET_BRT_Deinit();
+}
+
+/// Checks that the next received frame is made of a record of each of the given packets
+static void checkAggregatedFrame(uint8_t const* const* packets, size_t const* lengths, size_t count) {
+    uint8_t received[256];
+    size_t  length = EMBENET_BRT_Receive(received, sizeof(received));
+    size_t  offset = 0;
+    for (size_t i = 0; i < count; ++i) {
+        CHECK((offset < length) && (lengths[i] == received[offset]));
+        CHECK((offset + 1 + lengths[i] <= length) && (0 == memcmp(packets[i], &received[offset + 1], lengths[i])));
+        offset += 1 + lengths[i];
+    }
+    CHECK(offset == length);
+}
+
+static void testBrtAggregation(void) {
+    static uint8_t encoded[4096];
+    uint8_t        packets[3][196];
+    for (size_t i = 0; i < sizeof(packets); ++i) {
+        packets[i / sizeof(packets[0])][i % sizeof(packets[0])] = (uint8_t)((i % 5) ? (0x7d + (i % 2)) : i);
+    }
+    uint8_t const* shared[3] = {packets[0], packets[1], packets[2]};
+    size_t const   lengths[] = {5, 20, 1};
+    EMBENET_BRT_Init();
+    CHECK(!EMBENET_BRT_IsAggregationEnabled());
+    EMBENET_BRT_SetAggregation(true);
+    CHECK(EMBENET_BRT_IsAggregationEnabled());
+
+    // the packets wait for company and share one frame, as records of a length byte and the packet, under one FCS
+    for (size_t i = 0; i < 3; ++i) {
+        CHECK(EMBENET_BRT_TrySend(packets[i], lengths[i]));
+    }
+    CHECK(0 == HOST_MOCKS_UarteDrainTx(encoded, sizeof(encoded)));
+    EMBENET_BRT_Flush();
+    size_t encodedLength = HOST_MOCKS_UarteDrainTx(encoded, sizeof(encoded));
+    HOST_MOCKS_UarteReceive(encoded, encodedLength);
+    checkAggregatedFrame(shared, lengths, 3);
+    CHECK(0 == EMBENET_BRT_GetPendingFrameCount());
+
+    // a packet too long to share a frame sends the aggregated ones first, and goes out alone as a single record
+    size_t const longLength = sizeof(packets[0]);
+    CHECK(EMBENET_BRT_TrySend(packets[0], lengths[0]));
+    CHECK(EMBENET_BRT_TrySend(packets[1], longLength));
+    encodedLength = HOST_MOCKS_UarteDrainTx(encoded, sizeof(encoded));
+    HOST_MOCKS_UarteReceive(encoded, encodedLength);
+    checkAggregatedFrame(&shared[0], &lengths[0], 1);
+    checkAggregatedFrame(&shared[1], &longLength, 1);
+
+    // the frame goes out by itself once the timeout passes, when the link is polled
+    CHECK(EMBENET_BRT_TrySend(packets[2], lengths[2]));
+    uint64_t start = HOST_MOCKS_NowNs();
+    while (HOST_MOCKS_NowNs() - start < (EMBENET_PORT_BRT_AGGREGATION_TIMEOUT_US + 500U) * 1000U) {
+    }
+    uint8_t received[256];
+    CHECK(0 == EMBENET_BRT_Receive(received, sizeof(received)));
+    encodedLength = HOST_MOCKS_UarteDrainTx(encoded, sizeof(encoded));
+    HOST_MOCKS_UarteReceive(encoded, encodedLength);
+    checkAggregatedFrame(&shared[2], &lengths[2], 1);
+
+    // a new link starts with the plain framing, until the border router offers again
+    EMBENET_BRT_Deinit();
+    EMBENET_BRT_Init();
+    CHECK(!EMBENET_BRT_IsAggregationEnabled());
+    CHECK(EMBENET_BRT_TrySend(packets[0], lengths[0]));
+    encodedLength = HOST_MOCKS_UarteDrainTx(encoded, sizeof(encoded));
+    HOST_MOCKS_UarteReceive(encoded, encodedLength);
+    CHECK(lengths[0] == EMBENET_BRT_Receive(received, sizeof(received)));
+    CHECK(0 == memcmp(packets[0], received, lengths[0]));
+    EMBENET_BRT_Deinit();
+}
+
+static uint64_t testAsn;
+
+static uint64_t getTestAsn(void) {
+    return testAsn;
+}
+
+static void testChannelQualityMap(void) {
+    // one to the most channels allowed, spread out or packed, and pairs that are a multiple of the good channel count apart
+    EMBENET_ChannelMask const blacklists[] = {
+        UINT64_C(0x1),
+        UINT64_C(1) << 36,
+        UINT64_C(0x5555),
+        UINT64_C(0x1fffff),
+        UINT64_C(0x1fffff) << 16,
+        UINT64_C(0x0f0f0f0f),
+        UINT64_C(1) | (UINT64_C(1) << 35),
+        UINT64_C(0x3) | (UINT64_C(0x3) << 33),
+    };
+    uint64_t const asns[] = {0, 1, 20, 36, 37, 1000, UINT64_C(0x123456789)};
+    EMBENET_CHANNEL_QUALITY_Reset();
+    // nothing is remapped until the ASN source is set
+    CHECK(EMBENET_CHANNEL_QUALITY_SetBlacklist(blacklists[0]));
+    CHECK(0 == EMBENET_CHANNEL_QUALITY_Map(0));
+    EMBENET_CHANNEL_QUALITY_SetAsnSource(getTestAsn);
+    for (size_t i = 0; i < sizeof(blacklists) / sizeof(blacklists[0]); ++i) {
+        EMBENET_ChannelMask blacklist = blacklists[i];
+        CHECK(EMBENET_CHANNEL_QUALITY_SetBlacklist(blacklist));
+        for (size_t j = 0; j < sizeof(asns) / sizeof(asns[0]); ++j) {
+            testAsn = asns[j];
+            for (uint8_t ch = 0; ch < EMBENET_CHANNEL_QUALITY_CHANNEL_COUNT; ++ch) {
+                uint8_t mapped = EMBENET_CHANNEL_QUALITY_Map(ch);
+                CHECK((mapped < EMBENET_CHANNEL_QUALITY_CHANNEL_COUNT) && (0 == ((blacklist >> mapped) & 1U)));
+                if (0 == ((blacklist >> ch) & 1U)) {
+                    CHECK(ch == mapped);
+                }
+            }
+            // the cells of different channel offsets in this slot never share a channel
+            EMBENET_ChannelMask used = 0;
+            for (unsigned offset = 0; offset < EMBENET_CHANNEL_QUALITY_CHANNEL_OFFSETS; ++offset) {
+                uint8_t mapped = EMBENET_CHANNEL_QUALITY_Map((uint8_t)((testAsn + offset) % EMBENET_CHANNEL_QUALITY_CHANNEL_COUNT));
+                CHECK(0 == ((used >> mapped) & 1U));
+                used |= UINT64_C(1) << mapped;
+            }
+        }
+        // the advertising channels are never remapped
+        CHECK(37 == EMBENET_CHANNEL_QUALITY_Map(37));
+    }
+    EMBENET_CHANNEL_QUALITY_SetAsnSource(NULL);
+    EMBENET_CHANNEL_QUALITY_Reset();
+}
+
+static void testSpscRingBuffer(void) {
+    uint8_t        storage[64];
+    SpscRingBuffer ringBuffer;
+    CHECK(!SpscRingBuffer_Init(&ringBuffer, storage, 48));
+    CHECK(SpscRingBuffer_Init(&ringBuffer, storage, sizeof(storage)));
+
+    uint8_t  in[40];
+    uint8_t  out[40];
+    uint32_t next = 0;
+    for (unsigned round = 0; round < 100; ++round) {
+        for (size_t i = 0; i < sizeof(in); ++i) {
+            in[i] = (uint8_t)(next + i);
+        }
+        // wraps around every couple of rounds
+        CHECK(sizeof(in) == SpscRingBuffer_Write(&ringBuffer, in, sizeof(in)));
+        CHECK(sizeof(storage) - sizeof(in) == SpscRingBuffer_GetSpace(&ringBuffer));
+        CHECK(sizeof(out) == SpscRingBuffer_Read(&ringBuffer, out, sizeof(out)));
+        CHECK(0 == memcmp(in, out, sizeof(in)));
+        next += sizeof(in);
+    }
+    // writes only as much as fits
+    uint8_t more[2 * sizeof(storage)] = {0};
+    CHECK(sizeof(storage) == SpscRingBuffer_Write(&ringBuffer, more, sizeof(more)));
+    CHECK(0 == SpscRingBuffer_GetSpace(&ringBuffer));
+}
+
+static void testTimerConversions(void) {
+    // exact against plain 64-bit arithmetic, densely at the bottom and sparsely across the whole range
+    uint32_t value = 0;
+    for (unsigned i = 0; i < 2000000; ++i) {
+        CHECK(EMBENET_TIMER_TicksToUs(value) == (EMBENET_TimeUs)(((uint64_t)value * 15625U) / 512U));
+        CHECK(EMBENET_TIMER_UsToTicks(value) == (uint32_t)(((uint64_t)value * 512U) / 15625U));
+        value = (i < 1000000) ? (value + 1) : (value * 1664525U + 1013904223U);
+    }
+    CHECK(EMBENET_TIMER_UsToTicks(UINT32_MAX) == (uint32_t)(((uint64_t)UINT32_MAX * 512U) / 15625U));
+}
+
+static void testAes128(void) {
+    // FIPS-197 appendix C.1
+    uint8_t const key[16]        = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+    uint8_t const cleartext[16]  = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+    uint8_t const ciphertext[16] = {0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a};
+    uint8_t       block[16];
+
+    EMBENET_AES128_Init();
+    EMBENET_AES128_SetKey(key);
+    memcpy(block, cleartext, sizeof(block));
+    EMBENET_AES128_Encrypt(block);
+    CHECK(0 == memcmp(block, ciphertext, sizeof(block)));
+    EMBENET_AES128_Decrypt(block);
+    CHECK(0 == memcmp(block, cleartext, sizeof(block)));
+
+    EMBENET_AES128_KeyHandle handle = EMBENET_AES128_KeyCreate(key);
+    CHECK(EMBENET_AES128_KEY_HANDLE_INVALID != handle);
+    memcpy(block, ciphertext, sizeof(block));
+    CHECK(EMBENET_AES128_KeyDecrypt(handle, block));
+    CHECK(0 == memcmp(block, cleartext, sizeof(block)));
+    EMBENET_AES128_KeyDestroy(handle);
+    EMBENET_AES128_Deinit();
+}
+
+static void testNvm(void) {
+    uint8_t const first[]  = "first";
+    uint8_t       second[40];
+    uint8_t       out[64];
+    memset(second, 0x5a, sizeof(second));
+    HOST_MOCKS_FlashErase();
+    CHECK(EMBENET_NVM_Init());
+
+    // write, read, overwrite and delete
+    CHECK(EMBENET_NVM_Write(1, first, sizeof(first)));
+    CHECK(sizeof(first) == EMBENET_NVM_Read(1, out, sizeof(out)));
+    CHECK(0 == memcmp(first, out, sizeof(first)));
+    CHECK(0 == EMBENET_NVM_Read(2, out, sizeof(out)));
+    CHECK(EMBENET_NVM_Write(1, second, sizeof(second)));
+    CHECK(sizeof(second) == EMBENET_NVM_Read(1, out, 4));
+    CHECK(sizeof(second) == EMBENET_NVM_Read(1, out, sizeof(out)));
+    CHECK(0 == memcmp(second, out, sizeof(second)));
+    CHECK(EMBENET_NVM_Delete(1));
+    CHECK(0 == EMBENET_NVM_Read(1, out, sizeof(out)));
+    CHECK(EMBENET_NVM_Delete(1));
+    CHECK(!EMBENET_NVM_Write(EMBENET_NVM_KEY_INVALID, first, sizeof(first)));
+
+    // a write cut off before its CRC is ignored after the reset, and the next one lands after it
+    CHECK(EMBENET_NVM_Write(2, first, sizeof(first)));
+    HOST_MOCKS_FlashCutOff((EMBENET_NVM_GetRecordSize(sizeof(second)) / sizeof(uint32_t)) - 1);
+    (void)EMBENET_NVM_Write(2, second, sizeof(second));
+    HOST_MOCKS_FlashCutOff(SIZE_MAX);
+    CHECK(EMBENET_NVM_Init());
+    CHECK(0 == EMBENET_NVM_Read(1, out, sizeof(out)));
+    CHECK(sizeof(first) == EMBENET_NVM_Read(2, out, sizeof(out)));
+    CHECK(0 == memcmp(first, out, sizeof(first)));
+    CHECK(EMBENET_NVM_Write(2, second, sizeof(second)));
+    CHECK(sizeof(second) == EMBENET_NVM_Read(2, out, sizeof(out)));
+
+    // filling the first page compacts the latest values into the second one, with the next generation
+    uint32_t const* pages[2] = {HOST_MOCKS_FlashGetPage(0), HOST_MOCKS_FlashGetPage(1)};
+    uint8_t         counter  = 0;
+    while (EMBENET_NVM_GetFreeSpace() >= EMBENET_NVM_GetRecordSize(sizeof(counter))) {
+        CHECK(EMBENET_NVM_Write(3, &counter, sizeof(counter)));
+        counter++;
+    }
+    CHECK(0xFFFFFFFFU == pages[1][0]);
+    CHECK(EMBENET_NVM_Write(3, &counter, sizeof(counter)));
+    CHECK(pages[0][0] == pages[1][0]);
+    CHECK(pages[0][1] + 1 == pages[1][1]);
+    CHECK(EMBENET_NVM_GetFreeSpace() > EMBENET_PORT_NVM_PAGE_SIZE / 2);
+    uint8_t value = 0;
+    CHECK(1 == EMBENET_NVM_Read(3, &value, sizeof(value)));
+    CHECK(counter == value);
+    CHECK(sizeof(second) == EMBENET_NVM_Read(2, out, sizeof(out)));
+    CHECK(0 == memcmp(second, out, sizeof(second)));
+
+    // after a reset the page of the newer generation is used, although the older one is still valid
+    CHECK(EMBENET_NVM_Init());
+    CHECK(1 == EMBENET_NVM_Read(3, &value, sizeof(value)));
+    CHECK(counter == value);
+
+    // a compaction cut off before the magic of the new page leaves the old page active
+    size_t copiedWords = (EMBENET_NVM_GetRecordSize(sizeof(second)) + EMBENET_NVM_GetRecordSize(sizeof(counter))) / sizeof(uint32_t);
+    HOST_MOCKS_FlashCutOff(copiedWords + 1);
+    CHECK(EMBENET_NVM_Compact());
+    HOST_MOCKS_FlashCutOff(SIZE_MAX);
+    CHECK(0xFFFFFFFFU == pages[0][0]);
+    CHECK(EMBENET_NVM_Init());
+    CHECK(1 == EMBENET_NVM_Read(3, &value, sizeof(value)));
+    CHECK(counter == value);
+    CHECK(EMBENET_NVM_Compact());
+    CHECK(EMBENET_NVM_Init());
+    CHECK(pages[1][1] + 1 == pages[0][1]);
+    CHECK(sizeof(second) == EMBENET_NVM_Read(2, out, sizeof(out)));
+
+    // no programmed bit was ever set again without an erase
+    CHECK(0 == HOST_MOCKS_FlashGetFaults());
+}
+
+static void testPacketPool(void) {
+    EMBENET_PacketPoolStats before;
+    EMBENET_PACKET_POOL_GetStats(&before);
+    CHECK(0 == before.inUse);
+    CHECK(before.blockCount >= 2);
+
+    // every block is handed out once, word aligned, and then the pool runs dry
+    uint8_t* blocks[32];
+    for (uint32_t i = 0; i < before.blockCount; ++i) {
+        blocks[i] = EMBENET_PACKET_POOL_Alloc();
+        CHECK(NULL != blocks[i]);
+        CHECK(0 == ((uintptr_t)blocks[i] & 3U));
+        CHECK(1 == EMBENET_PACKET_POOL_GetRefCount(blocks[i]));
+        memset(blocks[i], (int)i, EMBENET_PACKET_POOL_BLOCK_SIZE);
+    }
+    CHECK(NULL == EMBENET_PACKET_POOL_Alloc());
+    for (uint32_t i = 0; i < before.blockCount; ++i) {
+        // no block overlaps another
+        CHECK((uint8_t)i == blocks[i][0]);
+        CHECK((uint8_t)i == blocks[i][EMBENET_PACKET_POOL_BLOCK_SIZE - 1]);
+    }
+    EMBENET_PacketPoolStats full;
+    EMBENET_PACKET_POOL_GetStats(&full);
+    CHECK(full.blockCount == full.inUse);
+    CHECK(full.blockCount == full.highWatermark);
+    CHECK(1 == full.allocFailures - before.allocFailures);
+
+    // a block passed on through a pointer into it stays allocated until its last holder gives it back
+    uint8_t const* payload = &blocks[0][40];
+    CHECK(blocks[0] == EMBENET_PACKET_POOL_GetBlock(payload));
+    CHECK(EMBENET_PACKET_POOL_Retain(payload));
+    CHECK(2 == EMBENET_PACKET_POOL_GetRefCount(blocks[0]));
+    EMBENET_PACKET_POOL_Release(blocks[0]);
+    CHECK(NULL == EMBENET_PACKET_POOL_Alloc());
+    EMBENET_PACKET_POOL_Release(payload);
+    CHECK(0 == EMBENET_PACKET_POOL_GetRefCount(blocks[0]));
+    CHECK(NULL == EMBENET_PACKET_POOL_GetBlock(payload));
+    CHECK(!EMBENET_PACKET_POOL_Retain(payload));
+    // the freed block is the one handed out next
+    CHECK(blocks[0] == EMBENET_PACKET_POOL_Alloc());
+
+    // memory outside the pool is not a block
+    uint8_t outside[4];
+    CHECK(NULL == EMBENET_PACKET_POOL_GetBlock(outside));
+    CHECK(0 == EMBENET_PACKET_POOL_GetRefCount(outside));
+
+    for (uint32_t i = 0; i < before.blockCount; ++i) {
+        EMBENET_PACKET_POOL_Release(blocks[i]);
+    }
+    // a release too many is ignored
+    EMBENET_PACKET_POOL_Release(blocks[1]);
+    EMBENET_PacketPoolStats after;
+    EMBENET_PACKET_POOL_GetStats(&after);
+    CHECK(0 == after.inUse);
+    CHECK(after.blockCount == after.highWatermark);
+    EMBENET_PACKET_POOL_ResetHighWatermark();
+    EMBENET_PACKET_POOL_GetStats(&after);
+    CHECK(0 == after.highWatermark);
+}
+
+int main(void) {
+    // the link delimits the received frames in the deferred work
+    EMBENET_DEFERRED_Init();
+    testCrc();
+    testHdlcRoundTrip();
+    testBrtOutputFull();
+    testBrtReceiveBuffer();
+    testBrtAggregation();
+    testChannelQualityMap();
+    testSpscRingBuffer();
+    testTimerConversions();
+    testAes128();
+    testNvm();
+    testPacketPool();
+    if (0 != failures) {
+        printf("%u checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf("All checks passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,142 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Energy accounting
+*/
+
+#include "energy_monitor.h"
+#include "app_task.h"
+#include "embenet_node_diag.h"
+#include "embenet_port_energy.h"
+#include "embenet_port_idle.h"
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define UA_US_PER_NAH 3600000U // 1nAh = 3.6mC = 3600000uA*us
+
+/// ENMS service instance the lifetime is reported through
+static EnmsNode* monitorEnmsNode;
+/// Counters updated by the trace handlers, all of them called at the priority of the radio and the MAC timer
+static volatile uint32_t slots;
+static volatile uint32_t txFrames;
+static volatile uint32_t noAcks;
+/// Total charge and uptime at the last estimation
+static uint64_t lastTotalNah;
+static uint64_t lastUptimeMs;
+/// Results of the last estimation
+static uint32_t averageCurrentUa;
+static uint32_t estimatedLifetimeHours = ENERGY_MONITOR_UNKNOWN_LIFETIME;
+
+static uint64_t toNah(uint64_t uaUs) {
+    return uaUs / UA_US_PER_NAH;
+}
+
+void energy_monitor_get_stats(energy_monitor_stats* stats) {
+    uint64_t uptimeUs = EMBENET_NODE_GetLocalTime() * 1000U;
+    uint64_t sleepUs  = EMBENET_IDLE_GetSleepTime();
+    uint64_t awakeUs  = (sleepUs < uptimeUs) ? (uptimeUs - sleepUs) : 0;
+
+    EMBENET_NODE_DIAG_DutyCycleRawData radio = EMBENET_NODE_DIAG_GetRadioDutyCycleRaw();
+    stats->slots                             = slots;
+    stats->txFrames                          = txFrames;
+    uint32_t failed                          = noAcks;
+    stats->deliveredPackets                  = (failed < stats->txFrames) ? (stats->txFrames - failed) : 0;
+
+    uint32_t rxSlots      = (stats->txFrames < stats->slots) ? (stats->slots - stats->txFrames) : 0;
+    stats->idleNah        = toNah(uptimeUs * EMBENET_ENERGY_IDLE_CURRENT_UA);
+    stats->cpuNah         = toNah(awakeUs * EMBENET_ENERGY_CPU_CURRENT_UA);
+    stats->txNah          = toNah(radio.timeTx * EMBENET_ENERGY_TX_CURRENT_UA);
+    stats->rxNah          = toNah(radio.timeRx * EMBENET_ENERGY_RX_CURRENT_UA);
+    stats->preparationNah = (((uint64_t)stats->txFrames * EMBENET_ENERGY_TX_PREPARATION_PAH) + ((uint64_t)rxSlots * EMBENET_ENERGY_RX_PREPARATION_PAH)) / 1000U;
+    stats->totalNah       = stats->idleNah + stats->cpuNah + stats->txNah + stats->rxNah + stats->preparationNah;
+
+    uint64_t radioNah             = stats->txNah + stats->rxNah + stats->preparationNah;
+    stats->nahPerDeliveredPacket  = (0 == stats->deliveredPackets) ? 0 : (uint32_t)(radioNah / stats->deliveredPackets);
+    stats->averageCurrentUa       = averageCurrentUa;
+    stats->estimatedLifetimeHours = estimatedLifetimeHours;
+}
+
+uint32_t energy_monitor_get_charge_uah(void) {
+    energy_monitor_stats stats;
+    energy_monitor_get_stats(&stats);
+    return (uint32_t)(stats.totalNah / 1000U);
+}
+
+uint64_t energy_monitor_get_task_charge_nah(EMBENET_TaskId taskId) {
+    app_task_stats stats;
+    if (!app_task_get_stats(taskId, &stats)) {
+        return 0;
+    }
+    return toNah(stats.totalTimeUs * EMBENET_ENERGY_CPU_CURRENT_UA);
+}
+
+/**
+ * @brief Task estimating the lifetime from the average current of the last period
+ *
+ * @param[in] taskId id of the task
+ * @param[in] timeSource time source used in scheduling
+ * @param[in] t time at which the task was scheduled
+ * @param[in] context unused
+ */
+static void estimationTask(EMBENET_TaskId taskId, EMBENET_NODE_TimeSource timeSource, uint64_t t, void* context) {
+    (void)taskId;
+    (void)timeSource;
+    (void)t;
+    (void)context;
+    energy_monitor_stats stats;
+    energy_monitor_get_stats(&stats);
+    uint64_t uptimeMs = EMBENET_NODE_GetLocalTime();
+    if (uptimeMs <= lastUptimeMs) {
+        return;
+    }
+    // uA = nAh * 3600000 / ms / 1000
+    uint64_t current = ((stats.totalNah - lastTotalNah) * 3600U) / (uptimeMs - lastUptimeMs);
+    averageCurrentUa = (uint32_t)((0 == current) ? 1 : current);
+    lastTotalNah     = stats.totalNah;
+    lastUptimeMs     = uptimeMs;
+
+    uint64_t capacityNah = (uint64_t)ENERGY_MONITOR_BATTERY_CAPACITY_MAH * 1000000U;
+    uint64_t leftNah     = (stats.totalNah < capacityNah) ? (capacityNah - stats.totalNah) : 0;
+    // nAh / (uA * 1000) = h
+    uint64_t hours         = leftNah / ((uint64_t)averageCurrentUa * 1000U);
+    estimatedLifetimeHours = (uint32_t)((hours < ENERGY_MONITOR_UNKNOWN_LIFETIME) ? hours : (ENERGY_MONITOR_UNKNOWN_LIFETIME - 1));
+
+    printf("ENERGY_MONITOR: %" PRIu32 "uAh (idle %" PRIu32 ", cpu %" PRIu32 ", tx %" PRIu32 ", rx %" PRIu32 ", preparation %" PRIu32 "), average %" PRIu32
+           "uA, lifetime %" PRIu32 "h, %" PRIu32 "nAh per delivered packet\n",
+           (uint32_t)(stats.totalNah / 1000U), (uint32_t)(stats.idleNah / 1000U), (uint32_t)(stats.cpuNah / 1000U), (uint32_t)(stats.txNah / 1000U),
+           (uint32_t)(stats.rxNah / 1000U), (uint32_t)(stats.preparationNah / 1000U), averageCurrentUa, estimatedLifetimeHours, stats.nahPerDeliveredPacket);
+
+    uint32_t weeks = estimatedLifetimeHours / (24U * 7U);
+    (void)ENMS_NODE_SetServiceState(monitorEnmsNode, ENERGY_MONITOR_SERVICE_NAME, (uint8_t)((weeks > UINT8_MAX) ? UINT8_MAX : weeks));
+}
+
+void energy_monitor_init(EnmsNode* enmsNode) {
+    monitorEnmsNode = enmsNode;
+    lastUptimeMs    = EMBENET_NODE_GetLocalTime();
+    EMBENET_TaskId estimationTaskId = app_task_create_periodic("energy", estimationTask, NULL, ENERGY_MONITOR_PERIOD_MS, 0);
+    if ((EMBENET_TASKID_INVALID == estimationTaskId) ||
+        (EMBENET_RESULT_OK != app_task_start(estimationTaskId, EMBENET_NODE_TIME_SOURCE_LOCAL, ENERGY_MONITOR_PERIOD_MS))) {
+        printf("ENERGY_MONITOR: Unable to start the estimation\n");
+    }
+    (void)ENMS_NODE_RegisterService(monitorEnmsNode, ENERGY_MONITOR_SERVICE_NAME, 0);
+}
+
+void energy_monitor_on_slot(bool enters) {
+    if (enters) {
+        slots++;
+    }
+}
+
+void energy_monitor_on_link_layer_event(EMBENET_TRACE_LinkLayerTelemetry const* telemetry) {
+    // acknowledgements are sent in the slots of the frames received
+    if ((EMBENET_TRACE_CELL_EVENT_TX == telemetry->cellEvent) && (EMBENET_TRACE_FRAME_TYPE_ACK != telemetry->frameType)) {
+        txFrames++;
+    }
+}
+
+void energy_monitor_on_packet_no_ack(void) {
+    noAcks++;
+}
@@ -0,0 +1,92 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Energy accounting
+
+The charge drawn by the node is integrated per state with the energy model of the port (embenet_port_energy.h): idle for the whole
+uptime, CPU while the main loop does not sleep, radio for the TX and RX times of the duty cycle raw data and the preparation of the radio
+once per slot (a transmission preparation for the slots that sent a frame, a reception one for the others). The charge of a task is its
+execution time at the CPU current, the charge per delivered packet is the radio charge over the frames sent and acknowledged (or
+broadcast).
+
+Every ENERGY_MONITOR_PERIOD_MS the average current of the period gives the estimated lifetime of a ENERGY_MONITOR_BATTERY_CAPACITY_MAH
+battery, reported in ENMS as the state of the "energy" service, in weeks (0 until the first period, saturated at 255).
+*/
+
+#ifndef ENERGY_MONITOR_H_
+#define ENERGY_MONITOR_H_
+
+#include "embenet_node.h"
+#include "embenet_node_trace.h"
+#include "enms_node.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define ENERGY_MONITOR_SERVICE_NAME         "energy" ///< name of the service reported in ENMS
+#define ENERGY_MONITOR_PERIOD_MS            60000    ///< period of the lifetime estimation and report [ms]
+#ifndef ENERGY_MONITOR_BATTERY_CAPACITY_MAH
+#    define ENERGY_MONITOR_BATTERY_CAPACITY_MAH 220 ///< capacity of the battery, the CR2032 cell of the nRF52-DK by default [mAh]
+#endif
+#define ENERGY_MONITOR_UNKNOWN_LIFETIME UINT32_MAX ///< lifetime not estimated yet
+
+/// Charge drawn since the startup
+typedef struct {
+    uint64_t idleNah;                ///< idle [nAh]
+    uint64_t cpuNah;                 ///< CPU [nAh]
+    uint64_t txNah;                  ///< radio transmitting [nAh]
+    uint64_t rxNah;                  ///< radio listening and receiving [nAh]
+    uint64_t preparationNah;         ///< radio preparations [nAh]
+    uint64_t totalNah;               ///< sum of the above [nAh]
+    uint32_t slots;                  ///< active slots
+    uint32_t txFrames;               ///< frames sent (acknowledgements excluded)
+    uint32_t deliveredPackets;       ///< frames sent that were acknowledged or broadcast
+    uint32_t nahPerDeliveredPacket;  ///< radio charge per delivered packet [nAh], 0 if none was delivered
+    uint32_t averageCurrentUa;       ///< average current over the last period [uA]
+    uint32_t estimatedLifetimeHours; ///< remaining battery lifetime, ENERGY_MONITOR_UNKNOWN_LIFETIME before the first period [h]
+} energy_monitor_stats;
+
+/**
+ * @brief Initializes the accounting, starting the periodic estimation and registering the service in ENMS.
+ * @param[in] enmsNode ENMS Node service instance the lifetime is reported through
+ */
+void energy_monitor_init(EnmsNode* enmsNode);
+
+/**
+ * @brief Gets the charge drawn since the startup.
+ * @param[out] stats charge per state and per packet, average current and lifetime
+ */
+void energy_monitor_get_stats(energy_monitor_stats* stats);
+
+/**
+ * @brief Gets the total charge drawn since the startup.
+ * @return charge [uAh]
+ */
+uint32_t energy_monitor_get_charge_uah(void);
+
+/**
+ * @brief Gets the charge drawn by a task.
+ * @param[in] taskId task created with app_task
+ * @return CPU charge of the runs of the task [nAh], 0 if the task is unknown
+ */
+uint64_t energy_monitor_get_task_charge_nah(EMBENET_TaskId taskId);
+
+/**
+ * @brief Counts the slots, called from the onSlotStartEnd trace handler.
+ * @param[in] enters true if the slot starts
+ */
+void energy_monitor_on_slot(bool enters);
+
+/**
+ * @brief Counts the frames sent, called from the onLinkLayerEvent trace handler.
+ * @param[in] telemetry frame sent or received
+ */
+void energy_monitor_on_link_layer_event(EMBENET_TRACE_LinkLayerTelemetry const* telemetry);
+
+/**
+ * @brief Counts the frames not acknowledged, called from the onPacketNoAck trace handler.
+ */
+void energy_monitor_on_packet_no_ack(void);
+
+#endif // ENERGY_MONITOR_H_
@@ -0,0 +1,207 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Background jobs run in the free windows of the schedule
+*/
+
+#include "free_slot_jobs.h"
+#include "app_task.h"
+#include "embenet_critical_section.h"
+#include "embenet_node.h"
+#include "embenet_timer.h"
+#include <stddef.h>
+#include <stdio.h>
+
+/// Window announced by the trace handler, not yet taken by the main loop
+static struct {
+    volatile bool  pending;
+    uint64_t       startNwkTime;
+    uint32_t       durationUs;
+    EMBENET_TimeUs announcedAt; ///< port timer when announced
+} announced;
+
+/// Window the jobs are run in
+static struct {
+    bool           open;    ///< false once the window has ended
+    EMBENET_TimeUs startUs; ///< start on the port timer
+    EMBENET_TimeUs endUs;   ///< end on the port timer
+} window;
+
+/// Queued jobs, in the order of submission
+static free_slot_job* head;
+static free_slot_job* tail;
+/// Set when the runner should be scheduled in the current window
+static volatile bool runRequested;
+/// Id of the runner task
+static EMBENET_TaskId runnerTaskId = EMBENET_TASKID_INVALID;
+/// Statistics
+static free_slot_jobs_stats stats;
+
+/// Time left in the window, 0 if it has not started yet or is over
+static int32_t timeLeftUs(EMBENET_TimeUs now) {
+    if ((int32_t)(now - window.startUs) < 0) {
+        return 0;
+    }
+    int32_t left = (int32_t)(window.endUs - now) - FREE_SLOT_JOBS_GUARD_US;
+    return (left > 0) ? left : 0;
+}
+
+/// Takes out the first queued job that fits in the given time
+static free_slot_job* takeJob(int32_t timeLeft) {
+    EMBENET_CRITICAL_SECTION_Enter();
+    free_slot_job* previous = NULL;
+    free_slot_job* job      = head;
+    while ((NULL != job) && ((int64_t)job->worstCaseUs > timeLeft)) {
+        previous = job;
+        job      = job->next;
+    }
+    if (NULL != job) {
+        if (NULL == previous) {
+            head = job->next;
+        } else {
+            previous->next = job->next;
+        }
+        if (tail == job) {
+            tail = previous;
+        }
+        job->next   = NULL;
+        job->queued = false;
+    }
+    EMBENET_CRITICAL_SECTION_Exit();
+    return job;
+}
+
+/**
+ * @brief Task running the jobs that fit in the current window
+ *
+ * @param[in] taskId id of the task
+ * @param[in] timeSource time source used in scheduling
+ * @param[in] t time at which the task was scheduled
+ * @param[in] context unused
+ */
+static void runnerTask(EMBENET_TaskId taskId, EMBENET_NODE_TimeSource timeSource, uint64_t t, void* context) {
+    (void)timeSource;
+    (void)t;
+    (void)context;
+    EMBENET_TimeUs now = EMBENET_TIMER_ReadCounter();
+    if ((int32_t)(now - window.startUs) < 0) {
+        // network time has a 1ms resolution, the window may be still ahead
+        uint32_t waitMs = ((uint32_t)(window.startUs - now) + 999U) / 1000U;
+        EMBENET_NODE_TaskSchedule(taskId, EMBENET_NODE_TIME_SOURCE_LOCAL, EMBENET_NODE_GetLocalTime() + waitMs);
+        return;
+    }
+    free_slot_job* job;
+    while (window.open && (NULL != (job = takeJob(timeLeftUs(now))))) {
+        job->function(job->context);
+        EMBENET_TimeUs end = EMBENET_TIMER_ReadCounter();
+        stats.jobsRun++;
+        if ((uint32_t)(end - now) > job->worstCaseUs) {
+            stats.overruns++;
+        }
+        now = end;
+    }
+    if (0 == timeLeftUs(now)) {
+        window.open = false;
+    }
+}
+
+void free_slot_jobs_init(void) {
+    runnerTaskId = app_task_create("free_slot_jobs", runnerTask, NULL);
+    if (EMBENET_TASKID_INVALID == runnerTaskId) {
+        printf("FREE_SLOT_JOBS: Unable to create task\n");
+    }
+}
+
+bool free_slot_jobs_submit(free_slot_job* job) {
+    bool submitted = false;
+    EMBENET_CRITICAL_SECTION_Enter();
+    if (!job->queued) {
+        job->queued = true;
+        job->next   = NULL;
+        if (NULL == tail) {
+            head = job;
+        } else {
+            tail->next = job;
+        }
+        tail         = job;
+        runRequested = true;
+        submitted    = true;
+    }
+    EMBENET_CRITICAL_SECTION_Exit();
+    return submitted;
+}
+
+bool free_slot_jobs_cancel(free_slot_job* job) {
+    bool cancelled = false;
+    EMBENET_CRITICAL_SECTION_Enter();
+    free_slot_job* previous = NULL;
+    for (free_slot_job* queued = head; NULL != queued; previous = queued, queued = queued->next) {
+        if (queued == job) {
+            if (NULL == previous) {
+                head = job->next;
+            } else {
+                previous->next = job->next;
+            }
+            if (tail == job) {
+                tail = previous;
+            }
+            job->next   = NULL;
+            job->queued = false;
+            cancelled   = true;
+            break;
+        }
+    }
+    EMBENET_CRITICAL_SECTION_Exit();
+    return cancelled;
+}
+
+void free_slot_jobs_on_free_slots(uint64_t asn, uint64_t startNwkTime, uint32_t durationUs) {
+    (void)asn;
+    // may be called from an interrupt, the window is only recorded here
+    EMBENET_CRITICAL_SECTION_Enter();
+    announced.startNwkTime = startNwkTime;
+    announced.durationUs   = durationUs;
+    announced.announcedAt  = EMBENET_TIMER_ReadCounter();
+    announced.pending      = true;
+    EMBENET_CRITICAL_SECTION_Exit();
+}
+
+void free_slot_jobs_proc(void) {
+    uint64_t startNwkTime = 0;
+    if (announced.pending) {
+        EMBENET_CRITICAL_SECTION_Enter();
+        startNwkTime         = announced.startNwkTime;
+        uint32_t durationUs  = announced.durationUs;
+        window.startUs       = announced.announcedAt;
+        announced.pending    = false;
+        EMBENET_CRITICAL_SECTION_Exit();
+
+        uint64_t nowNwkTime = EMBENET_NODE_GetNetworkTime();
+        if ((0 != nowNwkTime) && (startNwkTime > nowNwkTime)) {
+            window.startUs = EMBENET_TIMER_ReadCounter() + (EMBENET_TimeUs)((startNwkTime - nowNwkTime) * 1000U);
+        } else {
+            startNwkTime = 0;
+        }
+        window.endUs = window.startUs + durationUs;
+        window.open  = true;
+        runRequested = true;
+        stats.windows++;
+        if (durationUs > stats.longestWindowUs) {
+            stats.longestWindowUs = durationUs;
+        }
+    }
+    if (runRequested && window.open && (NULL != head)) {
+        runRequested = false;
+        if (0 != startNwkTime) {
+            EMBENET_NODE_TaskSchedule(runnerTaskId, EMBENET_NODE_TIME_SOURCE_NETWORK, startNwkTime);
+        } else {
+            EMBENET_NODE_TaskSchedule(runnerTaskId, EMBENET_NODE_TIME_SOURCE_LOCAL, EMBENET_NODE_GetLocalTime());
+        }
+    }
+}
+
+void free_slot_jobs_get_stats(free_slot_jobs_stats* statsOut) {
+    *statsOut = stats;
+}
@@ -0,0 +1,87 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Background jobs run in the free windows of the schedule
+
+Deferrable work (flash writes, application crypto, data compression...) is queued as jobs with a declared worst-case duration. The stack
+announces the windows with no active slot through the onFreeSlots trace handler; the jobs are run from an embeNET Node task only inside
+such a window, and only the ones whose worst-case duration, plus FREE_SLOT_JOBS_GUARD_US, fits in what is left of it. The jobs are run in
+the order they were queued, except that a job too long for the current window lets the shorter ones behind it go first. Heavy work thus
+stays out of the active slots instead of delaying their TX and RX.
+
+The announced start (startNwkTime) is taken to be network time in ms, the unit of EMBENET_NODE_GetNetworkTime. A window announced ahead
+is waited for, one that has already started is used right away.
+*/
+
+#ifndef FREE_SLOT_JOBS_H_
+#define FREE_SLOT_JOBS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define FREE_SLOT_JOBS_GUARD_US 500 ///< margin kept before the end of a window [us]
+
+/**
+ * @brief Job function, called from an embeNET Node task inside a free window.
+ * @param[in] context context given in the job
+ */
+typedef void (*free_slot_job_function)(void* context);
+
+/// Background job, owned by the caller and left untouched while queued
+typedef struct free_slot_job {
+    free_slot_job_function function;    ///< function doing the work
+    void*                  context;     ///< passed to the function
+    uint32_t               worstCaseUs; ///< longest time the function may take [us]
+    volatile bool          queued;      ///< true while the job waits to be run
+    struct free_slot_job*  next;        ///< next queued job
+} free_slot_job;
+
+/// Statistics of the runner
+typedef struct {
+    uint32_t windows;         ///< number of free windows announced
+    uint32_t jobsRun;         ///< number of jobs run
+    uint32_t overruns;        ///< number of jobs that took longer than their declared worst case
+    uint32_t longestWindowUs; ///< longest window announced [us]
+} free_slot_jobs_stats;
+
+/**
+ * @brief Initializes the runner, creating its task. Must be called after the stack is initialized.
+ */
+void free_slot_jobs_init(void);
+
+/**
+ * @brief Queues a job to be run in one of the next free windows. May be called from an interrupt that is allowed to use the critical section.
+ * @param[in] job job to run, with function, context and worstCaseUs set
+ * @return false if the job is already queued
+ */
+bool free_slot_jobs_submit(free_slot_job* job);
+
+/**
+ * @brief Takes a job out of the queue.
+ * @param[in] job queued job
+ * @return true if the job was queued and will not be run
+ */
+bool free_slot_jobs_cancel(free_slot_job* job);
+
+/**
+ * @brief Records a free window, called from the onFreeSlots trace handler.
+ * @param[in] asn ASN of the first free slot
+ * @param[in] startNwkTime network time the window starts at
+ * @param[in] durationUs length of the window [us]
+ */
+void free_slot_jobs_on_free_slots(uint64_t asn, uint64_t startNwkTime, uint32_t durationUs);
+
+/**
+ * @brief Schedules the runner for an announced window. To be called in the main loop.
+ */
+void free_slot_jobs_proc(void);
+
+/**
+ * @brief Gets the statistics of the runner.
+ * @param[out] stats statistics since the startup
+ */
+void free_slot_jobs_get_stats(free_slot_jobs_stats* stats);
+
+#endif // FREE_SLOT_JOBS_H_
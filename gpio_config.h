@@ -15,5 +15,7 @@
 #define LED4 20
 
 #define BUTTON1 13
+#define BUTTON2 14
+#define BUTTON3 15
 
 #endif /* GPIO_CONFIG_H_ */
\ No newline at end of file
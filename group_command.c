@@ -0,0 +1,128 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Commands sent once to a multicast group of nodes
+*/
+
+#include "group_command.h"
+#include "app_command.h"
+#include "app_log.h"
+#include "embenet_node.h"
+#include "embenet_udp.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+/// Group listened to
+typedef struct {
+    EMBENET_UDP_SocketDescriptor socket;         ///< multicast socket of the group, groupId is EMBENET_GROUPID_INVALID if unused
+    bool                         hasSequence;    ///< true if a sequenced command was executed
+    uint16_t                     lastSequence;   ///< sequence number of the last executed command
+    uint64_t                     lastSequenceMs; ///< time of the last executed command [ms]
+} Group;
+
+static Group              groups[GROUP_COMMAND_MAX_GROUPS];
+static group_command_stats stats;
+
+/// Checks the sequence number of a command, true if it has to be executed
+static bool acceptSequence(Group* group, uint16_t sequence) {
+    uint64_t now = EMBENET_NODE_GetLocalTime();
+    if (group->hasSequence && ((now - group->lastSequenceMs) < GROUP_COMMAND_SEQUENCE_TIMEOUT_MS)) {
+        uint16_t distance = (uint16_t)(sequence - group->lastSequence);
+        if ((0 == distance) || (distance >= 0x8000U)) {
+            return false;
+        }
+    }
+    group->hasSequence    = true;
+    group->lastSequence   = sequence;
+    group->lastSequenceMs = now;
+    return true;
+}
+
+/**
+ * @brief Invoked upon datagram reception on the multicast socket of a group
+ *
+ * @param[in] socket socket descriptor
+ * @param[in] sourceAddress source IPv6 address
+ * @param[in] sourcePort UDP source port
+ * @param[in] data pointer to datagram's payload
+ * @param[in] dataSize size of datagram's payload
+ */
+static void onGroupCommand(EMBENET_UDP_SocketDescriptor const* socket, EMBENET_IPV6 const* sourceAddress, uint16_t sourcePort, void const* data, size_t dataSize) {
+    Group*         group = (Group*)socket->userContext;
+    uint8_t const* bytes = (uint8_t const*)data;
+
+    if ((dataSize >= 3) && (GROUP_COMMAND_SEQUENCE_MARKER == bytes[0])) {
+        uint16_t sequence = (uint16_t)(((uint16_t)bytes[1] << 8) | bytes[2]);
+        if (!acceptSequence(group, sequence)) {
+            stats.duplicates++;
+            return;
+        }
+        bytes = &bytes[3];
+        dataSize -= 3;
+    }
+    if (APP_COMMAND_RESULT_OK == app_command_execute(bytes, dataSize)) {
+        stats.executed++;
+    } else {
+        stats.rejected++;
+        APP_LOG_WARNING("GROUP_COMMAND: Command for group %u rejected, size: %u", (unsigned)socket->groupId, (unsigned)dataSize);
+    }
+}
+
+static Group* findGroup(EMBENET_GroupId groupId) {
+    for (size_t i = 0; i < GROUP_COMMAND_MAX_GROUPS; ++i) {
+        if (groupId == groups[i].socket.groupId) {
+            return &groups[i];
+        }
+    }
+    return NULL;
+}
+
+bool group_command_join(EMBENET_GroupId groupId) {
+    if (EMBENET_GROUPID_INVALID == groupId) {
+        return false;
+    }
+    if (NULL != findGroup(groupId)) {
+        return true;
+    }
+    Group* group = findGroup(EMBENET_GROUPID_INVALID);
+    if (NULL == group) {
+        printf("GROUP_COMMAND: No room for group %u\n", (unsigned)groupId);
+        return false;
+    }
+    if (!EMBENET_NODE_JoinGroup(groupId)) {
+        printf("GROUP_COMMAND: Unable to join group %u\n", (unsigned)groupId);
+        return false;
+    }
+    memset(group, 0, sizeof(Group));
+    group->socket.port           = GROUP_COMMAND_PORT;
+    group->socket.handledTraffic = EMBENET_UDP_TRAFFIC_MULTICAST;
+    group->socket.groupId        = groupId;
+    group->socket.rxDataHandler  = onGroupCommand;
+    group->socket.userContext    = group;
+    EMBENET_Result result        = EMBENET_UDP_RegisterSocket(&group->socket);
+    if (EMBENET_RESULT_OK != result) {
+        printf("GROUP_COMMAND: Registering socket of group %u failed with status %d\n", (unsigned)groupId, (int)result);
+        EMBENET_NODE_LeaveGroup(groupId);
+        group->socket.groupId = EMBENET_GROUPID_INVALID;
+        return false;
+    }
+    printf("GROUP_COMMAND: Listening to group %u on port %u\n", (unsigned)groupId, (unsigned)GROUP_COMMAND_PORT);
+    return true;
+}
+
+void group_command_leave(EMBENET_GroupId groupId) {
+    Group* group = (EMBENET_GROUPID_INVALID == groupId) ? NULL : findGroup(groupId);
+    if (NULL == group) {
+        return;
+    }
+    (void)EMBENET_UDP_UnregisterSocket(&group->socket);
+    EMBENET_NODE_LeaveGroup(groupId);
+    group->socket.groupId = EMBENET_GROUPID_INVALID;
+}
+
+void group_command_get_stats(group_command_stats* groupStats) {
+    *groupStats = stats;
+}
@@ -0,0 +1,57 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Commands sent once to a multicast group of nodes
+
+The node joins the configured groups and listens on GROUP_COMMAND_PORT for datagrams sent to their multicast addresses, so that one
+downlink datagram switches every member of a group instead of one unicast per node. The commands are those of app_command.h, in either
+encoding, optionally preceded by a sequence number:
+ - command: executed each time it is received,
+ - GROUP_COMMAND_SEQUENCE_MARKER, u16 sequence number (big endian), command: executed once; the copies of it and the older commands of
+   the group are ignored. The sequence numbers of a group grow by one or more (modulo 2^16). After GROUP_COMMAND_SEQUENCE_TIMEOUT_MS
+   without a command any sequence number is accepted again, so that a restarted sender does not have to know the last one.
+*/
+
+#ifndef GROUP_COMMAND_H_
+#define GROUP_COMMAND_H_
+
+#include "embenet_defs.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define GROUP_COMMAND_PORT                 1235   ///< UDP port of the group commands
+#define GROUP_COMMAND_MAX_GROUPS           4      ///< number of groups the service can listen to
+#define GROUP_COMMAND_DEFAULT_GROUP        1      ///< group joined by every node, addressing all of them
+#define GROUP_COMMAND_SEQUENCE_MARKER      0xC1   ///< first byte of a command with a sequence number
+#define GROUP_COMMAND_SEQUENCE_TIMEOUT_MS  600000 ///< time after which any sequence number is accepted [ms]
+
+/// Statistics of the group commands
+typedef struct {
+    uint32_t executed;   ///< commands executed
+    uint32_t duplicates; ///< copies and outdated commands ignored
+    uint32_t rejected;   ///< unknown commands or invalid arguments
+} group_command_stats;
+
+/**
+ * @brief Joins the given group and starts executing the commands sent to it.
+ * @param[in] groupId group to join
+ * @return true if joined, false if out of resources or the group is invalid
+ */
+bool group_command_join(EMBENET_GroupId groupId);
+
+/**
+ * @brief Stops executing the commands of the given group and leaves it.
+ * @param[in] groupId group to leave
+ */
+void group_command_leave(EMBENET_GroupId groupId);
+
+/**
+ * @brief Gets the statistics of the group commands.
+ * @param[out] stats statistics
+ */
+void group_command_get_stats(group_command_stats* stats);
+
+#endif // GROUP_COMMAND_H_
@@ -0,0 +1,142 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Interrupt driven, debounced digital inputs
+*/
+
+#include "input_events.h"
+#include "app_task.h"
+#include "bsp_interrupt_priorities.h"
+#include "embenet_node.h"
+#include "embenet_port_vtimer.h"
+
+#include <stdio.h>
+
+#include "nrf_gpio.h"
+#include "nrf_gpiote.h"
+
+/// Registered input
+typedef struct {
+    uint32_t             pin;       ///< GPIO pin number
+    bool                 activeLow; ///< true if the input is active at the low level
+    volatile bool        high;      ///< last debounced level
+    volatile bool        sensing;   ///< true while the pin raises the PORT event, false while being debounced
+    input_events_handler handler;   ///< called on debounced changes
+    EMBENET_VTIMER_Timer debounce;  ///< debounce timer
+} Input;
+
+/// Registered inputs
+static Input inputs[INPUT_EVENTS_MAX_INPUTS];
+/// Number of registered inputs
+static volatile uint32_t inputCount;
+/// Bit n is set if the change of inputs[n] is waiting to be reported
+static volatile uint32_t pendingInputs;
+/// Set when a change became pending, until the reporting task is scheduled
+static volatile bool reportRequested;
+/// Id of the reporting task
+static EMBENET_TaskId reportTaskId = EMBENET_TASKID_INVALID;
+
+/**
+ * @brief Arms the sensing for the level opposite to the debounced one.
+ *
+ * If the pin already changed again, the PORT event is raised right away.
+ */
+static void armSense(Input* input) {
+    input->sensing = true;
+    nrf_gpio_cfg_sense_set(input->pin, input->high ? NRF_GPIO_PIN_SENSE_LOW : NRF_GPIO_PIN_SENSE_HIGH);
+}
+
+/**
+ * @brief Debounce timer callback, samples the input once it had time to settle.
+ *
+ * @param[in] context input being debounced
+ */
+static void onDebounced(void* context) {
+    Input* input = (Input*)context;
+    bool   high  = (0 != nrf_gpio_pin_read(input->pin));
+    if (high != input->high) {
+        input->high = high;
+        __atomic_fetch_or(&pendingInputs, 1UL << (input - inputs), __ATOMIC_RELAXED);
+        reportRequested = true;
+    }
+    armSense(input);
+}
+
+/**
+ * @brief Task reporting the pending input changes
+ *
+ * @param[in] taskId id of the task
+ * @param[in] timeSource time source used in scheduling
+ * @param[in] t time at which the task was scheduled
+ * @param[in] context unused
+ */
+static void reportTask(EMBENET_TaskId taskId, EMBENET_NODE_TimeSource timeSource, uint64_t t, void* context) {
+    (void)taskId;
+    (void)timeSource;
+    (void)t;
+    (void)context;
+    uint32_t pending = __atomic_exchange_n(&pendingInputs, 0, __ATOMIC_RELAXED);
+    for (uint32_t i = 0; i < inputCount; ++i) {
+        if (0 != (pending & (1UL << i))) {
+            inputs[i].handler(inputs[i].pin, inputs[i].high != inputs[i].activeLow);
+        }
+    }
+}
+
+void input_events_init(void) {
+    inputCount      = 0;
+    pendingInputs   = 0;
+    reportRequested = false;
+    reportTaskId    = app_task_create("input_events", reportTask, NULL);
+    if (EMBENET_TASKID_INVALID == reportTaskId) {
+        puts("INPUT_EVENTS: Unable to create task");
+        return;
+    }
+    nrf_gpiote_event_clear(NRF_GPIOTE_EVENTS_PORT);
+    nrf_gpiote_int_enable(NRF_GPIOTE_INT_PORT_MASK);
+    NVIC_ClearPendingIRQ(GPIOTE_IRQn);
+    NVIC_SetPriority(GPIOTE_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), INTERRUPT_PRIORITY_BUTTONS, INTERRUPT_SUBPRIORITY_BUTTONS));
+    NVIC_EnableIRQ(GPIOTE_IRQn);
+}
+
+bool input_events_register(uint32_t pin, bool activeLow, input_events_handler handler) {
+    if ((EMBENET_TASKID_INVALID == reportTaskId) || (inputCount >= INPUT_EVENTS_MAX_INPUTS) || (NULL == handler)) {
+        return false;
+    }
+    Input* input     = &inputs[inputCount];
+    input->pin       = pin;
+    input->activeLow = activeLow;
+    input->handler   = handler;
+    input->sensing   = false;
+    nrf_gpio_cfg_sense_input(pin, activeLow ? NRF_GPIO_PIN_PULLUP : NRF_GPIO_PIN_PULLDOWN, NRF_GPIO_PIN_NOSENSE);
+    input->high = (0 != nrf_gpio_pin_read(pin));
+    // the interrupt handler only looks at the inputs counted in
+    inputCount++;
+    armSense(input);
+    return true;
+}
+
+void input_events_proc(void) {
+    if (reportRequested) {
+        reportRequested = false;
+        EMBENET_NODE_TaskSchedule(reportTaskId, EMBENET_NODE_TIME_SOURCE_LOCAL, EMBENET_NODE_GetLocalTime());
+    }
+}
+
+/**
+ * @brief GPIOTE interrupt handler, starts debouncing the inputs that changed.
+ */
+void GPIOTE_IRQHandler(void) {
+    nrf_gpiote_event_clear(NRF_GPIOTE_EVENTS_PORT);
+    for (uint32_t i = 0; i < inputCount; ++i) {
+        Input* input = &inputs[i];
+        // the pins still sensing the level they are at keep the PORT event from being raised again
+        if (input->sensing && ((0 != nrf_gpio_pin_read(input->pin)) != input->high)) {
+            input->sensing = false;
+            nrf_gpio_cfg_sense_set(input->pin, NRF_GPIO_PIN_NOSENSE);
+            EMBENET_VTIMER_Start(&input->debounce, INPUT_EVENTS_DEBOUNCE_MS * 1000U, 0, onDebounced, input);
+        }
+    }
+}
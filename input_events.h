@@ -0,0 +1,52 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Interrupt driven, debounced digital inputs
+
+Inputs are watched with the SENSE mechanism of the GPIO port, which raises the GPIOTE PORT event without a running clock, so idle inputs
+cost nothing. On the first edge the input stops sensing and a virtual timer is started; when it expires the input is sampled and, if its
+level differs from the last reported one, the change is reported. Sensing is then re-armed for the opposite level. Bounces within the
+debounce time are therefore never seen by the CPU. Changes are reported from an embeNET Node task, the interrupts only mark them pending.
+
+*/
+
+#ifndef INPUT_EVENTS_H_
+#define INPUT_EVENTS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define INPUT_EVENTS_MAX_INPUTS 4  ///< maximum number of registered inputs
+#define INPUT_EVENTS_DEBOUNCE_MS 20 ///< time the input must be stable before the change is reported [ms]
+
+/**
+ * @brief Input change handler, called from an embeNET Node task.
+ * @param[in] pin GPIO pin number of the input
+ * @param[in] active true if the input went active, false if it went inactive
+ */
+typedef void (*input_events_handler)(uint32_t pin, bool active);
+
+/**
+ * @brief Initializes the input events.
+ *
+ * Creates the reporting task and enables the GPIOTE PORT interrupt. Must be called after the stack and the virtual timers are initialized.
+ */
+void input_events_init(void);
+
+/**
+ * @brief Starts watching an input.
+ * @param[in] pin GPIO pin number, configured as an input with a pull resistor towards the inactive level
+ * @param[in] activeLow true if the input is active when the pin reads low (e.g. a button to ground)
+ * @param[in] handler called on every debounced change
+ * @return true if the input was registered, false if all INPUT_EVENTS_MAX_INPUTS inputs are in use
+ */
+bool input_events_register(uint32_t pin, bool activeLow, input_events_handler handler);
+
+/**
+ * @brief Schedules the reporting task when changes are pending. Meant to be called from the main loop, costs a single read otherwise.
+ */
+void input_events_proc(void);
+
+#endif // INPUT_EVENTS_H_
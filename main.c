@@ -14,10 +14,30 @@
 // embeNET includes
 #include "embenet_node.h"
 #include "enms_node.h"
+#include "embenet_port_brt.h"
+#include "embenet_port_deferred.h"
+#include "embenet_port_idle.h"
+#include "embenet_port_random.h"
+#include "embenet_port_vtimer.h"
 #include "gpio_config.h"
 // demo services
+#include "app_command.h"
+#include "app_log.h"
+#include "app_task.h"
+#include "app_trace.h"
+#include "brt_aggregation.h"
+#include "brt_monitor.h"
+#include "channel_manager.h"
 #include "custom_service.h"
+#include "energy_monitor.h"
+#include "free_slot_jobs.h"
+#include "group_command.h"
+#include "input_events.h"
 #include "mqttsn_client_service.h"
+#include "perf_report.h"
+#include "quick_join.h"
+#include "slot_profiler.h"
+#include "trace_recorder.h"
 // board and chip specific header files
 #include "SEGGER_RTT.h"
 #include "app_error.h"
@@ -32,6 +52,11 @@
 #include "nrf_gpio.h"
 
 
+/// Maximum number of additional stack iterations per main loop iteration spent on frames queued from the border router
+#define BRT_FRAMES_PER_ITERATION 8
+/// Length of the packets the border router link must still be able to take for the stack to get another frame from it in a burst
+#define BRT_BURST_OUTPUT_SPACE 128
+
 /// Descriptor of the ENMS service (network maintenance and visualization)
 EnmsNode enmsNode;
 
@@ -77,6 +102,8 @@ static void init(void) {
         ;
     // initialize RTT
     SEGGER_RTT_Init();
+    app_log_init();
+    trace_recorder_init();
 }
 
 /**
@@ -94,8 +121,19 @@ static void onJoined(EMBENET_PANID panId, const EMBENET_NODE_QuickJoinCredential
     } else {
         printf("ENMS service failed to start with status: %d\n", (int)enmsStartStatus);
     }
+    // Start network-wide channel hopping list management
+    channel_manager_start(panId);
+    // Start sending the performance reports
+    perf_report_start();
 
-#if 1 != IS_ROOT
+#if 1 == IS_ROOT
+    // Start reporting the health of the border router link
+    brt_monitor_start();
+    // Take the offers of the border router to aggregate the frames sent to it
+    brt_aggregation_start();
+#else
+    // Keep the credentials for the quick join after a reset
+    quick_join_on_joined(quickJoinCredentials);
     // Start exemplary, user-defined custom service
     custom_service_start();
     // Start MQTT-SN demo service
@@ -115,8 +153,18 @@ static void onLeft(void) {
     } else {
         printf("ENMS service failed to stop with status: %d\n", (int)enmsStopStatus);
     }
+    // Stop channel hopping list management
+    channel_manager_stop();
+    // Stop sending the performance reports
+    perf_report_stop();
 
-#if 1 != IS_ROOT
+#if 1 == IS_ROOT
+    // Stop reporting the health of the border router link
+    brt_monitor_stop();
+    // Back to the plain framing
+    brt_aggregation_stop();
+#else
+    quick_join_on_left();
     // Stop exemplary, user-defined custom service
     custom_service_stop();
     // Stop MQTT-SN demo service
@@ -149,10 +197,12 @@ static void dataOnUregisteredPort(uint16_t port) {
  * @brief User-defined callback, that will be called when provided quick join credentials become obsolete.
  *
  * If the quick join feature is used, user should delete the stored data and store new data, when onJoined callback will be called again.
- * This demo application does not use the quick join feature.
  */
 static void onQuickJoinCredentialsObsolete(void) {
     printf("Quick join credentials became obsolete\n");
+#if 1 != IS_ROOT
+    quick_join_on_credentials_obsolete();
+#endif
 }
 
 /**
@@ -174,12 +224,31 @@ int main(void) {
                                                         .onDataOnUnregisteredPort       = dataOnUregisteredPort,
                                                         .onQuickJoinCredentialsObsolete = onQuickJoinCredentialsObsolete};
 
+    // Seed the random number generator now, so that no draw of the stack waits for the RNG
+    EMBENET_RANDOM_Init();
+    // Software interrupts the interrupt handlers can defer their non time-critical work to, must precede the stack, whose border router
+    // link defers the delimiting of the received frames
+    EMBENET_DEFERRED_Init();
     // Initialize network stack
     if (EMBENET_RESULT_OK == EMBENET_NODE_Init(&handlers)) {
         printf("embeNET Node initialized\n");
     } else {
         printf("Failed to initialize embeNET Node\n");
     }
+    // Keep runtime statistics of the demo tasks, must precede the creation of the tasks
+    app_task_init();
+    // Install trace handlers shared by the demo modules
+    app_trace_init();
+    // Virtual timers run on the port timer, which is initialized together with the stack
+    EMBENET_VTIMER_Init();
+    // Let the main loop sleep between interrupts
+    EMBENET_IDLE_Init();
+    // Inputs are reported on interrupts, there is no need to poll them
+    input_events_init();
+    // Deferrable work is run in the free windows of the schedule
+    free_slot_jobs_init();
+    // Commands of the UDP and MQTT-SN services
+    app_command_init();
 	// Construct 128-bit hardware ID using 64-bit UID (here actually 802.15.4 MAC Address)
     uint8_t  hardwareId[16] = {0x00};
     uint64_t uid            = EMBENET_NODE_GetUID();
@@ -190,9 +259,22 @@ int main(void) {
     } else {
         printf("Failed to initialize ENMS service!\n");
     }
+    // Time the slots and the MAC and radio routines, reported through ENMS
+    slot_profiler_init(&enmsNode);
+    // Account the charge drawn and estimate the battery lifetime, reported through ENMS
+    energy_monitor_init(&enmsNode);
+    // Compact performance report, sent next to ENMS with the default cadence
+    perf_report_init(NULL);
+    // Initialize channel hopping list management, used by both root and nodes so that they hop over the same channels
+    channel_manager_init();
 
 #if 1 == IS_ROOT
     printf("Acting as root with UID: 0x%x%08x\n", (unsigned)(EMBENET_NODE_GetUID()>>32), (unsigned)(EMBENET_NODE_GetUID()));
+
+    // Initialize monitoring of the border router link, reported through ENMS
+    brt_monitor_init(&enmsNode);
+    // Negotiation of the aggregated framing with the border router
+    brt_aggregation_init();
 	
     // When the application is built for Root node, start as root instead of joining the network
     EMBENET_NODE_RootStart(NULL, 0);
@@ -203,6 +285,8 @@ int main(void) {
     custom_service_init();
     // Initialize MQTT-SN service
     mqttsn_client_service_init();
+    // Execute the commands sent once to all nodes
+    (void)group_command_join(GROUP_COMMAND_DEFAULT_GROUP);
 
     // Additionally tell the ENMS what services are running
     (void)ENMS_NODE_RegisterService(&enmsNode, "custom", 1);
@@ -218,17 +302,29 @@ int main(void) {
     };
 
     printf("Trying to join a network...\n");
-    // Make the node join the network
-    EMBENET_NODE_Join(&config);
+    // Make the node join the network, quickly with the credentials stored before the reset if there are any
+    quick_join_init();
+    quick_join_start(&config);
 #endif
 
     while (1) {
         // Periodically call embeNET Node process function.
         EMBENET_NODE_Proc();
-        #if 1 != IS_ROOT
-            // When acting as Node, run the MQTT-SN service process
-            mqttsn_client_service_proc();
-        #endif		
+        #if 1 == IS_ROOT
+            // When acting as Root, let the stack take a burst of frames from the border router before going on, unless its replies
+            // may not fit in the output buffer, then the frames wait and the paused reception holds the border router back
+            for (unsigned i = 0; (i < BRT_FRAMES_PER_ITERATION) && (EMBENET_BRT_GetPendingFrameCount() > 0) &&
+                                 (EMBENET_BRT_GetOutputSpace() >= BRT_BURST_OUTPUT_SPACE);
+                 ++i) {
+                EMBENET_NODE_Proc();
+            }
+        #endif
+        // Hand over the input changes signalled by interrupts to the stack tasks
+        input_events_proc();
+        // Schedule the background jobs for the free window announced by the stack
+        free_slot_jobs_proc();
+        // Sleep until the next interrupt (radio, timers, UART, GPIO), unless the stack has work queued
+        EMBENET_IDLE_Sleep();
     }
 }
 
@@ -8,7 +8,13 @@
 
 #include "mqttsn_client.h"
 #include "embenet_node.h"
+#include "app_command.h"
+#include "app_log.h"
+#include "app_task.h"
 #include "gpio_config.h"
+#include "input_events.h"
+#include "mqttsn_publish.h"
+#include "mqttsn_sleep.h"
 
 #include <stdbool.h>
 #include <string.h>
@@ -21,6 +27,35 @@ const uint16_t gatewayPortNo = 1885;
 // MQTT-SN Client port number
 const uint16_t clientPortNo = gatewayPortNo;
 
+/// Topic id of the uptime topic predefined in the gateway, 0 if the topic is registered by the client
+#ifndef MQTTSN_SERVICE_UPTIME_TOPIC_ID
+#define MQTTSN_SERVICE_UPTIME_TOPIC_ID 0
+#endif
+/// Topic id of the button state topic predefined in the gateway, 0 if the topic is registered by the client
+#ifndef MQTTSN_SERVICE_BUTTON_TOPIC_ID
+#define MQTTSN_SERVICE_BUTTON_TOPIC_ID 0
+#endif
+/// Sleep duration of the sleeping client [s], 0 to keep the client active
+#ifndef MQTTSN_SERVICE_SLEEP_DURATION_S
+#define MQTTSN_SERVICE_SLEEP_DURATION_S 0
+#endif
+/// Time the gateway has to deliver the buffered messages after the client wakes up [ms]
+#define MQTTSN_SERVICE_AWAKE_TIMEOUT_MS 5000
+/// Wakeups with no answer from the gateway after which the client connects again
+#define MQTTSN_SERVICE_MAX_MISSED_WAKEUPS 3
+
+#if MQTTSN_SERVICE_SLEEP_DURATION_S > 0
+#    if MQTTSN_SERVICE_SLEEP_DURATION_S > (UINT16_MAX / 3)
+#        error "MQTTSN_SERVICE_SLEEP_DURATION_S is too long"
+#    endif
+// The client polls the gateway once per sleep duration, the library must not ping it in between
+#    define MQTTSN_SERVICE_KEEP_ALIVE_S  (3 * MQTTSN_SERVICE_SLEEP_DURATION_S)
+#    define MQTTSN_SERVICE_PING_PERIOD_S (2 * MQTTSN_SERVICE_SLEEP_DURATION_S)
+#else
+#    define MQTTSN_SERVICE_KEEP_ALIVE_S  30
+#    define MQTTSN_SERVICE_PING_PERIOD_S 10
+#endif
+
 // Enumeration describing the state of the MQTT-SN service
 enum mqttsnServiceState {
     // In the process of connecting
@@ -32,23 +67,127 @@ enum mqttsnServiceState {
     // In the process of subscribing to topic
     SUBSCRIBE_TO_TOPIC,
     // Normal state of operation
-    RUNNING
+    RUNNING,
+    // Sleeping client, the gateway buffers the messages
+    ASLEEP,
+    // Sleeping client woken up, receiving the buffered messages
+    AWAKE
 } serviceState = CONNECTING;
 
 // Descriptor of the MQTT-SN client
 static MQTTSNClient mqttsnClient;
 // MQTT-SN service task id
 static EMBENET_TaskId mqttsnTaskId = EMBENET_TASKID_INVALID;
+// Topic the client publishes to. The id is kept across reconnects, so that publishing does not wait for the registration again.
+typedef struct {
+    char          name[MQTTSN_MAX_TOPIC_NAME_LENGTH];
+    MQTTSNTopicId id;         ///< 0 until registered
+    bool          predefined; ///< true if the id is predefined in the gateway
+} PublishTopic;
+
 // This will be the MQTT topic that the client publishes to, pushing uptime information
-static char uptimeTopic[MQTTSN_MAX_TOPIC_NAME_LENGTH];
+static PublishTopic uptimeTopic;
 // This will be the MQTT topic that the client publishes to, pushing button state information
-static char buttonTopic[MQTTSN_MAX_TOPIC_NAME_LENGTH];
+static PublishTopic buttonTopic;
+// True once the topics are registered in the session, which the gateway keeps for the next connect
+static bool sessionEstablished;
+// True when the gateway delivered the buffered messages to the awake client
+static bool awakeDone;
+// Consecutive wakeups with no answer from the gateway
+static unsigned missedWakeups;
 // This will be the MQTT topic that the client subscribes to, in order to receive control messages
 static const char* ledControlTopic = "ledcontrol";
 
 // Prototypes of event handlers
 static void onMQTTConnected(MQTTSNClient* client);
 static void onMQTTDisconnected(MQTTSNClient* client);
+static void onButtonChanged(uint32_t pin, bool active);
+static void onAwakeDone(MQTTSNClient* client);
+
+/**
+ * Forgets the ids registered in the session, so that the next connect starts a clean session and registers the topics again.
+ */
+static void forgetSession(void) {
+    sessionEstablished = false;
+    if (!uptimeTopic.predefined) {
+        uptimeTopic.id = 0;
+    }
+    if (!buttonTopic.predefined) {
+        buttonTopic.id = 0;
+    }
+}
+
+/**
+ * Gets the state following the connection or a registration: the topics with no id yet are registered, then the client subscribes.
+ */
+static enum mqttsnServiceState getRegistrationState(void) {
+    if (0 == uptimeTopic.id) {
+        return REGISTER_UPTIME_TOPIC;
+    }
+    if (0 == buttonTopic.id) {
+        return REGISTER_BUTTON_STATE_TOPIC;
+    }
+    return SUBSCRIBE_TO_TOPIC;
+}
+
+/**
+ * Publishes a message, in place by the topic id if it is known.
+ *
+ * @param[in] topic topic to publish to
+ * @param[in] message message, preceded by MQTTSN_PUBLISH_HEADROOM free bytes
+ * @param[in] length length of the message
+ */
+static void publish(PublishTopic const* topic, uint8_t* message, size_t length) {
+    if (0 == topic->id) {
+        MQTTSN_CLIENT_PublishMessage(&mqttsnClient, topic->name, (char const*)message, length);
+    } else if (!mqttsn_publish_in_place(&mqttsnClient, topic->id, topic->predefined, message, length)) {
+        puts("MQTT-SN: Unable to publish");
+    }
+}
+
+/**
+ * Sends a coalesced message when it is due. While the client is not connected, only the predefined topics can be published, with QoS -1.
+ *
+ * @param[in] topic PublishTopic of the message
+ * @param[in] message message, preceded by MQTTSN_PUBLISH_HEADROOM free bytes
+ * @param[in] messageSize size of the message
+ */
+static void onPublishDue(void* topic, uint8_t* message, size_t messageSize) {
+    PublishTopic const* publishTopic = (PublishTopic const*)topic;
+    if (RUNNING == serviceState) {
+        publish(publishTopic, message, messageSize);
+    } else if (publishTopic->predefined) {
+        (void)mqttsn_publish_in_place(NULL, publishTopic->id, true, message, messageSize);
+    } else {
+        puts("MQTT-SN: Not connected, message dropped");
+    }
+}
+
+/**
+ * This callback function is called when the gateway delivered the buffered messages to the awake client.
+ *
+ * @param[in] client MQTT-SN client descriptor
+ *
+ */
+static void onAwakeDone(MQTTSNClient* client) {
+    awakeDone     = true;
+    missedWakeups = 0;
+    // Go back to sleep right away
+    EMBENET_NODE_TaskSchedule(mqttsnTaskId, EMBENET_NODE_TIME_SOURCE_LOCAL, EMBENET_NODE_GetLocalTime());
+}
+
+/**
+ * Puts the client to sleep and schedules the next wakeup, early enough for the gateway not to take the client for lost.
+ *
+ * @param[in] t current time
+ */
+static void enterSleep(uint64_t t) {
+    if (!mqttsn_sleep_enter(&mqttsnClient, MQTTSN_SERVICE_SLEEP_DURATION_S)) {
+        puts("MQTT-SN: Unable to send the sleep request");
+    }
+    serviceState = ASLEEP;
+    EMBENET_NODE_TaskSchedule(mqttsnTaskId, EMBENET_NODE_TIME_SOURCE_LOCAL, t + (MQTTSN_SERVICE_SLEEP_DURATION_S * 900U));
+}
 
 // Structure holding event handlers
 const MQTTSNClientEventHandlers mqttEventHandlers = {
@@ -66,8 +205,12 @@ const MQTTSNClientEventHandlers mqttEventHandlers = {
  */
 static void onMQTTConnected(MQTTSNClient* client) {
     puts("MQTT-SN: Connected to gateway");
-    // Move to another state and reschedule the service task
-    serviceState = REGISTER_UPTIME_TOPIC;
+#if MQTTSN_SERVICE_SLEEP_DURATION_S > 0
+    // The socket is reopened on every connect
+    mqttsn_sleep_attach(client, onAwakeDone);
+#endif
+    // Move to another state and reschedule the service task, the topics with known ids need no registration
+    serviceState = getRegistrationState();
     EMBENET_NODE_TaskSchedule(mqttsnTaskId, EMBENET_NODE_TIME_SOURCE_LOCAL, EMBENET_NODE_GetLocalTime());
 }
 
@@ -81,6 +224,10 @@ static void onMQTTConnected(MQTTSNClient* client) {
  */
 static void onMQTTDisconnected(MQTTSNClient* client) {
     puts("MQTT-SN: Client disconnected. Will try to reconnect in 5s.");
+    if (CONNECTING == serviceState) {
+        // No answer to the connect, the gateway may have been restarted and lost the session
+        forgetSession();
+    }
     // Cancel the service task
     EMBENET_NODE_TaskCancel(mqttsnTaskId);
     // Re-initialize the client
@@ -105,12 +252,14 @@ static void onMQTTDisconnected(MQTTSNClient* client) {
  */
 static void onMQTTTopicRegistered(const struct MQTTSNClient* client, MQTTSNTopicId topicId, const char* topicName) {
     printf("MQTT-SN: Topic '%s' registered in gateway with id %d\n", topicName, (int)topicId);
-    // Move to next state
-    if (serviceState == REGISTER_UPTIME_TOPIC) {
-        serviceState = REGISTER_BUTTON_STATE_TOPIC;
-    } else {
-        serviceState = SUBSCRIBE_TO_TOPIC;
+    // Keep the id for publishing and for the next connect
+    if (0 == strcmp(topicName, uptimeTopic.name)) {
+        uptimeTopic.id = topicId;
+    } else if (0 == strcmp(topicName, buttonTopic.name)) {
+        buttonTopic.id = topicId;
     }
+    // Move to next state
+    serviceState = getRegistrationState();
     // Reschedule immediately
     EMBENET_NODE_TaskSchedule(mqttsnTaskId, EMBENET_NODE_TIME_SOURCE_LOCAL, EMBENET_NODE_GetLocalTime());
 }
@@ -125,37 +274,11 @@ static void onMQTTTopicRegistered(const struct MQTTSNClient* client, MQTTSNTopic
  *
  */
 static void onLedcontrolUpdate(struct MQTTSNClient* client, MQTTSNTopicId topicId, const void* data, size_t dataSize) {
-    char* msg = (char*)data;
-
-    printf("MQTT-SN: Got message on control topic: %s\n", msg);
-
-    // Perform action based on received command
-    if (0 == strncmp(msg, "led1on", 6)) {
-        printf("MQTT-SN: Led 1 on\n");
-        nrf_gpio_pin_clear(LED1);
-    } else if (0 == strncmp(msg, "led1off", 7)) {
-        printf("MQTT-SN: Led 1 off\n");
-        nrf_gpio_pin_set(LED1);
-    } else if (0 == strncmp(msg, "led2on", 6)) {
-        printf("MQTT-SN: Led 2 on\n");
-        nrf_gpio_pin_clear(LED2);
-    } else if (0 == strncmp(msg, "led2off", 7)) {
-        printf("MQTT-SN: Led 2 off\n");
-        nrf_gpio_pin_set(LED2);
-    } else if (0 == strncmp(msg, "led3on", 6)) {
-        printf("MQTT-SN: Led 3 on\n");
-        nrf_gpio_pin_clear(LED3);
-    } else if (0 == strncmp(msg, "led3off", 7)) {
-        printf("MQTT-SN: Led 3 off\n");
-        nrf_gpio_pin_set(LED3);
-    } else if (0 == strncmp(msg, "led4on", 6)) {
-        printf("MQTT-SN: Led 4 on\n");
-        nrf_gpio_pin_clear(LED4);
-    } else if (0 == strncmp(msg, "led4off", 7)) {
-        printf("MQTT-SN: Led 4 off\n");
-        nrf_gpio_pin_set(LED4);
-    } else {
-        puts("MQTT-SN: Unknown command, ignoring");
+    // the payload is not NUL-terminated
+    APP_LOG_INFO("MQTT-SN: Got message on control topic, size: %u", (unsigned)dataSize);
+
+    if (APP_COMMAND_RESULT_OK != app_command_execute(data, dataSize)) {
+        APP_LOG_WARNING("MQTT-SN: Unknown command, ignoring");
     }
 }
 
@@ -175,39 +298,68 @@ static void mqttsnServiceTask(EMBENET_TaskId taskId, EMBENET_NODE_TimeSource tim
             // Get border router address. We assume that the MQTT-SN gateway runs on the border router IP.
             EMBENET_IPV6 addr;
             EMBENET_NODE_GetBorderRouterAddress(&addr);
-            // Perform a clean connect - you can tweak the timings here
-            MQTTSN_CLIENT_CleanConnect(&mqttsnClient, &addr, gatewayPortNo, 30, 10, NULL, NULL);
+            // Resume the session if the gateway keeps the registered topics, otherwise perform a clean connect - you can tweak the timings here
+            if (sessionEstablished) {
+                MQTTSN_CLIENT_Connect(&mqttsnClient, &addr, gatewayPortNo, MQTTSN_SERVICE_KEEP_ALIVE_S, MQTTSN_SERVICE_PING_PERIOD_S, NULL, NULL);
+            } else {
+                MQTTSN_CLIENT_CleanConnect(&mqttsnClient, &addr, gatewayPortNo, MQTTSN_SERVICE_KEEP_ALIVE_S, MQTTSN_SERVICE_PING_PERIOD_S, NULL, NULL);
+            }
             // Reschedule the task to try again after 10s if failed to connect
             EMBENET_NODE_TaskSchedule(mqttsnTaskId, timeSource, t + 10000);
             break;
         case REGISTER_UPTIME_TOPIC:
             puts("MQTT-SN: Registering uptime topic");
-            MQTTSN_CLIENT_RegisterTopic(&mqttsnClient, uptimeTopic, onMQTTTopicRegistered);
+            MQTTSN_CLIENT_RegisterTopic(&mqttsnClient, uptimeTopic.name, onMQTTTopicRegistered);
             break;
         case REGISTER_BUTTON_STATE_TOPIC:
             puts("MQTT-SN: Registering button state topic");
-            MQTTSN_CLIENT_RegisterTopic(&mqttsnClient, buttonTopic, onMQTTTopicRegistered);
+            MQTTSN_CLIENT_RegisterTopic(&mqttsnClient, buttonTopic.name, onMQTTTopicRegistered);
             break;
         case SUBSCRIBE_TO_TOPIC:
             printf("MQTT-SN: Subscribing to topic: '%s'\n", ledControlTopic);
             MQTTSN_CLIENT_Subscribe(&mqttsnClient, ledControlTopic, onLedcontrolUpdate);
-            // Move to normal state of operation
-            serviceState = RUNNING;
+            // Move to normal state of operation, the registrations can be reused from now on
+            serviceState       = RUNNING;
+            sessionEstablished = true;
             // Reschedule the task
             EMBENET_NODE_TaskSchedule(mqttsnTaskId, timeSource, EMBENET_NODE_GetLocalTime() + 1000);
             break;
         case RUNNING: {
             // Get current local time
             uint64_t uptime = EMBENET_NODE_GetLocalTime();
-            // Construct a simple JSON
-            char uptimeStr[80];
-            sprintf(uptimeStr, "{\"uptime\":%u}", (unsigned)(uptime / 1000U));
+            // Construct a simple JSON, behind the room for the PUBLISH header
+            uint8_t buffer[MQTTSN_PUBLISH_HEADROOM + MQTTSN_MAX_MESSAGE_DATA];
+            char*   uptimeStr = (char*)&buffer[MQTTSN_PUBLISH_HEADROOM];
+            int     length    = snprintf(uptimeStr, MQTTSN_MAX_MESSAGE_DATA, "{\"uptime\":%u}", (unsigned)(uptime / 1000U));
             // Publish the message
-            printf("MQTT-SN: Publishing on topic '%s' message: %s\n", uptimeTopic, uptimeStr);
-            MQTTSN_CLIENT_PublishMessage(&mqttsnClient, uptimeTopic, uptimeStr, strlen(uptimeStr));
+            printf("MQTT-SN: Publishing on topic '%s' message: %s\n", uptimeTopic.name, uptimeStr);
+            publish(&uptimeTopic, &buffer[MQTTSN_PUBLISH_HEADROOM], (size_t)length);
+#if MQTTSN_SERVICE_SLEEP_DURATION_S > 0
+            // Nothing more to send, let the gateway buffer the control messages
+            enterSleep(t);
+#else
             // Reschedule the task
             EMBENET_NODE_TaskSchedule(taskId, timeSource, t + 10000);
+#endif
         } break;
+        case ASLEEP:
+            // Poll the gateway for the buffered messages
+            awakeDone = false;
+            if (!mqttsn_sleep_wake(&mqttsnClient)) {
+                puts("MQTT-SN: Unable to send the wakeup");
+            }
+            serviceState = AWAKE;
+            EMBENET_NODE_TaskSchedule(taskId, timeSource, t + MQTTSN_SERVICE_AWAKE_TIMEOUT_MS);
+            break;
+        case AWAKE:
+            if (!awakeDone && (++missedWakeups >= MQTTSN_SERVICE_MAX_MISSED_WAKEUPS)) {
+                // The gateway has lost the client, start over
+                missedWakeups = 0;
+                onMQTTDisconnected(&mqttsnClient);
+            } else {
+                enterSleep(EMBENET_NODE_GetLocalTime());
+            }
+            break;
         default:
             puts("MQTT-SN: Unknown service state");
             break;
@@ -221,17 +373,30 @@ void mqttsn_client_service_init(void) {
     char          clientId[32];
     sprintf(clientId, "Client%x%08x", (unsigned)(uid>>32), (unsigned)(uid));
     // Prepare topics
-    sprintf(uptimeTopic, "uptime/%x%08x", (unsigned)(uid>>32), (unsigned)(uid));
-    sprintf(buttonTopic, "button/%x%08x", (unsigned)(uid>>32), (unsigned)(uid));
+    sprintf(uptimeTopic.name, "uptime/%x%08x", (unsigned)(uid>>32), (unsigned)(uid));
+    sprintf(buttonTopic.name, "button/%x%08x", (unsigned)(uid>>32), (unsigned)(uid));
+    // Topics predefined in the gateway are never registered
+    uptimeTopic.id         = MQTTSN_SERVICE_UPTIME_TOPIC_ID;
+    uptimeTopic.predefined = (0 != MQTTSN_SERVICE_UPTIME_TOPIC_ID);
+    buttonTopic.id         = MQTTSN_SERVICE_BUTTON_TOPIC_ID;
+    buttonTopic.predefined = (0 != MQTTSN_SERVICE_BUTTON_TOPIC_ID);
     // Initialize the MQTT-SN client
     if (MQTTSN_CLIENT_RESULT_OK == MQTTSN_CLIENT_Init(&mqttsnClient, clientPortNo, clientId, &mqttEventHandlers)) {
         // Create the service task
-        mqttsnTaskId = EMBENET_NODE_TaskCreate(mqttsnServiceTask, &mqttsnClient);
+        mqttsnTaskId = app_task_create("mqttsn", mqttsnServiceTask, &mqttsnClient);
         if (EMBENET_TASKID_INVALID == mqttsnTaskId) {
             MQTTSN_CLIENT_Deinit(&mqttsnClient);
             puts("MQTT-SN: Unable to create task. Service aborted.");
         } else {
             printf("MQTT-SN: Service initialized with clientId: %s\n", clientId);
+            // Bursts of button presses are published as one message with the latest count
+            if (!mqttsn_publish_init(onPublishDue)) {
+                puts("MQTT-SN: Unable to initialize the publish queue.");
+            }
+            // Get notified about button presses instead of polling the button
+            if (!input_events_register(BUTTON1, true, onButtonChanged)) {
+                puts("MQTT-SN: Unable to watch the button.");
+            }
         }
     } else {
         puts("MQTT-SN: Unable to initialize MQTT-SN client. Service aborted.");
@@ -256,30 +421,34 @@ void mqttsn_client_service_stop(void) {
     char          clientId[32];
     sprintf(clientId, "Client%x%08x", (unsigned)(EMBENET_NODE_GetUID()>>32), (unsigned)(EMBENET_NODE_GetUID()));
     MQTTSN_CLIENT_Init(&mqttsnClient, clientPortNo, clientId, &mqttEventHandlers);
+    // The node may join through another border router, with another gateway
+    forgetSession();
+    // The queued messages cannot reach the gateway any more
+    mqttsn_publish_discard();
 }
 
 
-void mqttsn_client_service_proc(void) {
-    // Holds the last timestamp at which gateway was notified
-    static uint64_t lastTimestamp;
+/**
+ * This callback function is called when the button changes its state.
+ * Publishes the number of presses; the presses following each other within MQTTSN_PUBLISH_COALESCE_MS are sent in one message.
+ *
+ * @param[in] pin button pin
+ * @param[in] active true if the button was pressed
+ *
+ */
+static void onButtonChanged(uint32_t pin, bool active) {
     // Holds the number of button presses
     static int buttonPressCounter;
 
-    // Check if service is running
-    if (serviceState == RUNNING) {
-        // Check if button is pressed
-		if (!nrf_gpio_pin_read(BUTTON1)) {
-            // Check if sufficient time passed from the last time we notified the gateway
-            if (lastTimestamp + 1000 < EMBENET_NODE_GetLocalTime()) {
-                // Prepare message to be published
-                char payloadStr[80];
-                sprintf(payloadStr, "{\"button\":%d}", ++buttonPressCounter);
-                // Publish message
-                printf("MQTT-SN: Publishing on topic '%s' message: %s\n", buttonTopic, payloadStr);
-                MQTTSN_CLIENT_PublishMessage(&mqttsnClient, buttonTopic, payloadStr, strlen(payloadStr));
-                // Save timestamp
-                lastTimestamp = EMBENET_NODE_GetLocalTime();
-            }
+    // Check if the button was pressed, not released
+    if (active) {
+        // Prepare message to be published
+        char payloadStr[MQTTSN_MAX_MESSAGE_DATA];
+        int  length = snprintf(payloadStr, sizeof(payloadStr), "{\"button\":%d}", ++buttonPressCounter);
+        // Queue the message, it replaces the one not sent yet
+        printf("MQTT-SN: Queueing on topic '%s' message: %s\n", buttonTopic.name, payloadStr);
+        if (!mqttsn_publish_enqueue(&buttonTopic, payloadStr, (size_t)length)) {
+            puts("MQTT-SN: Unable to queue the message");
         }
     }
 }
@@ -12,6 +12,8 @@
 /**
  * @brief Initializes an exemplary, user-defined MQTT-SN service.
  *
+ * Button presses are published as they come, see @ref input_events_init (must be called before).
+ * With MQTTSN_SERVICE_SLEEP_DURATION_S set, the client sleeps between polls of the gateway (see mqttsn_sleep.h).
  */
 void mqttsn_client_service_init(void);
 
@@ -25,9 +27,4 @@ void mqttsn_client_service_start(void);
  */
 void mqttsn_client_service_stop(void);
 
-/**
- * @brief Periodically scans a button and publishes a state message using MQTT-SN.
- */
-void mqttsn_client_service_proc(void);
-
 #endif // MQTTSN_CLIENT_SERVICE_H_
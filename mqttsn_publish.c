@@ -0,0 +1,229 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Coalesced MQTT-SN publishes and QoS -1 publishing
+*/
+
+#include "mqttsn_publish.h"
+#include "app_task.h"
+#include "embenet_node.h"
+#include "embenet_udp.h"
+#include <stdio.h>
+#include <string.h>
+
+#define PUBLISH_TYPE          0x0C ///< MsgType of PUBLISH
+#define PUBLISH_FLAGS_QOS_0   0x00 ///< QoS field set to 0
+#define PUBLISH_FLAGS_QOS_M1  0x60 ///< QoS field set to -1
+#define PUBLISH_FLAGS_PREDEF  0x01 ///< TopicIdType: predefined topic id
+#define PUBLISH_FIELDS_SIZE   6    ///< MsgType, Flags, TopicId, MsgId
+#define PUBLISH_LONG_LENGTH   0x01 ///< first byte of a three-byte Length field
+
+/// Message waiting for newer ones
+typedef struct {
+    void*    topic;                            ///< NULL if the entry is free
+    uint64_t dueTime;                          ///< local time at which the message is sent [ms]
+    size_t   size;                             ///< size of the message [bytes]
+    uint8_t  buffer[MQTTSN_PUBLISH_HEADROOM + MQTTSN_MAX_MESSAGE_DATA]; ///< latest message of the topic, after the headroom
+} QueuedMessage;
+
+static QueuedMessage                queue[MQTTSN_PUBLISH_QUEUE_SIZE];
+static mqttsn_publish_send_function sendFunction;
+static EMBENET_TaskId               publishTaskId = EMBENET_TASKID_INVALID;
+static EMBENET_UDP_SocketDescriptor qosMinus1Socket;
+static mqttsn_publish_stats         stats;
+
+/// The QoS -1 publishes are only sent, but the socket needs a reception handler
+static void onReceived(EMBENET_UDP_SocketDescriptor const* socket, EMBENET_IPV6 const* sourceAddress, uint16_t sourcePort, void const* data, size_t dataSize) {
+    (void)socket;
+    (void)sourceAddress;
+    (void)sourcePort;
+    (void)data;
+    (void)dataSize;
+}
+
+/// Schedules the task at the earliest due time
+static void scheduleNext(void) {
+    uint64_t earliest = UINT64_MAX;
+    for (size_t i = 0; i < MQTTSN_PUBLISH_QUEUE_SIZE; ++i) {
+        if ((NULL != queue[i].topic) && (queue[i].dueTime < earliest)) {
+            earliest = queue[i].dueTime;
+        }
+    }
+    if (UINT64_MAX == earliest) {
+        EMBENET_NODE_TaskCancel(publishTaskId);
+    } else {
+        EMBENET_NODE_TaskSchedule(publishTaskId, EMBENET_NODE_TIME_SOURCE_LOCAL, earliest);
+    }
+}
+
+static void sendDue(uint64_t now) {
+    for (size_t i = 0; i < MQTTSN_PUBLISH_QUEUE_SIZE; ++i) {
+        if ((NULL != queue[i].topic) && (queue[i].dueTime <= now)) {
+            void* topic    = queue[i].topic;
+            queue[i].topic = NULL;
+            stats.sent++;
+            sendFunction(topic, &queue[i].buffer[MQTTSN_PUBLISH_HEADROOM], queue[i].size);
+        }
+    }
+}
+
+/**
+ * @brief Sends the messages that are due
+ *
+ * @param[in] taskId id of the task
+ * @param[in] timeSource time source (local time or network time)
+ * @param[in] t time at which the task was scheduled to run
+ * @param[in] context generic, user-defined context
+ */
+static void publishTask(EMBENET_TaskId taskId, EMBENET_NODE_TimeSource timeSource, uint64_t t, void* context) {
+    (void)taskId;
+    (void)timeSource;
+    (void)t;
+    (void)context;
+    sendDue(EMBENET_NODE_GetLocalTime());
+    scheduleNext();
+}
+
+bool mqttsn_publish_init(mqttsn_publish_send_function send) {
+    if (NULL == send) {
+        return false;
+    }
+    sendFunction = send;
+    memset(queue, 0, sizeof(queue));
+    publishTaskId = app_task_create("mqttsn_publish", publishTask, NULL);
+    if (EMBENET_TASKID_INVALID == publishTaskId) {
+        printf("MQTTSN_PUBLISH: Unable to create task\n");
+        return false;
+    }
+    qosMinus1Socket = (EMBENET_UDP_SocketDescriptor){
+        .port           = MQTTSN_PUBLISH_QOS_MINUS1_PORT,
+        .groupId        = 0,
+        .handledTraffic = EMBENET_UDP_TRAFFIC_UNICAST,
+        .rxDataHandler  = onReceived,
+        .userContext    = NULL,
+    };
+    EMBENET_Result status = EMBENET_UDP_RegisterSocket(&qosMinus1Socket);
+    if (EMBENET_RESULT_OK != status) {
+        printf("MQTTSN_PUBLISH: Registering socket failed with status %d\n", (int)status);
+        return false;
+    }
+    return true;
+}
+
+bool mqttsn_publish_enqueue(void* topic, char const* message, size_t messageSize) {
+    if ((NULL == topic) || (messageSize > MQTTSN_MAX_MESSAGE_DATA)) {
+        return false;
+    }
+    QueuedMessage* entry = NULL;
+    for (size_t i = 0; i < MQTTSN_PUBLISH_QUEUE_SIZE; ++i) {
+        if (topic == queue[i].topic) {
+            entry = &queue[i];
+            break;
+        }
+        if ((NULL == entry) && (NULL == queue[i].topic)) {
+            entry = &queue[i];
+        }
+    }
+    if (NULL == entry) {
+        stats.overflows++;
+        return false;
+    }
+    stats.queued++;
+    if (topic == entry->topic) {
+        // the due time of the first message is kept, so that a steady stream of updates is still sent
+        stats.coalesced++;
+    } else {
+        entry->topic   = topic;
+        entry->dueTime = EMBENET_NODE_GetLocalTime() + MQTTSN_PUBLISH_COALESCE_MS;
+    }
+    memcpy(&entry->buffer[MQTTSN_PUBLISH_HEADROOM], message, messageSize);
+    entry->size = messageSize;
+    scheduleNext();
+    return true;
+}
+
+void mqttsn_publish_flush(void) {
+    sendDue(UINT64_MAX);
+    scheduleNext();
+}
+
+void mqttsn_publish_discard(void) {
+    for (size_t i = 0; i < MQTTSN_PUBLISH_QUEUE_SIZE; ++i) {
+        queue[i].topic = NULL;
+    }
+    EMBENET_NODE_TaskCancel(publishTaskId);
+}
+
+/**
+ * Writes the PUBLISH header in front of the payload.
+ *
+ * @return beginning of the packet, NULL if the payload is too long
+ */
+static uint8_t* putHeader(uint8_t* payload, size_t payloadSize, uint8_t flags, MQTTSNTopicId topicId) {
+    size_t   length = 1 + PUBLISH_FIELDS_SIZE + payloadSize;
+    uint8_t* header = payload - PUBLISH_FIELDS_SIZE;
+    header[0]       = PUBLISH_TYPE;
+    header[1]       = flags;
+    header[2]       = (uint8_t)(topicId >> 8);
+    header[3]       = (uint8_t)topicId;
+    header[4]       = 0; // MsgId, not relevant for QoS 0 and -1
+    header[5]       = 0;
+    if (length <= UINT8_MAX) {
+        header -= 1;
+        header[0] = (uint8_t)length;
+    } else {
+        length += 2;
+        if (length > UINT16_MAX) {
+            return NULL;
+        }
+        header -= 3;
+        header[0] = PUBLISH_LONG_LENGTH;
+        header[1] = (uint8_t)(length >> 8);
+        header[2] = (uint8_t)length;
+    }
+    return header;
+}
+
+bool mqttsn_publish_in_place(MQTTSNClient* client, MQTTSNTopicId topicId, bool predefined, uint8_t* payload, size_t payloadSize) {
+    uint8_t flags = (uint8_t)(((NULL == client) ? PUBLISH_FLAGS_QOS_M1 : PUBLISH_FLAGS_QOS_0) | (predefined ? PUBLISH_FLAGS_PREDEF : 0));
+    if ((NULL == client) && !predefined) {
+        return false;
+    }
+    uint8_t* packet = putHeader(payload, payloadSize, flags, topicId);
+    if (NULL == packet) {
+        return false;
+    }
+    size_t packetSize = (size_t)(payload - packet) + payloadSize;
+
+    EMBENET_Result result;
+    if (NULL == client) {
+        EMBENET_IPV6 gatewayAddress;
+        EMBENET_NODE_GetBorderRouterAddress(&gatewayAddress);
+        result = EMBENET_UDP_Send(&qosMinus1Socket, &gatewayAddress, MQTTSN_PUBLISH_GATEWAY_PORT, packet, packetSize);
+    } else {
+        result = EMBENET_UDP_Send(&client->udpSocket, &client->gatewayAddress, client->gatewayPort, packet, packetSize);
+    }
+    if (EMBENET_RESULT_OK != result) {
+        return false;
+    }
+    stats.inPlace++;
+    if (NULL == client) {
+        stats.qosMinus1++;
+    }
+    return true;
+}
+
+bool mqttsn_publish_qos_minus1(MQTTSNTopicId topicId, char const* message, size_t messageSize) {
+    uint8_t buffer[MQTTSN_PUBLISH_HEADROOM + MQTTSN_MAX_MESSAGE_DATA];
+    if (messageSize > MQTTSN_MAX_MESSAGE_DATA) {
+        return false;
+    }
+    memcpy(&buffer[MQTTSN_PUBLISH_HEADROOM], message, messageSize);
+    return mqttsn_publish_in_place(NULL, topicId, true, &buffer[MQTTSN_PUBLISH_HEADROOM], messageSize);
+}
+
+void mqttsn_publish_get_stats(mqttsn_publish_stats* publishStats) {
+    *publishStats = stats;
+}
@@ -0,0 +1,106 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Coalesced MQTT-SN publishes and QoS -1 publishing
+
+For topics where only the latest value matters, messages are queued per topic and sent once MQTTSN_PUBLISH_COALESCE_MS has passed
+since the first of them was queued. A newer message replaces the one queued for the same topic, so a burst of updates costs one PUBLISH.
+The messages are handed back to the user through the send function given in mqttsn_publish_init() when they are due.
+
+QoS -1 publishing (MQTT-SN v1.2, 6.8) sends a PUBLISH for a topic id predefined in the gateway with no connection to it, from a socket
+of its own on MQTTSN_PUBLISH_QOS_MINUS1_PORT. Nothing is received and nothing is acknowledged, so a sensor can publish as soon as the
+node has joined the network.
+
+Publishing in place takes a payload of any size up to the UDP datagram limit, in a buffer owned by the caller with
+MQTTSN_PUBLISH_HEADROOM free bytes in front of it. The PUBLISH header is written into the headroom and the datagram is handed to the stack
+from there, without the copy into the client library and without its MQTTSN_MAX_MESSAGE_DATA limit. The queued messages are kept with
+the headroom too, so they are sent the same way.
+*/
+
+#ifndef MQTTSN_PUBLISH_H_
+#define MQTTSN_PUBLISH_H_
+
+#include "mqttsn_client.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MQTTSN_PUBLISH_QUEUE_SIZE        4    ///< number of topics with a queued message
+#define MQTTSN_PUBLISH_COALESCE_MS       1000 ///< longest time a message waits for newer ones [ms]
+#define MQTTSN_PUBLISH_QOS_MINUS1_PORT   1886 ///< local UDP port of the QoS -1 publishes
+#define MQTTSN_PUBLISH_GATEWAY_PORT      1885 ///< UDP port of the MQTT-SN gateway
+#define MQTTSN_PUBLISH_HEADROOM          9    ///< free bytes needed in front of a payload published in place
+
+/**
+ * @brief Sends a queued message when it is due.
+ * @param[in] topic topic given to mqttsn_publish_enqueue
+ * @param[in] message message, preceded by MQTTSN_PUBLISH_HEADROOM free bytes
+ * @param[in] messageSize size of the message [bytes]
+ */
+typedef void (*mqttsn_publish_send_function)(void* topic, uint8_t* message, size_t messageSize);
+
+/// Publishing statistics
+typedef struct {
+    uint32_t queued;      ///< messages queued
+    uint32_t coalesced;   ///< queued messages replaced by newer ones
+    uint32_t sent;        ///< queued messages handed to the send function
+    uint32_t overflows;   ///< messages rejected because all the queue entries were taken by other topics
+    uint32_t qosMinus1;   ///< QoS -1 publishes sent
+    uint32_t inPlace;     ///< publishes sent in place, QoS -1 included
+} mqttsn_publish_stats;
+
+/**
+ * @brief Initializes the publish queue and the QoS -1 socket.
+ * @param[in] send function sending the due messages
+ * @return true on success, false otherwise
+ */
+bool mqttsn_publish_init(mqttsn_publish_send_function send);
+
+/**
+ * @brief Queues a message, replacing the one queued for the same topic.
+ * @param[in] topic topic, compared by address
+ * @param[in] message message, copied
+ * @param[in] messageSize size of the message, at most MQTTSN_MAX_MESSAGE_DATA [bytes]
+ * @return true if queued, false if the message is too long or the queue is full
+ */
+bool mqttsn_publish_enqueue(void* topic, char const* message, size_t messageSize);
+
+/**
+ * @brief Sends all the queued messages right away.
+ */
+void mqttsn_publish_flush(void);
+
+/**
+ * @brief Drops all the queued messages.
+ */
+void mqttsn_publish_discard(void);
+
+/**
+ * @brief Publishes a message with QoS -1 to the gateway on the border router.
+ * @param[in] topicId topic id predefined in the gateway
+ * @param[in] message message
+ * @param[in] messageSize size of the message [bytes]
+ * @return true if sent, false otherwise
+ */
+bool mqttsn_publish_qos_minus1(MQTTSNTopicId topicId, char const* message, size_t messageSize);
+
+/**
+ * @brief Publishes a payload in place, with QoS 0 through a connected client or with QoS -1 if there is no client.
+ * @param[in] client connected MQTT-SN client descriptor, NULL to publish with QoS -1 (predefined topic ids only)
+ * @param[in] topicId registered or predefined topic id
+ * @param[in] predefined true if the topic id is predefined in the gateway
+ * @param[in,out] payload payload, preceded by MQTTSN_PUBLISH_HEADROOM bytes that are overwritten
+ * @param[in] payloadSize size of the payload [bytes]
+ * @return true if sent, false otherwise
+ */
+bool mqttsn_publish_in_place(MQTTSNClient* client, MQTTSNTopicId topicId, bool predefined, uint8_t* payload, size_t payloadSize);
+
+/**
+ * @brief Gets the publishing statistics.
+ * @param[out] stats statistics
+ */
+void mqttsn_publish_get_stats(mqttsn_publish_stats* stats);
+
+#endif // MQTTSN_PUBLISH_H_
@@ -0,0 +1,88 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     MQTT-SN sleeping client (MQTT-SN v1.2, 6.14)
+*/
+
+#include "mqttsn_sleep.h"
+#include "embenet_udp.h"
+#include <stddef.h>
+#include <string.h>
+
+#define MSG_TYPE_PINGREQ    0x16
+#define MSG_TYPE_PINGRESP   0x17
+#define MSG_TYPE_DISCONNECT 0x18
+
+static MQTTSNClient*              sleepingClient;
+static EMBENET_UDP_RxDataHandler  clientHandler;
+static mqttsn_sleep_awake_handler awakeHandler;
+static bool                       sleeping;
+static bool                       awake;
+
+/// Gets the MsgType of a packet, 0 if the packet is broken
+static uint8_t getMessageType(uint8_t const* packet, size_t size) {
+    if ((size >= 2) && (0x01 != packet[0])) {
+        return packet[1];
+    }
+    if (size >= 4) {
+        // three-byte length field
+        return packet[3];
+    }
+    return 0;
+}
+
+/// Reception handler of the client socket, filters the packets of the sleeping client
+static void onReceived(EMBENET_UDP_SocketDescriptor const* socket, EMBENET_IPV6 const* sourceAddress, uint16_t sourcePort, void const* data, size_t dataSize) {
+    if (sleeping) {
+        uint8_t type = getMessageType((uint8_t const*)data, dataSize);
+        if (MSG_TYPE_DISCONNECT == type) {
+            // the gateway confirms the sleep, the library would take it for a disconnection
+            return;
+        }
+        if ((MSG_TYPE_PINGRESP == type) && awake) {
+            awake = false;
+            clientHandler(socket, sourceAddress, sourcePort, data, dataSize);
+            awakeHandler(sleepingClient);
+            return;
+        }
+    }
+    clientHandler(socket, sourceAddress, sourcePort, data, dataSize);
+}
+
+void mqttsn_sleep_attach(MQTTSNClient* client, mqttsn_sleep_awake_handler onAwakeDone) {
+    sleepingClient = client;
+    awakeHandler   = onAwakeDone;
+    sleeping       = false;
+    awake          = false;
+    if (onReceived != client->udpSocket.rxDataHandler) {
+        clientHandler                    = client->udpSocket.rxDataHandler;
+        client->udpSocket.rxDataHandler = onReceived;
+    }
+}
+
+static bool sendToGateway(MQTTSNClient* client, uint8_t const* packet, size_t size) {
+    return EMBENET_RESULT_OK == EMBENET_UDP_Send(&client->udpSocket, &client->gatewayAddress, client->gatewayPort, packet, size);
+}
+
+bool mqttsn_sleep_enter(MQTTSNClient* client, uint16_t durationSec) {
+    uint8_t packet[4] = {sizeof(packet), MSG_TYPE_DISCONNECT, (uint8_t)(durationSec >> 8), (uint8_t)durationSec};
+    sleeping          = true;
+    awake             = false;
+    return sendToGateway(client, packet, sizeof(packet));
+}
+
+bool mqttsn_sleep_wake(MQTTSNClient* client) {
+    uint8_t packet[2 + MQTTSN_MAX_CLIENT_ID_LENGTH];
+    size_t  idLength = strlen(client->clientId);
+    packet[0]        = (uint8_t)(2 + idLength);
+    packet[1]        = MSG_TYPE_PINGREQ;
+    memcpy(&packet[2], client->clientId, idLength);
+    awake = true;
+    return sendToGateway(client, packet, 2 + idLength);
+}
+
+bool mqttsn_sleep_is_sleeping(void) {
+    return sleeping;
+}
@@ -0,0 +1,59 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     MQTT-SN sleeping client (MQTT-SN v1.2, 6.14)
+
+A connected client goes to sleep with a DISCONNECT carrying the sleep duration: the gateway keeps the session and buffers the messages
+published to its subscriptions instead of sending them. Before the duration elapses the client wakes up with a PINGREQ carrying its
+client id, receives the buffered messages and, once the gateway answers with PINGRESP, goes to sleep again. The node does not exchange
+keepalives with the gateway while asleep, it only polls it once per sleep duration.
+
+The MQTT-SN client library has no sleeping state, so the client socket is attached to: the gateway's answer to the DISCONNECT is kept
+from the library, which stays connected and delivers the buffered messages to the subscription callbacks as usual. Publishing needs the
+client to be active, but QoS -1 publishes (see mqttsn_publish.h) can be sent at any time.
+*/
+
+#ifndef MQTTSN_SLEEP_H_
+#define MQTTSN_SLEEP_H_
+
+#include "mqttsn_client.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Called when the gateway answers the PINGREQ, after the buffered messages.
+ * @param[in] client MQTT-SN client descriptor
+ */
+typedef void (*mqttsn_sleep_awake_handler)(MQTTSNClient* client);
+
+/**
+ * @brief Attaches to the socket of the client. Must be called every time the client connects, as the socket is reopened.
+ * @param[in] client MQTT-SN client descriptor, connected
+ * @param[in] onAwakeDone called when the gateway has delivered the buffered messages
+ */
+void mqttsn_sleep_attach(MQTTSNClient* client, mqttsn_sleep_awake_handler onAwakeDone);
+
+/**
+ * @brief Puts the client to sleep.
+ * @param[in] client MQTT-SN client descriptor, connected
+ * @param[in] durationSec sleep duration, the client has to wake up before it elapses [s]
+ * @return true if the DISCONNECT was sent, false otherwise
+ */
+bool mqttsn_sleep_enter(MQTTSNClient* client, uint16_t durationSec);
+
+/**
+ * @brief Wakes the client up to receive the buffered messages.
+ * @param[in] client MQTT-SN client descriptor, asleep
+ * @return true if the PINGREQ was sent, false otherwise
+ */
+bool mqttsn_sleep_wake(MQTTSNClient* client);
+
+/**
+ * @brief Checks if the client is asleep or awake (not active).
+ * @return true if the client went to sleep and did not connect again since
+ */
+bool mqttsn_sleep_is_sleeping(void);
+
+#endif // MQTTSN_SLEEP_H_
@@ -0,0 +1,289 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Compact, delta-encoded performance report sent next to ENMS
+*/
+
+#include "perf_report.h"
+#include "app_task.h"
+#include "embenet_node.h"
+#include "embenet_node_diag.h"
+#include "energy_monitor.h"
+#include "embenet_port_brt.h"
+#include "embenet_port_critical_section.h"
+#include "embenet_port_packet_pool.h"
+#include "embenet_udp.h"
+#include "slot_profiler.h"
+#include "trace_recorder.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define FLAG_KEYFRAME   0x01
+#define ENTRY_EUI       0x10
+#define ENTRY_REMOVED   0x20
+#define MAX_VARINT_SIZE 5
+#define MAX_ENTRY_SIZE  (1 + 8 + MAX_VARINT_SIZE + MAX_VARINT_SIZE)
+#define MAX_REPORT_SIZE (5 + (PERF_REPORT_VALUE_COUNT * MAX_VARINT_SIZE) + 1 + (PERF_REPORT_MAX_NEIGHBORS * MAX_ENTRY_SIZE))
+
+/// Neighbor as last reported
+typedef struct {
+    uint64_t eui; ///< 0 if the entry is free
+    int32_t  rssi;
+    uint32_t pdr;
+} Neighbor;
+
+/// Socket the reports are sent through
+static EMBENET_UDP_SocketDescriptor reportSocket;
+/// Id of the reporting task
+static EMBENET_TaskId reportTaskId = EMBENET_TASKID_INVALID;
+/// Cadence of the reports
+static perf_report_policy reportPolicy = {.firstSendTimeSec = 60, .sendPeriodSec = 300};
+/// Values in the last report
+static uint32_t lastValues[PERF_REPORT_VALUE_COUNT];
+/// Neighbors in the last report
+static Neighbor lastNeighbors[PERF_REPORT_MAX_NEIGHBORS];
+/// Sequence number of the next report
+static uint16_t sequence;
+/// Reports left until the next key frame
+static unsigned reportsToKeyframe;
+
+/// The reports are only sent, but the socket needs a reception handler
+static void onReceived(EMBENET_UDP_SocketDescriptor const* socket, EMBENET_IPV6 const* sourceAddress, uint16_t sourcePort, void const* data, size_t dataSize) {
+    (void)socket;
+    (void)sourceAddress;
+    (void)sourcePort;
+    (void)data;
+    (void)dataSize;
+}
+
+static size_t putVarint(uint8_t* out, int32_t difference) {
+    uint32_t zigzag = ((uint32_t)difference << 1) ^ (uint32_t)(difference >> 31);
+    size_t   length = 0;
+    do {
+        uint8_t byte = (uint8_t)(zigzag & 0x7F);
+        zigzag >>= 7;
+        out[length++] = (uint8_t)(byte | ((0 != zigzag) ? 0x80 : 0));
+    } while (0 != zigzag);
+    return length;
+}
+
+/// Difference of two readouts of a counter, which may wrap around
+static int32_t delta(uint32_t value, uint32_t previous) {
+    return (int32_t)(value - previous);
+}
+
+static void readValues(uint32_t values[PERF_REPORT_VALUE_COUNT]) {
+    memset(values, 0, PERF_REPORT_VALUE_COUNT * sizeof(values[0]));
+    values[PERF_REPORT_VALUE_UPTIME_S]         = (uint32_t)(EMBENET_NODE_GetLocalTime() / 1000U);
+    values[PERF_REPORT_VALUE_DAG_RANK]         = EMBENET_NODE_DIAG_GetDAGRank();
+    values[PERF_REPORT_VALUE_PARENT_RSSI]      = (uint32_t)(int32_t)EMBENET_NODE_DIAG_GetParentRSSI();
+    values[PERF_REPORT_VALUE_PARENT_PDR]       = EMBENET_NODE_DIAG_GetParentPDR();
+    values[PERF_REPORT_VALUE_UP_PACKET_RATE]   = EMBENET_NODE_DIAG_GetUpPacketRate();
+    values[PERF_REPORT_VALUE_DOWN_PACKET_RATE] = EMBENET_NODE_DIAG_GetDownPacketRate();
+    values[PERF_REPORT_VALUE_READY_DUTY_CYCLE] = EMBENET_NODE_DIAG_GetRadioReadyDutyCycle();
+    values[PERF_REPORT_VALUE_TX_DUTY_CYCLE]    = EMBENET_NODE_DIAG_GetRadioTxDutyCycle();
+    values[PERF_REPORT_VALUE_RX_DUTY_CYCLE]    = EMBENET_NODE_DIAG_GetRadioRxDutyCycle();
+
+    EMBENET_NODE_DIAG_QueueCounters queue      = EMBENET_NODE_DIAG_GetQueueThresholdAndOverflowCounters();
+    values[PERF_REPORT_VALUE_QUEUE_ALERTS]     = queue.alert;
+    values[PERF_REPORT_VALUE_QUEUE_OVERFLOWS]  = queue.overflow;
+    EMBENET_NODE_DIAG_DutyCycleRawData radio   = EMBENET_NODE_DIAG_GetRadioDutyCycleRaw();
+    values[PERF_REPORT_VALUE_TX_TIME_MS]       = (uint32_t)(radio.timeTx / 1000U);
+    values[PERF_REPORT_VALUE_RX_TIME_MS]       = (uint32_t)(radio.timeRx / 1000U);
+
+    slot_profiler_stats stats;
+    slot_profiler_get_stats(SLOT_PROFILER_SECTION_SLOT, &stats);
+    values[PERF_REPORT_VALUE_SLOT_MAX_US]   = stats.maxCycles / SLOT_PROFILER_CYCLES_PER_US;
+    values[PERF_REPORT_VALUE_SLOT_MEAN_US]  = (0 == stats.count) ? 0 : (uint32_t)(stats.totalCycles / stats.count / SLOT_PROFILER_CYCLES_PER_US);
+    values[PERF_REPORT_VALUE_SLOT_OVERRUNS] = stats.histogram[SLOT_PROFILER_HISTOGRAM_BINS - 1];
+    slot_profiler_get_stats(SLOT_PROFILER_SECTION_MAC, &stats);
+    values[PERF_REPORT_VALUE_MAC_MAX_US] = stats.maxCycles / SLOT_PROFILER_CYCLES_PER_US;
+    slot_profiler_get_stats(SLOT_PROFILER_SECTION_RADIO_ISR, &stats);
+    values[PERF_REPORT_VALUE_RADIO_ISR_MAX_US] = stats.maxCycles / SLOT_PROFILER_CYCLES_PER_US;
+    values[PERF_REPORT_VALUE_CRITICAL_MAX_US]  = EMBENET_CRITICAL_SECTION_GetMaxMaskedTimeUs();
+    values[PERF_REPORT_VALUE_TRACE_DROPPED]    = trace_recorder_get_dropped();
+
+    energy_monitor_stats energy;
+    energy_monitor_get_stats(&energy);
+    values[PERF_REPORT_VALUE_CHARGE_UAH]         = (uint32_t)(energy.totalNah / 1000U);
+    values[PERF_REPORT_VALUE_AVERAGE_CURRENT_UA] = energy.averageCurrentUa;
+    values[PERF_REPORT_VALUE_LIFETIME_H]         = energy.estimatedLifetimeHours;
+
+    EMBENET_PacketPoolStats pool;
+    EMBENET_PACKET_POOL_GetStats(&pool);
+    values[PERF_REPORT_VALUE_POOL_HIGH_WATERMARK] = pool.highWatermark;
+    values[PERF_REPORT_VALUE_POOL_ALLOC_FAILURES] = pool.allocFailures;
+
+    if (EMBENET_NODE_DIAG_IsRoot()) {
+        EMBENET_BRT_Stats brt;
+        EMBENET_BRT_GetStats(&brt);
+        values[PERF_REPORT_VALUE_BRT_FRAMES_IN]    = brt.framesIn;
+        values[PERF_REPORT_VALUE_BRT_FRAMES_OUT]   = brt.framesOut;
+        values[PERF_REPORT_VALUE_BRT_FRAME_ERRORS] = brt.crcErrors + brt.framingErrors;
+        values[PERF_REPORT_VALUE_BRT_RX_OVERRUNS]  = brt.rxOverruns;
+        values[PERF_REPORT_VALUE_BRT_TX_STALLS]    = brt.txStalls;
+    }
+}
+
+/// Mean PDR of the TX cells towards the neighbor
+static uint32_t neighborPdr(uint64_t eui) {
+    uint32_t sum   = 0;
+    uint32_t cells = 0;
+    unsigned count = EMBENET_NODE_DIAG_GetCellsCount();
+    for (unsigned i = 0; i < count; ++i) {
+        EMBENET_NODE_DIAG_CellInfo cell = EMBENET_NODE_DIAG_GetCellInfo(i);
+        if ((eui == cell.companionEui) && ((EMBENET_NODE_DIAG_CELL_TYPE_TX == cell.type) || (EMBENET_NODE_DIAG_CELL_TYPE_TXRX == cell.type))) {
+            sum += cell.pdr;
+            cells++;
+        }
+    }
+    return (0 == cells) ? PERF_REPORT_UNKNOWN_PDR : (sum / cells);
+}
+
+static size_t putNeighbor(uint8_t* out, unsigned index, bool withEui, Neighbor const* current, Neighbor const* previous) {
+    size_t length = 0;
+    out[length++] = (uint8_t)(index | (withEui ? ENTRY_EUI : 0));
+    if (withEui) {
+        for (unsigned i = 0; i < 8; ++i) {
+            out[length++] = (uint8_t)(current->eui >> (8 * i));
+        }
+    }
+    length += putVarint(&out[length], current->rssi - previous->rssi);
+    length += putVarint(&out[length], delta(current->pdr, previous->pdr));
+    return length;
+}
+
+/// Appends the neighbor entries that fit in the given space, updating the table for the ones appended
+static size_t putNeighbors(uint8_t* out, size_t space, bool keyframe) {
+    static Neighbor const none = {0};
+    Neighbor              current[PERF_REPORT_MAX_NEIGHBORS];
+    memset(current, 0, sizeof(current));
+
+    // neighbors keep their place in the table as long as they are reported
+    unsigned count = EMBENET_NODE_DIAG_GetNeighborCount();
+    for (unsigned i = 0; i < count; ++i) {
+        EMBENET_NODE_DIAG_NeighborInfo info = EMBENET_NODE_DIAG_GetNeighborInfo(i);
+        if (0 == info.eui) {
+            continue;
+        }
+        int slot = -1;
+        for (unsigned j = 0; j < PERF_REPORT_MAX_NEIGHBORS; ++j) {
+            if (lastNeighbors[j].eui == info.eui) {
+                slot = (int)j;
+                break;
+            }
+            if ((slot < 0) && (0 == lastNeighbors[j].eui) && (0 == current[j].eui)) {
+                slot = (int)j; // first free place, unless the neighbor is found further on
+            }
+        }
+        if ((slot >= 0) && (0 == current[slot].eui)) {
+            current[slot] = (Neighbor){.eui = info.eui, .rssi = info.rssi, .pdr = neighborPdr(info.eui)};
+        }
+    }
+
+    size_t   length  = 1;
+    unsigned entries = 0;
+    for (unsigned j = 0; (j < PERF_REPORT_MAX_NEIGHBORS) && (length + MAX_ENTRY_SIZE <= space); ++j) {
+        Neighbor* previous = &lastNeighbors[j];
+        if (0 != current[j].eui) {
+            bool isNew = keyframe || (previous->eui != current[j].eui);
+            if (isNew || (previous->rssi != current[j].rssi) || (previous->pdr != current[j].pdr)) {
+                length += putNeighbor(&out[length], j, isNew, &current[j], isNew ? &none : previous);
+                entries++;
+            }
+        } else if (0 != previous->eui) {
+            out[length++] = (uint8_t)(j | ENTRY_REMOVED);
+            entries++;
+        }
+        // entries that did not fit keep their last reported state and go in a later report
+        *previous = current[j];
+    }
+    out[0] = (uint8_t)entries;
+    return length;
+}
+
+/**
+ * @brief Task sending the report
+ *
+ * @param[in] taskId id of the task
+ * @param[in] timeSource time source used in scheduling
+ * @param[in] t time at which the task was scheduled
+ * @param[in] context unused
+ */
+static void reportTask(EMBENET_TaskId taskId, EMBENET_NODE_TimeSource timeSource, uint64_t t, void* context) {
+    (void)taskId;
+    (void)timeSource;
+    (void)t;
+    (void)context;
+    uint8_t  report[MAX_REPORT_SIZE];
+    uint32_t values[PERF_REPORT_VALUE_COUNT];
+    bool     keyframe = (0 == reportsToKeyframe);
+    if (keyframe) {
+        memset(lastValues, 0, sizeof(lastValues));
+        memset(lastNeighbors, 0, sizeof(lastNeighbors));
+        reportsToKeyframe = PERF_REPORT_KEYFRAME_INTERVAL;
+    }
+    reportsToKeyframe--;
+    readValues(values);
+
+    size_t length    = 0;
+    report[length++] = PERF_REPORT_VERSION;
+    report[length++] = keyframe ? FLAG_KEYFRAME : 0;
+    report[length++] = (uint8_t)sequence;
+    report[length++] = (uint8_t)(sequence >> 8);
+    report[length++] = PERF_REPORT_VALUE_COUNT;
+    for (unsigned i = 0; i < PERF_REPORT_VALUE_COUNT; ++i) {
+        length += putVarint(&report[length], delta(values[i], lastValues[i]));
+    }
+    size_t space = EMBENET_UDP_GetMaxDataSize(&reportSocket);
+    if (space > sizeof(report)) {
+        space = sizeof(report);
+    }
+    length += putNeighbors(&report[length], (space > length) ? (space - length) : 1, keyframe);
+    memcpy(lastValues, values, sizeof(lastValues));
+    sequence++;
+
+    EMBENET_IPV6 borderRouterAddress;
+    EMBENET_NODE_GetBorderRouterAddress(&borderRouterAddress);
+    if (EMBENET_RESULT_OK != EMBENET_UDP_Send(&reportSocket, &borderRouterAddress, PERF_REPORT_PORT, report, length)) {
+        // the collector is brought back in sync by the next key frame
+        reportsToKeyframe = 0;
+        printf("PERF_REPORT: Failed to send the report\n");
+    }
+}
+
+void perf_report_init(perf_report_policy const* policy) {
+    if (NULL != policy) {
+        reportPolicy = *policy;
+    }
+    reportSocket = (EMBENET_UDP_SocketDescriptor){
+        .port           = PERF_REPORT_PORT,
+        .groupId        = 0,
+        .handledTraffic = EMBENET_UDP_TRAFFIC_UNICAST,
+        .rxDataHandler  = onReceived,
+        .userContext    = NULL,
+    };
+    EMBENET_Result status = EMBENET_UDP_RegisterSocket(&reportSocket);
+    if (EMBENET_RESULT_OK != status) {
+        printf("PERF_REPORT: Registering socket failed with status %d\n", (int)status);
+        return;
+    }
+    reportTaskId = app_task_create_periodic("perf_report", reportTask, NULL, reportPolicy.sendPeriodSec * 1000U, 0);
+    if (EMBENET_TASKID_INVALID == reportTaskId) {
+        printf("PERF_REPORT: Unable to create task\n");
+    }
+}
+
+void perf_report_start(void) {
+    reportsToKeyframe = 0;
+    app_task_start(reportTaskId, EMBENET_NODE_TIME_SOURCE_LOCAL, reportPolicy.firstSendTimeSec * 1000U);
+}
+
+void perf_report_stop(void) {
+    EMBENET_NODE_TaskCancel(reportTaskId);
+}
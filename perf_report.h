@@ -0,0 +1,98 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Compact, delta-encoded performance report sent next to ENMS
+
+Every period the node sends to the border router, on PERF_REPORT_PORT, a binary report with the diagnostic counters of the stack, the
+border router link statistics (root only), the slot profiler results, the energy accounting, the packet pool use and the RSSI and PDR of its neighbors. A counter that has not
+changed costs a single byte: every value is sent as the zigzag-encoded LEB128 varint of its difference from the value in the previous
+report. Every PERF_REPORT_KEYFRAME_INTERVAL reports a key frame carries the values themselves (differences from zero), so that a collector
+that has missed reports, or has just started, catches up. tools/perf_report_decode.py decodes the reports.
+
+Report:
+ field                | encoding
+ ---------------------|----------------------------------------------------------------------
+ version              | 1 byte, PERF_REPORT_VERSION
+ flags                | 1 byte, bit 0: key frame
+ sequence             | 2 bytes, little endian, incremented with every report
+ value count          | 1 byte, values follow in the order of @ref perf_report_value
+ values               | varint each
+ neighbor count       | 1 byte, entries follow, in a delta report only the changed ones
+ neighbor entries     | 1 byte: bits 0-3 table index, bit 4 EUI follows, bit 5 neighbor removed
+                      | [8 bytes EUI, little endian], varint RSSI [dBm], varint PDR [0.01%, 0xFFFF unknown]
+
+The reports go on their own port because ENMS is a closed library: its indications and EnmsIndicationPolicy cannot be extended. The
+cadence is set the same way, with a @ref perf_report_policy.
+*/
+
+#ifndef PERF_REPORT_H_
+#define PERF_REPORT_H_
+
+#include <stdint.h>
+
+#define PERF_REPORT_PORT              UINT16_C(0xf0b2) ///< UDP port of the reports, next to ENMS_DEFAULT_PORT
+#define PERF_REPORT_VERSION           1                ///< version of the report format
+#define PERF_REPORT_KEYFRAME_INTERVAL 10               ///< every how many reports a key frame is sent
+#define PERF_REPORT_MAX_NEIGHBORS     8                ///< neighbors reported, at most 16
+#define PERF_REPORT_UNKNOWN_PDR       0xFFFF           ///< PDR of a neighbor with no TX cell
+
+/// Values of the report, in the order they are sent
+typedef enum {
+    PERF_REPORT_VALUE_UPTIME_S,            ///< uptime [s]
+    PERF_REPORT_VALUE_DAG_RANK,            ///< DAG rank
+    PERF_REPORT_VALUE_PARENT_RSSI,         ///< RSSI of the parent [dBm]
+    PERF_REPORT_VALUE_PARENT_PDR,          ///< PDR towards the parent [0.01%]
+    PERF_REPORT_VALUE_UP_PACKET_RATE,      ///< packets sent up per superframe
+    PERF_REPORT_VALUE_DOWN_PACKET_RATE,    ///< packets sent down per superframe
+    PERF_REPORT_VALUE_READY_DUTY_CYCLE,    ///< radio ready duty cycle [0.01%]
+    PERF_REPORT_VALUE_TX_DUTY_CYCLE,       ///< radio TX duty cycle [0.01%]
+    PERF_REPORT_VALUE_RX_DUTY_CYCLE,       ///< radio RX duty cycle [0.01%]
+    PERF_REPORT_VALUE_QUEUE_ALERTS,        ///< queue alert superframes in the last 1000
+    PERF_REPORT_VALUE_QUEUE_OVERFLOWS,     ///< queue overflow superframes in the last 1000
+    PERF_REPORT_VALUE_TX_TIME_MS,          ///< total time spent transmitting [ms]
+    PERF_REPORT_VALUE_RX_TIME_MS,          ///< total time spent listening and receiving [ms]
+    PERF_REPORT_VALUE_SLOT_MAX_US,         ///< longest slot [us]
+    PERF_REPORT_VALUE_SLOT_MEAN_US,        ///< mean slot [us]
+    PERF_REPORT_VALUE_SLOT_OVERRUNS,       ///< slots longer than TsSlotDurationUs
+    PERF_REPORT_VALUE_MAC_MAX_US,          ///< longest MAC routine [us]
+    PERF_REPORT_VALUE_RADIO_ISR_MAX_US,    ///< longest radio interrupt [us]
+    PERF_REPORT_VALUE_CRITICAL_MAX_US,     ///< longest critical section [us], 0 unless measured
+    PERF_REPORT_VALUE_TRACE_DROPPED,       ///< trace records dropped
+    PERF_REPORT_VALUE_BRT_FRAMES_IN,       ///< border router link frames received
+    PERF_REPORT_VALUE_BRT_FRAMES_OUT,      ///< border router link frames sent
+    PERF_REPORT_VALUE_BRT_FRAME_ERRORS,    ///< border router link frames dropped (FCS and framing)
+    PERF_REPORT_VALUE_BRT_RX_OVERRUNS,     ///< border router link bytes lost on input
+    PERF_REPORT_VALUE_BRT_TX_STALLS,       ///< border router link bytes lost on output
+    PERF_REPORT_VALUE_CHARGE_UAH,          ///< charge drawn since the startup [uAh]
+    PERF_REPORT_VALUE_AVERAGE_CURRENT_UA,  ///< average current over the last energy period [uA]
+    PERF_REPORT_VALUE_LIFETIME_H,          ///< estimated battery lifetime [h]
+    PERF_REPORT_VALUE_POOL_HIGH_WATERMARK, ///< most packet pool blocks allocated at once since the startup
+    PERF_REPORT_VALUE_POOL_ALLOC_FAILURES, ///< packet pool allocations that found no free block
+    PERF_REPORT_VALUE_COUNT
+} perf_report_value;
+
+/// When the reports are sent
+typedef struct {
+    uint32_t firstSendTimeSec; ///< time from the start of the report to the first one [s]
+    uint32_t sendPeriodSec;    ///< period of the reports [s]
+} perf_report_policy;
+
+/**
+ * @brief Initializes the report, registering its socket and creating its task.
+ * @param[in] policy cadence of the reports, NULL for the default one (first after 60s, then every 300s)
+ */
+void perf_report_init(perf_report_policy const* policy);
+
+/**
+ * @brief Starts sending the reports, beginning with a key frame. To be called when the node joins the network.
+ */
+void perf_report_start(void);
+
+/**
+ * @brief Stops sending the reports.
+ */
+void perf_report_stop(void);
+
+#endif // PERF_REPORT_H_
@@ -0,0 +1,142 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Quick join with the credentials kept in flash across resets
+*/
+
+#include "quick_join.h"
+#include "app_task.h"
+#include "embenet_port_nvm.h"
+#include "free_slot_jobs.h"
+#include <stdio.h>
+#include <string.h>
+
+#define QUICK_JOIN_NVM_KEY        0x0001 ///< key of the credentials in the store
+#define QUICK_JOIN_STORE_WORST_US 1500   ///< writing the credentials: up to 15 words of 67.5us, plus the CRC [us]
+
+static EMBENET_NODE_Config const*        joinConfig;
+static EMBENET_NODE_QuickJoinCredentials storedCredentials;
+static bool                              hasCredentials;
+static bool                              storeReady;
+static bool                              joined;
+static EMBENET_TaskId                    fallbackTaskId = EMBENET_TASKID_INVALID;
+
+/// Credentials written by the store job
+static EMBENET_NODE_QuickJoinCredentials pendingCredentials;
+static bool                              pendingDelete;
+static free_slot_job                     storeJob;
+
+/// Writes or deletes the credentials, run in a free window of the schedule
+static void storeCredentials(void* context) {
+    (void)context;
+    bool success;
+    if (pendingDelete) {
+        success = EMBENET_NVM_Delete(QUICK_JOIN_NVM_KEY);
+    } else {
+        success = EMBENET_NVM_Write(QUICK_JOIN_NVM_KEY, &pendingCredentials, sizeof(pendingCredentials));
+    }
+    if (!success) {
+        printf("QUICK_JOIN: Unable to update the stored credentials\n");
+    }
+}
+
+static void submitStore(bool deleteCredentials) {
+    if (!storeReady) {
+        return;
+    }
+    // a job still queued just takes the latest credentials
+    pendingDelete = deleteCredentials;
+    if (!storeJob.queued) {
+        storeJob.function    = storeCredentials;
+        storeJob.context     = NULL;
+        storeJob.worstCaseUs = QUICK_JOIN_STORE_WORST_US;
+        (void)free_slot_jobs_submit(&storeJob);
+    }
+}
+
+/// Gives up the quick join and starts the full join
+static void fullJoin(void) {
+    printf("QUICK_JOIN: Quick join failed, trying the full join\n");
+    (void)EMBENET_NODE_Leave();
+    (void)EMBENET_NODE_Join(joinConfig);
+}
+
+/// Schedules the full join in delayMs from now, or starts it right away if it cannot be scheduled
+static void scheduleFullJoin(uint32_t delayMs) {
+    if ((EMBENET_TASKID_INVALID == fallbackTaskId) ||
+        (EMBENET_RESULT_OK != EMBENET_NODE_TaskSchedule(fallbackTaskId, EMBENET_NODE_TIME_SOURCE_LOCAL, EMBENET_NODE_GetLocalTime() + delayMs))) {
+        fullJoin();
+    }
+}
+
+/**
+ * @brief Replaces the quick join that has not succeeded with the full join
+ *
+ * @param[in] taskId id of the task
+ * @param[in] timeSource time source (local time or network time)
+ * @param[in] t time at which the task was scheduled to run
+ * @param[in] context generic, user-defined context
+ */
+static void fallbackTask(EMBENET_TaskId taskId, EMBENET_NODE_TimeSource timeSource, uint64_t t, void* context) {
+    (void)taskId;
+    (void)timeSource;
+    (void)t;
+    (void)context;
+    if (joined) {
+        return;
+    }
+    fullJoin();
+}
+
+void quick_join_init(void) {
+    storeReady = EMBENET_NVM_Init();
+    if (!storeReady) {
+        printf("QUICK_JOIN: No flash reserved for the store\n");
+        return;
+    }
+    // erasing a page stalls the CPU for tens of milliseconds, it is better done now than while in the network
+    if (EMBENET_NVM_GetFreeSpace() < (2 * EMBENET_NVM_GetRecordSize(sizeof(EMBENET_NODE_QuickJoinCredentials)))) {
+        (void)EMBENET_NVM_Compact();
+    }
+    hasCredentials = (sizeof(storedCredentials) == EMBENET_NVM_Read(QUICK_JOIN_NVM_KEY, &storedCredentials, sizeof(storedCredentials)));
+    fallbackTaskId = app_task_create("quick_join", fallbackTask, NULL);
+}
+
+void quick_join_start(EMBENET_NODE_Config const* config) {
+    joinConfig = config;
+    if (hasCredentials && (EMBENET_TASKID_INVALID != fallbackTaskId) && (EMBENET_RESULT_OK == EMBENET_NODE_QuickJoin(&storedCredentials))) {
+        printf("QUICK_JOIN: Quick joining with the stored credentials\n");
+        scheduleFullJoin(QUICK_JOIN_TIMEOUT_MS);
+        return;
+    }
+    (void)EMBENET_NODE_Join(config);
+}
+
+void quick_join_on_joined(EMBENET_NODE_QuickJoinCredentials const* credentials) {
+    joined = true;
+    EMBENET_NODE_TaskCancel(fallbackTaskId);
+    if ((NULL == credentials) || (hasCredentials && (0 == memcmp(credentials, &storedCredentials, sizeof(storedCredentials))))) {
+        // nothing new, the flash is not worn for nothing
+        return;
+    }
+    storedCredentials  = *credentials;
+    pendingCredentials = *credentials;
+    hasCredentials     = true;
+    submitStore(false);
+}
+
+void quick_join_on_left(void) {
+    joined = false;
+}
+
+void quick_join_on_credentials_obsolete(void) {
+    if (hasCredentials) {
+        hasCredentials = false;
+        submitStore(true);
+    }
+    if (!joined) {
+        scheduleFullJoin(0);
+    }
+}
@@ -0,0 +1,52 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Quick join with the credentials kept in flash across resets
+
+The quick join credentials given on every join are stored in the non-volatile store of the port (embenet_port_nvm.h), in a free window
+of the schedule. After a reset the node quick joins with them instead of scanning for advertisements, and falls back to the full join if
+the quick join does not succeed within QUICK_JOIN_TIMEOUT_MS or the stack finds the credentials obsolete; obsolete credentials are
+deleted. A network whose nodes reset together (e.g. after a power blip) thus rejoins without saturating the advertising channels.
+*/
+
+#ifndef QUICK_JOIN_H_
+#define QUICK_JOIN_H_
+
+#include "embenet_node.h"
+#include <stdbool.h>
+
+#define QUICK_JOIN_TIMEOUT_MS 30000 ///< time after which a quick join that has not succeeded is replaced with the full join [ms]
+
+/**
+ * @brief Initializes the store and loads the stored credentials. Must be called before the node joins the network.
+ *
+ * The store is compacted now if a compaction would otherwise be needed while in the network.
+ */
+void quick_join_init(void);
+
+/**
+ * @brief Joins the network, quickly if there are stored credentials.
+ * @param[in] config network configuration for the full join, must stay valid
+ */
+void quick_join_start(EMBENET_NODE_Config const* config);
+
+/**
+ * @brief Stores the credentials if they changed. To be called from the onJoined handler.
+ * @param[in] credentials credentials given by the stack
+ */
+void quick_join_on_joined(EMBENET_NODE_QuickJoinCredentials const* credentials);
+
+/**
+ * @brief Notes that the node is not in the network any more. To be called from the onLeft handler.
+ */
+void quick_join_on_left(void);
+
+/**
+ * @brief Deletes the stored credentials and falls back to the full join if the node is not joined. To be called from the
+ * onQuickJoinCredentialsObsolete handler.
+ */
+void quick_join_on_credentials_obsolete(void);
+
+#endif // QUICK_JOIN_H_
@@ -0,0 +1,542 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET radio benchmark for nRF52
+@brief     Radio throughput, PER and turnaround benchmark running directly on the EMBENET_RADIO port interface, without the stack
+
+Two boards make a pair. The role is chosen by the button held at reset:
+- none: responder, answers every ping right from the end of frame interrupt, the way the MAC answers with an ACK
+- BUTTON1: initiator, sweeps the PHY profiles, channels and output powers and reports the results over RTT
+- BUTTON2 / BUTTON3: continuous carrier / PN9 modulated transmission on RADIO_BENCH_CW_CHANNEL, for RF tests
+
+Both boards meet on a control channel, at the build time PHY profile. For every measurement point the initiator announces the profile,
+channel and power in a SETUP frame, both move there, and the initiator sends RADIO_BENCH_PINGS pings, one at a time, each waiting for
+its pong. The responder goes back to the control channel once the pings stop, and reports what it received when asked. The radio
+timestamps give the responder turnaround (end of the ping to the start of its pong), the gap between the frames seen by the initiator,
+and the delay from EMBENET_RADIO_TxNow to the first bit, which are printed next to the constants of embenet_port_radio_config.h.
+*/
+
+// Standard C library
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+// embeNET port
+#include "embenet_critical_section.h"
+#include "embenet_port_radio_config.h"
+#include "embenet_port_radio_extension.h"
+#include "embenet_radio.h"
+#include "embenet_timer.h"
+#include "gpio_config.h"
+// board and chip specific header files
+#include "SEGGER_RTT.h"
+#include "nrf_clock.h"
+#include "nrf_gpio.h"
+
+#define RADIO_BENCH_PSDU_LENGTH         32    ///< length of the pings and pongs, the sensitivity is specified for 30B frames
+#define RADIO_BENCH_PINGS               100   ///< pings sent at every measurement point
+#define RADIO_BENCH_CONTROL_CHANNEL     8     ///< channel the boards meet on between the measurement points
+#define RADIO_BENCH_CONTROL_POWER       0     ///< output power on the control channel [dBm]
+#define RADIO_BENCH_REPLY_TIMEOUT_US    2000  ///< time from a transmission to the end of the reply, the reply is lost after it [us]
+#define RADIO_BENCH_SETUP_RETRIES       50    ///< attempts to reach the responder on the control channel
+#define RADIO_BENCH_IDLE_TIMEOUT_US     20000 ///< the responder goes back to the control channel after this long without pings [us]
+#define RADIO_BENCH_CHANNEL_STEP        1     ///< channels swept: 0, step, 2*step, ...
+#define RADIO_BENCH_CW_CHANNEL          20    ///< channel of the continuous transmission
+#define RADIO_BENCH_CW_POWER            4     ///< output power of the continuous transmission [dBm]
+
+#define FRAME_MAGIC          0xb7 ///< first byte of all benchmark frames
+#define FRAME_SETUP          1    ///< measurement point: profile, channel, power
+#define FRAME_PING           2    ///< ping, answered with a pong
+#define FRAME_PONG           3    ///< answer to a setup or a ping: RSSI of the frame answered
+#define FRAME_REPORT_REQUEST 4    ///< request of the responder statistics of the last point
+#define FRAME_REPORT         5    ///< responder statistics
+#define FRAME_HEADER_LENGTH  4    ///< magic, type, sequence number
+
+/// Output powers swept [dBm]
+static const EMBENET_RADIO_Power powers[] = {-20, -8, 0, 4};
+/// PHY profiles swept, the ones that do not fit in the slot duration are skipped
+static const EMBENET_RADIO_PhyProfile profiles[] = {EMBENET_RADIO_PHY_BLE_1MBIT, EMBENET_RADIO_PHY_BLE_2MBIT};
+
+/// Running statistics of a time [us]
+typedef struct {
+    uint32_t count;
+    uint32_t sum;
+    uint32_t min;
+    uint32_t max;
+} Stat;
+
+typedef enum {
+    RADIO_OP_NONE, ///< radio idle, or its events are ignored
+    RADIO_OP_TX,   ///< transmitting
+    RADIO_OP_RX,   ///< listening or receiving
+} RadioOp;
+
+/// Radio use, shared with the radio interrupt
+static struct {
+    volatile RadioOp         op;
+    EMBENET_RADIO_Channel    channel;
+    EMBENET_RADIO_Power      power;
+    EMBENET_RADIO_PhyProfile defaultProfile;
+    uint8_t                  txFrame[RADIO_BENCH_PSDU_LENGTH];
+    uint8_t                  rxFrame[EMBENET_RADIO_MAX_PSDU_LENGTH];
+    EMBENET_RADIO_RxInfo     rxInfo;
+    volatile bool            rxDone;    ///< set when a frame is received, the radio is left active
+    volatile EMBENET_TimeUs  txStartTs; ///< first bit of the last frame sent
+    volatile EMBENET_TimeUs  txEndTs;   ///< end of the last frame sent
+    volatile EMBENET_TimeUs  rxStartTs; ///< first bit of the last frame received
+    volatile EMBENET_TimeUs  rxEndTs;   ///< end of the last frame received
+} radio;
+
+/// Responder state, changed by the radio interrupt, except for the return to the control channel
+static struct {
+    volatile bool            testActive;     ///< true while on a measurement point
+    bool                     switchAfterTx;  ///< true if the setup is acknowledged, the measurement point starts after the pong
+    bool                     pongSent;       ///< true if the frame being sent is a pong to a ping
+    EMBENET_RADIO_PhyProfile profile;        ///< measurement point
+    EMBENET_RADIO_Channel    channel;
+    EMBENET_RADIO_Power      power;
+    volatile EMBENET_TimeUs  lastActivity;   ///< time of the last ping
+    uint16_t                 rxOk;           ///< pings received
+    uint16_t                 crcErrors;      ///< frames received with a wrong CRC
+    int32_t                  rssiSum;        ///< sum of the RSSI of the pings received
+    Stat                     turnaround;     ///< end of a ping to the start of its pong
+} responder;
+
+// Enable printf logging through RTT
+_ssize_t _write(int file, const void* ptr, size_t len) {
+    (void)file; /* Not used, avoid warning */
+    for (size_t i = 0; i < len; ++i) {
+        SEGGER_RTT_PutCharSkipNoLock(0, ((const uint8_t*)ptr)[i]);
+    }
+    return len;
+}
+
+static void statReset(Stat* stat) {
+    stat->count = 0;
+    stat->sum   = 0;
+    stat->min   = UINT32_MAX;
+    stat->max   = 0;
+}
+
+static void statAdd(Stat* stat, uint32_t value) {
+    stat->count++;
+    stat->sum += value;
+    stat->min = (value < stat->min) ? value : stat->min;
+    stat->max = (value > stat->max) ? value : stat->max;
+}
+
+static uint32_t statAvg(Stat const* stat) {
+    return (0 != stat->count) ? (stat->sum / stat->count) : 0;
+}
+
+static uint32_t statMin(Stat const* stat) {
+    return (0 != stat->count) ? stat->min : 0;
+}
+
+static void put16(uint8_t* bytes, uint16_t value) {
+    bytes[0] = (uint8_t)value;
+    bytes[1] = (uint8_t)(value >> 8);
+}
+
+static uint16_t get16(uint8_t const* bytes) {
+    return (uint16_t)(bytes[0] | (bytes[1] << 8));
+}
+
+static char const* profileName(EMBENET_RADIO_PhyProfile profile) {
+    return (EMBENET_RADIO_PHY_BLE_2MBIT == profile) ? "2M" : "1M";
+}
+
+/// Builds the header of the frame to send, padded with a pattern up to the benchmark length
+static uint8_t* frameBuild(uint8_t type, uint16_t seq) {
+    radio.txFrame[0] = FRAME_MAGIC;
+    radio.txFrame[1] = type;
+    put16(&radio.txFrame[2], seq);
+    for (size_t i = FRAME_HEADER_LENGTH; i < sizeof(radio.txFrame); ++i) {
+        radio.txFrame[i] = (uint8_t)(i * 71);
+    }
+    return &radio.txFrame[FRAME_HEADER_LENGTH];
+}
+
+/// Checks the last received frame
+static bool frameIsValid(uint8_t type, uint16_t seq) {
+    return radio.rxInfo.crcValid && (radio.rxInfo.mpduLength >= FRAME_HEADER_LENGTH) && (FRAME_MAGIC == radio.rxFrame[0]) &&
+           (type == radio.rxFrame[1]) && (seq == get16(&radio.rxFrame[2]));
+}
+
+static void listen(void) {
+    radio.op = RADIO_OP_RX;
+    (void)EMBENET_RADIO_RxEnable(radio.channel);
+    (void)EMBENET_RADIO_RxNow();
+}
+
+static void transmit(void) {
+    radio.op = RADIO_OP_TX;
+    (void)EMBENET_RADIO_TxEnable(radio.channel, radio.power, radio.txFrame, sizeof(radio.txFrame));
+    (void)EMBENET_RADIO_TxNow();
+}
+
+/// Moves the radio to the given measurement point, or to the control channel
+static void radioTune(EMBENET_RADIO_PhyProfile profile, EMBENET_RADIO_Channel channel, EMBENET_RADIO_Power power) {
+    radio.op = RADIO_OP_NONE;
+    (void)EMBENET_RADIO_Idle();
+    (void)EMBENET_RADIO_SetPhyProfile(profile);
+    radio.channel = channel;
+    radio.power   = power;
+}
+
+static void radioTuneControl(void) {
+    radioTune(radio.defaultProfile, RADIO_BENCH_CONTROL_CHANNEL, RADIO_BENCH_CONTROL_POWER);
+}
+
+// ###################################################################################################
+//  Responder
+// ###################################################################################################
+
+/**
+ * @brief Answers the frame just received, called from the radio interrupt.
+ */
+static void responderOnFrame(void) {
+    bool isBench = (radio.rxInfo.mpduLength >= FRAME_HEADER_LENGTH) && (FRAME_MAGIC == radio.rxFrame[0]);
+    if (!radio.rxInfo.crcValid || !isBench) {
+        if (responder.testActive && !radio.rxInfo.crcValid) {
+            responder.crcErrors++;
+        }
+        listen();
+        return;
+    }
+    uint16_t seq = get16(&radio.rxFrame[2]);
+    switch (radio.rxFrame[1]) {
+        case FRAME_PING:
+            if (responder.testActive) {
+                responder.rxOk++;
+                responder.rssiSum += radio.rxInfo.rssi;
+                responder.lastActivity = radio.rxEndTs;
+                frameBuild(FRAME_PONG, seq)[0] = (uint8_t)radio.rxInfo.rssi;
+                responder.pongSent = true;
+                transmit();
+                return;
+            }
+            break;
+        case FRAME_SETUP:
+            if (!responder.testActive) {
+                responder.profile       = (EMBENET_RADIO_PhyProfile)radio.rxFrame[4];
+                responder.channel       = radio.rxFrame[5];
+                responder.power         = (EMBENET_RADIO_Power)radio.rxFrame[6];
+                responder.switchAfterTx = true;
+                frameBuild(FRAME_PONG, seq)[0] = (uint8_t)radio.rxInfo.rssi;
+                transmit();
+                return;
+            }
+            break;
+        case FRAME_REPORT_REQUEST:
+            if (!responder.testActive) {
+                uint8_t* payload = frameBuild(FRAME_REPORT, seq);
+                put16(&payload[0], responder.rxOk);
+                put16(&payload[2], responder.crcErrors);
+                payload[4] = (uint8_t)(int8_t)((0 != responder.rxOk) ? (responder.rssiSum / responder.rxOk) : 0);
+                put16(&payload[5], (uint16_t)statMin(&responder.turnaround));
+                put16(&payload[7], (uint16_t)statAvg(&responder.turnaround));
+                put16(&payload[9], (uint16_t)responder.turnaround.max);
+                transmit();
+                return;
+            }
+            break;
+        default: break;
+    }
+    listen();
+}
+
+/**
+ * @brief Goes on listening after a frame is sent, called from the radio interrupt.
+ */
+static void responderOnSent(void) {
+    responder.pongSent = false;
+    if (responder.switchAfterTx) {
+        responder.switchAfterTx = false;
+        radioTune(responder.profile, responder.channel, responder.power);
+        responder.rxOk      = 0;
+        responder.crcErrors = 0;
+        responder.rssiSum   = 0;
+        statReset(&responder.turnaround);
+        responder.lastActivity = EMBENET_TIMER_ReadCounter();
+        responder.testActive   = true;
+    }
+    listen();
+}
+
+static void responderRun(void) {
+    printf("RADIO_BENCH: responder, waiting on channel %u\n", RADIO_BENCH_CONTROL_CHANNEL);
+    statReset(&responder.turnaround);
+    EMBENET_CRITICAL_SECTION_Enter();
+    radioTuneControl();
+    listen();
+    EMBENET_CRITICAL_SECTION_Exit();
+    while (1) {
+        if (responder.testActive && ((EMBENET_TimeUs)(EMBENET_TIMER_ReadCounter() - responder.lastActivity) > RADIO_BENCH_IDLE_TIMEOUT_US)) {
+            // the pings are over, back to the control channel for the report request
+            EMBENET_CRITICAL_SECTION_Enter();
+            responder.testActive = false;
+            radioTuneControl();
+            listen();
+            EMBENET_CRITICAL_SECTION_Exit();
+            printf("RADIO_BENCH: %s ch %2u %+3d dBm: received %u, CRC errors %u, turnaround %" PRIu32 "/%" PRIu32 "/%" PRIu32 "us\n",
+                   profileName(responder.profile), responder.channel, responder.power, responder.rxOk, responder.crcErrors,
+                   statMin(&responder.turnaround), statAvg(&responder.turnaround), responder.turnaround.max);
+        }
+        __WFE();
+    }
+}
+
+// ###################################################################################################
+//  Initiator
+// ###################################################################################################
+
+/// Results of a measurement point, as seen by the initiator
+typedef struct {
+    uint16_t pongs;
+    int32_t  rssiSum;       ///< RSSI of the pongs
+    int32_t  remoteRssiSum; ///< RSSI of the pings, reported in the pongs
+    Stat     gap;           ///< end of a ping to the start of its pong
+    Stat     txStart;       ///< EMBENET_RADIO_TxNow to the first bit of the ping
+    uint32_t elapsedUs;     ///< duration of all the exchanges
+} InitiatorResult;
+
+/**
+ * @brief Sends the frame built in radio.txFrame and waits for the reply.
+ * @return true if the expected reply is received
+ */
+static bool exchange(uint8_t replyType, uint16_t seq, EMBENET_TimeUs* txNowTime) {
+    radio.rxDone = false;
+    EMBENET_CRITICAL_SECTION_Enter();
+    EMBENET_TimeUs start = EMBENET_TIMER_ReadCounter();
+    transmit();
+    EMBENET_CRITICAL_SECTION_Exit();
+    if (NULL != txNowTime) {
+        *txNowTime = start;
+    }
+    while (!radio.rxDone) {
+        if ((EMBENET_TimeUs)(EMBENET_TIMER_ReadCounter() - start) > RADIO_BENCH_REPLY_TIMEOUT_US) {
+            EMBENET_CRITICAL_SECTION_Enter();
+            radio.op = RADIO_OP_NONE;
+            (void)EMBENET_RADIO_Idle();
+            EMBENET_CRITICAL_SECTION_Exit();
+            return false;
+        }
+    }
+    return frameIsValid(replyType, seq);
+}
+
+static void waitUs(EMBENET_TimeUs duration) {
+    EMBENET_TimeUs start = EMBENET_TIMER_ReadCounter();
+    while ((EMBENET_TimeUs)(EMBENET_TIMER_ReadCounter() - start) < duration) {
+        ;
+    }
+}
+
+static uint32_t perPermille(uint32_t received, uint32_t sent) {
+    return (received < sent) ? ((sent - received) * 1000U / sent) : 0;
+}
+
+static void initiatorRunPoint(EMBENET_RADIO_PhyProfile profile, EMBENET_RADIO_Channel channel, EMBENET_RADIO_Power power, uint16_t* seq) {
+    // announce the measurement point
+    radioTuneControl();
+    bool acknowledged = false;
+    for (unsigned attempt = 0; (attempt < RADIO_BENCH_SETUP_RETRIES) && !acknowledged; ++attempt) {
+        uint8_t* payload = frameBuild(FRAME_SETUP, ++(*seq));
+        payload[0]       = (uint8_t)profile;
+        payload[1]       = channel;
+        payload[2]       = (uint8_t)power;
+        acknowledged     = exchange(FRAME_PONG, *seq, NULL);
+    }
+    if (!acknowledged) {
+        printf("RADIO_BENCH: %s ch %2u %+3d dBm: no responder on channel %u\n", profileName(profile), channel, power, RADIO_BENCH_CONTROL_CHANNEL);
+        return;
+    }
+
+    InitiatorResult result = {0};
+    statReset(&result.gap);
+    statReset(&result.txStart);
+    radioTune(profile, channel, power);
+    EMBENET_TimeUs start = EMBENET_TIMER_ReadCounter();
+    for (unsigned i = 0; i < RADIO_BENCH_PINGS; ++i) {
+        EMBENET_TimeUs txNowTime;
+        frameBuild(FRAME_PING, ++(*seq));
+        bool answered = exchange(FRAME_PONG, *seq, &txNowTime);
+        statAdd(&result.txStart, (uint32_t)(radio.txStartTs - txNowTime));
+        if (answered) {
+            result.pongs++;
+            result.rssiSum += radio.rxInfo.rssi;
+            result.remoteRssiSum += (int8_t)radio.rxFrame[FRAME_HEADER_LENGTH];
+            statAdd(&result.gap, (uint32_t)(radio.rxStartTs - radio.txEndTs));
+        }
+    }
+    result.elapsedUs = (uint32_t)(EMBENET_TIMER_ReadCounter() - start);
+
+    // the responder is back on the control channel once the pings stop
+    radioTuneControl();
+    waitUs(RADIO_BENCH_IDLE_TIMEOUT_US + RADIO_BENCH_IDLE_TIMEOUT_US / 2);
+    bool reported = false;
+    for (unsigned attempt = 0; (attempt < RADIO_BENCH_SETUP_RETRIES) && !reported; ++attempt) {
+        frameBuild(FRAME_REPORT_REQUEST, ++(*seq));
+        reported = exchange(FRAME_REPORT, *seq, NULL);
+    }
+
+    uint8_t const* report     = &radio.rxFrame[FRAME_HEADER_LENGTH];
+    uint32_t       remoteRx   = reported ? get16(&report[0]) : 0;
+    uint32_t       forwardPer = perPermille(remoteRx, RADIO_BENCH_PINGS);
+    uint32_t       roundPer   = perPermille(result.pongs, RADIO_BENCH_PINGS);
+    uint32_t       fps        = (0 != result.elapsedUs) ? (uint32_t)((2ULL * result.pongs * 1000000U) / result.elapsedUs) : 0;
+    printf("RADIO_BENCH: %s ch %2u %+3d dBm: PER fwd %" PRIu32 ".%" PRIu32 "%% round trip %" PRIu32 ".%" PRIu32 "%%, RSSI %d/%d dBm, %" PRIu32
+           " frames/s\n",
+           profileName(profile), channel, power, forwardPer / 10, forwardPer % 10, roundPer / 10, roundPer % 10,
+           (0 != result.pongs) ? (int)(result.rssiSum / result.pongs) : 0, (0 != result.pongs) ? (int)(result.remoteRssiSum / result.pongs) : 0, fps);
+    if (reported) {
+        printf("RADIO_BENCH:     turnaround %u/%u/%uus, frame gap %" PRIu32 "/%" PRIu32 "/%" PRIu32 "us, TX start %" PRIu32 "/%" PRIu32 "/%" PRIu32
+               "us, CRC errors %u\n",
+               get16(&report[5]), get16(&report[7]), get16(&report[9]), statMin(&result.gap), statAvg(&result.gap), result.gap.max,
+               statMin(&result.txStart), statAvg(&result.txStart), result.txStart.max, get16(&report[2]));
+    } else {
+        printf("RADIO_BENCH:     no report from the responder\n");
+    }
+}
+
+static void initiatorRun(void) {
+    printf("RADIO_BENCH: initiator, %u pings of %uB per point, min/avg/max times below\n", RADIO_BENCH_PINGS, RADIO_BENCH_PSDU_LENGTH);
+    uint16_t seq = 0;
+    while (1) {
+        for (size_t p = 0; p < sizeof(profiles) / sizeof(profiles[0]); ++p) {
+            if (EMBENET_RADIO_STATUS_SUCCESS != EMBENET_RADIO_SetPhyProfile(profiles[p])) {
+                printf("RADIO_BENCH: %s profile does not fit in the slot duration, skipped\n", profileName(profiles[p]));
+                continue;
+            }
+            EMBENET_RADIO_Capabilities const* capabilities = EMBENET_RADIO_GetCapabilities();
+            printf("RADIO_BENCH: %s reported ActiveToTxReady %" PRIu32 "us, TxDelay %" PRIu32 "us, RX start delay %" PRIu32 "us\n", profileName(profiles[p]),
+                   capabilities->activeToTxReady, capabilities->txDelay, capabilities->txRxStartDelay);
+            for (unsigned channel = EMBENET_RADIO_MIN_CHANNEL; channel <= EMBENET_RADIO_MAX_CHANNEL; channel += RADIO_BENCH_CHANNEL_STEP) {
+                for (size_t w = 0; w < sizeof(powers) / sizeof(powers[0]); ++w) {
+                    initiatorRunPoint(profiles[p], (EMBENET_RADIO_Channel)channel, powers[w], &seq);
+                }
+            }
+        }
+        printf("RADIO_BENCH: sweep done, starting over\n");
+    }
+}
+
+// ###################################################################################################
+//  Radio events
+// ###################################################################################################
+
+static void onStartOfFrame(void* context, EMBENET_TimeUs timestamp) {
+    (void)context;
+    if (RADIO_OP_TX == radio.op) {
+        radio.txStartTs = timestamp;
+        if (responder.pongSent) {
+            statAdd(&responder.turnaround, (uint32_t)(timestamp - radio.rxEndTs));
+        }
+    } else if (RADIO_OP_RX == radio.op) {
+        radio.rxStartTs = timestamp;
+    }
+}
+
+static void onEndOfFrame(void* context, EMBENET_TimeUs timestamp) {
+    bool isResponder = (bool)(uintptr_t)context;
+    if (RADIO_OP_TX == radio.op) {
+        radio.txEndTs = timestamp;
+        if (isResponder) {
+            responderOnSent();
+        } else {
+            // ready for the reply right away, as the MAC is for an ACK
+            listen();
+        }
+    } else if (RADIO_OP_RX == radio.op) {
+        radio.rxEndTs = timestamp;
+        radio.op      = RADIO_OP_NONE;
+        radio.rxInfo  = EMBENET_RADIO_GetReceivedFrame(radio.rxFrame, sizeof(radio.rxFrame));
+        if (isResponder) {
+            responderOnFrame();
+        } else {
+            radio.rxDone = true;
+        }
+    }
+}
+
+static void onTimerCompare(void* context) {
+    (void)context;
+}
+
+static void init(void) {
+    // preemption priority grouping
+    NVIC_SetPriorityGrouping(3); // 16 preemption, 16 subpriorities
+
+    // configure system clock
+    nrf_clock_event_clear(NRF_CLOCK_EVENT_LFCLKSTARTED);
+    nrf_clock_lf_src_set(NRF_CLOCK_LFCLK_Xtal);
+    nrf_clock_task_trigger(NRF_CLOCK_TASK_LFCLKSTART);
+    // Start HFCLK
+    nrf_clock_event_clear(NRF_CLOCK_EVENT_HFCLKSTARTED);
+    nrf_clock_task_trigger(NRF_CLOCK_TASK_HFCLKSTART);
+    // wait for clocks to be started
+    while (!nrf_clock_event_check(NRF_CLOCK_EVENT_LFCLKSTARTED) || !nrf_clock_event_check(NRF_CLOCK_EVENT_HFCLKSTARTED))
+        ;
+    // initialize RTT
+    SEGGER_RTT_Init();
+
+    nrf_gpio_cfg_input(BUTTON1, NRF_GPIO_PIN_PULLUP);
+    nrf_gpio_cfg_input(BUTTON2, NRF_GPIO_PIN_PULLUP);
+    nrf_gpio_cfg_input(BUTTON3, NRF_GPIO_PIN_PULLUP);
+}
+
+/**
+ * @brief The application entry point.
+ */
+int main(void) {
+    init();
+    printf("+---------------------------------------------+\n"
+           "   embeNET radio benchmark for NRF52 DK board  \n"
+           "+---------------------------------------------+\n");
+
+    // the stack is not used, the port timer and the radio are driven directly
+    EMBENET_TIMER_Init(onTimerCompare, NULL);
+    if (EMBENET_RADIO_STATUS_SUCCESS != EMBENET_RADIO_Init()) {
+        printf("RADIO_BENCH: Unable to initialize the radio\n");
+        while (1) {
+            ;
+        }
+    }
+    radio.defaultProfile = EMBENET_RADIO_GetPhyProfile();
+    // crystal stays on, so that every measurement reflects the radio alone
+    EMBENET_RADIO_LockHfxo();
+
+    // buttons are active low
+    bool isInitiator = (0 == nrf_gpio_pin_read(BUTTON1));
+    if (0 == nrf_gpio_pin_read(BUTTON2)) {
+        printf("RADIO_BENCH: continuous carrier on channel %u at %d dBm\n", RADIO_BENCH_CW_CHANNEL, RADIO_BENCH_CW_POWER);
+        (void)EMBENET_RADIO_StartContinuousTx(EMBENET_RADIO_CONTINUOUS_TX_MODE_CARRIER, RADIO_BENCH_CW_CHANNEL, RADIO_BENCH_CW_POWER);
+    } else if (0 == nrf_gpio_pin_read(BUTTON3)) {
+        printf("RADIO_BENCH: continuous PN9 transmission on channel %u at %d dBm\n", RADIO_BENCH_CW_CHANNEL, RADIO_BENCH_CW_POWER);
+        (void)EMBENET_RADIO_StartContinuousTx(EMBENET_RADIO_CONTINUOUS_TX_MODE_PN9, RADIO_BENCH_CW_CHANNEL, RADIO_BENCH_CW_POWER);
+    } else {
+        EMBENET_RADIO_SetCallbacks(onStartOfFrame, onEndOfFrame, (void*)(uintptr_t)!isInitiator);
+        if (isInitiator) {
+            initiatorRun();
+        } else {
+            responderRun();
+        }
+    }
+    while (1) {
+        __WFE();
+    }
+}
+
+/**
+ * This hander is called by the port when a critical error aborts operation.
+ */
+__attribute__((noreturn)) void EXPECT_OnAbortHandler(char const* why, char const* file, int line) {
+    printf("Program aborted: %s %s:%i\n", why, file, line);
+    while (1) {
+        ;
+    }
+    __builtin_unreachable();
+}
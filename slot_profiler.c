@@ -0,0 +1,177 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Cycle-accurate profiler of the slots and of the MAC and radio routines
+*/
+
+#include "slot_profiler.h"
+#include "app_task.h"
+#include "embenet_critical_section.h"
+#include "embenet_node.h"
+#include "embenet_port_capabilities.h"
+#include "nrf.h"
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/// Profiling state of a section
+typedef struct {
+    uint32_t            enterCycles; ///< cycle counter at the entry
+    uint32_t            depth;       ///< nesting of the entries, only the outermost one is timed
+    slot_profiler_stats stats;
+} Section;
+
+/// ENMS service instance the slot load is reported through
+static EnmsNode* profilerEnmsNode;
+/// Set once the cycle counter runs
+static volatile bool profiling;
+/// Sections
+static Section sections[SLOT_PROFILER_SECTION_COUNT];
+/// Slot duration [CPU cycles]
+static uint32_t slotBudgetCycles;
+/// Longest slot since the last report [CPU cycles]
+static volatile uint32_t periodMaxSlotCycles;
+
+static char const* const sectionNames[SLOT_PROFILER_SECTION_COUNT] = {"slot", "mac", "radio api", "radio isr"};
+
+static unsigned binOf(slot_profiler_section section, uint32_t cycles) {
+    unsigned bin;
+    if (SLOT_PROFILER_SECTION_SLOT == section) {
+        // tenths of the slot duration, the last bin counts the overruns
+        bin = (cycles >= slotBudgetCycles) ? (SLOT_PROFILER_HISTOGRAM_BINS - 1) : (unsigned)(((uint64_t)cycles * 10) / slotBudgetCycles);
+    } else {
+        // powers of two of microseconds
+        uint32_t us = cycles / SLOT_PROFILER_CYCLES_PER_US;
+        bin         = (0 == us) ? 0 : (31U - __CLZ(us));
+    }
+    return (bin < SLOT_PROFILER_HISTOGRAM_BINS) ? bin : (SLOT_PROFILER_HISTOGRAM_BINS - 1);
+}
+
+static void clearStats(slot_profiler_stats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->minCycles = UINT32_MAX;
+}
+
+/**
+ * @brief Task printing the report and updating the ENMS state
+ *
+ * @param[in] taskId id of the task
+ * @param[in] timeSource time source used in scheduling
+ * @param[in] t time at which the task was scheduled
+ * @param[in] context unused
+ */
+static void reportTask(EMBENET_TaskId taskId, EMBENET_NODE_TimeSource timeSource, uint64_t t, void* context) {
+    (void)taskId;
+    (void)timeSource;
+    (void)t;
+    (void)context;
+    slot_profiler_print_stats();
+
+    EMBENET_CRITICAL_SECTION_Enter();
+    uint32_t maxSlotCycles = periodMaxSlotCycles;
+    periodMaxSlotCycles    = 0;
+    EMBENET_CRITICAL_SECTION_Exit();
+
+    uint64_t percent = ((uint64_t)maxSlotCycles * 100) / slotBudgetCycles;
+    (void)ENMS_NODE_SetServiceState(profilerEnmsNode, SLOT_PROFILER_SERVICE_NAME, (uint8_t)((percent > UINT8_MAX) ? UINT8_MAX : percent));
+}
+
+void slot_profiler_init(EnmsNode* enmsNode) {
+    profilerEnmsNode = enmsNode;
+    slotBudgetCycles = embenetMacTimings.TsSlotDurationUs * SLOT_PROFILER_CYCLES_PER_US;
+    slot_profiler_reset();
+    if (0 == (DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+    profiling = true;
+
+    EMBENET_TaskId reportTaskId = app_task_create_periodic("slot_profiler", reportTask, NULL, SLOT_PROFILER_REPORT_PERIOD_MS, 0);
+    if ((EMBENET_TASKID_INVALID == reportTaskId) ||
+        (EMBENET_RESULT_OK != app_task_start(reportTaskId, EMBENET_NODE_TIME_SOURCE_LOCAL, SLOT_PROFILER_REPORT_PERIOD_MS))) {
+        printf("SLOT_PROFILER: Unable to start the report\n");
+    }
+    (void)ENMS_NODE_RegisterService(profilerEnmsNode, SLOT_PROFILER_SERVICE_NAME, 0);
+}
+
+void slot_profiler_mark(slot_profiler_section section, bool enters) {
+    uint32_t now = DWT->CYCCNT;
+    if (!profiling || (section >= SLOT_PROFILER_SECTION_COUNT)) {
+        return;
+    }
+    // the handlers of the stack run at several interrupt priorities, the update must not be interleaved
+    EMBENET_CRITICAL_SECTION_Enter();
+    Section* s = &sections[section];
+    if (enters) {
+        if (0 == s->depth++) {
+            s->enterCycles = now;
+        }
+    } else if ((0 != s->depth) && (0 == --s->depth)) {
+        uint32_t cycles = now - s->enterCycles;
+        s->stats.count++;
+        s->stats.totalCycles += cycles;
+        if (cycles < s->stats.minCycles) {
+            s->stats.minCycles = cycles;
+        }
+        if (cycles > s->stats.maxCycles) {
+            s->stats.maxCycles = cycles;
+        }
+        s->stats.histogram[binOf(section, cycles)]++;
+        if ((SLOT_PROFILER_SECTION_SLOT == section) && (cycles > periodMaxSlotCycles)) {
+            periodMaxSlotCycles = cycles;
+        }
+    }
+    EMBENET_CRITICAL_SECTION_Exit();
+}
+
+void slot_profiler_get_stats(slot_profiler_section section, slot_profiler_stats* stats) {
+    if (section >= SLOT_PROFILER_SECTION_COUNT) {
+        clearStats(stats);
+        return;
+    }
+    EMBENET_CRITICAL_SECTION_Enter();
+    *stats = sections[section].stats;
+    EMBENET_CRITICAL_SECTION_Exit();
+}
+
+uint32_t slot_profiler_get_slot_budget_us(void) {
+    return embenetMacTimings.TsSlotDurationUs;
+}
+
+void slot_profiler_reset(void) {
+    EMBENET_CRITICAL_SECTION_Enter();
+    for (unsigned i = 0; i < SLOT_PROFILER_SECTION_COUNT; ++i) {
+        clearStats(&sections[i].stats);
+    }
+    periodMaxSlotCycles = 0;
+    EMBENET_CRITICAL_SECTION_Exit();
+}
+
+void slot_profiler_print_stats(void) {
+    for (unsigned i = 0; i < SLOT_PROFILER_SECTION_COUNT; ++i) {
+        slot_profiler_stats stats;
+        slot_profiler_get_stats((slot_profiler_section)i, &stats);
+        if (0 == stats.count) {
+            printf("SLOT_PROFILER: %-9s no samples\n", sectionNames[i]);
+            continue;
+        }
+        printf("SLOT_PROFILER: %-9s count %" PRIu32 ", min %" PRIu32 "us, mean %" PRIu32 "us, max %" PRIu32 "us\n", sectionNames[i], stats.count,
+               stats.minCycles / SLOT_PROFILER_CYCLES_PER_US, (uint32_t)(stats.totalCycles / stats.count / SLOT_PROFILER_CYCLES_PER_US),
+               stats.maxCycles / SLOT_PROFILER_CYCLES_PER_US);
+        printf("SLOT_PROFILER: %-9s histogram", sectionNames[i]);
+        for (unsigned bin = 0; bin < SLOT_PROFILER_HISTOGRAM_BINS; ++bin) {
+            printf(" %" PRIu32, stats.histogram[bin]);
+        }
+        printf("\n");
+    }
+    slot_profiler_stats slot;
+    slot_profiler_get_stats(SLOT_PROFILER_SECTION_SLOT, &slot);
+    if (0 != slot.count) {
+        printf("SLOT_PROFILER: longest slot %" PRIu32 "%% of %" PRIu32 "us, %" PRIu32 " slots overran\n",
+               (uint32_t)(((uint64_t)slot.maxCycles * 100) / slotBudgetCycles), slot_profiler_get_slot_budget_us(),
+               slot.histogram[SLOT_PROFILER_HISTOGRAM_BINS - 1]);
+    }
+}
@@ -0,0 +1,87 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Cycle-accurate profiler of the slots and of the MAC and radio routines
+
+The trace handlers bracketing the time-critical sections of the stack (slots, MAC routines, radio API calls and radio ISRs) are timed with
+the DWT cycle counter. For every section the count, the shortest, longest and mean duration and a histogram are kept. Histogram bin i
+counts the sections that took [2^i, 2^(i+1)) us, except for the slots, whose bins are tenths of the slot duration (TsSlotDurationUs) and
+whose last bin counts the slots that overran it.
+
+Every SLOT_PROFILER_REPORT_PERIOD_MS the statistics are printed and the longest slot of the period is reported in ENMS as the state of the
+"slot_prof" service, in percent of the slot duration (0 if no slot was active, saturated at 255).
+*/
+
+#ifndef SLOT_PROFILER_H_
+#define SLOT_PROFILER_H_
+
+#include "enms_node.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SLOT_PROFILER_SERVICE_NAME     "slot_prof" ///< name of the service reported in ENMS
+#define SLOT_PROFILER_REPORT_PERIOD_MS 60000       ///< period of the report [ms]
+#define SLOT_PROFILER_HISTOGRAM_BINS   11          ///< number of histogram bins
+#define SLOT_PROFILER_CYCLES_PER_US    64          ///< CPU clock [MHz]
+
+/// Profiled sections
+typedef enum {
+    SLOT_PROFILER_SECTION_SLOT,      ///< active slot, from onSlotStartEnd
+    SLOT_PROFILER_SECTION_MAC,       ///< MAC routine, from onMacRoutine
+    SLOT_PROFILER_SECTION_RADIO_API, ///< radio API call, from onRadioApiUsed
+    SLOT_PROFILER_SECTION_RADIO_ISR, ///< radio interrupt, from onRadioIsr
+    SLOT_PROFILER_SECTION_COUNT
+} slot_profiler_section;
+
+/// Statistics of a section
+typedef struct {
+    uint32_t count;                                   ///< number of completed sections
+    uint32_t minCycles;                               ///< shortest section [CPU cycles]
+    uint32_t maxCycles;                               ///< longest section [CPU cycles]
+    uint64_t totalCycles;                             ///< sum of the durations [CPU cycles]
+    uint32_t histogram[SLOT_PROFILER_HISTOGRAM_BINS]; ///< number of sections per bin
+} slot_profiler_stats;
+
+/**
+ * @brief Initializes the profiler: starts the cycle counter and the report, registers the service in ENMS.
+ *
+ * @param[in] enmsNode ENMS Node service instance the slot load is reported through
+ */
+void slot_profiler_init(EnmsNode* enmsNode);
+
+/**
+ * @brief Marks the entry to or the exit from a section, called from the trace handlers.
+ *
+ * @param[in] section profiled section
+ * @param[in] enters true on entry, false on exit
+ */
+void slot_profiler_mark(slot_profiler_section section, bool enters);
+
+/**
+ * @brief Gets the statistics of a section since the startup or the last reset.
+ *
+ * @param[in] section profiled section
+ * @param[out] stats statistics
+ */
+void slot_profiler_get_stats(slot_profiler_section section, slot_profiler_stats* stats);
+
+/**
+ * @brief Gets the slot duration the slots are compared with.
+ *
+ * @return TsSlotDurationUs of the port [us]
+ */
+uint32_t slot_profiler_get_slot_budget_us(void);
+
+/**
+ * @brief Clears the statistics of all the sections.
+ */
+void slot_profiler_reset(void);
+
+/**
+ * @brief Prints the statistics of all the sections.
+ */
+void slot_profiler_print_stats(void);
+
+#endif // SLOT_PROFILER_H_
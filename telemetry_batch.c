@@ -0,0 +1,143 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Batched sending of fixed-size binary telemetry samples
+*/
+
+#include "telemetry_batch.h"
+#include "app_task.h"
+#include "embenet_node.h"
+#include <stdio.h>
+#include <string.h>
+
+/// Batching state
+static struct {
+    EMBENET_UDP_SocketDescriptor const* socket;
+    uint16_t                            destinationPort;
+    size_t                              sampleSize;
+    uint32_t                            maxLatencyMs;
+    bool                                withHeader;
+    size_t                              capacity;        ///< samples per datagram
+    EMBENET_TaskId                      flushTaskId;
+    uint16_t                            sequence;
+    size_t                              count;           ///< samples in the buffer
+    uint64_t                            firstSampleTime; ///< local time of the first sample in the buffer [ms]
+    uint8_t                             buffer[TELEMETRY_BATCH_MAX_DATAGRAM_SIZE];
+} batch = {.flushTaskId = EMBENET_TASKID_INVALID};
+
+/// Statistics
+static telemetry_batch_stats stats;
+
+static size_t headerSize(void) {
+    return batch.withHeader ? TELEMETRY_BATCH_HEADER_SIZE : 0;
+}
+
+/// Sends the buffer, keeping it for a retry if it cannot be sent
+static bool send(void) {
+    if (0 == batch.count) {
+        return true;
+    }
+    if (batch.withHeader) {
+        batch.buffer[0] = (uint8_t)batch.sampleSize;
+        batch.buffer[1] = (uint8_t)batch.count;
+        batch.buffer[2] = (uint8_t)batch.sequence;
+        batch.buffer[3] = (uint8_t)(batch.sequence >> 8);
+        for (unsigned i = 0; i < 4; ++i) {
+            batch.buffer[4 + i] = (uint8_t)(batch.firstSampleTime >> (8 * i));
+        }
+    }
+    EMBENET_IPV6 borderRouterAddress;
+    EMBENET_NODE_GetBorderRouterAddress(&borderRouterAddress);
+    if (EMBENET_RESULT_OK != EMBENET_UDP_Send(batch.socket, &borderRouterAddress, batch.destinationPort, batch.buffer, headerSize() + (batch.count * batch.sampleSize))) {
+        stats.failedSends++;
+        EMBENET_NODE_TaskSchedule(batch.flushTaskId, EMBENET_NODE_TIME_SOURCE_LOCAL, EMBENET_NODE_GetLocalTime() + TELEMETRY_BATCH_RETRY_MS);
+        return false;
+    }
+    stats.datagrams++;
+    batch.sequence++;
+    batch.count = 0;
+    EMBENET_NODE_TaskCancel(batch.flushTaskId);
+    return true;
+}
+
+/**
+ * @brief Task sending the batch when its oldest sample has waited long enough, or retrying a failed send
+ *
+ * @param[in] taskId id of the task
+ * @param[in] timeSource time source used in scheduling
+ * @param[in] t time at which the task was scheduled
+ * @param[in] context unused
+ */
+static void flushTask(EMBENET_TaskId taskId, EMBENET_NODE_TimeSource timeSource, uint64_t t, void* context) {
+    (void)taskId;
+    (void)timeSource;
+    (void)t;
+    (void)context;
+    (void)send();
+}
+
+bool telemetry_batch_init(EMBENET_UDP_SocketDescriptor const* socket, uint16_t destinationPort, size_t sampleSize, uint32_t maxLatencyMs,
+                          bool withHeader) {
+    batch.socket          = socket;
+    batch.destinationPort = destinationPort;
+    batch.sampleSize      = sampleSize;
+    batch.maxLatencyMs    = maxLatencyMs;
+    batch.withHeader      = withHeader;
+    batch.count           = 0;
+
+    size_t space = EMBENET_UDP_GetMaxDataSize(socket);
+    if (space > sizeof(batch.buffer)) {
+        space = sizeof(batch.buffer);
+    }
+    batch.capacity = ((0 == sampleSize) || (space <= headerSize())) ? 0 : ((space - headerSize()) / sampleSize);
+    if (batch.capacity > UINT8_MAX) {
+        batch.capacity = UINT8_MAX;
+    }
+    if (0 == batch.capacity) {
+        printf("TELEMETRY_BATCH: Samples of %u bytes do not fit in a datagram\n", (unsigned)sampleSize);
+        return false;
+    }
+    batch.flushTaskId = app_task_create("telemetry_batch", flushTask, NULL);
+    if (EMBENET_TASKID_INVALID == batch.flushTaskId) {
+        printf("TELEMETRY_BATCH: Unable to create task\n");
+        return false;
+    }
+    printf("TELEMETRY_BATCH: %u samples per datagram\n", (unsigned)batch.capacity);
+    return true;
+}
+
+void telemetry_batch_add(void const* sample) {
+    if (0 == batch.capacity) {
+        return;
+    }
+    if ((batch.count == batch.capacity) && !send()) {
+        // the full batch is still pending, the new sample takes its place
+        stats.droppedSamples += (uint32_t)batch.count;
+        batch.count = 0;
+    }
+    if (0 == batch.count) {
+        batch.firstSampleTime = EMBENET_NODE_GetLocalTime();
+        EMBENET_NODE_TaskSchedule(batch.flushTaskId, EMBENET_NODE_TIME_SOURCE_LOCAL, batch.firstSampleTime + batch.maxLatencyMs);
+    }
+    memcpy(&batch.buffer[headerSize() + (batch.count * batch.sampleSize)], sample, batch.sampleSize);
+    batch.count++;
+    stats.samples++;
+    if (batch.count == batch.capacity) {
+        (void)send();
+    }
+}
+
+void telemetry_batch_flush(void) {
+    (void)send();
+}
+
+void telemetry_batch_discard(void) {
+    batch.count = 0;
+    EMBENET_NODE_TaskCancel(batch.flushTaskId);
+}
+
+void telemetry_batch_get_stats(telemetry_batch_stats* statsOut) {
+    *statsOut = stats;
+}
@@ -0,0 +1,78 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Batched sending of fixed-size binary telemetry samples
+
+Samples are appended to a buffer holding as many of them as fit in one datagram (EMBENET_UDP_GetMaxDataSize, at most
+TELEMETRY_BATCH_MAX_DATAGRAM_SIZE) and the buffer is sent to the border router when it is full, or when the oldest sample in it has waited
+for the maximum latency. One datagram carries several samples, so the IPv6, UDP and MAC overhead is paid once per batch instead of once
+per sample. If a batch cannot be sent it is kept and retried after TELEMETRY_BATCH_RETRY_MS; should it still be pending when the buffer
+overflows, it is dropped and counted.
+
+With the header enabled, every datagram starts with:
+ offset | size | field
+ -------|------|-----------------------------------------------------------
+ 0      | 1    | sample size [bytes]
+ 1      | 1    | number of samples
+ 2      | 2    | sequence number of the batch, little endian
+ 4      | 4    | local time of the first sample [ms], little endian
+followed by the samples in the order they were added.
+*/
+
+#ifndef TELEMETRY_BATCH_H_
+#define TELEMETRY_BATCH_H_
+
+#include "embenet_udp.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TELEMETRY_BATCH_MAX_DATAGRAM_SIZE 256  ///< size of the batch buffer [bytes]
+#define TELEMETRY_BATCH_HEADER_SIZE       8    ///< size of the optional header [bytes]
+#define TELEMETRY_BATCH_RETRY_MS          1000 ///< delay before a batch that could not be sent is retried [ms]
+
+/// Batching statistics
+typedef struct {
+    uint32_t samples;        ///< samples added
+    uint32_t datagrams;      ///< datagrams sent
+    uint32_t failedSends;    ///< attempts to send that failed
+    uint32_t droppedSamples; ///< samples dropped because the buffer overflowed
+} telemetry_batch_stats;
+
+/**
+ * @brief Initializes the batching and creates its task.
+ * @param[in] socket registered socket the batches are sent from, must stay valid
+ * @param[in] destinationPort UDP port of the border router the batches are sent to
+ * @param[in] sampleSize size of a sample [bytes]
+ * @param[in] maxLatencyMs longest time a sample waits before its batch is sent [ms]
+ * @param[in] withHeader true to start every datagram with the header
+ * @return false if the sample does not fit in a datagram or the task could not be created
+ */
+bool telemetry_batch_init(EMBENET_UDP_SocketDescriptor const* socket, uint16_t destinationPort, size_t sampleSize, uint32_t maxLatencyMs,
+                          bool withHeader);
+
+/**
+ * @brief Appends a sample, sending the batch if it gets full. To be called from an embeNET Node task.
+ * @param[in] sample sampleSize bytes
+ */
+void telemetry_batch_add(void const* sample);
+
+/**
+ * @brief Sends the samples collected so far.
+ */
+void telemetry_batch_flush(void);
+
+/**
+ * @brief Discards the samples collected so far, e.g. when the node leaves the network.
+ */
+void telemetry_batch_discard(void);
+
+/**
+ * @brief Gets the batching statistics.
+ * @param[out] stats statistics since the startup
+ */
+void telemetry_batch_get_stats(telemetry_batch_stats* stats);
+
+#endif // TELEMETRY_BATCH_H_
@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+"""Decoder of the binary log written by app_log.h.
+
+The format strings are read from the .app_log section of the ELF file, the records from a capture of the RTT up-buffer 1, e.g.:
+
+    JLinkRTTLogger -Device NRF52832_XXAA -If SWD -Speed 4000 -RTTChannel 1 app_log.bin
+    python3 tools/app_log_decode.py _build/nrf52832_xxaa.out app_log.bin
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+LEVELS = {0: "EMERG", 1: "ALERT", 2: "CRIT", 3: "ERROR", 4: "WARN", 5: "NOTICE", 6: "INFO", 7: "VERBOSE", 8: "DEBUG", 9: "TRACE"}
+CONVERSION = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(?:hh|h|ll|l|z|t|j)?([diouxXc%])")
+
+
+def read_formats(elf_path):
+    """Returns the content of the .app_log section of a 32-bit little endian ELF file."""
+    with open(elf_path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF" or elf[4] != 1 or elf[5] != 1:
+        sys.exit("%s: not a 32-bit little endian ELF file" % elf_path)
+    shoff, = struct.unpack_from("<I", elf, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", elf, 0x2E)
+
+    def section(index):
+        return struct.unpack_from("<IIIIIIIIII", elf, shoff + index * shentsize)
+
+    names_offset = section(shstrndx)[4]
+    for index in range(shnum):
+        name, _, _, _, offset, size = section(index)[:6]
+        end = elf.index(b"\0", names_offset + name)
+        if elf[names_offset + name:end] == b".app_log":
+            return elf[offset:offset + size]
+    sys.exit("%s: no .app_log section" % elf_path)
+
+
+def format_message(fmt, args):
+    """Applies the printf-like format to the raw 32-bit arguments."""
+    values = iter(args)
+
+    def convert(match):
+        flags, conversion = match.groups()
+        if conversion == "%":
+            return "%"
+        value = next(values, 0)
+        if conversion in "di" and value >= 0x80000000:
+            value -= 0x100000000
+        if conversion == "u":
+            conversion = "d"
+        return ("%" + flags + conversion) % value
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def decode(formats, data, out):
+    position = 0
+    while position + 8 <= len(data):
+        header, timestamp = struct.unpack_from("<II", data, position)
+        offset, level, count = header & 0xFFFFFF, (header >> 24) & 0xF, header >> 28
+        length = 8 + 4 * count
+        if position + length > len(data):
+            break
+        args = struct.unpack_from("<%dI" % count, data, position + 8)
+        position += length
+        if offset >= len(formats):
+            out.write("%10u.%06u ?       <unknown message 0x%06x>\n" % (timestamp // 1000000, timestamp % 1000000, offset))
+            continue
+        fmt = formats[offset:formats.index(b"\0", offset)].decode("utf-8", "replace")
+        message = format_message(fmt, args)
+        out.write("%10u.%06u %-7s %s\n" % (timestamp // 1000000, timestamp % 1000000, LEVELS.get(level, str(level)), message))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("elf", help="firmware ELF file")
+    parser.add_argument("capture", nargs="?", help="capture of the RTT up-buffer 1, standard input if omitted")
+    arguments = parser.parse_args()
+    formats = read_formats(arguments.elf)
+    if arguments.capture:
+        with open(arguments.capture, "rb") as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+    decode(formats, data, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""Decoder of the performance reports sent by perf_report.h.
+
+Each report is a UDP payload sent to port 0xf0b2 of the border router. The decoder keeps the state of every node, applies the
+differences of the delta reports to it and prints the values as JSON lines. Reports of a node are ignored until its first key frame.
+
+Library use:
+    decoder = PerfReportDecoder()
+    state = decoder.decode(source, payload)   # None until synchronized
+
+From the command line, reads hex-encoded payloads, one per line, optionally preceded by the source address:
+    fd00::1234 010100001900...
+"""
+
+import json
+import sys
+
+VERSION = 1
+VALUES = [
+    "uptime_s", "dag_rank", "parent_rssi", "parent_pdr", "up_packet_rate", "down_packet_rate", "ready_duty_cycle", "tx_duty_cycle",
+    "rx_duty_cycle", "queue_alerts", "queue_overflows", "tx_time_ms", "rx_time_ms", "slot_max_us", "slot_mean_us", "slot_overruns",
+    "mac_max_us", "radio_isr_max_us", "critical_max_us", "trace_dropped", "brt_frames_in", "brt_frames_out", "brt_frame_errors",
+    "brt_rx_overruns", "brt_tx_stalls", "charge_uah", "average_current_ua", "lifetime_h",
+    "pool_high_watermark", "pool_alloc_failures",
+]
+SIGNED = {"parent_rssi"}
+
+
+def varint(data, position):
+    value, shift = 0, 0
+    while True:
+        byte = data[position]
+        position += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return (value >> 1) ^ -(value & 1), position
+
+
+class PerfReportDecoder:
+    def __init__(self):
+        self.nodes = {}
+
+    def decode(self, source, data):
+        if len(data) < 5 or data[0] != VERSION:
+            return None
+        keyframe, sequence, count = data[1] & 1, data[2] | (data[3] << 8), data[4]
+        node = self.nodes.get(source)
+        if keyframe:
+            node = self.nodes[source] = {"values": [0] * count, "neighbors": {}, "sequence": None}
+        elif node is None or (sequence - node["sequence"]) & 0xFFFF != 1:
+            # a report was missed, wait for the next key frame
+            self.nodes.pop(source, None)
+            return None
+        node["sequence"] = sequence
+        values = node["values"]
+        values.extend([0] * (count - len(values)))
+        position = 5
+        for i in range(count):
+            difference, position = varint(data, position)
+            values[i] = (values[i] + difference) & 0xFFFFFFFF
+        neighbors = node["neighbors"]
+        entries = data[position] if position < len(data) else 0
+        position += 1
+        for _ in range(entries):
+            header = data[position]
+            position += 1
+            index = header & 0x0F
+            if header & 0x20:
+                neighbors.pop(index, None)
+                continue
+            if header & 0x10:
+                eui = int.from_bytes(data[position:position + 8], "little")
+                position += 8
+                neighbors[index] = {"eui": eui, "rssi": 0, "pdr": 0}
+            rssi, position = varint(data, position)
+            pdr, position = varint(data, position)
+            neighbor = neighbors.setdefault(index, {"eui": 0, "rssi": 0, "pdr": 0})
+            neighbor["rssi"] += rssi
+            neighbor["pdr"] = (neighbor["pdr"] + pdr) & 0xFFFFFFFF
+        return self.state(source)
+
+    def state(self, source):
+        node = self.nodes[source]
+        result = {"source": source, "sequence": node["sequence"]}
+        for i, value in enumerate(node["values"]):
+            name = VALUES[i] if i < len(VALUES) else "value%d" % i
+            result[name] = value - (1 << 32) if name in SIGNED and value >= 0x80000000 else value
+        result["neighbors"] = [{"eui": "%016x" % n["eui"], "rssi": n["rssi"], "pdr": None if n["pdr"] == 0xFFFF else n["pdr"]}
+                               for _, n in sorted(node["neighbors"].items())]
+        return result
+
+
+def main():
+    decoder = PerfReportDecoder()
+    for line in sys.stdin:
+        fields = line.split()
+        if not fields:
+            continue
+        source, payload = (fields[0], fields[1]) if len(fields) > 1 else ("node", fields[0])
+        state = decoder.decode(source, bytes.fromhex(payload))
+        if state is not None:
+            print(json.dumps(state))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,154 @@
+#!/usr/bin/env python3
+"""Decoder of the stack trace records written by trace_recorder.h.
+
+The records are read from a capture of the RTT up-buffer 2, e.g.:
+
+    JLinkRTTLogger -Device NRF52832_XXAA -If SWD -Speed 4000 -RTTChannel 2 trace.bin
+    python3 tools/trace_decode.py trace.bin                          # text
+    python3 tools/trace_decode.py --csv trace.csv trace.bin          # one row per event
+    python3 tools/trace_decode.py --timeline trace.json trace.bin    # chrome://tracing or ui.perfetto.dev
+"""
+
+import argparse
+import csv
+import json
+import struct
+import sys
+
+CELL_EVENTS = ["TX", "RX"]
+CELL_ROLES = ["ADV", "AUTO_UP", "AUTO_DOWN", "AUTO_UPDOWN", "AUTO_MANAGED"]
+FRAME_TYPES = ["BEACON", "DATA", "ACK"]
+
+
+def eui(data, offset):
+    return "%016x" % struct.unpack_from("<Q", data, offset)[0]
+
+
+def asn(data, offset):
+    return int.from_bytes(data[offset:offset + 5], "little")
+
+
+def name(names, value):
+    return names[value] if value < len(names) else str(value)
+
+
+def link_layer(p):
+    return {
+        "cellEvent": name(CELL_EVENTS, p[0]),
+        "cellRole": name(CELL_ROLES, p[1]),
+        "frameType": name(FRAME_TYPES, p[2]),
+        "channelOffset": p[3],
+        "slotOffset": struct.unpack_from("<H", p, 4)[0],
+        "rssiOrTxPower": struct.unpack_from("<b", p, 6)[0],
+        "length": struct.unpack_from("<H", p, 7)[0],
+        "asn": asn(p, 9),
+        "src": eui(p, 14),
+        "dst": eui(p, 22),
+        "node": eui(p, 30),
+    }
+
+
+# event: (name, payload decoder, timeline track of the enter/leave events)
+EVENTS = {
+    1: ("Started", lambda p: {"eui": eui(p, 0)}, None),
+    2: ("Synchronized", lambda p: {"panid": "0x%04x" % struct.unpack_from("<H", p)[0]}, None),
+    3: ("Desynchronized", lambda p: {}, None),
+    4: ("PacketNoAck", lambda p: {"linkLocalDestinationEui": eui(p, 0), "destinationEui": eui(p, 8), "attempt": p[16]}, None),
+    5: ("ManagedPacketNoAck", lambda p: {"linkLocalDestinationEui": eui(p, 0)}, None),
+    6: ("PacketNotDelivered", lambda p: {"linkLocalDestinationEui": eui(p, 0), "destinationEui": eui(p, 8)}, None),
+    7: ("Joined", lambda p: {"parentEui": eui(p, 0)}, None),
+    8: ("SyncCorrection", lambda p: {"us": struct.unpack_from("<i", p)[0]}, None),
+    9: ("ParentSelected", lambda p: {"parentEui": eui(p, 0)}, None),
+    10: ("ParentLost", lambda p: {"parentEui": eui(p, 0)}, None),
+    11: ("NeighborAdded", lambda p: {"neighborEui": eui(p, 0), "rssi": struct.unpack_from("<b", p, 8)[0]}, None),
+    12: ("NeighborRemoved", lambda p: {"neighborEui": eui(p, 0)}, None),
+    13: ("RankUpdate", lambda p: {"rank": struct.unpack_from("<H", p)[0]}, None),
+    14: ("QueueLength", lambda p: {"length": struct.unpack_from("<H", p)[0]}, None),
+    15: ("EnmsStatusSent", lambda p: {}, None),
+    16: ("LinkLayerEvent", link_layer, None),
+    17: ("FreeSlots", lambda p: {"asn": asn(p, 0), "startNwkTime": struct.unpack_from("<Q", p, 5)[0],
+                                 "durationUs": struct.unpack_from("<I", p, 13)[0]}, None),
+    18: ("Slot", lambda p: {"enters": bool(p[0])}, "slot"),
+    19: ("MacRoutine", lambda p: {"enters": bool(p[0])}, "mac"),
+    20: ("RadioApi", lambda p: {"enters": bool(p[0])}, "radio api"),
+    21: ("RadioIsr", lambda p: {"enters": bool(p[0])}, "radio isr"),
+    31: ("Dropped", lambda p: {"records": struct.unpack_from("<I", p)[0]}, None),
+}
+
+
+def decode(data):
+    """Yields (time [us], event name, arguments, track) for every complete record, the 32-bit time is unwrapped."""
+    position = 0
+    previous = None
+    epoch = 0
+    while position + 6 <= len(data):
+        event, length, timestamp = struct.unpack_from("<BBI", data, position)
+        if position + 6 + length > len(data):
+            break
+        payload = data[position + 6:position + 6 + length]
+        position += 6 + length
+        if previous is not None and timestamp < previous and previous - timestamp > 0x80000000:
+            epoch += 1 << 32
+        previous = timestamp
+        name_, decoder, track = EVENTS.get(event, ("Unknown%d" % event, lambda p: {"payload": p.hex()}, None))
+        try:
+            arguments = decoder(payload)
+        except (IndexError, struct.error):
+            arguments = {"payload": payload.hex()}
+        yield epoch + timestamp, name_, arguments, track
+
+
+def write_text(records, out):
+    for time, name_, arguments, _ in records:
+        text = " ".join("%s=%s" % item for item in arguments.items())
+        out.write("%10u.%06u %-18s %s\n" % (time // 1000000, time % 1000000, name_, text))
+
+
+def write_csv(records, path):
+    with open(path, "w", newline="") as f:
+        writer = csv.writer(f)
+        writer.writerow(["time_us", "event", "arguments"])
+        for time, name_, arguments, _ in records:
+            writer.writerow([time, name_, json.dumps(arguments)])
+
+
+def write_timeline(records, path):
+    """Trace Event Format: enter/leave events become durations on their own tracks, the other ones instants, the queue length a counter."""
+    tracks = {}
+    events = []
+    for time, name_, arguments, track in records:
+        if track is not None:
+            tid = tracks.setdefault(track, len(tracks) + 1)
+            events.append({"name": name_, "ph": "B" if arguments["enters"] else "E", "ts": time, "pid": 1, "tid": tid})
+        elif name_ == "QueueLength":
+            events.append({"name": "queue", "ph": "C", "ts": time, "pid": 1, "args": {"length": arguments["length"]}})
+        else:
+            events.append({"name": name_, "ph": "i", "s": "p", "ts": time, "pid": 1, "tid": 0, "args": arguments})
+    metadata = [{"name": "thread_name", "ph": "M", "pid": 1, "tid": 0, "args": {"name": "events"}}]
+    metadata += [{"name": "thread_name", "ph": "M", "pid": 1, "tid": tid, "args": {"name": track}} for track, tid in tracks.items()]
+    with open(path, "w") as f:
+        json.dump({"traceEvents": metadata + events, "displayTimeUnit": "ms"}, f)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("capture", nargs="?", help="capture of the RTT up-buffer 2, standard input if omitted")
+    parser.add_argument("--csv", metavar="FILE", help="write the events as CSV")
+    parser.add_argument("--timeline", metavar="FILE", help="write a timeline in the Trace Event Format")
+    arguments = parser.parse_args()
+    if arguments.capture:
+        with open(arguments.capture, "rb") as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+    records = list(decode(data))
+    if arguments.csv:
+        write_csv(records, arguments.csv)
+    if arguments.timeline:
+        write_timeline(records, arguments.timeline)
+    if not arguments.csv and not arguments.timeline:
+        write_text(records, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,221 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Binary recorder of the stack trace events
+*/
+
+#include "trace_recorder.h"
+#include "embenet_critical_section.h"
+#include "embenet_timer.h"
+
+#include "SEGGER_RTT.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define HEADER_SIZE      6
+#define MAX_PAYLOAD_SIZE 38 // link layer event
+
+/// Record being built
+typedef struct {
+    uint8_t bytes[HEADER_SIZE + MAX_PAYLOAD_SIZE];
+    size_t  length;
+} Record;
+
+/// RTT up-buffer of the recorder
+static uint8_t rttBuffer[TRACE_RECORDER_BUFFER_SIZE];
+/// Events recorded
+static volatile uint32_t eventMask = TRACE_RECORDER_DEFAULT_MASK;
+/// Records dropped since the startup
+static uint32_t droppedTotal;
+/// Records dropped since the last one written, reported before the next one
+static uint32_t droppedPending;
+
+static void put(Record* record, uint64_t value, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        record->bytes[record->length++] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static bool begin(Record* record, TRACE_RECORDER_Event event) {
+    if (0 == (eventMask & TRACE_RECORDER_MASK(event))) {
+        return false;
+    }
+    record->length = 0;
+    put(record, (uint64_t)event, 1);
+    put(record, 0, 1); // payload length, set on commit
+    put(record, EMBENET_TIMER_ReadCounter(), 4);
+    return true;
+}
+
+static void commit(Record* record) {
+    record->bytes[1] = (uint8_t)(record->length - HEADER_SIZE);
+    // events come from any context of the stack, including the radio interrupt, and the write is a short copy done in the critical section
+    EMBENET_CRITICAL_SECTION_Enter();
+    if (0 != droppedPending) {
+        Record dropped;
+        dropped.length = 0;
+        put(&dropped, TRACE_RECORDER_EVENT_DROPPED, 1);
+        put(&dropped, 4, 1);
+        put(&dropped, EMBENET_TIMER_ReadCounter(), 4);
+        put(&dropped, droppedPending, 4);
+        if (0 != SEGGER_RTT_WriteSkipNoLock(TRACE_RECORDER_RTT_BUFFER, dropped.bytes, (unsigned)dropped.length)) {
+            droppedPending = 0;
+        }
+    }
+    // after a loss the record is written only once the loss is reported, so the host knows where the gap is
+    if ((0 != droppedPending) || (0 == SEGGER_RTT_WriteSkipNoLock(TRACE_RECORDER_RTT_BUFFER, record->bytes, (unsigned)record->length))) {
+        droppedPending++;
+        droppedTotal++;
+    }
+    EMBENET_CRITICAL_SECTION_Exit();
+}
+
+/// Records an event with a single argument
+static void recordValue(TRACE_RECORDER_Event event, uint64_t value, size_t size) {
+    Record record;
+    if (begin(&record, event)) {
+        put(&record, value, size);
+        commit(&record);
+    }
+}
+
+/// Records an event with two EUIs
+static void recordEuis(TRACE_RECORDER_Event event, uint64_t first, uint64_t second) {
+    Record record;
+    if (begin(&record, event)) {
+        put(&record, first, 8);
+        put(&record, second, 8);
+        commit(&record);
+    }
+}
+
+void trace_recorder_init(void) {
+    SEGGER_RTT_ConfigUpBuffer(TRACE_RECORDER_RTT_BUFFER, "trace", rttBuffer, sizeof(rttBuffer), SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+}
+
+void trace_recorder_set_mask(uint32_t mask) {
+    eventMask = mask;
+}
+
+uint32_t trace_recorder_get_dropped(void) {
+    return droppedTotal;
+}
+
+void trace_recorder_started(uint64_t eui) {
+    recordValue(TRACE_RECORDER_EVENT_STARTED, eui, 8);
+}
+
+void trace_recorder_synchronized(uint16_t panid) {
+    recordValue(TRACE_RECORDER_EVENT_SYNCHRONIZED, panid, 2);
+}
+
+void trace_recorder_desynchronized(void) {
+    recordValue(TRACE_RECORDER_EVENT_DESYNCHRONIZED, 0, 0);
+}
+
+void trace_recorder_packet_no_ack(uint64_t linkLocalDestinationEui, uint64_t destinationEui, uint8_t attempt) {
+    Record record;
+    if (begin(&record, TRACE_RECORDER_EVENT_PACKET_NO_ACK)) {
+        put(&record, linkLocalDestinationEui, 8);
+        put(&record, destinationEui, 8);
+        put(&record, attempt, 1);
+        commit(&record);
+    }
+}
+
+void trace_recorder_managed_packet_no_ack(uint64_t linkLocalDestinationEui) {
+    recordValue(TRACE_RECORDER_EVENT_MANAGED_PACKET_NO_ACK, linkLocalDestinationEui, 8);
+}
+
+void trace_recorder_packet_not_delivered(uint64_t linkLocalDestinationEui, uint64_t destinationEui) {
+    recordEuis(TRACE_RECORDER_EVENT_PACKET_NOT_DELIVERED, linkLocalDestinationEui, destinationEui);
+}
+
+void trace_recorder_joined(uint64_t parentEui) {
+    recordValue(TRACE_RECORDER_EVENT_JOINED, parentEui, 8);
+}
+
+void trace_recorder_sync_correction(int32_t us) {
+    recordValue(TRACE_RECORDER_EVENT_SYNC_CORRECTION, (uint32_t)us, 4);
+}
+
+void trace_recorder_parent_selected(uint64_t parentEui) {
+    recordValue(TRACE_RECORDER_EVENT_PARENT_SELECTED, parentEui, 8);
+}
+
+void trace_recorder_parent_lost(uint64_t parentEui) {
+    recordValue(TRACE_RECORDER_EVENT_PARENT_LOST, parentEui, 8);
+}
+
+void trace_recorder_neighbor_added(uint64_t neighborEui, int8_t rssi) {
+    Record record;
+    if (begin(&record, TRACE_RECORDER_EVENT_NEIGHBOR_ADDED)) {
+        put(&record, neighborEui, 8);
+        put(&record, (uint8_t)rssi, 1);
+        commit(&record);
+    }
+}
+
+void trace_recorder_neighbor_removed(uint64_t neighborEui) {
+    recordValue(TRACE_RECORDER_EVENT_NEIGHBOR_REMOVED, neighborEui, 8);
+}
+
+void trace_recorder_rank_update(uint16_t rank) {
+    recordValue(TRACE_RECORDER_EVENT_RANK_UPDATE, rank, 2);
+}
+
+void trace_recorder_queue_length(size_t length) {
+    recordValue(TRACE_RECORDER_EVENT_QUEUE_LENGTH, (length > UINT16_MAX) ? UINT16_MAX : length, 2);
+}
+
+void trace_recorder_enms_status_sent(void) {
+    recordValue(TRACE_RECORDER_EVENT_ENMS_STATUS_SENT, 0, 0);
+}
+
+void trace_recorder_link_layer_event(EMBENET_TRACE_LinkLayerTelemetry const* telemetry) {
+    Record record;
+    if (begin(&record, TRACE_RECORDER_EVENT_LINK_LAYER)) {
+        put(&record, (uint64_t)telemetry->cellEvent, 1);
+        put(&record, (uint64_t)telemetry->cellRole, 1);
+        put(&record, (uint64_t)telemetry->frameType, 1);
+        put(&record, telemetry->channelOffset, 1);
+        put(&record, telemetry->slotOffset, 2);
+        put(&record, (uint8_t)telemetry->rssiOrTxPower, 1);
+        put(&record, telemetry->length, 2);
+        put(&record, telemetry->asn, 5);
+        put(&record, telemetry->src, 8);
+        put(&record, telemetry->dst, 8);
+        put(&record, telemetry->node, 8);
+        commit(&record);
+    }
+}
+
+void trace_recorder_free_slots(uint64_t asn, uint64_t startNwkTime, uint32_t durationUs) {
+    Record record;
+    if (begin(&record, TRACE_RECORDER_EVENT_FREE_SLOTS)) {
+        put(&record, asn, 5);
+        put(&record, startNwkTime, 8);
+        put(&record, durationUs, 4);
+        commit(&record);
+    }
+}
+
+void trace_recorder_slot(bool enters) {
+    recordValue(TRACE_RECORDER_EVENT_SLOT, enters, 1);
+}
+
+void trace_recorder_mac_routine(bool enters) {
+    recordValue(TRACE_RECORDER_EVENT_MAC_ROUTINE, enters, 1);
+}
+
+void trace_recorder_radio_api(bool enters) {
+    recordValue(TRACE_RECORDER_EVENT_RADIO_API, enters, 1);
+}
+
+void trace_recorder_radio_isr(bool enters) {
+    recordValue(TRACE_RECORDER_EVENT_RADIO_ISR, enters, 1);
+}
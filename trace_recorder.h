@@ -0,0 +1,113 @@
+/**
+@file
+@copyright (c) 2023 EMBETECH SP. Z O.O. All rights reserved.
+@version   1.1.4417
+@purpose   embeNET demo
+@brief     Binary recorder of the stack trace events
+
+Every trace event of the stack is written as a compact binary record to its own RTT up-buffer (TRACE_RECORDER_RTT_BUFFER), in a single
+write that never waits: if the host does not read the buffer fast enough the record is dropped whole and counted. The RTT buffer is a
+plain RAM ring, so the latest records can also be read out with a debugger from a node that is not connected. The host decodes the
+capture with tools/trace_decode.py, which also exports a timeline.
+
+Record (little endian):
+ offset | size | field
+ -------|------|---------------------------------------------
+ 0      | 1    | event (@ref TRACE_RECORDER_Event)
+ 1      | 1    | length of the payload
+ 2      | 4    | time [us] (port timer)
+ 6      | ...  | payload, the arguments of the handler in order:
+        |      | EUIs 8 bytes, ASNs 5 bytes, bools 1 byte, sizes and ranks 2 bytes
+*/
+
+#ifndef TRACE_RECORDER_H_
+#define TRACE_RECORDER_H_
+
+#include "embenet_node_trace.h"
+#include <stdint.h>
+
+#define TRACE_RECORDER_RTT_BUFFER  2    ///< RTT up-buffer the records are written to
+#define TRACE_RECORDER_BUFFER_SIZE 2048 ///< size of the RTT up-buffer [bytes]
+
+/// Events recorded, named after the trace handlers
+typedef enum {
+    TRACE_RECORDER_EVENT_STARTED               = 1,
+    TRACE_RECORDER_EVENT_SYNCHRONIZED          = 2,
+    TRACE_RECORDER_EVENT_DESYNCHRONIZED        = 3,
+    TRACE_RECORDER_EVENT_PACKET_NO_ACK         = 4,
+    TRACE_RECORDER_EVENT_MANAGED_PACKET_NO_ACK = 5,
+    TRACE_RECORDER_EVENT_PACKET_NOT_DELIVERED  = 6,
+    TRACE_RECORDER_EVENT_JOINED                = 7,
+    TRACE_RECORDER_EVENT_SYNC_CORRECTION       = 8,
+    TRACE_RECORDER_EVENT_PARENT_SELECTED       = 9,
+    TRACE_RECORDER_EVENT_PARENT_LOST           = 10,
+    TRACE_RECORDER_EVENT_NEIGHBOR_ADDED        = 11,
+    TRACE_RECORDER_EVENT_NEIGHBOR_REMOVED      = 12,
+    TRACE_RECORDER_EVENT_RANK_UPDATE           = 13,
+    TRACE_RECORDER_EVENT_QUEUE_LENGTH          = 14,
+    TRACE_RECORDER_EVENT_ENMS_STATUS_SENT      = 15,
+    TRACE_RECORDER_EVENT_LINK_LAYER            = 16,
+    TRACE_RECORDER_EVENT_FREE_SLOTS            = 17,
+    TRACE_RECORDER_EVENT_SLOT                  = 18,
+    TRACE_RECORDER_EVENT_MAC_ROUTINE           = 19,
+    TRACE_RECORDER_EVENT_RADIO_API             = 20,
+    TRACE_RECORDER_EVENT_RADIO_ISR             = 21,
+    TRACE_RECORDER_EVENT_DROPPED               = 31, ///< payload: number of records dropped since the previous one written (4 bytes)
+} TRACE_RECORDER_Event;
+
+/// Mask of an event for @ref trace_recorder_set_mask
+#define TRACE_RECORDER_MASK(event) ((uint32_t)1 << (event))
+
+/// Events recorded by default: all but the enter/leave pairs of the slots and the MAC and radio routines, which come several times per slot
+#define TRACE_RECORDER_DEFAULT_MASK                                                                                                      \
+    (~(TRACE_RECORDER_MASK(TRACE_RECORDER_EVENT_SLOT) | TRACE_RECORDER_MASK(TRACE_RECORDER_EVENT_MAC_ROUTINE) |                          \
+       TRACE_RECORDER_MASK(TRACE_RECORDER_EVENT_RADIO_API) | TRACE_RECORDER_MASK(TRACE_RECORDER_EVENT_RADIO_ISR)))
+
+/**
+ * @brief Configures the RTT up-buffer of the recorder. Must be called after SEGGER_RTT_Init.
+ */
+void trace_recorder_init(void);
+
+/**
+ * @brief Selects the events to record.
+ *
+ * @param[in] mask ORed @ref TRACE_RECORDER_MASK of the events, UINT32_MAX records all of them
+ */
+void trace_recorder_set_mask(uint32_t mask);
+
+/**
+ * @brief Gets the number of records dropped because the RTT buffer was full.
+ *
+ * @return number of dropped records since the startup
+ */
+uint32_t trace_recorder_get_dropped(void);
+
+/**
+ * @name Recorders of the trace events
+ * Called from the trace handlers installed by app_trace.c, with the arguments of the handlers. Events cleared from the mask are skipped.
+ * @{
+ */
+void trace_recorder_started(uint64_t eui);
+void trace_recorder_synchronized(uint16_t panid);
+void trace_recorder_desynchronized(void);
+void trace_recorder_packet_no_ack(uint64_t linkLocalDestinationEui, uint64_t destinationEui, uint8_t attempt);
+void trace_recorder_managed_packet_no_ack(uint64_t linkLocalDestinationEui);
+void trace_recorder_packet_not_delivered(uint64_t linkLocalDestinationEui, uint64_t destinationEui);
+void trace_recorder_joined(uint64_t parentEui);
+void trace_recorder_sync_correction(int32_t us);
+void trace_recorder_parent_selected(uint64_t parentEui);
+void trace_recorder_parent_lost(uint64_t parentEui);
+void trace_recorder_neighbor_added(uint64_t neighborEui, int8_t rssi);
+void trace_recorder_neighbor_removed(uint64_t neighborEui);
+void trace_recorder_rank_update(uint16_t rank);
+void trace_recorder_queue_length(size_t length);
+void trace_recorder_enms_status_sent(void);
+void trace_recorder_link_layer_event(EMBENET_TRACE_LinkLayerTelemetry const* telemetry);
+void trace_recorder_free_slots(uint64_t asn, uint64_t startNwkTime, uint32_t durationUs);
+void trace_recorder_slot(bool enters);
+void trace_recorder_mac_routine(bool enters);
+void trace_recorder_radio_api(bool enters);
+void trace_recorder_radio_isr(bool enters);
+/** @} */
+
+#endif // TRACE_RECORDER_H_